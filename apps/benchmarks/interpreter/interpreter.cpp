@@ -0,0 +1,219 @@
+#include <benchmark/benchmark.h>
+
+#include <sstream>
+#include <stdexcept>
+
+#include <components/compiler/context.hpp>
+#include <components/compiler/extensions.hpp>
+#include <components/compiler/fileparser.hpp>
+#include <components/compiler/scanner.hpp>
+#include <components/compiler/streamerrorhandler.hpp>
+#include <components/interpreter/context.hpp>
+#include <components/interpreter/installopcodes.hpp>
+#include <components/interpreter/interpreter.hpp>
+
+namespace
+{
+    /// Local scripts in the style of the ones shipped with the game: timers, distance checks and state machines
+    /// driven by local and global variables. Only built-in instructions are used, so the scripts run without the
+    /// game's extensions.
+    const char* const sScripts[] = {
+        R"(
+            Begin LightFlicker
+                float timer
+                short state
+                if ( MenuMode == 1 )
+                    return
+                endif
+                set timer to timer + GetSecondsPassed
+                if ( timer < 0.25 )
+                    return
+                endif
+                set timer to 0
+                if ( state == 0 )
+                    set state to 1
+                elseif ( state == 1 )
+                    set state to 2
+                else
+                    set state to 0
+                endif
+            End
+        )",
+        R"(
+            Begin GuardPatrol
+                short doOnce
+                short step
+                float wait
+                long visits
+                if ( MenuMode )
+                    return
+                endif
+                if ( doOnce == 0 )
+                    set doOnce to 1
+                    set step to 0
+                endif
+                if ( GetDistance "player" > 1024 )
+                    return
+                endif
+                set wait to wait + GetSecondsPassed
+                if ( wait >= 2.0 )
+                    set wait to 0
+                    set step to step + 1
+                    set visits to visits + 1
+                    if ( step > 4 )
+                        set step to 0
+                    endif
+                endif
+                if ( GlobalState == 3 )
+                    set visits to 0
+                endif
+            End
+        )",
+        R"(
+            Begin CounterLoop
+                short i
+                short sum
+                float scale
+                set i to 0
+                set sum to 0
+                while ( i < 20 )
+                    if ( i == 5 )
+                        set sum to sum + 10
+                    elseif ( i >= 15 )
+                        set sum to sum + 2
+                    else
+                        set sum to sum + 1
+                    endif
+                    set i to i + 1
+                endwhile
+                set scale to sum * 0.5
+                if ( scale != 0 )
+                    set GlobalState to sum
+                endif
+            End
+        )",
+    };
+
+    struct CompilerContext : Compiler::Context
+    {
+        bool canDeclareLocals() const override { return true; }
+        char getGlobalType(const std::string& name) const override { return name == "globalstate" ? 's' : ' '; }
+        std::pair<char, bool> getMemberType(const std::string&, const std::string&) const override { return {' ', false}; }
+        bool isId(const std::string& name) const override { return name == "player"; }
+        bool isJournalId(const std::string&) const override { return false; }
+    };
+
+    struct InterpreterContext : Interpreter::Context
+    {
+        std::vector<int> mShorts = std::vector<int>(8, 0);
+        std::vector<int> mLongs = std::vector<int>(8, 0);
+        std::vector<float> mFloats = std::vector<float>(8, 0);
+        int mGlobalState = 0;
+
+        int getLocalShort(int index) const override { return mShorts[index]; }
+        int getLocalLong(int index) const override { return mLongs[index]; }
+        float getLocalFloat(int index) const override { return mFloats[index]; }
+        void setLocalShort(int index, int value) override { mShorts[index] = value; }
+        void setLocalLong(int index, int value) override { mLongs[index] = value; }
+        void setLocalFloat(int index, float value) override { mFloats[index] = value; }
+        bool menuMode() override { return false; }
+        int getGlobalShort(const std::string&) const override { return mGlobalState; }
+        int getGlobalLong(const std::string&) const override { return mGlobalState; }
+        float getGlobalFloat(const std::string&) const override { return static_cast<float>(mGlobalState); }
+        void setGlobalShort(const std::string&, int value) override { mGlobalState = value; }
+        void setGlobalLong(const std::string&, int value) override { mGlobalState = value; }
+        void setGlobalFloat(const std::string&, float value) override { mGlobalState = static_cast<int>(value); }
+        char getGlobalType(const std::string&) const override { return 's'; }
+        float getDistance(const std::string&, const std::string&) const override { return 512; }
+        float getSecondsPassed() const override { return 1 / 60.0f; }
+
+        void messageBox(const std::string&, const std::vector<std::string>&) override { unsupported(); }
+        void report(const std::string&) override { unsupported(); }
+        std::vector<std::string> getGlobals() const override { unsupported(); }
+        std::string getActionBinding(const std::string&) const override { unsupported(); }
+        std::string getActorName() const override { unsupported(); }
+        std::string getNPCRace() const override { unsupported(); }
+        std::string getNPCClass() const override { unsupported(); }
+        std::string getNPCFaction() const override { unsupported(); }
+        std::string getNPCRank() const override { unsupported(); }
+        std::string getPCName() const override { unsupported(); }
+        std::string getPCRace() const override { unsupported(); }
+        std::string getPCClass() const override { unsupported(); }
+        std::string getPCRank() const override { unsupported(); }
+        std::string getPCNextRank() const override { unsupported(); }
+        int getPCBounty() const override { unsupported(); }
+        std::string getCurrentCellName() const override { unsupported(); }
+        bool isScriptRunning(const std::string&) const override { unsupported(); }
+        void startScript(const std::string&, const std::string&) override { unsupported(); }
+        void stopScript(const std::string&) override { unsupported(); }
+        bool isDisabled(const std::string&) const override { unsupported(); }
+        void enable(const std::string&) override { unsupported(); }
+        void disable(const std::string&) override { unsupported(); }
+        int getMemberShort(const std::string&, const std::string&, bool) const override { unsupported(); }
+        int getMemberLong(const std::string&, const std::string&, bool) const override { unsupported(); }
+        float getMemberFloat(const std::string&, const std::string&, bool) const override { unsupported(); }
+        void setMemberShort(const std::string&, const std::string&, int, bool) override { unsupported(); }
+        void setMemberLong(const std::string&, const std::string&, int, bool) override { unsupported(); }
+        void setMemberFloat(const std::string&, const std::string&, float, bool) override { unsupported(); }
+        std::string getTargetId() const override { unsupported(); }
+
+        [[noreturn]] static void unsupported()
+        {
+            throw std::logic_error("unsupported in benchmark");
+        }
+    };
+
+    std::vector<std::vector<Interpreter::Type_Code>> compileScripts()
+    {
+        CompilerContext context;
+        Compiler::Extensions extensions;
+        context.setExtensions(&extensions);
+        Compiler::StreamErrorHandler errorHandler;
+
+        std::vector<std::vector<Interpreter::Type_Code>> result;
+        for (const char* script : sScripts)
+        {
+            Compiler::FileParser parser(errorHandler, context);
+            std::istringstream input(script);
+            Compiler::Scanner scanner(errorHandler, input, &extensions);
+            scanner.scan(parser);
+            if (!errorHandler.isGood())
+                throw std::runtime_error("failed to compile benchmark script");
+            result.emplace_back();
+            parser.getCode(result.back());
+        }
+        return result;
+    }
+
+    /// Run every script once per iteration. The argument selects how the scripts are run: 0 decodes the byte code
+    /// on every run, 1 runs decoded programs without superinstructions, 2 runs decoded programs with
+    /// superinstructions as ScriptManager does.
+    void runScripts(benchmark::State& state)
+    {
+        const std::vector<std::vector<Interpreter::Type_Code>> scripts = compileScripts();
+        Interpreter::Interpreter interpreter;
+        Interpreter::installOpcodes(interpreter);
+
+        std::vector<Interpreter::Program> programs;
+        for (const auto& code : scripts)
+            programs.push_back(interpreter.decode(code.data(), static_cast<int>(code.size()), state.range(0) == 2));
+
+        std::vector<InterpreterContext> contexts(scripts.size());
+
+        for (auto _ : state)
+        {
+            for (std::size_t i = 0; i < scripts.size(); ++i)
+            {
+                if (state.range(0) == 0)
+                    interpreter.run(scripts[i].data(), static_cast<int>(scripts[i].size()), contexts[i]);
+                else
+                    interpreter.run(programs[i], contexts[i]);
+            }
+        }
+
+        state.counters["instructions"] = benchmark::Counter(static_cast<double>(interpreter.getExecutedInstructions()),
+            benchmark::Counter::kIsRate);
+    }
+}
+
+BENCHMARK(runScripts)->Arg(0)->Arg(1)->Arg(2);
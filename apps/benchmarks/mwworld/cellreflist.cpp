@@ -0,0 +1,88 @@
+#include <benchmark/benchmark.h>
+
+#include <list>
+#include <memory>
+#include <vector>
+
+#include <components/esm/cellref.hpp>
+#include <components/misc/stablevector.hpp>
+
+namespace
+{
+    const std::size_t sCellsCount = 9;
+    const std::size_t sTypesCount = 21;
+    const std::size_t sReferencesPerCell = 3000;
+
+    /// Stand-in for MWWorld::LiveCellRef, which can't be created without the game world: the loaded reference plus
+    /// roughly the size of the runtime state.
+    struct Reference
+    {
+        ESM::CellRef mRef;
+        char mRefData[160];
+        int mCount;
+        bool mDeletedByContentFile;
+
+        Reference(std::size_t index)
+            : mCount(index % 50 == 0 ? 0 : 1)
+            , mDeletedByContentFile(index % 200 == 0)
+        {
+            mRef.blank();
+            mRef.mRefNum.mIndex = static_cast<unsigned int>(index);
+            mRef.mRefID = "reference_" + std::to_string(index % 500);
+            mRef.mPos.pos[0] = static_cast<float>(index % 8192);
+            mRef.mPos.pos[1] = static_cast<float>(index / 8192);
+        }
+    };
+
+    template <class Container>
+    struct Cell
+    {
+        std::vector<Container> mLists {sTypesCount};
+    };
+
+    /// Load the 3x3 exterior cells around the player. References of a cell come in file order, where the types are
+    /// mixed, and each reference allocates its strings on the way, like CellStore::loadRefs does.
+    template <class Container>
+    std::vector<std::unique_ptr<Cell<Container>>> loadCells()
+    {
+        std::vector<std::unique_ptr<Cell<Container>>> cells;
+        for (std::size_t i = 0; i < sCellsCount; ++i)
+        {
+            cells.emplace_back(new Cell<Container>);
+            for (std::size_t j = 0; j < sReferencesPerCell; ++j)
+                cells.back()->mLists[(j * 5) % sTypesCount].push_back(Reference(i * sReferencesPerCell + j));
+        }
+        return cells;
+    }
+
+    /// Visit every accessible reference of the loaded cells, as CellStore::forEach does for scripts, AI and physics.
+    template <class Container>
+    void iterateCellRefs(benchmark::State& state)
+    {
+        const auto cells = loadCells<Container>();
+
+        for (auto _ : state)
+        {
+            float sum = 0;
+            for (const auto& cell : cells)
+            {
+                for (const auto& list : cell->mLists)
+                {
+                    for (const Reference& ref : list)
+                    {
+                        if (ref.mDeletedByContentFile || (!ref.mRef.mRefNum.hasContentFile() && ref.mCount <= 0))
+                            continue;
+                        sum += ref.mRef.mPos.pos[0];
+                    }
+                }
+            }
+            benchmark::DoNotOptimize(sum);
+        }
+
+        state.counters["references"] = benchmark::Counter(
+            static_cast<double>(state.iterations() * sCellsCount * sReferencesPerCell), benchmark::Counter::kIsRate);
+    }
+}
+
+BENCHMARK_TEMPLATE(iterateCellRefs, std::list<Reference>);
+BENCHMARK_TEMPLATE(iterateCellRefs, Misc::StableVector<Reference>);
@@ -0,0 +1,300 @@
+#include <benchmark/benchmark.h>
+
+#include <chrono>
+#include <thread>
+
+#include <boost/filesystem/fstream.hpp>
+#include <boost/filesystem/operations.hpp>
+
+#include <components/esm/esmreader.hpp>
+#include <components/esm/esmwriter.hpp>
+#include <components/loadinglistener/loadinglistener.hpp>
+
+#include "apps/openmw/mwworld/esmloader.hpp"
+#include "apps/openmw/mwworld/esmstore.hpp"
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    const std::size_t sPluginsCount = 32;
+    const std::size_t sMasterRecordsPerType = 20000;
+    const std::size_t sPluginRecordsPerType = 2000;
+    const std::size_t sInfosPerDialogue = 20;
+    const std::size_t sCellsCount = 200;
+    const std::size_t sReferencesPerCell = 500;
+
+    template <class T>
+    void writeRecord(ESM::ESMWriter& writer, const T& record)
+    {
+        writer.startRecord(T::sRecordId);
+        record.save(writer);
+        writer.endRecord(T::sRecordId);
+    }
+
+    /// Write a content file with statics, miscellaneous items, books and dialogues, and interior cells for the
+    /// master. Plugins override half of the master records and add as many new ones, so that merging has to deal
+    /// with both cases.
+    void writeContentFile(const boost::filesystem::path& path, std::size_t index, std::size_t recordsPerType,
+        const boost::filesystem::path& master)
+    {
+        ESM::ESMWriter writer;
+        writer.setVersion();
+        writer.setType(index == 0 ? 1 : 0);
+        writer.setFormat(0);
+        writer.setAuthor("openmw_benchmarks");
+        writer.setDescription("Synthetic content file");
+        if (index != 0)
+            writer.addMaster(master.filename().string(), boost::filesystem::file_size(master));
+
+        boost::filesystem::ofstream stream(path, std::ios::binary);
+        writer.save(stream);
+
+        ESM::Class cls;
+        cls.blank();
+        cls.mId = "class";
+        cls.mName = "Class";
+        writeRecord(writer, cls);
+
+        for (std::size_t i = 0; i < recordsPerType; ++i)
+        {
+            const std::string id = std::to_string(index == 0 || i % 2 == 0 ? 0 : index) + "_" + std::to_string(i);
+
+            ESM::Static stat;
+            stat.blank();
+            stat.mId = "static_" + id;
+            stat.mModel = "meshes/x/ex_static_" + id + ".nif";
+            writeRecord(writer, stat);
+
+            ESM::Miscellaneous misc;
+            misc.blank();
+            misc.mId = "misc_" + id;
+            misc.mName = "Miscellaneous item " + id;
+            misc.mModel = "meshes/m/misc_" + id + ".nif";
+            misc.mIcon = "m/misc_" + id + ".tga";
+            writeRecord(writer, misc);
+
+            ESM::Book book;
+            book.blank();
+            book.mId = "book_" + id;
+            book.mName = "Book " + id;
+            book.mText = std::string(512, 'x');
+            writeRecord(writer, book);
+        }
+
+        for (std::size_t i = 0; i < recordsPerType / sInfosPerDialogue; ++i)
+        {
+            ESM::Dialogue dialogue;
+            dialogue.blank();
+            dialogue.mId = "topic " + std::to_string(i);
+            dialogue.mType = ESM::Dialogue::Topic;
+            writeRecord(writer, dialogue);
+
+            for (std::size_t j = 0; j < sInfosPerDialogue; ++j)
+            {
+                ESM::DialInfo info;
+                info.blank();
+                info.mId = std::to_string(index) + "_" + std::to_string(i) + "_" + std::to_string(j);
+                info.mPrev = j == 0 ? std::string() : std::to_string(index) + "_" + std::to_string(i) + "_" + std::to_string(j - 1);
+                info.mNext = j + 1 == sInfosPerDialogue ? std::string() : std::to_string(index) + "_" + std::to_string(i) + "_" + std::to_string(j + 1);
+                info.mResponse = std::string(128, 'y');
+                writeRecord(writer, info);
+            }
+        }
+
+        for (std::size_t i = 0; index == 0 && i < sCellsCount; ++i)
+        {
+            ESM::Cell cell;
+            cell.blank();
+            cell.mName = "Interior " + std::to_string(i);
+            cell.mData.mFlags = ESM::Cell::Interior;
+
+            writer.startRecord(ESM::Cell::sRecordId);
+            cell.save(writer);
+            for (std::size_t j = 0; j < sReferencesPerCell; ++j)
+            {
+                ESM::CellRef ref;
+                ref.blank();
+                ref.mRefNum.mIndex = static_cast<unsigned int>(i * sReferencesPerCell + j);
+                ref.mRefID = "static_0_" + std::to_string(j);
+                ref.save(writer);
+            }
+            writer.endRecord(ESM::Cell::sRecordId);
+        }
+
+        writer.close();
+    }
+
+    struct SyntheticLoadOrder
+    {
+        boost::filesystem::path mDirectory;
+        std::vector<boost::filesystem::path> mFiles;
+
+        SyntheticLoadOrder()
+            : mDirectory(boost::filesystem::temp_directory_path() / boost::filesystem::unique_path())
+        {
+            boost::filesystem::create_directories(mDirectory);
+            mFiles.push_back(mDirectory / "Master.esm");
+            writeContentFile(mFiles.front(), 0, sMasterRecordsPerType, mFiles.front());
+            for (std::size_t i = 1; i <= sPluginsCount; ++i)
+            {
+                mFiles.push_back(mDirectory / ("Plugin" + std::to_string(i) + ".esp"));
+                writeContentFile(mFiles.back(), i, sPluginRecordsPerType, mFiles.front());
+            }
+        }
+
+        ~SyntheticLoadOrder()
+        {
+            boost::filesystem::remove_all(mDirectory);
+        }
+    };
+
+    const std::vector<boost::filesystem::path>& getContentFiles()
+    {
+        static const SyntheticLoadOrder loadOrder;
+        return loadOrder.mFiles;
+    }
+
+    double toMilliseconds(Clock::duration duration)
+    {
+        return std::chrono::duration<double, std::milli>(duration).count();
+    }
+
+    /// Decoding phase only: stage every content file with the given number of threads
+    void stageContentFiles(benchmark::State& state)
+    {
+        const std::vector<boost::filesystem::path>& files = getContentFiles();
+        const MWWorld::ESMStore store;
+
+        for (auto _ : state)
+        {
+            std::vector<MWWorld::StagedContent> staged(files.size());
+            std::vector<std::thread> threads;
+            for (int thread = 0; thread < state.range(0); ++thread)
+                threads.emplace_back([&, thread]
+                {
+                    for (std::size_t i = thread; i < files.size(); i += state.range(0))
+                    {
+                        ESM::ESMReader reader;
+                        reader.setIndex(static_cast<int>(i));
+                        reader.open(files[i].string());
+                        staged[i] = store.stage(reader);
+                    }
+                });
+            for (auto& thread : threads)
+                thread.join();
+            benchmark::DoNotOptimize(staged);
+        }
+    }
+
+    /// Merging phase only: insert previously staged content files in load order
+    void mergeContentFiles(benchmark::State& state)
+    {
+        const std::vector<boost::filesystem::path>& files = getContentFiles();
+        Loading::Listener listener;
+
+        for (auto _ : state)
+        {
+            state.PauseTiming();
+            MWWorld::ESMStore store;
+            std::vector<MWWorld::StagedContent> staged;
+            for (std::size_t i = 0; i < files.size(); ++i)
+            {
+                ESM::ESMReader reader;
+                reader.setIndex(static_cast<int>(i));
+                reader.open(files[i].string());
+                staged.push_back(store.stage(reader));
+            }
+            std::vector<ESM::ESMReader> readers(files.size());
+            state.ResumeTiming();
+
+            for (std::size_t i = 0; i < files.size(); ++i)
+            {
+                readers[i].setIndex(static_cast<int>(i));
+                readers[i].setGlobalReaderList(&readers);
+                readers[i].open(files[i].string());
+                store.merge(readers[i], staged[i], &listener);
+            }
+        }
+    }
+
+    /// Read the references of every cell the way CellStore::loadRefs does. The argument is whether the content
+    /// file is memory mapped.
+    void loadCellReferences(benchmark::State& state)
+    {
+        const boost::filesystem::path& master = getContentFiles().front();
+        Loading::Listener listener;
+        MWWorld::ESMStore store;
+        std::vector<ESM::ESMReader> readers(1);
+        readers[0].setIndex(0);
+        readers[0].setGlobalReaderList(&readers);
+        if (state.range(0) != 0)
+            readers[0].openMapped(master.string());
+        else
+            readers[0].open(master.string());
+        store.load(readers[0], &listener);
+        store.setUp(true);
+
+        std::size_t references = 0;
+        for (auto _ : state)
+        {
+            const MWWorld::Store<ESM::Cell>& cells = store.get<ESM::Cell>();
+            for (auto cell = cells.intBegin(); cell != cells.intEnd(); ++cell)
+            {
+                for (std::size_t i = 0; i < cell->mContextList.size(); ++i)
+                {
+                    cell->restore(readers[0], static_cast<int>(i));
+                    ESM::CellRef ref;
+                    bool deleted = false;
+                    while (cell->getNextRef(readers[0], ref, deleted))
+                        ++references;
+                }
+            }
+        }
+
+        state.counters["references"] = benchmark::Counter(static_cast<double>(references), benchmark::Counter::kIsRate);
+    }
+
+    /// Whole startup content loading as done by the engine, reporting the time spent in each phase.
+    /// Arguments are the number of threads and whether content files are memory mapped.
+    void loadContentFiles(benchmark::State& state)
+    {
+        const std::vector<boost::filesystem::path>& files = getContentFiles();
+        Loading::Listener listener;
+        double loadTime = 0;
+        double setUpTime = 0;
+
+        for (auto _ : state)
+        {
+            MWWorld::ESMStore store;
+            std::vector<ESM::ESMReader> readers(files.size());
+
+            const Clock::time_point start = Clock::now();
+            {
+                MWWorld::EsmLoader loader(store, readers, nullptr, listener, static_cast<int>(state.range(0)),
+                    state.range(1) != 0);
+                for (std::size_t i = 0; i < files.size(); ++i)
+                    loader.stage(files[i], static_cast<int>(i));
+                for (std::size_t i = 0; i < files.size(); ++i)
+                {
+                    int index = static_cast<int>(i);
+                    loader.load(files[i], index);
+                }
+            }
+            const Clock::time_point loaded = Clock::now();
+            store.setUp(true);
+            const Clock::time_point done = Clock::now();
+
+            loadTime += toMilliseconds(loaded - start);
+            setUpTime += toMilliseconds(done - loaded);
+        }
+
+        state.counters["load_ms"] = benchmark::Counter(loadTime, benchmark::Counter::kAvgIterations);
+        state.counters["setup_ms"] = benchmark::Counter(setUpTime, benchmark::Counter::kAvgIterations);
+    }
+}
+
+BENCHMARK(stageContentFiles)->Arg(1)->Arg(2)->Arg(4)->Arg(8)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(mergeContentFiles)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(loadCellReferences)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(loadContentFiles)->ArgsProduct({{1, 2, 4, 8}, {0, 1}})->Unit(benchmark::kMillisecond)->UseRealTime();
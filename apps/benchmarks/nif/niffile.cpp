@@ -0,0 +1,89 @@
+#include <benchmark/benchmark.h>
+
+#include <boost/filesystem/operations.hpp>
+
+#include <components/misc/stringops.hpp>
+#include <components/nif/niffile.hpp>
+#include <components/vfs/bsaarchive.hpp>
+#include <components/vfs/filesystemarchive.hpp>
+#include <components/vfs/manager.hpp>
+
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+namespace
+{
+    /// Every NIF file of the data directory given by OPENMW_BENCHMARK_DATA, with its archives and loose files,
+    /// the way niftest walks it
+    struct NifFiles
+    {
+        VFS::Manager mVFS {false};
+        std::vector<std::string> mNames;
+        std::int64_t mBytes = 0;
+
+        explicit NifFiles(const boost::filesystem::path& path)
+        {
+            for (boost::filesystem::directory_iterator it(path), end; it != end; ++it)
+                if (Misc::StringUtils::lowerCase(it->path().extension().string()) == ".bsa")
+                    mVFS.addArchive(new VFS::BsaArchive(it->path().string()));
+            mVFS.addArchive(new VFS::FileSystemArchive(path.string()));
+            mVFS.buildIndex();
+
+            // Names in the index are normalized to lower case
+            for (const auto& file : mVFS.getIndex())
+            {
+                const std::string& name = file.first;
+                if (name.size() <= 4 || name.compare(name.size() - 4, 4, ".nif") != 0)
+                    continue;
+                mNames.push_back(name);
+                Files::IStreamPtr stream = mVFS.getNormalized(name);
+                stream->seekg(0, std::ios_base::end);
+                mBytes += static_cast<std::int64_t>(stream->tellg());
+            }
+        }
+    };
+
+    /// Parse every NIF file of the data directory, reported in bytes of NIF data per second.
+    /// Arg 0: whether the files are read into memory before they are decoded.
+    void parseAllNifs(benchmark::State& state)
+    {
+        const bool buffered = state.range(0) != 0;
+        state.SetLabel(buffered ? "buffered" : "streamed");
+
+        const char* const dataPath = std::getenv("OPENMW_BENCHMARK_DATA");
+        if (dataPath == nullptr || !boost::filesystem::is_directory(dataPath))
+        {
+            state.SkipWithError("OPENMW_BENCHMARK_DATA is not set to a data directory");
+            return;
+        }
+
+        const NifFiles files(dataPath);
+
+        std::size_t failed = 0;
+        for (auto _ : state)
+        {
+            failed = 0;
+            for (const std::string& name : files.mNames)
+            {
+                try
+                {
+                    Nif::NIFFile file(files.mVFS.getNormalized(name), name, buffered);
+                    benchmark::DoNotOptimize(file.numRoots());
+                }
+                catch (const std::exception&)
+                {
+                    ++failed;
+                }
+            }
+        }
+
+        state.SetBytesProcessed(state.iterations() * files.mBytes);
+        state.SetItemsProcessed(state.iterations() * files.mNames.size());
+        state.counters["files"] = files.mNames.size();
+        state.counters["failed"] = failed;
+    }
+}
+
+BENCHMARK(parseAllNifs)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond)->UseRealTime();
@@ -0,0 +1,142 @@
+#include <benchmark/benchmark.h>
+
+#include <boost/filesystem/operations.hpp>
+
+#include <components/misc/stringops.hpp>
+#include <components/resource/niffilemanager.hpp>
+#include <components/resource/resourcesystem.hpp>
+#include <components/resource/scenemanager.hpp>
+#include <components/resource/templatediskcache.hpp>
+#include <components/vfs/bsaarchive.hpp>
+#include <components/vfs/filesystemarchive.hpp>
+#include <components/vfs/manager.hpp>
+
+#include <cstdlib>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace
+{
+    enum Mode
+    {
+        /// Parse and optimize every model, as without the disk cache
+        Mode_NoDiskCache,
+        /// Parse and optimize every model and store it, as in the first session with the disk cache
+        Mode_Cold,
+        /// Read every model stored in a previous session
+        Mode_Warm
+    };
+
+    const char* getModeName(Mode mode)
+    {
+        switch (mode)
+        {
+            case Mode_NoDiskCache: return "no disk cache";
+            case Mode_Cold: return "cold";
+            case Mode_Warm: return "warm";
+        }
+        return "";
+    }
+
+    /// The data directory of the game given by OPENMW_BENCHMARK_DATA, with its archives and loose files
+    struct DataFiles
+    {
+        VFS::Manager mVFS {false};
+        std::vector<std::string> mModels;
+
+        explicit DataFiles(const boost::filesystem::path& path)
+        {
+            for (boost::filesystem::directory_iterator it(path), end; it != end; ++it)
+                if (Misc::StringUtils::lowerCase(it->path().extension().string()) == ".bsa")
+                    mVFS.addArchive(new VFS::BsaArchive(it->path().string()));
+            mVFS.addArchive(new VFS::FileSystemArchive(path.string()));
+            mVFS.buildIndex();
+
+            // Names in the index are normalized to lower case
+            for (const auto& file : mVFS.getIndex())
+            {
+                const std::string& name = file.first;
+                if (name.compare(0, 7, "meshes/") == 0 && name.size() > 4
+                        && name.compare(name.size() - 4, 4, ".nif") == 0)
+                    mModels.push_back(name);
+            }
+        }
+    };
+
+    /// Load every NIF model of the data directory with empty memory caches. Textures stay cached between iterations,
+    /// they are read the same way in all modes.
+    /// Arg 0: Mode.
+    void loadAllModels(benchmark::State& state)
+    {
+        const Mode mode = static_cast<Mode>(state.range(0));
+        state.SetLabel(getModeName(mode));
+
+        const char* const dataPath = std::getenv("OPENMW_BENCHMARK_DATA");
+        if (dataPath == nullptr || !boost::filesystem::is_directory(dataPath))
+        {
+            state.SkipWithError("OPENMW_BENCHMARK_DATA is not set to a data directory");
+            return;
+        }
+
+        const DataFiles data(dataPath);
+        Resource::ResourceSystem resourceSystem(&data.mVFS);
+        Resource::SceneManager* sceneManager = resourceSystem.getSceneManager();
+        const boost::filesystem::path cachePath = boost::filesystem::temp_directory_path()
+            / boost::filesystem::unique_path("openmw-benchmark-models-%%%%-%%%%-%%%%");
+
+        std::size_t failed = 0;
+        const auto loadModels = [&]
+        {
+            failed = 0;
+            for (const std::string& model : data.mModels)
+            {
+                try
+                {
+                    benchmark::DoNotOptimize(sceneManager->getTemplate(model));
+                }
+                catch (const std::exception&)
+                {
+                    ++failed;
+                }
+            }
+            sceneManager->clearCache();
+            resourceSystem.getNifFileManager()->clearCache();
+        };
+
+        if (mode == Mode_Warm)
+        {
+            sceneManager->setDiskCache(std::make_shared<Resource::TemplateDiskCache>(cachePath));
+            loadModels();
+        }
+
+        for (auto _ : state)
+        {
+            if (mode != Mode_NoDiskCache)
+            {
+                state.PauseTiming();
+                if (mode == Mode_Cold)
+                    boost::filesystem::remove_all(cachePath);
+                sceneManager->setDiskCache(std::make_shared<Resource::TemplateDiskCache>(cachePath));
+                state.ResumeTiming();
+            }
+
+            loadModels();
+        }
+
+        std::size_t stored = 0;
+        if (boost::filesystem::is_directory(cachePath))
+            stored = std::distance(boost::filesystem::directory_iterator(cachePath),
+                                   boost::filesystem::directory_iterator());
+        boost::filesystem::remove_all(cachePath);
+
+        state.SetItemsProcessed(state.iterations() * data.mModels.size());
+        state.counters["models"] = data.mModels.size();
+        state.counters["failed"] = failed;
+        state.counters["stored"] = stored;
+    }
+}
+
+BENCHMARK(loadAllModels)->Arg(Mode_NoDiskCache)->Arg(Mode_Cold)->Arg(Mode_Warm)->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
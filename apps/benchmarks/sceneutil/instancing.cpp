@@ -0,0 +1,306 @@
+#include <benchmark/benchmark.h>
+
+#include <osg/Geometry>
+#include <osg/Material>
+#include <osg/MatrixTransform>
+
+#include <osgUtil/SceneView>
+#include <osgUtil/Statistics>
+
+#include <osgViewer/Renderer>
+#include <osgViewer/Viewer>
+
+#include <components/resource/resourcesystem.hpp>
+#include <components/resource/scenemanager.hpp>
+#include <components/sceneutil/glextensions.hpp>
+#include <components/sceneutil/instancing.hpp>
+#include <components/sceneutil/optimizer.hpp>
+#include <components/sceneutil/shadow.hpp>
+#include <components/shader/shadermanager.hpp>
+#include <components/vfs/manager.hpp>
+
+#include <boost/filesystem/operations.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+namespace
+{
+    /// A dense exterior cell: a few rock and flora models, each placed hundreds of times
+    const int sNumModels = 6;
+    const int sCopiesPerModel = 500;
+    const int sRockSides = 12;
+    const float sCellSize = 8192.f;
+    const int sWidth = 1280;
+    const int sHeight = 720;
+
+    enum Mode
+    {
+        /// A cloned subtree per reference, as SceneManager::createInstance gives
+        Mode_Nodes,
+        /// Copies of all references merged per state set, as object paging does without instancing
+        Mode_Merged,
+        /// An instanced draw per model
+        Mode_Instanced
+    };
+
+    const char* getModeName(Mode mode)
+    {
+        switch (mode)
+        {
+            case Mode_Nodes: return "nodes";
+            case Mode_Merged: return "merged";
+            case Mode_Instanced: return "instanced";
+        }
+        return "";
+    }
+
+    /// A bumpy dome of a few hundred triangles under a root transform, with a material of its own
+    osg::ref_ptr<osg::Node> createModel(int index)
+    {
+        osg::ref_ptr<osg::Vec3Array> positions (new osg::Vec3Array);
+        osg::ref_ptr<osg::Vec3Array> normals (new osg::Vec3Array);
+        for (int y = 0; y <= sRockSides; ++y)
+        {
+            for (int x = 0; x <= sRockSides; ++x)
+            {
+                const float u = static_cast<float>(x) / sRockSides * 2 - 1;
+                const float v = static_cast<float>(y) / sRockSides * 2 - 1;
+                const float height = std::max(0.f, 1 - u * u - v * v) * (1 + 0.1f * ((x * 7 + y * 3 + index) % 5));
+                positions->push_back(osg::Vec3f(u, v, height) * 64.f);
+                osg::Vec3f normal(u, v, 1);
+                normal.normalize();
+                normals->push_back(normal);
+            }
+        }
+
+        osg::ref_ptr<osg::DrawElementsUShort> triangles (new osg::DrawElementsUShort(GL_TRIANGLES));
+        for (int y = 0; y < sRockSides; ++y)
+        {
+            for (int x = 0; x < sRockSides; ++x)
+            {
+                const unsigned short corner = static_cast<unsigned short>(y * (sRockSides + 1) + x);
+                triangles->push_back(corner);
+                triangles->push_back(corner + 1);
+                triangles->push_back(corner + sRockSides + 1);
+                triangles->push_back(corner + 1);
+                triangles->push_back(corner + sRockSides + 2);
+                triangles->push_back(corner + sRockSides + 1);
+            }
+        }
+
+        osg::ref_ptr<osg::Geometry> geometry (new osg::Geometry);
+        geometry->setVertexArray(positions);
+        geometry->setNormalArray(normals, osg::Array::BIND_PER_VERTEX);
+        geometry->addPrimitiveSet(triangles);
+        geometry->setUseDisplayList(false);
+        geometry->setUseVertexBufferObjects(true);
+
+        osg::ref_ptr<osg::Material> material (new osg::Material);
+        material->setDiffuse(osg::Material::FRONT_AND_BACK, osg::Vec4f(0.2f * index, 0.5f, 0.5f, 1.f));
+        geometry->getOrCreateStateSet()->setAttributeAndModes(material, osg::StateAttribute::ON);
+
+        osg::ref_ptr<osg::MatrixTransform> root (new osg::MatrixTransform(osg::Matrix::rotate(0.1f * index, 0, 0, 1)));
+        root->addChild(geometry);
+        return root;
+    }
+
+    SceneUtil::Instance makeInstance(int model, int copy)
+    {
+        // Scatter the copies over the cell the way random placement would, without any two at the same place
+        const float x = std::fmod(copy * 0.618034f + model * 0.1f, 1.f) * sCellSize;
+        const float y = std::fmod(copy * 0.754878f + model * 0.3f, 1.f) * sCellSize;
+        return SceneUtil::Instance {osg::Vec3f(x, y, 0), osg::Quat(copy * 0.7f, osg::Vec3f(0, 0, 1)),
+                                    0.5f + (copy % 10) * 0.1f};
+    }
+
+    /// Object shaders read from the directory given by OPENMW_BENCHMARK_SHADERS, by default the one the build copies
+    /// them to. Shaders are forced like with "force shaders" in the settings, so all modes draw with the same program
+    /// and only the instanced one reads the instance transforms.
+    struct Shaders
+    {
+        VFS::Manager mVFS {false};
+        Resource::ResourceSystem mResourceSystem {&mVFS};
+        bool mFound = false;
+
+        Shaders()
+        {
+            const char* const path = std::getenv("OPENMW_BENCHMARK_SHADERS");
+            const std::string shaderPath = path == nullptr ? "resources/shaders" : path;
+            mFound = boost::filesystem::exists(boost::filesystem::path(shaderPath) / "objects_vertex.glsl");
+
+            Resource::SceneManager* sceneManager = mResourceSystem.getSceneManager();
+            sceneManager->setShaderPath(shaderPath);
+            sceneManager->setForceShaders(true);
+
+            Shader::ShaderManager::DefineMap defines = SceneUtil::ShadowManager::getShadowsDisabledDefines();
+            defines["forcePPL"] = "0";
+            defines["clamp"] = "1";
+            defines["preLightEnv"] = "0";
+            defines["radialFog"] = "0";
+            defines["clusteredLighting"] = "0";
+            sceneManager->getShaderManager().setGlobalDefines(defines);
+        }
+    };
+
+    osg::ref_ptr<osg::Node> createCell(Mode mode, Shaders& shaders)
+    {
+        osg::ref_ptr<osg::Group> cell (new osg::Group);
+        for (int model = 0; model < sNumModels; ++model)
+        {
+            const osg::ref_ptr<osg::Node> node = createModel(model);
+            std::vector<SceneUtil::Instance> instances;
+            for (int copy = 0; copy < sCopiesPerModel; ++copy)
+                instances.push_back(makeInstance(model, copy));
+
+            if (mode == Mode_Instanced)
+            {
+                cell->addChild(SceneUtil::createInstances(*node, instances));
+                continue;
+            }
+
+            const osg::CopyOp copyOp = mode == Mode_Merged
+                ? osg::CopyOp(osg::CopyOp::DEEP_COPY_NODES | osg::CopyOp::DEEP_COPY_DRAWABLES
+                    | osg::CopyOp::DEEP_COPY_ARRAYS | osg::CopyOp::DEEP_COPY_PRIMITIVES)
+                : osg::CopyOp(osg::CopyOp::DEEP_COPY_NODES);
+            for (const SceneUtil::Instance& instance : instances)
+            {
+                osg::ref_ptr<osg::MatrixTransform> transform (new osg::MatrixTransform(
+                    osg::Matrix::scale(instance.mScale, instance.mScale, instance.mScale)
+                    * osg::Matrix::rotate(instance.mRotation)
+                    * osg::Matrix::translate(instance.mPosition)));
+                transform->addChild(static_cast<osg::Node*>(node->clone(copyOp)));
+                cell->addChild(transform);
+            }
+        }
+
+        if (mode == Mode_Merged)
+        {
+            SceneUtil::Optimizer optimizer;
+            optimizer.optimize(cell, SceneUtil::Optimizer::FLATTEN_STATIC_TRANSFORMS
+                | SceneUtil::Optimizer::REMOVE_REDUNDANT_NODES | SceneUtil::Optimizer::MERGE_GEOMETRY);
+        }
+
+        // The way ObjectPaging::createChunk gives the instanced models their program
+        shaders.mResourceSystem.getSceneManager()->recreateShaders(cell);
+        return cell;
+    }
+
+    /// A player standing at a corner of the cell, looking over it
+    void setupView(osg::Camera& camera)
+    {
+        camera.setViewport(0, 0, sWidth, sHeight);
+        camera.setProjectionMatrixAsPerspective(55.0, static_cast<double>(sWidth) / sHeight, 1.0, 2 * sCellSize);
+        camera.setViewMatrixAsLookAt(osg::Vec3f(-256, -256, 512), osg::Vec3f(sCellSize, sCellSize, 0) / 2,
+                                     osg::Vec3f(0, 0, 1));
+    }
+
+    /// Cull the cell without a graphics context, as the cull thread does every frame.
+    /// Arg 0: Mode.
+    void cullDenseCell(benchmark::State& state)
+    {
+        const Mode mode = static_cast<Mode>(state.range(0));
+        Shaders shaders;
+        if (!shaders.mFound)
+        {
+            state.SkipWithError("OPENMW_BENCHMARK_SHADERS is not set to the shaders directory");
+            return;
+        }
+
+        osg::ref_ptr<osgUtil::SceneView> sceneView (new osgUtil::SceneView);
+        sceneView->setDefaults();
+        sceneView->setSceneData(createCell(mode, shaders));
+        setupView(*sceneView->getCamera());
+        osg::ref_ptr<osg::FrameStamp> frameStamp (new osg::FrameStamp);
+        sceneView->setFrameStamp(frameStamp);
+
+        for (auto _ : state)
+        {
+            frameStamp->setFrameNumber(frameStamp->getFrameNumber() + 1);
+            sceneView->cull();
+        }
+
+        osgUtil::Statistics stats;
+        sceneView->getStats(stats);
+        state.SetLabel(getModeName(mode));
+        state.counters["draws"] = stats.numDrawables;
+    }
+
+    /// Render frames of the cell to an offscreen pbuffer, skipped when no context can be created.
+    /// Arg 0: Mode.
+    void drawDenseCell(benchmark::State& state)
+    {
+        const Mode mode = static_cast<Mode>(state.range(0));
+        state.SetLabel(getModeName(mode));
+
+        Shaders shaders;
+        if (!shaders.mFound)
+        {
+            state.SkipWithError("OPENMW_BENCHMARK_SHADERS is not set to the shaders directory");
+            return;
+        }
+
+        osg::ref_ptr<osg::GraphicsContext::Traits> traits (new osg::GraphicsContext::Traits);
+        traits->width = sWidth;
+        traits->height = sHeight;
+        traits->pbuffer = true;
+        traits->doubleBuffer = false;
+        traits->depth = 24;
+        osg::ref_ptr<osg::GraphicsContext> context = osg::GraphicsContext::createGraphicsContext(traits);
+        if (!context)
+        {
+            state.SkipWithError("Failed to create a pbuffer");
+            return;
+        }
+
+        osg::ref_ptr<osgViewer::Viewer> viewer (new osgViewer::Viewer);
+        viewer->setThreadingModel(osgViewer::ViewerBase::SingleThreaded);
+        osg::Camera* camera = viewer->getCamera();
+        camera->setGraphicsContext(context);
+        camera->setDrawBuffer(GL_FRONT);
+        camera->setReadBuffer(GL_FRONT);
+        setupView(*camera);
+        camera->getStats()->collectStats("rendering", true);
+        viewer->setSceneData(createCell(mode, shaders));
+        viewer->setRealizeOperation(new SceneUtil::GetGLExtensionsOperation);
+        viewer->realize();
+        if (!viewer->isRealized())
+        {
+            state.SkipWithError("Failed to realize the viewer");
+            return;
+        }
+        const osg::GLExtensions* exts = SceneUtil::getGLExtensions();
+        if (mode == Mode_Instanced && (!exts || !SceneUtil::isInstancingSupported(*exts)))
+        {
+            state.SkipWithError("Instancing is not supported");
+            return;
+        }
+
+        // The first frame uploads the buffers
+        viewer->frame();
+
+        for (auto _ : state)
+            viewer->frame();
+
+        osg::Stats* stats = camera->getStats();
+        double cullTime = 0;
+        stats->getAveragedAttribute(stats->getEarliestFrameNumber(), stats->getLatestFrameNumber(),
+                                    "Cull traversal time taken", cullTime);
+        state.counters["cull ms"] = cullTime * 1000;
+
+        // Frames alternate between the scene views of the renderer
+        osgViewer::Renderer* renderer = static_cast<osgViewer::Renderer*>(camera->getRenderer());
+        unsigned int draws = 0;
+        for (unsigned int i = 0; i < 2; ++i)
+        {
+            osgUtil::Statistics sceneStats;
+            renderer->getSceneView(i)->getStats(sceneStats);
+            draws = std::max(draws, sceneStats.numDrawables);
+        }
+        state.counters["draws"] = draws;
+    }
+}
+
+BENCHMARK(cullDenseCell)->Arg(Mode_Nodes)->Arg(Mode_Merged)->Arg(Mode_Instanced);
+BENCHMARK(drawDenseCell)->Arg(Mode_Nodes)->Arg(Mode_Merged)->Arg(Mode_Instanced)->UseRealTime();
@@ -0,0 +1,102 @@
+#include <benchmark/benchmark.h>
+
+#include <osg/Geometry>
+#include <osg/MatrixTransform>
+
+#include <osgUtil/SceneView>
+
+#include <components/sceneutil/lightmanager.hpp>
+
+#include <cmath>
+
+namespace
+{
+    /// An exterior cell full of objects, lit by a varying number of lights
+    const int sNumObjects = 2000;
+    const float sCellSize = 8192.f;
+    const float sLightRadius = 400.f;
+    const int sWidth = 1280;
+    const int sHeight = 720;
+
+    osg::ref_ptr<osg::Geometry> createBox()
+    {
+        osg::ref_ptr<osg::Vec3Array> positions (new osg::Vec3Array);
+        for (int i = 0; i < 8; ++i)
+            positions->push_back(osg::Vec3f(i & 1 ? 32 : -32, i & 2 ? 32 : -32, i & 4 ? 64 : 0));
+        const GLushort indices[] = {0, 1, 3, 0, 3, 2, 4, 6, 7, 4, 7, 5, 0, 4, 5, 0, 5, 1,
+                                    2, 3, 7, 2, 7, 6, 0, 2, 6, 0, 6, 4, 1, 5, 7, 1, 7, 3};
+        osg::ref_ptr<osg::Geometry> geometry (new osg::Geometry);
+        geometry->setVertexArray(positions);
+        geometry->addPrimitiveSet(new osg::DrawElementsUShort(GL_TRIANGLES, sizeof(indices) / sizeof(indices[0]), indices));
+        return geometry;
+    }
+
+    osg::Vec3f scatter(int index, float golden, float silver, float height)
+    {
+        // Spread the objects over the cell the way random placement would, without any two at the same place
+        return osg::Vec3f(std::fmod(index * golden, 1.f) * sCellSize, std::fmod(index * silver, 1.f) * sCellSize, height);
+    }
+
+    osg::ref_ptr<SceneUtil::LightManager> createCell(int numLights, bool clustered)
+    {
+        osg::ref_ptr<SceneUtil::LightManager> lightManager (new SceneUtil::LightManager);
+        lightManager->setStartLight(1);
+        if (clustered)
+            lightManager->setClusteredLighting(8);
+
+        const osg::ref_ptr<osg::Geometry> box = createBox();
+        for (int i = 0; i < sNumObjects; ++i)
+        {
+            // A light list callback per object, as Objects::insertBegin sets on each object's base node
+            osg::ref_ptr<osg::MatrixTransform> object (new osg::MatrixTransform(
+                osg::Matrix::translate(scatter(i, 0.618034f, 0.754878f, 0))));
+            object->addCullCallback(new SceneUtil::LightListCallback);
+            object->addChild(box);
+            lightManager->addChild(object);
+        }
+
+        for (int i = 0; i < numLights; ++i)
+        {
+            osg::ref_ptr<osg::Light> light (new osg::Light);
+            light->setDiffuse(osg::Vec4f(1.f, 0.8f, 0.5f, 1.f));
+            light->setLinearAttenuation(1.f / sLightRadius);
+            osg::ref_ptr<SceneUtil::LightSource> lightSource (new SceneUtil::LightSource);
+            lightSource->setLight(light);
+            lightSource->setRadius(sLightRadius);
+            osg::ref_ptr<osg::MatrixTransform> transform (new osg::MatrixTransform(
+                osg::Matrix::translate(scatter(i, 0.569840f, 0.347296f, 128))));
+            transform->addChild(lightSource);
+            lightManager->addChild(transform);
+        }
+        return lightManager;
+    }
+
+    /// Update and cull the cell without a graphics context, as the main and cull threads do every frame.
+    /// Arg 0: number of lights. Arg 1: whether the lights are assigned to clusters instead of to each object.
+    void cullLitCell(benchmark::State& state)
+    {
+        const int numLights = static_cast<int>(state.range(0));
+        const bool clustered = state.range(1) != 0;
+        state.SetLabel(clustered ? "clustered" : "per object");
+
+        osg::ref_ptr<osgUtil::SceneView> sceneView (new osgUtil::SceneView);
+        sceneView->setDefaults();
+        sceneView->setSceneData(createCell(numLights, clustered));
+        osg::Camera* camera = sceneView->getCamera();
+        camera->setViewport(0, 0, sWidth, sHeight);
+        camera->setProjectionMatrixAsPerspective(55.0, static_cast<double>(sWidth) / sHeight, 1.0, 2 * sCellSize);
+        camera->setViewMatrixAsLookAt(osg::Vec3f(-256, -256, 512), osg::Vec3f(sCellSize, sCellSize, 0) / 2,
+                                      osg::Vec3f(0, 0, 1));
+        osg::ref_ptr<osg::FrameStamp> frameStamp (new osg::FrameStamp);
+        sceneView->setFrameStamp(frameStamp);
+
+        for (auto _ : state)
+        {
+            frameStamp->setFrameNumber(frameStamp->getFrameNumber() + 1);
+            sceneView->update();
+            sceneView->cull();
+        }
+    }
+}
+
+BENCHMARK(cullLitCell)->Args({8, 0})->Args({8, 1})->Args({64, 0})->Args({64, 1})->Args({512, 0})->Args({512, 1});
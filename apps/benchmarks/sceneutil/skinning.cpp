@@ -0,0 +1,133 @@
+#include <benchmark/benchmark.h>
+
+#include <osg/Geometry>
+
+#include <components/sceneutil/skinning.hpp>
+#include <components/sceneutil/workqueue.hpp>
+
+namespace
+{
+    /// Roughly the size of a fully clothed NPC: body parts, clothing and armor skinned to a biped skeleton.
+    const int sNumVertices = 6000;
+    const int sNumBones = 60;
+    const int sCrowdSize = 40;
+
+    osg::ref_ptr<SceneUtil::SkinningData> createNpcMesh()
+    {
+        osg::ref_ptr<osg::Geometry> source (new osg::Geometry);
+        osg::ref_ptr<osg::Vec3Array> positions (new osg::Vec3Array);
+        osg::ref_ptr<osg::Vec3Array> normals (new osg::Vec3Array);
+        osg::ref_ptr<osg::Vec4Array> tangents (new osg::Vec4Array);
+        std::vector<SceneUtil::SkinningData::VertexWeights> weights(sNumBones);
+        for (int i = 0; i < sNumVertices; ++i)
+        {
+            positions->push_back(osg::Vec3f(i % 17, i % 23, i % 128));
+            normals->push_back(osg::Vec3f(0, 0, 1));
+            tangents->push_back(osg::Vec4f(1, 0, 0, 1));
+
+            // Vertices along a limb are shared between neighbouring bones, as at the joints
+            const int bone = i * sNumBones / sNumVertices;
+            if (i % 4 == 0 && bone + 1 < sNumBones)
+            {
+                weights[bone].emplace_back(i, 0.6f);
+                weights[bone + 1].emplace_back(i, 0.4f);
+            }
+            else
+                weights[bone].emplace_back(i, 1.f);
+        }
+        source->setVertexArray(positions);
+        source->setNormalArray(normals);
+        source->setTexCoordArray(7, tangents);
+
+        std::vector<osg::Matrixf> invBindMatrices;
+        std::vector<const SceneUtil::SkinningData::VertexWeights*> boneWeights;
+        for (int i = 0; i < sNumBones; ++i)
+        {
+            invBindMatrices.push_back(osg::Matrixf::translate(0, 0, -i));
+            boneWeights.push_back(&weights[i]);
+        }
+
+        return new SceneUtil::SkinningData(invBindMatrices, boneWeights, *source);
+    }
+
+    struct Npc
+    {
+        std::vector<osg::Matrixf> mBoneMatrices;
+        std::vector<osg::Matrixf> mGroupMatrices;
+        osg::ref_ptr<osg::Vec3Array> mPositions {new osg::Vec3Array(sNumVertices)};
+        osg::ref_ptr<osg::Vec3Array> mNormals {new osg::Vec3Array(sNumVertices)};
+        osg::ref_ptr<osg::Vec4Array> mTangents {new osg::Vec4Array(sNumVertices)};
+
+        explicit Npc(int index)
+        {
+            for (int i = 0; i < sNumBones; ++i)
+                mBoneMatrices.push_back(osg::Matrixf::rotate(0.01f * (i + index), 0, 0, 1) * osg::Matrixf::translate(index, 0, i));
+        }
+
+        void skin(const SceneUtil::SkinningData& data, bool vectorized)
+        {
+            std::vector<const osg::Matrixf*> boneMatrices;
+            for (const osg::Matrixf& matrix : mBoneMatrices)
+                boneMatrices.push_back(&matrix);
+            data.computeGroupMatrices(boneMatrices, nullptr, mGroupMatrices);
+            data.skin(mGroupMatrices, *mPositions, mNormals, mTangents, vectorized);
+        }
+    };
+
+    struct SkinningWorkItem : SceneUtil::WorkItem
+    {
+        const SceneUtil::SkinningData& mData;
+        Npc& mNpc;
+
+        SkinningWorkItem(const SceneUtil::SkinningData& data, Npc& npc) : mData(data), mNpc(npc) {}
+
+        void doWork() override
+        {
+            mNpc.skin(mData, true);
+        }
+    };
+
+    /// Skin a crowd of NPCs sharing the same mesh, as RigGeometry does every frame for the visible actors.
+    /// Arg 0: 0 for the scalar kernel, 1 for the vectorized kernel.
+    /// Arg 1: number of skinning threads, 0 to skin on the calling thread.
+    void skinCrowd(benchmark::State& state)
+    {
+        const osg::ref_ptr<SceneUtil::SkinningData> data = createNpcMesh();
+        std::vector<Npc> crowd;
+        for (int i = 0; i < sCrowdSize; ++i)
+            crowd.emplace_back(i);
+
+        const bool vectorized = state.range(0) != 0;
+        const int threads = static_cast<int>(state.range(1));
+        osg::ref_ptr<SceneUtil::WorkQueue> workQueue;
+        if (threads > 0)
+            workQueue = new SceneUtil::WorkQueue(threads);
+
+        std::vector<osg::ref_ptr<SkinningWorkItem>> jobs;
+        for (auto _ : state)
+        {
+            if (workQueue)
+            {
+                jobs.clear();
+                for (Npc& npc : crowd)
+                {
+                    jobs.emplace_back(new SkinningWorkItem(*data, npc));
+                    workQueue->addWorkItem(jobs.back(), SceneUtil::WorkPriority_Immediate);
+                }
+                for (const auto& job : jobs)
+                    job->waitTillDone();
+            }
+            else
+            {
+                for (Npc& npc : crowd)
+                    npc.skin(*data, vectorized);
+            }
+        }
+
+        state.SetLabel(vectorized ? SceneUtil::SkinningData::getInstructionSet() : "scalar");
+        state.counters["vertices"] = benchmark::Counter(static_cast<double>(state.iterations()) * sCrowdSize * sNumVertices,
+            benchmark::Counter::kIsRate);
+    }
+}
+
+BENCHMARK(skinCrowd)->Args({0, 0})->Args({1, 0})->Args({1, 2})->Args({1, 4})->UseRealTime();
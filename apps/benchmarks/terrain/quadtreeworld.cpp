@@ -0,0 +1,150 @@
+#include <benchmark/benchmark.h>
+
+#include <osg/Group>
+#include <osg/Image>
+
+#include <components/resource/resourcesystem.hpp>
+#include <components/terrain/quadtreeworld.hpp>
+#include <components/terrain/storage.hpp>
+#include <components/terrain/viewdata.hpp>
+#include <components/vfs/manager.hpp>
+
+#include <atomic>
+#include <cmath>
+#include <string>
+
+namespace
+{
+    /// Same cell size and resolution as the Morrowind landscape.
+    const float sCellWorldSize = 8192;
+    const int sCellVertices = 65;
+    const int sNumLayers = 8;
+    const float sHalfWorldSize = 32;
+    const float sViewDistance = 20 * sCellWorldSize;
+    const float sMaxHeight = 4096;
+
+    float getHeight(float x, float y)
+    {
+        return sMaxHeight * 0.5f * (std::sin(x * 0.0003f) + std::cos(y * 0.0002f + std::sin(x * 0.0001f)));
+    }
+
+    /// Procedural hills with a few texture layers per chunk, the content does not matter as long as each chunk costs
+    /// about as much to build as one of the game.
+    class BenchmarkStorage : public Terrain::Storage
+    {
+    public:
+        void getBounds(float& minX, float& maxX, float& minY, float& maxY) override
+        {
+            minX = minY = -sHalfWorldSize;
+            maxX = maxY = sHalfWorldSize;
+        }
+
+        bool getMinMaxHeights(float size, const osg::Vec2f& center, float& min, float& max) override
+        {
+            min = -sMaxHeight;
+            max = sMaxHeight;
+            return true;
+        }
+
+        void fillVertexBuffers(int lodLevel, float size, const osg::Vec2f& center,
+            osg::ref_ptr<osg::Vec3Array> positions, osg::ref_ptr<osg::Vec3Array> normals,
+            osg::ref_ptr<osg::Vec4ubArray> colours) override
+        {
+            const unsigned int numVerts = static_cast<unsigned int>((sCellVertices - 1) * size / (1 << lodLevel) + 1);
+            const float step = size * sCellWorldSize / (numVerts - 1);
+            const osg::Vec2f origin = (center - osg::Vec2f(size, size) * 0.5f) * sCellWorldSize;
+            const osg::Vec2f worldCenter = center * sCellWorldSize;
+
+            positions->resize(numVerts * numVerts);
+            normals->resize(numVerts * numVerts);
+            colours->resize(numVerts * numVerts);
+
+            for (unsigned int row = 0; row < numVerts; ++row)
+            {
+                for (unsigned int col = 0; col < numVerts; ++col)
+                {
+                    const float x = origin.x() + col * step;
+                    const float y = origin.y() + row * step;
+                    const float z = getHeight(x, y);
+                    const unsigned int index = row * numVerts + col;
+                    (*positions)[index] = osg::Vec3f(x - worldCenter.x(), y - worldCenter.y(), z);
+                    osg::Vec3f normal(z - getHeight(x + step, y), z - getHeight(x, y + step), step);
+                    normal.normalize();
+                    (*normals)[index] = normal;
+                    (*colours)[index] = osg::Vec4ub(255, 255, 255, 255);
+                }
+            }
+        }
+
+        void getBlendmaps(float chunkSize, const osg::Vec2f& chunkCenter, ImageVector& blendmaps,
+            std::vector<Terrain::LayerInfo>& layerList) override
+        {
+            const int blendmapSize = static_cast<int>((sCellVertices - 1) * chunkSize) + 1;
+            for (int i = 0; i < sNumLayers; ++i)
+            {
+                Terrain::LayerInfo layer;
+                layer.mDiffuseMap = "textures\\benchmark_" + std::to_string(i) + ".dds";
+                layer.mParallax = false;
+                layer.mSpecular = false;
+                layerList.push_back(layer);
+
+                if (i == 0)
+                    continue;
+
+                osg::ref_ptr<osg::Image> image (new osg::Image);
+                image->allocateImage(blendmapSize, blendmapSize, 1, GL_ALPHA, GL_UNSIGNED_BYTE);
+                unsigned char* data = image->data();
+                for (int y = 0; y < blendmapSize; ++y)
+                    for (int x = 0; x < blendmapSize; ++x)
+                        data[y * blendmapSize + x] = static_cast<unsigned char>((x * i + y) % 256);
+                blendmaps.push_back(image);
+            }
+        }
+
+        float getHeightAt(const osg::Vec3f& worldPos) override
+        {
+            return getHeight(worldPos.x(), worldPos.y());
+        }
+
+        float getCellWorldSize() override { return sCellWorldSize; }
+
+        int getCellVertices() override { return sCellVertices; }
+
+        int getBlendmapScale(float chunkSize) override { return 1; }
+    };
+
+    /// Build every chunk of the view of a fixed eye point from an empty chunk cache, as after a teleport.
+    /// Arg 0: number of chunk build threads.
+    void buildView(benchmark::State& state)
+    {
+        VFS::Manager vfs(false);
+        Resource::ResourceSystem resourceSystem(&vfs);
+        osg::ref_ptr<osg::Group> parent (new osg::Group);
+        osg::ref_ptr<osg::Group> compileRoot (new osg::Group);
+
+        const unsigned int threads = static_cast<unsigned int>(state.range(0));
+        Terrain::QuadTreeWorld world(parent, compileRoot, &resourceSystem, new BenchmarkStorage, ~0, ~0, ~0,
+            512, 1.f, 1.f, 0, 4.f, threads);
+        world.setViewDistance(sViewDistance);
+
+        const osg::Vec3f eyePoint(0, 0, sMaxHeight);
+        std::atomic<bool> abort(false);
+        std::size_t chunks = 0;
+
+        for (auto _ : state)
+        {
+            state.PauseTiming();
+            world.clearAssociatedCaches();
+            osg::ref_ptr<Terrain::View> view = world.createView();
+            state.ResumeTiming();
+
+            world.preload(view, eyePoint, osg::Vec4i(0, 0, 0, 0), abort);
+
+            chunks += static_cast<Terrain::ViewData*>(view.get())->getNumEntries();
+        }
+
+        state.counters["chunks"] = benchmark::Counter(static_cast<double>(chunks), benchmark::Counter::kIsRate);
+    }
+}
+
+BENCHMARK(buildView)->Arg(1)->Arg(2)->Arg(4)->Arg(8)->Unit(benchmark::kMillisecond)->UseRealTime();
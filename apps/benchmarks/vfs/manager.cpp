@@ -0,0 +1,107 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <iterator>
+#include <sstream>
+
+#include <components/misc/stringops.hpp>
+#include <components/vfs/archive.hpp>
+#include <components/vfs/manager.hpp>
+
+namespace
+{
+    struct EmptyFile : VFS::File
+    {
+        Files::IStreamPtr open() override
+        {
+            return Files::IStreamPtr(new std::istringstream);
+        }
+    };
+
+    /// Archive with the given number of files spread over the usual data directories
+    struct SyntheticArchive : VFS::Archive
+    {
+        std::vector<std::string> mNames;
+        EmptyFile mFile;
+
+        SyntheticArchive(std::size_t count)
+        {
+            static const char* const sDirectories[] = {"Meshes\\X\\Ex_", "Meshes\\F\\Furn_", "Textures\\Tx_",
+                "Icons\\M\\Misc_", "Sound\\Fx\\", "BookArt\\"};
+            for (std::size_t i = 0; i < count; ++i)
+                mNames.push_back(sDirectories[i % 6] + std::string("Object_") + std::to_string(i) + ".NIF");
+        }
+
+        void listResources(std::map<std::string, VFS::File*>& out, char (*normalize_function) (char)) override
+        {
+            for (const std::string& name : mNames)
+            {
+                std::string normalized;
+                std::transform(name.begin(), name.end(), std::back_inserter(normalized), normalize_function);
+                out[normalized] = &mFile;
+            }
+        }
+    };
+
+    struct Fixture
+    {
+        VFS::Manager mManager {false};
+        std::vector<std::string> mNames;
+        std::vector<std::string> mNormalizedNames;
+
+        /// Every other query misses, as with the fallback lookups done for textures and meshes
+        Fixture(std::size_t count)
+        {
+            SyntheticArchive* archive = new SyntheticArchive(count);
+            mManager.addArchive(archive);
+            mManager.buildIndex();
+            for (std::size_t i = 0; i < count; i += 97)
+            {
+                mNames.push_back(archive->mNames[i]);
+                mNames.push_back(archive->mNames[i] + ".missing");
+            }
+            for (std::string name : mNames)
+            {
+                mManager.normalizeFilename(name);
+                mNormalizedNames.push_back(name);
+            }
+        }
+    };
+
+    /// Lookup as done before the hash table: copy, normalize and search the sorted map
+    void existsInMap(benchmark::State& state)
+    {
+        const Fixture fixture(static_cast<std::size_t>(state.range(0)));
+        const std::map<std::string, VFS::File*>& index = fixture.mManager.getIndex();
+        std::size_t i = 0;
+
+        for (auto _ : state)
+        {
+            std::string normalized = fixture.mNames[i++ % fixture.mNames.size()];
+            fixture.mManager.normalizeFilename(normalized);
+            benchmark::DoNotOptimize(index.find(normalized) != index.end());
+        }
+    }
+
+    void exists(benchmark::State& state)
+    {
+        const Fixture fixture(static_cast<std::size_t>(state.range(0)));
+        std::size_t i = 0;
+
+        for (auto _ : state)
+            benchmark::DoNotOptimize(fixture.mManager.exists(fixture.mNames[i++ % fixture.mNames.size()]));
+    }
+
+    void existsNormalized(benchmark::State& state)
+    {
+        const Fixture fixture(static_cast<std::size_t>(state.range(0)));
+        std::size_t i = 0;
+
+        for (auto _ : state)
+            benchmark::DoNotOptimize(fixture.mManager.existsNormalized(fixture.mNormalizedNames[i++ % fixture.mNormalizedNames.size()]));
+    }
+}
+
+BENCHMARK(existsInMap)->Arg(1000)->Arg(100000);
+BENCHMARK(exists)->Arg(1000)->Arg(100000);
+BENCHMARK(existsNormalized)->Arg(1000)->Arg(100000);
@@ -0,0 +1,140 @@
+#include "navmeshgenerator.hpp"
+#include "worldspacedata.hpp"
+
+#include <components/debug/debuglog.hpp>
+#include <components/detournavigator/makenavmesh.hpp>
+#include <components/detournavigator/navmeshdiskcache.hpp>
+#include <components/detournavigator/recastmesh.hpp>
+
+#include <algorithm>
+
+namespace NavMeshTool
+{
+    NavMeshGenerator::NavMeshGenerator(const osg::Vec3f& agentHalfExtents, const DetourNavigator::Settings& settings,
+            DetourNavigator::NavMeshDiskCache& diskCache, std::size_t threads)
+        : mAgentHalfExtents(agentHalfExtents)
+        , mSettings(settings)
+        , mDiskCache(diskCache)
+        , mMaxJobs(std::max<std::size_t>(threads, 1) * 256)
+        , mProcessing(0)
+        , mShouldStop(false)
+        , mTiles(0)
+        , mGenerated(0)
+        , mCached(0)
+        , mEmpty(0)
+        , mFailed(0)
+    {
+        for (std::size_t i = 0; i < std::max<std::size_t>(threads, 1); ++i)
+            mThreads.emplace_back([&] { run(); });
+    }
+
+    NavMeshGenerator::~NavMeshGenerator()
+    {
+        {
+            const std::lock_guard<std::mutex> lock(mMutex);
+            mShouldStop = true;
+            mJobs.clear();
+        }
+        mHasJob.notify_all();
+        for (auto& thread : mThreads)
+            thread.join();
+    }
+
+    void NavMeshGenerator::add(std::shared_ptr<WorldspaceData> worldspace)
+    {
+        Log(Debug::Verbose) << "Generating " << worldspace->mTiles.size() << " nav mesh tiles for "
+                            << worldspace->mName;
+
+        mTiles += worldspace->mTiles.size();
+
+        for (const auto& tile : worldspace->mTiles)
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mDone.wait(lock, [&] { return mJobs.size() < mMaxJobs; });
+            mJobs.push_back(Job {worldspace, tile});
+            lock.unlock();
+            mHasJob.notify_one();
+        }
+    }
+
+    GenerationStats NavMeshGenerator::wait()
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        mDone.wait(lock, [&] { return mJobs.empty() && mProcessing == 0; });
+        return GenerationStats {mTiles, mGenerated, mCached, mEmpty, mFailed};
+    }
+
+    void NavMeshGenerator::run()
+    {
+        while (true)
+        {
+            Job job;
+
+            {
+                std::unique_lock<std::mutex> lock(mMutex);
+                mHasJob.wait(lock, [&] { return mShouldStop || !mJobs.empty(); });
+                if (mShouldStop)
+                    return;
+                job = std::move(mJobs.front());
+                mJobs.pop_front();
+                ++mProcessing;
+            }
+
+            mDone.notify_all();
+
+            try
+            {
+                process(job);
+            }
+            catch (const std::exception& e)
+            {
+                Log(Debug::Error) << "Failed to generate nav mesh tile (" << job.mTile.x() << ", " << job.mTile.y()
+                                  << ") for " << job.mWorldspace->mName << ": " << e.what();
+                ++mFailed;
+            }
+
+            // Release the worldspace outside the lock, the last tile frees all of its geometry
+            job.mWorldspace.reset();
+
+            {
+                const std::lock_guard<std::mutex> lock(mMutex);
+                --mProcessing;
+            }
+
+            mDone.notify_all();
+        }
+    }
+
+    void NavMeshGenerator::process(const Job& job)
+    {
+        const auto recastMesh = job.mWorldspace->mRecastMeshManager.getMesh(job.mTile);
+
+        if (!recastMesh)
+        {
+            ++mEmpty;
+            return;
+        }
+
+        const auto offMeshConnections = job.mWorldspace->mOffMeshConnectionsManager.get(job.mTile);
+
+        if (mDiskCache.get(mAgentHalfExtents, job.mTile, *recastMesh, offMeshConnections).mValue)
+        {
+            ++mCached;
+            return;
+        }
+
+        const auto navMeshData = DetourNavigator::makeNavMeshTile(mAgentHalfExtents, *recastMesh, offMeshConnections,
+            job.mTile, mSettings);
+
+        if (!navMeshData.mValue)
+        {
+            ++mEmpty;
+            return;
+        }
+
+        mDiskCache.set(mAgentHalfExtents, job.mTile, *recastMesh, offMeshConnections, navMeshData.mValue.get(),
+            navMeshData.mSize);
+
+        ++mGenerated;
+    }
+}
@@ -0,0 +1,83 @@
+#ifndef OPENMW_NAVMESHTOOL_NAVMESHGENERATOR_H
+#define OPENMW_NAVMESHTOOL_NAVMESHGENERATOR_H
+
+#include <components/detournavigator/tileposition.hpp>
+
+#include <osg/Vec3f>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace DetourNavigator
+{
+    class NavMeshDiskCache;
+    struct Settings;
+}
+
+namespace NavMeshTool
+{
+    struct WorldspaceData;
+
+    struct GenerationStats
+    {
+        std::size_t mTiles;
+        std::size_t mGenerated;
+        std::size_t mCached;
+        ///< Tiles already stored by a previous run or by the game
+        std::size_t mEmpty;
+        ///< Tiles without anything to walk on
+        std::size_t mFailed;
+    };
+
+    /// \brief Generates nav mesh tiles of the worldspaces in background threads and stores them in the disk cache
+    class NavMeshGenerator
+    {
+    public:
+        NavMeshGenerator(const osg::Vec3f& agentHalfExtents, const DetourNavigator::Settings& settings,
+            DetourNavigator::NavMeshDiskCache& diskCache, std::size_t threads);
+
+        ~NavMeshGenerator();
+
+        void add(std::shared_ptr<WorldspaceData> worldspace);
+        ///< Blocks while there are too many tiles waiting, the worldspace is released when all its tiles are done
+
+        GenerationStats wait();
+        ///< Waits for all added tiles
+
+    private:
+        struct Job
+        {
+            std::shared_ptr<WorldspaceData> mWorldspace;
+            DetourNavigator::TilePosition mTile;
+        };
+
+        const osg::Vec3f mAgentHalfExtents;
+        const DetourNavigator::Settings& mSettings;
+        DetourNavigator::NavMeshDiskCache& mDiskCache;
+        const std::size_t mMaxJobs;
+        std::mutex mMutex;
+        std::condition_variable mHasJob;
+        std::condition_variable mDone;
+        std::deque<Job> mJobs;
+        std::size_t mProcessing;
+        bool mShouldStop;
+        std::atomic_size_t mTiles;
+        std::atomic_size_t mGenerated;
+        std::atomic_size_t mCached;
+        std::atomic_size_t mEmpty;
+        std::atomic_size_t mFailed;
+        std::vector<std::thread> mThreads;
+
+        void run();
+
+        void process(const Job& job);
+    };
+}
+
+#endif
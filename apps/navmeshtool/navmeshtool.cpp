@@ -0,0 +1,279 @@
+#include "navmeshgenerator.hpp"
+#include "worldspacedata.hpp"
+
+#include "apps/openmw/mwphysics/constants.hpp"
+#include "apps/openmw/mwworld/esmloader.hpp"
+#include "apps/openmw/mwworld/esmstore.hpp"
+
+#include <components/debug/debugging.hpp>
+#include <components/detournavigator/navmeshdiskcache.hpp>
+#include <components/detournavigator/recastglobalallocator.hpp>
+#include <components/detournavigator/settings.hpp>
+#include <components/esm/esmreader.hpp>
+#include <components/files/collections.hpp>
+#include <components/files/configurationmanager.hpp>
+#include <components/files/escape.hpp>
+#include <components/loadinglistener/loadinglistener.hpp>
+#include <components/resource/bulletshape.hpp>
+#include <components/resource/bulletshapemanager.hpp>
+#include <components/resource/resourcesystem.hpp>
+#include <components/settings/settings.hpp>
+#include <components/to_utf8/to_utf8.hpp>
+#include <components/vfs/manager.hpp>
+#include <components/vfs/registerarchives.hpp>
+
+#include <boost/filesystem/operations.hpp>
+#include <boost/program_options.hpp>
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+
+namespace
+{
+    namespace bpo = boost::program_options;
+
+    using Clock = std::chrono::steady_clock;
+
+    double toSeconds(Clock::duration duration)
+    {
+        return std::chrono::duration_cast<std::chrono::duration<double>>(duration).count();
+    }
+
+    bool parseOptions(int argc, char** argv, bpo::variables_map& variables, Files::ConfigurationManager& cfgMgr)
+    {
+        bpo::options_description desc("Syntax: openmw-navmeshtool <options>\n"
+            "Generates nav mesh tiles for every cell and stores them in the nav mesh disk cache used by the game\n\n"
+            "Allowed options");
+
+        desc.add_options()
+            ("help", "print help message")
+
+            ("data", bpo::value<Files::EscapePathContainer>()->default_value(Files::EscapePathContainer(), "data")
+                ->multitoken()->composing(), "set data directories (later directories have higher priority)")
+
+            ("data-local", bpo::value<Files::EscapeHashString>()->default_value(""),
+                "set local data directory (highest priority)")
+
+            ("fallback-archive", bpo::value<Files::EscapeStringVector>()->default_value(Files::EscapeStringVector(), "fallback-archive")
+                ->multitoken(), "set fallback BSA archives (later archives have higher priority)")
+
+            ("resources", bpo::value<Files::EscapeHashString>()->default_value("resources"),
+                "set resources directory")
+
+            ("content", bpo::value<Files::EscapeStringVector>()->default_value(Files::EscapeStringVector(), "")
+                ->multitoken(), "content file(s): esm/esp, or omwgame/omwaddon")
+
+            ("fs-strict", bpo::value<bool>()->implicit_value(true)
+                ->default_value(false), "strict file system handling (no case folding)")
+
+            ("encoding", bpo::value<Files::EscapeHashString>()->default_value("win1252"),
+                "Character encoding used in OpenMW game messages:\n"
+                "\n\twin1250 - Central and Eastern European such as Polish, Czech, Slovak, Hungarian, Slovene, Bosnian, Croatian, Serbian (Latin script), Romanian and Albanian languages\n"
+                "\n\twin1251 - Cyrillic alphabet such as Russian, Bulgarian, Serbian Cyrillic and other languages\n"
+                "\n\twin1252 - Western European (Latin) alphabet, used by default")
+
+            ("threads", bpo::value<int>()->default_value(0),
+                "number of threads loading content files and generating tiles, 0 uses one thread per hardware core")
+        ;
+
+        bpo::parsed_options validOptions = bpo::command_line_parser(argc, argv)
+            .options(desc).allow_unregistered().run();
+
+        bpo::store(validOptions, variables);
+        bpo::notify(variables);
+
+        if (variables.count("help"))
+        {
+            std::cout << desc << std::endl;
+            return false;
+        }
+
+        cfgMgr.readConfiguration(variables, desc);
+
+        return true;
+    }
+
+    /// Same settings files as OMW::Engine::loadSettings, so the tiles are generated with the game settings
+    void loadSettings(Settings::Manager& settings, const Files::ConfigurationManager& cfgMgr)
+    {
+        const std::string localdefault = (cfgMgr.getLocalPath() / "settings-default.cfg").string();
+        const std::string globaldefault = (cfgMgr.getGlobalPath() / "settings-default.cfg").string();
+
+        if (boost::filesystem::exists(localdefault))
+            settings.loadDefault(localdefault);
+        else if (boost::filesystem::exists(globaldefault))
+            settings.loadDefault(globaldefault);
+        else
+            throw std::runtime_error ("No default settings file found! Make sure the file \"settings-default.cfg\" was properly installed.");
+
+        const std::string settingspath = (cfgMgr.getUserConfigPath() / "settings.cfg").string();
+        if (boost::filesystem::exists(settingspath))
+            settings.loadUser(settingspath);
+    }
+
+    void loadContentFiles(const Files::Collections& fileCollections, const std::vector<std::string>& content,
+        MWWorld::ESMStore& store, std::vector<ESM::ESMReader>& readers, ToUTF8::Utf8Encoder& encoder, int threads)
+    {
+        std::vector<boost::filesystem::path> paths;
+        paths.reserve(content.size());
+        for (const std::string& file : content)
+        {
+            const Files::MultiDirCollection& collection
+                = fileCollections.getCollection(boost::filesystem::path(file).extension().string());
+            if (!collection.doesExist(file))
+                throw std::runtime_error("Failed loading " + file + ": the content file does not exist");
+            paths.push_back(collection.getPath(file));
+        }
+
+        Loading::Listener listener;
+        readers.resize(paths.size());
+        MWWorld::EsmLoader loader(store, readers, &encoder, listener, threads);
+
+        for (std::size_t i = 0; i < paths.size(); ++i)
+            loader.stage(paths[i], static_cast<int>(i));
+
+        for (std::size_t i = 0; i < paths.size(); ++i)
+        {
+            int index = static_cast<int>(i);
+            loader.load(paths[i], index);
+        }
+    }
+
+    int runNavMeshTool(int argc, char* argv[])
+    {
+        Files::ConfigurationManager cfgMgr;
+        bpo::variables_map variables;
+
+        if (!parseOptions(argc, argv, variables, cfgMgr))
+            return 0;
+
+        const auto contentFiles = variables["content"].as<Files::EscapeStringVector>().toStdStringVector();
+        if (contentFiles.empty())
+        {
+            Log(Debug::Error) << "No content file given (esm/esp, nor omwgame/omwaddon). Aborting...";
+            return 1;
+        }
+
+        Files::PathContainer dataDirs(Files::EscapePath::toPathContainer(variables["data"].as<Files::EscapePathContainer>()));
+
+        std::string local(variables["data-local"].as<Files::EscapeHashString>().toStdString());
+        if (!local.empty())
+        {
+            if (local.front() == '\"')
+                local = local.substr(1, local.length() - 2);
+
+            dataDirs.push_back(Files::PathContainer::value_type(local));
+        }
+
+        cfgMgr.processPaths(dataDirs);
+
+        const bool fsStrict = variables["fs-strict"].as<bool>();
+        const auto archives = variables["fallback-archive"].as<Files::EscapeStringVector>().toStdStringVector();
+        const auto encoding = variables["encoding"].as<Files::EscapeHashString>().toStdString();
+        int threads = variables["threads"].as<int>();
+        if (threads <= 0)
+            threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+
+        Settings::Manager settings;
+        loadSettings(settings, cfgMgr);
+
+        auto navigatorSettings = DetourNavigator::makeSettingsFromSettingsManager();
+        if (!navigatorSettings)
+        {
+            Log(Debug::Warning) << "Warning: navigator is disabled in the settings, nothing to generate";
+            return 0;
+        }
+        if (!navigatorSettings->mEnableNavMeshDiskCache)
+        {
+            Log(Debug::Warning) << "Warning: nav mesh disk cache is disabled in the settings, nothing to generate";
+            return 0;
+        }
+
+        const auto start = Clock::now();
+
+        const Files::Collections fileCollections(dataDirs, !fsStrict);
+        VFS::Manager vfs(fsStrict);
+        VFS::registerArchives(&vfs, fileCollections, archives, true);
+        Resource::ResourceSystem resourceSystem(&vfs);
+        Resource::BulletShapeManager bulletShapeManager(&vfs, resourceSystem.getSceneManager(),
+                                                        resourceSystem.getNifFileManager());
+
+        ToUTF8::Utf8Encoder encoder(ToUTF8::calculateEncoding(encoding));
+        MWWorld::ESMStore store;
+        std::vector<ESM::ESMReader> readers;
+        loadContentFiles(fileCollections, contentFiles, store, readers, encoder, threads);
+        store.setUp();
+
+        const auto& gameSettings = store.get<ESM::GameSetting>();
+        navigatorSettings->mMaxClimb = MWPhysics::sStepSizeUp;
+        navigatorSettings->mMaxSlope = MWPhysics::sMaxSlope;
+        navigatorSettings->mSwimHeightScale = gameSettings.find("fSwimHeightScale")->mValue.getFloat();
+        const auto maxActivationDistance
+            = static_cast<float>(gameSettings.find("iMaxActivateDist")->mValue.getInteger());
+
+        // The game uses the half extents of the player model for every actor in the exteriors
+        const auto agentHalfExtents = bulletShapeManager.getShape("meshes\\base_anim.nif")->mCollisionBoxHalfExtents;
+
+        DetourNavigator::RecastGlobalAllocator::init();
+
+        const auto cachePath = cfgMgr.getCachePath() / "navmesh";
+        DetourNavigator::NavMeshDiskCache diskCache(cachePath, navigatorSettings->mMaxNavMeshDiskCacheSize,
+                                                    *navigatorSettings);
+
+        const auto loaded = Clock::now();
+        Log(Debug::Info) << "Loaded content files in " << std::fixed << std::setprecision(3)
+                         << toSeconds(loaded - start) << "s";
+
+        const NavMeshTool::WorldspaceContext context {store, readers, bulletShapeManager, *navigatorSettings,
+                                                      maxActivationDistance};
+
+        NavMeshTool::GenerationStats stats {};
+        std::size_t worldspaces = 0;
+
+        {
+            NavMeshTool::NavMeshGenerator generator(agentHalfExtents, *navigatorSettings, diskCache,
+                                                    static_cast<std::size_t>(threads));
+
+            generator.add(NavMeshTool::gatherExterior(context));
+            ++worldspaces;
+
+            const auto& cells = store.get<ESM::Cell>();
+            for (auto cell = cells.intBegin(); cell != cells.intEnd(); ++cell)
+            {
+                generator.add(NavMeshTool::gatherInterior(context, *cell));
+                ++worldspaces;
+            }
+
+            stats = generator.wait();
+        }
+
+        const auto finished = Clock::now();
+        const auto generationTime = toSeconds(finished - loaded);
+
+        Log(Debug::Info) << std::fixed << std::setprecision(3)
+            << "Processed " << stats.mTiles << " nav mesh tiles of " << worldspaces << " worldspaces"
+            << " using " << threads << " threads:"
+            << " generated=" << stats.mGenerated
+            << " cached=" << stats.mCached
+            << " empty=" << stats.mEmpty
+            << " failed=" << stats.mFailed;
+        Log(Debug::Info) << std::fixed << std::setprecision(3)
+            << "Generation time " << generationTime << "s"
+            << " (" << (generationTime > 0 ? static_cast<double>(stats.mTiles) / generationTime : 0) << " tiles/s),"
+            << " total time " << toSeconds(finished - start) << "s";
+        Log(Debug::Info) << "Nav mesh disk cache " << cachePath << " size is " << diskCache.getSize() << " bytes";
+
+        if (diskCache.getSize() >= navigatorSettings->mMaxNavMeshDiskCacheSize / 10 * 9)
+            Log(Debug::Warning) << "Warning: nav mesh disk cache is close to its limit and may have dropped tiles,"
+                                << " increase 'max nav mesh disk cache size' in the [Navigator] section of settings.cfg";
+
+        return stats.mFailed == 0 ? 0 : 1;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    return wrapApplication(&runNavMeshTool, argc, argv, "NavMeshTool");
+}
@@ -0,0 +1,329 @@
+#include "worldspacedata.hpp"
+
+#include "apps/openmw/mwphysics/heightfield.hpp"
+#include "apps/openmw/mwworld/esmstore.hpp"
+
+#include <components/debug/debuglog.hpp>
+#include <components/detournavigator/settingsutils.hpp>
+#include <components/esm/esmreader.hpp>
+#include <components/esm/loadcell.hpp>
+#include <components/esm/loadland.hpp>
+#include <components/misc/convert.hpp>
+#include <components/misc/resourcehelpers.hpp>
+#include <components/misc/stringops.hpp>
+#include <components/resource/bulletshape.hpp>
+#include <components/resource/bulletshapemanager.hpp>
+
+#include <BulletCollision/BroadphaseCollision/btDbvtBroadphase.h>
+#include <BulletCollision/CollisionDispatch/btCollisionObject.h>
+#include <BulletCollision/CollisionDispatch/btCollisionWorld.h>
+#include <BulletCollision/CollisionDispatch/btDefaultCollisionConfiguration.h>
+#include <BulletCollision/CollisionShapes/btHeightfieldTerrainShape.h>
+#include <BulletCollision/CollisionShapes/btStaticPlaneShape.h>
+
+#include <osg/Quat>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <set>
+
+namespace
+{
+    using namespace NavMeshTool;
+
+    /// Model of the references getting a collision object in the game, see insertObject of the MWClass classes
+    std::string getModel(const MWWorld::ESMStore& store, const std::string& id, bool& isDoor)
+    {
+        isDoor = false;
+
+        if (Misc::ResourceHelpers::isHiddenMarker(id))
+            return std::string();
+
+        std::string model;
+        if (const auto record = store.get<ESM::Static>().search(id))
+            model = record->mModel;
+        else if (const auto record = store.get<ESM::Activator>().search(id))
+            model = record->mModel;
+        else if (const auto record = store.get<ESM::Container>().search(id))
+            model = record->mModel;
+        else if (const auto record = store.get<ESM::Door>().search(id))
+        {
+            model = record->mModel;
+            isDoor = true;
+        }
+        else if (const auto record = store.get<ESM::Light>().search(id))
+        {
+            if ((record->mData.mFlags & ESM::Light::Carry) == 0)
+                model = record->mModel;
+        }
+
+        if (model.empty())
+            return model;
+        return "meshes\\" + model;
+    }
+
+    /// Adds the geometry to the recast mesh manager and to a collision world used to find the ends of the door off
+    /// mesh connections, like MWWorld::Scene does with the navigator and the physics system
+    class WorldspaceBuilder
+    {
+    public:
+        WorldspaceBuilder(const WorldspaceContext& context, WorldspaceData& data)
+            : mContext(context)
+            , mData(data)
+            , mDispatcher(&mCollisionConfiguration)
+            , mCollisionWorld(&mDispatcher, &mBroadphase, &mCollisionConfiguration)
+        {
+        }
+
+        void addHeightField(int cellX, int cellY)
+        {
+            const int verts = ESM::Land::LAND_SIZE;
+            const float worldsize = ESM::Land::REAL_SIZE;
+
+            std::vector<float> heights;
+            float minHeight = ESM::Land::DEFAULT_HEIGHT;
+            float maxHeight = ESM::Land::DEFAULT_HEIGHT;
+
+            if (const auto land = mContext.mStore.get<ESM::Land>().search(cellX, cellY))
+            {
+                ESM::Land::LandData data;
+                land->loadData(ESM::Land::DATA_VHGT, &data);
+                if (data.mDataLoaded & ESM::Land::DATA_VHGT)
+                {
+                    heights.assign(data.mHeights, data.mHeights + ESM::Land::LAND_NUM_VERTS);
+                    minHeight = data.mMinHeight;
+                    maxHeight = data.mMaxHeight;
+                }
+            }
+
+            if (heights.empty())
+                heights.resize(ESM::Land::LAND_NUM_VERTS, ESM::Land::DEFAULT_HEIGHT);
+
+            mData.mHeights.push_back(std::move(heights));
+            mData.mHeightFields.emplace_back(new MWPhysics::HeightField(mData.mHeights.back().data(), cellX, cellY,
+                worldsize / (verts - 1), verts, minHeight, maxHeight, nullptr));
+
+            const auto& heightField = *mData.mHeightFields.back();
+            mData.mRecastMeshManager.addObject(DetourNavigator::ObjectId(&heightField), *heightField.getShape(),
+                heightField.getCollisionObject()->getWorldTransform(), DetourNavigator::AreaType_ground);
+            mCollisionWorld.addCollisionObject(mData.mHeightFields.back()->getCollisionObject());
+        }
+
+        void addWater(int cellX, int cellY, int cellSize, float level, const btTransform& transform)
+        {
+            mData.mRecastMeshManager.addWater(osg::Vec2i(cellX, cellY), cellSize,
+                btTransform(transform.getBasis(), btVector3(transform.getOrigin().x(), transform.getOrigin().y(), level)));
+
+            if (!mWaterShape)
+            {
+                mWaterShape.reset(new btStaticPlaneShape(btVector3(0, 0, 1), level));
+                mWaterObject.setCollisionShape(mWaterShape.get());
+                mCollisionWorld.addCollisionObject(&mWaterObject);
+            }
+        }
+
+        void addObjects(const ESM::Cell& cell)
+        {
+            for (const auto& ref : ESM::loadCellRefs(cell, mContext.mReaders))
+            {
+                bool isDoor = false;
+                const auto model = getModel(mContext.mStore, ref.mRefID, isDoor);
+                if (model.empty())
+                    continue;
+
+                const auto instance = mContext.mBulletShapeManager.getInstance(model);
+                if (!instance || !instance->getCollisionShape())
+                    continue;
+
+                instance->setLocalScaling(btVector3(ref.mScale, ref.mScale, ref.mScale));
+                mData.mShapeInstances.push_back(instance);
+
+                const btTransform transform(Misc::Convert::toBullet(Misc::Convert::makeOsgQuat(ref.mPos)),
+                                            btVector3(ref.mPos.pos[0], ref.mPos.pos[1], ref.mPos.pos[2]));
+
+                if (!addObject(*instance, transform))
+                    continue;
+
+                // Doors are not hit by the rays looking for the ground under the off mesh connections
+                if (isDoor)
+                {
+                    if (!ref.mTeleport)
+                        mDoors.push_back(Door {instance.get(), transform});
+                    continue;
+                }
+
+                mCollisionObjects.emplace_back(new btCollisionObject);
+                mCollisionObjects.back()->setCollisionShape(instance->getCollisionShape());
+                mCollisionObjects.back()->setWorldTransform(transform);
+                mCollisionWorld.addCollisionObject(mCollisionObjects.back().get());
+            }
+        }
+
+        /// Should be called when all the other geometry is added
+        void addDoors()
+        {
+            for (const auto& door : mDoors)
+                addOffMeshConnection(door);
+        }
+
+    private:
+        struct Door
+        {
+            const Resource::BulletShapeInstance* mInstance;
+            btTransform mTransform;
+        };
+
+        const WorldspaceContext& mContext;
+        WorldspaceData& mData;
+        std::vector<Door> mDoors;
+        std::vector<std::unique_ptr<btCollisionObject>> mCollisionObjects;
+        std::unique_ptr<btStaticPlaneShape> mWaterShape;
+        btCollisionObject mWaterObject;
+        btDefaultCollisionConfiguration mCollisionConfiguration;
+        btCollisionDispatcher mDispatcher;
+        btDbvtBroadphase mBroadphase;
+        btCollisionWorld mCollisionWorld;
+
+        bool addObject(const Resource::BulletShapeInstance& instance, const btTransform& transform)
+        {
+            bool result = mData.mRecastMeshManager.addObject(DetourNavigator::ObjectId(&instance),
+                *instance.getCollisionShape(), transform, DetourNavigator::AreaType_ground);
+            if (const auto avoid = instance.getAvoidCollisionShape())
+                result = mData.mRecastMeshManager.addObject(DetourNavigator::ObjectId(avoid), *avoid, transform,
+                    DetourNavigator::AreaType_null) || result;
+            return result;
+        }
+
+        void addOffMeshConnection(const Door& door)
+        {
+            const auto shape = door.mInstance->getCollisionShape();
+
+            btVector3 aabbMin;
+            btVector3 aabbMax;
+            shape->getAabb(btTransform::getIdentity(), aabbMin, aabbMax);
+
+            const auto center = (aabbMax + aabbMin) * 0.5f;
+
+            const auto distanceFromDoor = mContext.mMaxActivationDistance * 0.5f;
+            const auto toPoint = aabbMax.x() - aabbMin.x() < aabbMax.y() - aabbMin.y()
+                    ? btVector3(distanceFromDoor, 0, 0)
+                    : btVector3(0, distanceFromDoor, 0);
+
+            const auto start = findGround(Misc::Convert::makeOsgVec3f(door.mTransform(center + toPoint)));
+            const auto end = findGround(Misc::Convert::makeOsgVec3f(door.mTransform(center - toPoint)));
+
+            mData.mOffMeshConnectionsManager.add(DetourNavigator::ObjectId(door.mInstance),
+                DetourNavigator::OffMeshConnection {
+                    DetourNavigator::toNavMeshCoordinates(mContext.mSettings, start),
+                    DetourNavigator::toNavMeshCoordinates(mContext.mSettings, end)
+                });
+        }
+
+        osg::Vec3f findGround(const osg::Vec3f& position)
+        {
+            const auto from = Misc::Convert::toBullet(position);
+            const auto to = Misc::Convert::toBullet(position - osg::Vec3f(0, 0, 1000));
+            btCollisionWorld::ClosestRayResultCallback callback(from, to);
+            mCollisionWorld.rayTest(from, to, callback);
+            return callback.hasHit() ? Misc::Convert::toOsg(callback.m_hitPointWorld) : position;
+        }
+    };
+
+    std::vector<DetourNavigator::TilePosition> getTiles(WorldspaceData& data)
+    {
+        std::vector<DetourNavigator::TilePosition> result;
+        data.mRecastMeshManager.forEachTilePosition([&] (const DetourNavigator::TilePosition& tile)
+                                                    { result.push_back(tile); });
+        return result;
+    }
+}
+
+namespace NavMeshTool
+{
+    WorldspaceData::WorldspaceData(std::string name, const DetourNavigator::Settings& settings)
+        : mName(std::move(name))
+        , mRecastMeshManager(settings)
+        , mOffMeshConnectionsManager(settings)
+    {
+    }
+
+    WorldspaceData::~WorldspaceData() = default;
+
+    std::unique_ptr<WorldspaceData> gatherExterior(const WorldspaceContext& context)
+    {
+        std::unique_ptr<WorldspaceData> result(new WorldspaceData("exterior", context.mSettings));
+        WorldspaceBuilder builder(context, *result);
+
+        const auto& cells = context.mStore.get<ESM::Cell>();
+        const auto& lands = context.mStore.get<ESM::Land>();
+
+        std::set<std::pair<int, int>> usedCells;
+        for (auto cell = cells.extBegin(); cell != cells.extEnd(); ++cell)
+            usedCells.emplace(cell->getGridX(), cell->getGridY());
+        for (auto land = lands.begin(); land != lands.end(); ++land)
+            usedCells.emplace(land->mX, land->mY);
+
+        // The game loads the neighbours of the used cells too, even when there is nothing but the default terrain
+        std::set<std::pair<int, int>> loadedCells;
+        for (const auto& cell : usedCells)
+            for (int x = -1; x <= 1; ++x)
+                for (int y = -1; y <= 1; ++y)
+                    loadedCells.emplace(cell.first + x, cell.second + y);
+
+        for (const auto& cell : loadedCells)
+        {
+            builder.addHeightField(cell.first, cell.second);
+            const auto& heightField = *result->mHeightFields.back();
+            // Exterior cells have the water at -1, see CellStore::getWaterLevel
+            builder.addWater(cell.first, cell.second, ESM::Land::REAL_SIZE, -1,
+                heightField.getCollisionObject()->getWorldTransform());
+        }
+
+        for (auto cell = cells.extBegin(); cell != cells.extEnd(); ++cell)
+            builder.addObjects(*cell);
+
+        builder.addDoors();
+
+        // Tiles at the border of the loaded cells miss the geometry of the cells which are never described by the
+        // content files, so only the tiles touching the used cells are the same as in the game
+        for (const auto& tile : getTiles(*result))
+        {
+            const auto bounds = DetourNavigator::makeTileBounds(context.mSettings, tile);
+            const auto min = DetourNavigator::fromNavMeshCoordinates(context.mSettings,
+                osg::Vec3f(bounds.mMin.x(), 0, bounds.mMin.y()));
+            const auto max = DetourNavigator::fromNavMeshCoordinates(context.mSettings,
+                osg::Vec3f(bounds.mMax.x(), 0, bounds.mMax.y()));
+            const int minX = static_cast<int>(std::floor(min.x() / ESM::Land::REAL_SIZE));
+            const int minY = static_cast<int>(std::floor(min.y() / ESM::Land::REAL_SIZE));
+            const int maxX = static_cast<int>(std::floor(max.x() / ESM::Land::REAL_SIZE));
+            const int maxY = static_cast<int>(std::floor(max.y() / ESM::Land::REAL_SIZE));
+            bool used = false;
+            for (int x = minX; x <= maxX && !used; ++x)
+                for (int y = minY; y <= maxY && !used; ++y)
+                    used = usedCells.count(std::make_pair(x, y)) > 0;
+            if (used)
+                result->mTiles.push_back(tile);
+        }
+
+        return result;
+    }
+
+    std::unique_ptr<WorldspaceData> gatherInterior(const WorldspaceContext& context, const ESM::Cell& cell)
+    {
+        std::unique_ptr<WorldspaceData> result(new WorldspaceData(cell.mName, context.mSettings));
+        WorldspaceBuilder builder(context, *result);
+
+        if (cell.hasWater())
+            builder.addWater(cell.getGridX(), cell.getGridY(), std::numeric_limits<int>::max(), cell.mWater,
+                btTransform::getIdentity());
+
+        builder.addObjects(cell);
+        builder.addDoors();
+
+        result->mTiles = getTiles(*result);
+
+        return result;
+    }
+}
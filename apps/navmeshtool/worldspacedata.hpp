@@ -0,0 +1,72 @@
+#ifndef OPENMW_NAVMESHTOOL_WORLDSPACEDATA_H
+#define OPENMW_NAVMESHTOOL_WORLDSPACEDATA_H
+
+#include <components/detournavigator/offmeshconnectionsmanager.hpp>
+#include <components/detournavigator/tilecachedrecastmeshmanager.hpp>
+#include <components/detournavigator/tileposition.hpp>
+
+#include <osg/ref_ptr>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace ESM
+{
+    class ESMReader;
+    struct Cell;
+}
+
+namespace MWPhysics
+{
+    class HeightField;
+}
+
+namespace MWWorld
+{
+    class ESMStore;
+}
+
+namespace Resource
+{
+    class BulletShapeInstance;
+    class BulletShapeManager;
+}
+
+namespace NavMeshTool
+{
+    /// \brief World geometry of an exterior world or a single interior cell, added to the recast mesh manager the same
+    /// way MWWorld::Scene adds it to the navigator
+    struct WorldspaceData
+    {
+        std::string mName;
+        DetourNavigator::TileCachedRecastMeshManager mRecastMeshManager;
+        DetourNavigator::OffMeshConnectionsManager mOffMeshConnectionsManager;
+        std::vector<osg::ref_ptr<Resource::BulletShapeInstance>> mShapeInstances;
+        std::vector<std::vector<float>> mHeights;
+        std::vector<std::unique_ptr<MWPhysics::HeightField>> mHeightFields;
+        std::vector<DetourNavigator::TilePosition> mTiles;
+        ///< Tiles to generate
+
+        WorldspaceData(std::string name, const DetourNavigator::Settings& settings);
+
+        ~WorldspaceData();
+    };
+
+    /// Shared state to gather the worldspaces
+    struct WorldspaceContext
+    {
+        const MWWorld::ESMStore& mStore;
+        std::vector<ESM::ESMReader>& mReaders;
+        Resource::BulletShapeManager& mBulletShapeManager;
+        const DetourNavigator::Settings& mSettings;
+        float mMaxActivationDistance;
+    };
+
+    std::unique_ptr<WorldspaceData> gatherExterior(const WorldspaceContext& context);
+    ///< Every exterior cell having a cell or a land record, surrounded by one cell of default terrain
+
+    std::unique_ptr<WorldspaceData> gatherInterior(const WorldspaceContext& context, const ESM::Cell& cell);
+}
+
+#endif
@@ -1,6 +1,7 @@
 #include "engine.hpp"
 
 #include <iomanip>
+#include <thread>
 
 #include <boost/filesystem/fstream.hpp>
 
@@ -23,9 +24,12 @@
 #include <components/resource/resourcesystem.hpp>
 #include <components/resource/scenemanager.hpp>
 #include <components/resource/stats.hpp>
+#include <components/resource/templatediskcache.hpp>
 
 #include <components/compiler/extensions0.hpp>
 
+#include <components/sceneutil/glextensions.hpp>
+#include <components/sceneutil/riggeometry.hpp>
 #include <components/sceneutil/workqueue.hpp>
 
 #include <components/files/configurationmanager.hpp>
@@ -204,8 +208,7 @@ bool OMW::Engine::frame(float frametime)
         {
             mResourceSystem->reportStats(frameNumber, stats);
 
-            stats->setAttribute(frameNumber, "WorkQueue", mWorkQueue->getNumItems());
-            stats->setAttribute(frameNumber, "WorkThread", mWorkQueue->getNumActiveThreads());
+            mWorkQueue->reportStats(frameNumber, *stats);
 
             mEnvironment.getWorld()->getNavigator()->reportStats(frameNumber, *stats);
         }
@@ -267,6 +270,9 @@ OMW::Engine::~Engine()
 
     mViewer = nullptr;
 
+    // only after the viewer, since drawing waits for skinning jobs
+    SceneUtil::RigGeometry::setWorkQueue(nullptr);
+
     mResourceSystem.reset();
 
     delete mEncoder;
@@ -439,6 +445,7 @@ void OMW::Engine::createWindow(Settings::Manager& settings)
     camera->setGraphicsContext(graphicsWindow);
     camera->setViewport(0, 0, traits->width, traits->height);
 
+    mViewer->setRealizeOperation(new SceneUtil::GetGLExtensionsOperation);
     mViewer->realize();
 
     mViewer->getEventQueue()->getCurrentEventState()->setWindowRectangle(0, 0, traits->width, traits->height);
@@ -490,12 +497,23 @@ void OMW::Engine::prepareEngine (Settings::Manager & settings)
         Settings::Manager::getString("texture mipmap", "General"),
         Settings::Manager::getInt("anisotropy", "General")
     );
+    if (Settings::Manager::getBool("enable model disk cache", "Cells"))
+        mResourceSystem->getSceneManager()->setDiskCache(
+            std::make_shared<Resource::TemplateDiskCache>(mCfgMgr.getCachePath() / "models"));
 
     int numThreads = Settings::Manager::getInt("preload num threads", "Cells");
     if (numThreads <= 0)
         throw std::runtime_error("Invalid setting: 'preload num threads' must be >0");
     mWorkQueue = new SceneUtil::WorkQueue(numThreads);
 
+    int skinningThreads = Settings::Manager::getInt("skinning threads", "General");
+    if (skinningThreads < 0)
+        throw std::runtime_error("Invalid setting: 'skinning threads' must be >=0");
+    if (skinningThreads == 0)
+        skinningThreads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    if (skinningThreads > 1)
+        SceneUtil::RigGeometry::setWorkQueue(new SceneUtil::WorkQueue(skinningThreads));
+
     // Create input and UI first to set up a bootstrapping environment for
     // showing a loading screen and keeping the window responsive while doing so
 
@@ -559,7 +577,7 @@ void OMW::Engine::prepareEngine (Settings::Manager & settings)
     // Create the world
     mEnvironment.setWorld( new MWWorld::World (mViewer, rootNode, mResourceSystem.get(), mWorkQueue.get(),
         mFileCollections, mContentFiles, mEncoder, mActivationDistanceOverride, mCellName,
-        mStartupScript, mResDir.string(), mCfgMgr.getUserDataPath().string()));
+        mStartupScript, mResDir.string(), mCfgMgr.getUserDataPath().string(), mCfgMgr.getCachePath().string()));
     mEnvironment.getWorld()->setupPlayer();
     input->setPlayer(&mEnvironment.getWorld()->getPlayer());
 
@@ -577,8 +595,25 @@ void OMW::Engine::prepareEngine (Settings::Manager & settings)
     mScriptContext = new MWScript::CompilerContext (MWScript::CompilerContext::Type_Full);
     mScriptContext->setExtensions (&mExtensions);
 
+    std::unique_ptr<MWScript::ScriptCache> scriptCache;
+    if (Settings::Manager::getBool("compiled script cache", "General"))
+    {
+        std::vector<boost::filesystem::path> contentFiles;
+        for (const std::string& file : mContentFiles)
+        {
+            const Files::MultiDirCollection& collection =
+                mFileCollections.getCollection(boost::filesystem::path(file).extension().string());
+            contentFiles.push_back(collection.doesExist(file) ? collection.getPath(file) : boost::filesystem::path(file));
+        }
+        // Warnings may be treated as errors, so scripts compiled with another mode can't be reused
+        const std::string version = Version::getOpenmwVersionDescription(mResDir.string())
+            + "\nwarnings " + std::to_string(mWarningsMode);
+        scriptCache.reset(new MWScript::ScriptCache(mCfgMgr.getCachePath() / "scripts.bin",
+            MWScript::ScriptCache::makeKey(version, contentFiles)));
+    }
+
     mEnvironment.setScriptManager (new MWScript::ScriptManager (mEnvironment.getWorld()->getStore(), *mScriptContext, mWarningsMode,
-        mScriptBlacklistUse ? mScriptBlacklist : std::vector<std::string>()));
+        mScriptBlacklistUse ? mScriptBlacklist : std::vector<std::string>(), std::move(scriptCache)));
 
     // Create game mechanics system
     MWMechanics::MechanicsManager* mechanics = new MWMechanics::MechanicsManager;
@@ -707,6 +742,10 @@ void OMW::Engine::go()
                                    "mechanics_time_taken", 1000.0, true, false, "mechanics_time_begin", "mechanics_time_end", 10000);
     statshandler->addUserStatsLine("Phys", osg::Vec4f(1.f, 1.f, 1.f, 1.f), osg::Vec4f(1.f, 1.f, 1.f, 1.f),
                                    "physics_time_taken", 1000.0, true, false, "physics_time_begin", "physics_time_end", 10000);
+    statshandler->addUserStatsLine("Async", osg::Vec4f(1.f, 1.f, 1.f, 1.f), osg::Vec4f(1.f, 1.f, 1.f, 1.f),
+                                   "physics_async_time_taken", 1000.0, true, false, "physics_async_time_begin", "physics_async_time_end", 10000);
+    statshandler->addUserStatsLine("Overlap", osg::Vec4f(1.f, 1.f, 1.f, 1.f), osg::Vec4f(1.f, 1.f, 1.f, 1.f),
+                                   "physics_async_overlap_time_taken", 1000.0, true, false, "", "", 10000);
     statshandler->addUserStatsLine("World", osg::Vec4f(1.f, 1.f, 1.f, 1.f), osg::Vec4f(1.f, 1.f, 1.f, 1.f),
                                    "world_time_taken", 1000.0, true, false, "world_time_begin", "world_time_end", 10000);
 
@@ -762,8 +801,14 @@ void OMW::Engine::go()
 
             mEnvironment.getWorld()->updateWindowManager();
 
+            // Nothing may access the physics from here until finishAsyncPhysics, only the rendering runs meanwhile
+            mEnvironment.getWorld()->startAsyncPhysics();
+
             mViewer->renderingTraversals();
 
+            mEnvironment.getWorld()->finishAsyncPhysics(mStartTick, mViewer->getFrameStamp()->getFrameNumber(),
+                                                        *mViewer->getViewerStats());
+
             bool guiActive = mEnvironment.getWindowManager()->isGuiMode();
             if (!guiActive)
                 simulationTime += dt;
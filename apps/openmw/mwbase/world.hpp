@@ -8,6 +8,8 @@
 #include <set>
 #include <deque>
 
+#include <osg/Timer>
+
 #include <components/esm/cellid.hpp>
 
 #include "../mwworld/ptr.hpp"
@@ -21,6 +23,7 @@ namespace osg
     class Matrixf;
     class Quat;
     class Image;
+    class Stats;
 }
 
 namespace Loading
@@ -378,6 +381,12 @@ namespace MWBase
             virtual void update (float duration, bool paused) = 0;
             virtual void updatePhysics (float duration, bool paused) = 0;
 
+            virtual void startAsyncPhysics () = 0;
+            ///< Start the physics work that may overlap with rendering the frame.
+
+            virtual void finishAsyncPhysics (osg::Timer_t startTick, unsigned int frameNumber, osg::Stats& stats) = 0;
+            ///< Wait for the physics work started by startAsyncPhysics and report its timing.
+
             virtual void updateWindowManager () = 0;
 
             virtual MWWorld::Ptr placeObject (const MWWorld::ConstPtr& object, float cursorX, float cursorY, int amount) = 0;
@@ -452,6 +461,10 @@ namespace MWBase
             virtual bool getLOS(const MWWorld::ConstPtr& actor,const MWWorld::ConstPtr& targetActor) = 0;
             ///< get Line of Sight (morrowind stupid implementation)
 
+            virtual void prefetchLOS(const std::vector<std::pair<MWWorld::ConstPtr, MWWorld::ConstPtr>>& pairs) = 0;
+            ///< Compute the line of sight of several pairs of actors at once, if worthwhile. The following getLOS calls
+            /// for these pairs in this frame are then cheap.
+
             virtual float getDistToNearestRayHit(const osg::Vec3f& from, const osg::Vec3f& dir, float maxDist, bool includeWater = false) = 0;
 
             virtual void enableActorCollision(const MWWorld::Ptr& actor, bool enable) = 0;
@@ -1476,6 +1476,13 @@ namespace MWMechanics
         std::vector<MWWorld::Ptr> neighbors;
         osg::Vec3f position (actor.getRefData().getPosition().asVec3());
         getObjectsInRange(position, mActorsProcessingRange, neighbors);
+
+        std::vector<std::pair<MWWorld::ConstPtr, MWWorld::ConstPtr>> lineOfSightPairs;
+        for (const MWWorld::Ptr &neighbor : neighbors)
+            if (neighbor != actor)
+                lineOfSightPairs.emplace_back(neighbor, actor);
+        MWBase::Environment::get().getWorld()->prefetchLOS(lineOfSightPairs);
+
         for (const MWWorld::Ptr &neighbor : neighbors)
         {
             if (neighbor == actor)
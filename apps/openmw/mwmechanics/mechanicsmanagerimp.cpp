@@ -1230,6 +1230,12 @@ namespace MWMechanics
         std::set<MWWorld::Ptr> playerFollowers;
         getActorsSidingWith(player, playerFollowers);
 
+        std::vector<std::pair<MWWorld::ConstPtr, MWWorld::ConstPtr>> lineOfSightPairs;
+        for (const MWWorld::Ptr &neighbor : neighbors)
+            if (canReportCrime(neighbor, victim, playerFollowers))
+                lineOfSightPairs.emplace_back(player, neighbor);
+        MWBase::Environment::get().getWorld()->prefetchLOS(lineOfSightPairs);
+
         // Did anyone see it?
         bool crimeSeen = false;
         for (const MWWorld::Ptr &neighbor : neighbors)
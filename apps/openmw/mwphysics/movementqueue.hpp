@@ -0,0 +1,20 @@
+#ifndef OPENMW_MWPHYSICS_MOVEMENTQUEUE_H
+#define OPENMW_MWPHYSICS_MOVEMENTQUEUE_H
+
+#include <utility>
+#include <vector>
+
+namespace MWPhysics
+{
+    /// Points the movement queued for old at updated, so the movement is not lost when the actor changes cell
+    /// between queueing and solving it.
+    template <class Ptr, class Movement>
+    void updateMovementQueuePtr(std::vector<std::pair<Ptr, Movement>>& queue, const Ptr& old, const Ptr& updated)
+    {
+        for (std::pair<Ptr, Movement>& entry : queue)
+            if (entry.first == old)
+                entry.first = updated;
+    }
+}
+
+#endif
@@ -1,8 +1,6 @@
 #ifndef OPENMW_MWPHYSICS_MOVEMENTSOLVER_H
 #define OPENMW_MWPHYSICS_MOVEMENTSOLVER_H
 
-#include <map>
-
 #include <osg/Vec3f>
 
 #include "../mwworld/ptr.hpp"
@@ -31,9 +29,17 @@ namespace MWPhysics
 
     public:
         static osg::Vec3f traceDown(const MWWorld::Ptr &ptr, const osg::Vec3f& position, Actor* actor, btCollisionWorld* collisionWorld, float maxHeight);
+
+        /// Apply the side effects of a jump requested by the character controller, i.e. advance Acrobatics and
+        /// decrease fatigue. Touches the game world, so it has to be called from the main thread before move().
+        static void jump(const MWWorld::Ptr &ptr, const Actor* physicActor);
+
+        /// Move the actor by one physics step. Only writes to \a physicActor and \a standingOn, so different actors
+        /// can be moved concurrently as long as the collision world and the game world are not modified meanwhile.
+        /// @param standingOn Set to the object the actor is standing on, if any.
         static osg::Vec3f move(osg::Vec3f position, const MWWorld::Ptr &ptr, Actor* physicActor, const osg::Vec3f &movement, float time,
                                bool isFlying, float waterlevel, float slowFall, const btCollisionWorld* collisionWorld,
-                               std::map<MWWorld::Ptr, MWWorld::Ptr>& standingCollisionTracker);
+                               MWWorld::Ptr& standingOn);
     };
 }
 
@@ -1,6 +1,8 @@
 #include "physicssystem.hpp"
 
 #include <osg/Group>
+#include <osg/Stats>
+#include <osg/Timer>
 
 #include <BulletCollision/CollisionShapes/btConeShape.h>
 #include <BulletCollision/CollisionShapes/btSphereShape.h>
@@ -13,6 +15,9 @@
 
 #include <LinearMath/btQuickprof.h>
 
+#include <stdexcept>
+#include <thread>
+
 #include <components/nifbullet/bulletnifloader.hpp>
 #include <components/resource/resourcesystem.hpp>
 #include <components/resource/bulletshapemanager.hpp>
@@ -21,6 +26,8 @@
 #include <components/misc/constants.hpp>
 #include <components/sceneutil/positionattitudetransform.hpp>
 #include <components/sceneutil/unrefqueue.hpp>
+#include <components/sceneutil/workqueue.hpp>
+#include <components/settings/settings.hpp>
 #include <components/misc/convert.hpp>
 
 #include <components/nifosg/particle.hpp> // FindRecIndexVisitor
@@ -49,9 +56,215 @@
 #include "contacttestresultcallback.hpp"
 #include "constants.hpp"
 #include "movementsolver.hpp"
+#include "movementqueue.hpp"
 
 namespace MWPhysics
 {
+    namespace
+    {
+        /// Run the physics steps of one actor. Doesn't move the actor's collision object, so that actors can be solved
+        /// concurrently against the same collision world.
+        void solveActorMovement(ActorFrameData& data, int numSteps, float physicsDt, const btCollisionWorld* collisionWorld)
+        {
+            for (int i=0; i<numSteps; ++i)
+            {
+                const osg::Vec3f position = MovementSolver::move(data.mPosition, data.mPtr, data.mActor, data.mMovement, physicsDt,
+                                                                 data.mFlying, data.mWaterlevel, data.mSlowFall, collisionWorld, data.mStandingOn);
+                if (position != data.mPosition)
+                    data.mPositionChanged = true;
+                data.mLastStepPosition = data.mPosition;
+                data.mPosition = position;
+            }
+        }
+
+        class MovementWorkItem : public SceneUtil::WorkItem
+        {
+        public:
+            MovementWorkItem(std::vector<ActorFrameData>& actors, std::size_t begin, std::size_t end, int numSteps,
+                             float physicsDt, const btCollisionWorld* collisionWorld)
+                : mActors(actors)
+                , mBegin(begin)
+                , mEnd(end)
+                , mNumSteps(numSteps)
+                , mPhysicsDt(physicsDt)
+                , mCollisionWorld(collisionWorld)
+            {
+            }
+
+            void doWork() override
+            {
+                for (std::size_t i = mBegin; i < mEnd; ++i)
+                    solveActorMovement(mActors[i], mNumSteps, mPhysicsDt, mCollisionWorld);
+            }
+
+        private:
+            std::vector<ActorFrameData>& mActors;
+            std::size_t mBegin;
+            std::size_t mEnd;
+            int mNumSteps;
+            float mPhysicsDt;
+            const btCollisionWorld* mCollisionWorld;
+        };
+
+        /// Solve the movement of all actors, on the threads of \a workQueue if there is one. Every actor collides
+        /// against the positions all other actors had at the start of the frame, so the results don't depend on
+        /// the number of threads nor on the order in which the jobs are finished.
+        void solveActorsMovement(std::vector<ActorFrameData>& actors, int numSteps, float physicsDt,
+                                 const btCollisionWorld* collisionWorld, SceneUtil::WorkQueue* workQueue, int numThreads)
+        {
+            if (!workQueue || actors.size() < 2)
+            {
+                for (ActorFrameData& data : actors)
+                    solveActorMovement(data, numSteps, physicsDt, collisionWorld);
+                return;
+            }
+
+            const std::size_t numJobs = std::min(actors.size(), static_cast<std::size_t>(numThreads) * 2);
+            std::vector<osg::ref_ptr<MovementWorkItem>> jobs;
+            jobs.reserve(numJobs);
+            for (std::size_t i = 0; i < numJobs; ++i)
+            {
+                jobs.emplace_back(new MovementWorkItem(actors, i * actors.size() / numJobs, (i + 1) * actors.size() / numJobs,
+                                                       numSteps, physicsDt, collisionWorld));
+                workQueue->addWorkItem(jobs.back(), SceneUtil::WorkPriority_Immediate);
+            }
+            for (const auto& job : jobs)
+                job->waitTillDone();
+        }
+
+        /// A PhysicsSystem::RayRequest with the Ptr to ignore resolved on the main thread
+        struct ResolvedRayRequest
+        {
+            btVector3 mFrom;
+            btVector3 mTo;
+            float mRadius;
+            const btCollisionObject* mIgnore;
+            int mMask;
+            int mGroup;
+        };
+
+        PhysicsSystem::RayResult rayTest(const btCollisionWorld* collisionWorld, const btVector3& from, const btVector3& to,
+                                         const btCollisionObject* me, const std::vector<const btCollisionObject*>& targets,
+                                         int mask, int group)
+        {
+            ClosestNotMeRayResultCallback resultCallback(me, targets, from, to);
+            resultCallback.m_collisionFilterGroup = group;
+            resultCallback.m_collisionFilterMask = mask;
+
+            collisionWorld->rayTest(from, to, resultCallback);
+
+            PhysicsSystem::RayResult result;
+            result.mHit = resultCallback.hasHit();
+            if (resultCallback.hasHit())
+            {
+                result.mHitPos = Misc::Convert::toOsg(resultCallback.m_hitPointWorld);
+                result.mHitNormal = Misc::Convert::toOsg(resultCallback.m_hitNormalWorld);
+                if (PtrHolder* ptrHolder = static_cast<PtrHolder*>(resultCallback.m_collisionObject->getUserPointer()))
+                    result.mHitObject = ptrHolder->getPtr();
+            }
+            return result;
+        }
+
+        PhysicsSystem::RayResult sphereTest(const btCollisionWorld* collisionWorld, const btVector3& from, const btVector3& to,
+                                            float radius, int mask, int group)
+        {
+            btCollisionWorld::ClosestConvexResultCallback callback(from, to);
+            callback.m_collisionFilterGroup = group;
+            callback.m_collisionFilterMask = mask;
+
+            btSphereShape shape(radius);
+            const btQuaternion btrot = btQuaternion::getIdentity();
+
+            btTransform from_ (btrot, from);
+            btTransform to_ (btrot, to);
+
+            collisionWorld->convexSweepTest(&shape, from_, to_, callback);
+
+            PhysicsSystem::RayResult result;
+            result.mHit = callback.hasHit();
+            if (result.mHit)
+            {
+                result.mHitPos = Misc::Convert::toOsg(callback.m_hitPointWorld);
+                result.mHitNormal = Misc::Convert::toOsg(callback.m_hitNormalWorld);
+            }
+            return result;
+        }
+
+        PhysicsSystem::RayResult castResolvedRay(const btCollisionWorld* collisionWorld, const ResolvedRayRequest& request)
+        {
+            if (request.mRadius > 0)
+                return sphereTest(collisionWorld, request.mFrom, request.mTo, request.mRadius, request.mMask, request.mGroup);
+            return rayTest(collisionWorld, request.mFrom, request.mTo, request.mIgnore, std::vector<const btCollisionObject*>(),
+                           request.mMask, request.mGroup);
+        }
+
+        class RayWorkItem : public SceneUtil::WorkItem
+        {
+        public:
+            RayWorkItem(const std::vector<ResolvedRayRequest>& requests, std::vector<PhysicsSystem::RayResult>& results,
+                        std::size_t begin, std::size_t end, const btCollisionWorld* collisionWorld)
+                : mRequests(requests)
+                , mResults(results)
+                , mBegin(begin)
+                , mEnd(end)
+                , mCollisionWorld(collisionWorld)
+            {
+            }
+
+            void doWork() override
+            {
+                for (std::size_t i = mBegin; i < mEnd; ++i)
+                    mResults[i] = castResolvedRay(mCollisionWorld, mRequests[i]);
+            }
+
+        private:
+            const std::vector<ResolvedRayRequest>& mRequests;
+            std::vector<PhysicsSystem::RayResult>& mResults;
+            std::size_t mBegin;
+            std::size_t mEnd;
+            const btCollisionWorld* mCollisionWorld;
+        };
+    }
+
+    /// Solves the movement of a frame on the physics thread, while the main thread renders the frame
+    class AsyncMovementWorkItem : public SceneUtil::WorkItem
+    {
+    public:
+        AsyncMovementWorkItem(std::vector<ActorFrameData>& actors, int numSteps, float physicsDt,
+                              const btCollisionWorld* collisionWorld, SceneUtil::WorkQueue* workQueue, int numThreads)
+            : mActors(actors)
+            , mNumSteps(numSteps)
+            , mPhysicsDt(physicsDt)
+            , mCollisionWorld(collisionWorld)
+            , mWorkQueue(workQueue)
+            , mNumThreads(numThreads)
+            , mBeginTick(0)
+            , mEndTick(0)
+        {
+        }
+
+        void doWork() override
+        {
+            mBeginTick = osg::Timer::instance()->tick();
+            solveActorsMovement(mActors, mNumSteps, mPhysicsDt, mCollisionWorld, mWorkQueue, mNumThreads);
+            mEndTick = osg::Timer::instance()->tick();
+        }
+
+        osg::Timer_t getBeginTick() const { return mBeginTick; }
+
+        osg::Timer_t getEndTick() const { return mEndTick; }
+
+    private:
+        std::vector<ActorFrameData>& mActors;
+        int mNumSteps;
+        float mPhysicsDt;
+        const btCollisionWorld* mCollisionWorld;
+        SceneUtil::WorkQueue* mWorkQueue;
+        int mNumThreads;
+        osg::Timer_t mBeginTick;
+        osg::Timer_t mEndTick;
+    };
+
     PhysicsSystem::PhysicsSystem(Resource::ResourceSystem* resourceSystem, osg::ref_ptr<osg::Group> parentNode)
         : mShapeManager(new Resource::BulletShapeManager(resourceSystem->getVFS(), resourceSystem->getSceneManager(), resourceSystem->getNifFileManager()))
         , mResourceSystem(resourceSystem)
@@ -61,12 +274,18 @@ namespace MWPhysics
         , mWaterEnabled(false)
         , mParentNode(parentNode)
         , mPhysicsDt(1.f / 60.f)
+        , mMovementThreads(1)
+        , mAsyncNumSteps(0)
+        , mAsyncFrameDuration(0.f)
+        , mAsyncMovementRequested(false)
+        , mAsyncWaitTime(0.0)
     {
         mResourceSystem->addResourceManager(mShapeManager.get());
 
         mCollisionConfiguration = new btDefaultCollisionConfiguration();
         mDispatcher = new btCollisionDispatcher(mCollisionConfiguration);
-        mBroadphase = new btDbvtBroadphase();
+        btDbvtBroadphase* broadphase = new btDbvtBroadphase();
+        mBroadphase = broadphase;
 
         mCollisionWorld = new btCollisionWorld(mDispatcher, mBroadphase, mCollisionConfiguration);
 
@@ -85,10 +304,29 @@ namespace MWPhysics
                 Log(Debug::Warning) << "Warning: using custom physics framerate (" << physFramerate << " FPS).";
             }
         }
+
+        mMovementThreads = Settings::Manager::getInt("actor movement threads", "Physics");
+        if (mMovementThreads < 0)
+            throw std::runtime_error("Invalid setting: 'actor movement threads' must be >=0");
+        if (mMovementThreads == 0)
+            mMovementThreads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+        // Concurrent collision queries need a broadphase stack per thread, which Bullet only has when built with BT_THREADSAFE
+        if (mMovementThreads > 1 && broadphase->m_rayTestStacks.size() <= 1)
+        {
+            Log(Debug::Warning) << "Warning: Bullet was built without multithreading support, actors will be moved by a single thread.";
+            mMovementThreads = 1;
+        }
+        if (mMovementThreads > 1)
+            mMovementWorkQueue = new SceneUtil::WorkQueue(mMovementThreads);
+
+        if (Settings::Manager::getBool("async actor movement", "Physics"))
+            mAsyncWorkQueue = new SceneUtil::WorkQueue(1);
     }
 
     PhysicsSystem::~PhysicsSystem()
     {
+        waitForAsyncMovement();
+
         mResourceSystem->removeResourceManager(mShapeManager.get());
 
         if (mWaterCollisionObject.get())
@@ -292,46 +530,67 @@ namespace MWPhysics
             }
         }
 
-        ClosestNotMeRayResultCallback resultCallback(me, targetCollisionObjects, btFrom, btTo);
-        resultCallback.m_collisionFilterGroup = group;
-        resultCallback.m_collisionFilterMask = mask;
-
-        mCollisionWorld->rayTest(btFrom, btTo, resultCallback);
-
-        RayResult result;
-        result.mHit = resultCallback.hasHit();
-        if (resultCallback.hasHit())
-        {
-            result.mHitPos = Misc::Convert::toOsg(resultCallback.m_hitPointWorld);
-            result.mHitNormal = Misc::Convert::toOsg(resultCallback.m_hitNormalWorld);
-            if (PtrHolder* ptrHolder = static_cast<PtrHolder*>(resultCallback.m_collisionObject->getUserPointer()))
-                result.mHitObject = ptrHolder->getPtr();
-        }
-        return result;
+        return rayTest(mCollisionWorld, btFrom, btTo, me, targetCollisionObjects, mask, group);
     }
 
     PhysicsSystem::RayResult PhysicsSystem::castSphere(const osg::Vec3f &from, const osg::Vec3f &to, float radius)
     {
-        btCollisionWorld::ClosestConvexResultCallback callback(Misc::Convert::toBullet(from), Misc::Convert::toBullet(to));
-        callback.m_collisionFilterGroup = 0xff;
-        callback.m_collisionFilterMask = CollisionType_World|CollisionType_HeightMap|CollisionType_Door;
+        return sphereTest(mCollisionWorld, Misc::Convert::toBullet(from), Misc::Convert::toBullet(to), radius,
+                          CollisionType_World|CollisionType_HeightMap|CollisionType_Door, 0xff);
+    }
+
+    void PhysicsSystem::castRays(const std::vector<RayRequest>& requests, std::vector<RayResult>& results) const
+    {
+        std::vector<ResolvedRayRequest> resolved;
+        resolved.reserve(requests.size());
+        for (const RayRequest& request : requests)
+        {
+            const btCollisionObject* me = nullptr;
+            if (!request.mIgnore.isEmpty())
+            {
+                if (const Actor* actor = getActor(request.mIgnore))
+                    me = actor->getCollisionObject();
+                else if (const Object* object = getObject(request.mIgnore))
+                    me = object->getCollisionObject();
+            }
+            resolved.push_back(ResolvedRayRequest {Misc::Convert::toBullet(request.mFrom), Misc::Convert::toBullet(request.mTo),
+                                                   request.mRadius, me, request.mMask, request.mGroup});
+        }
 
-        btSphereShape shape(radius);
-        const btQuaternion btrot = btQuaternion::getIdentity();
+        results.resize(requests.size());
 
-        btTransform from_ (btrot, Misc::Convert::toBullet(from));
-        btTransform to_ (btrot, Misc::Convert::toBullet(to));
+        if (!mMovementWorkQueue || resolved.size() < 2)
+        {
+            for (std::size_t i = 0; i < resolved.size(); ++i)
+                results[i] = castResolvedRay(mCollisionWorld, resolved[i]);
+            return;
+        }
 
-        mCollisionWorld->convexSweepTest(&shape, from_, to_, callback);
+        const std::size_t numJobs = std::min(resolved.size(), static_cast<std::size_t>(mMovementThreads));
+        std::vector<osg::ref_ptr<RayWorkItem>> jobs;
+        jobs.reserve(numJobs);
+        for (std::size_t i = 0; i < numJobs; ++i)
+        {
+            jobs.emplace_back(new RayWorkItem(resolved, results, i * resolved.size() / numJobs,
+                                              (i + 1) * resolved.size() / numJobs, mCollisionWorld));
+            mMovementWorkQueue->addWorkItem(jobs.back(), SceneUtil::WorkPriority_Immediate);
+        }
+        for (const auto& job : jobs)
+            job->waitTillDone();
+    }
 
-        RayResult result;
-        result.mHit = callback.hasHit();
-        if (result.mHit)
+    namespace
+    {
+        PhysicsSystem::RayRequest makeLineOfSightRequest(const Actor* actor1, const Actor* actor2)
         {
-            result.mHitPos = Misc::Convert::toOsg(callback.m_hitPointWorld);
-            result.mHitNormal = Misc::Convert::toOsg(callback.m_hitNormalWorld);
+            PhysicsSystem::RayRequest request;
+            request.mFrom = actor1->getCollisionObjectPosition() + osg::Vec3f(0,0,actor1->getHalfExtents().z() * 0.9); // eye level
+            request.mTo = actor2->getCollisionObjectPosition() + osg::Vec3f(0,0,actor2->getHalfExtents().z() * 0.9);
+            request.mRadius = 0;
+            request.mMask = CollisionType_World|CollisionType_HeightMap|CollisionType_Door;
+            request.mGroup = 0xff;
+            return request;
         }
-        return result;
     }
 
     bool PhysicsSystem::getLineOfSight(const MWWorld::ConstPtr &actor1, const MWWorld::ConstPtr &actor2) const
@@ -342,14 +601,47 @@ namespace MWPhysics
         if (!physactor1 || !physactor2)
             return false;
 
-        osg::Vec3f pos1 (physactor1->getCollisionObjectPosition() + osg::Vec3f(0,0,physactor1->getHalfExtents().z() * 0.9)); // eye level
-        osg::Vec3f pos2 (physactor2->getCollisionObjectPosition() + osg::Vec3f(0,0,physactor2->getHalfExtents().z() * 0.9));
+        const auto key = std::make_pair(physactor1, physactor2);
+        const auto cached = mLineOfSightCache.find(key);
+        if (cached != mLineOfSightCache.end())
+            return cached->second;
 
-        RayResult result = castRay(pos1, pos2, MWWorld::ConstPtr(), std::vector<MWWorld::Ptr>(), CollisionType_World|CollisionType_HeightMap|CollisionType_Door);
+        const RayRequest request = makeLineOfSightRequest(physactor1, physactor2);
+        RayResult result = castRay(request.mFrom, request.mTo, MWWorld::ConstPtr(), std::vector<MWWorld::Ptr>(), request.mMask);
 
+        mLineOfSightCache.emplace(key, !result.mHit);
         return !result.mHit;
     }
 
+    void PhysicsSystem::prefetchLinesOfSight(const std::vector<std::pair<MWWorld::ConstPtr, MWWorld::ConstPtr>>& pairs) const
+    {
+        // Without worker threads, casting the rays up front doesn't pay off, as callers usually stop at the first hit
+        if (!mMovementWorkQueue)
+            return;
+
+        std::vector<std::pair<const Actor*, const Actor*>> keys;
+        std::vector<RayRequest> requests;
+        for (const auto& pair : pairs)
+        {
+            const Actor* physactor1 = getActor(pair.first);
+            const Actor* physactor2 = getActor(pair.second);
+            if (!physactor1 || !physactor2)
+                continue;
+
+            const auto key = std::make_pair(physactor1, physactor2);
+            if (mLineOfSightCache.count(key) || std::find(keys.begin(), keys.end(), key) != keys.end())
+                continue;
+
+            keys.push_back(key);
+            requests.push_back(makeLineOfSightRequest(physactor1, physactor2));
+        }
+
+        std::vector<RayResult> results;
+        castRays(requests, results);
+        for (std::size_t i = 0; i < keys.size(); ++i)
+            mLineOfSightCache.emplace(keys[i], !results[i].mHit);
+    }
+
     bool PhysicsSystem::isOnGround(const MWWorld::Ptr &actor)
     {
         Actor* physactor = getActor(actor);
@@ -433,6 +725,8 @@ namespace MWPhysics
 
     void PhysicsSystem::addHeightField (const float* heights, int x, int y, float triSize, float sqrtVerts, float minH, float maxH, const osg::Object* holdObject)
     {
+        mLineOfSightCache.clear();
+
         HeightField *heightfield = new HeightField(heights, x, y, triSize, sqrtVerts, minH, maxH, holdObject);
         mHeightFields[std::make_pair(x,y)] = heightfield;
 
@@ -442,6 +736,8 @@ namespace MWPhysics
 
     void PhysicsSystem::removeHeightField (int x, int y)
     {
+        mLineOfSightCache.clear();
+
         HeightFieldMap::iterator heightfield = mHeightFields.find(std::make_pair(x,y));
         if(heightfield != mHeightFields.end())
         {
@@ -461,6 +757,8 @@ namespace MWPhysics
 
     void PhysicsSystem::addObject (const MWWorld::Ptr& ptr, const std::string& mesh, int collisionType)
     {
+        mLineOfSightCache.clear();
+
         osg::ref_ptr<Resource::BulletShapeInstance> shapeInstance = mShapeManager->getInstance(mesh);
         if (!shapeInstance || !shapeInstance->getCollisionShape())
             return;
@@ -477,6 +775,8 @@ namespace MWPhysics
 
     void PhysicsSystem::remove(const MWWorld::Ptr &ptr)
     {
+        mLineOfSightCache.clear();
+
         ObjectMap::iterator found = mObjects.find(ptr);
         if (found != mObjects.end())
         {
@@ -494,6 +794,7 @@ namespace MWPhysics
         ActorMap::iterator foundActor = mActors.find(ptr);
         if (foundActor != mActors.end())
         {
+            discardAsyncMovement(foundActor->second);
             delete foundActor->second;
             mActors.erase(foundActor);
         }
@@ -536,6 +837,16 @@ namespace MWPhysics
         }
 
         updateCollisionMapPtr(mStandingCollisions, old, updated);
+        updateMovementQueuePtr(mMovementQueue, old, updated);
+
+        waitForAsyncMovement();
+        for (ActorFrameData& data : mAsyncActors)
+        {
+            if (data.mPtr == old)
+                data.mPtr = updated;
+            if (data.mStandingOn == old)
+                data.mStandingOn = updated;
+        }
     }
 
     Actor *PhysicsSystem::getActor(const MWWorld::Ptr &ptr)
@@ -564,6 +875,8 @@ namespace MWPhysics
 
     void PhysicsSystem::updateScale(const MWWorld::Ptr &ptr)
     {
+        mLineOfSightCache.clear();
+
         ObjectMap::iterator found = mObjects.find(ptr);
         if (found != mObjects.end())
         {
@@ -583,6 +896,8 @@ namespace MWPhysics
 
     void PhysicsSystem::updateRotation(const MWWorld::Ptr &ptr)
     {
+        mLineOfSightCache.clear();
+
         ObjectMap::iterator found = mObjects.find(ptr);
         if (found != mObjects.end())
         {
@@ -604,6 +919,8 @@ namespace MWPhysics
 
     void PhysicsSystem::updatePosition(const MWWorld::Ptr &ptr)
     {
+        mLineOfSightCache.clear();
+
         ObjectMap::iterator found = mObjects.find(ptr);
         if (found != mObjects.end())
         {
@@ -614,6 +931,8 @@ namespace MWPhysics
         ActorMap::iterator foundActor = mActors.find(ptr);
         if (foundActor != mActors.end())
         {
+            // The actor was moved by other means than the physics, e.g. teleported by a script
+            discardAsyncMovement(foundActor->second);
             foundActor->second->updatePosition();
             mCollisionWorld->updateSingleAabb(foundActor->second->getCollisionObject());
             return;
@@ -621,6 +940,8 @@ namespace MWPhysics
     }
 
     void PhysicsSystem::addActor (const MWWorld::Ptr& ptr, const std::string& mesh) {
+        mLineOfSightCache.clear();
+
         osg::ref_ptr<const Resource::BulletShape> shape = mShapeManager->getShape(mesh);
         if (!shape)
             return;
@@ -673,19 +994,48 @@ namespace MWPhysics
     {
         mMovementQueue.clear();
         mStandingCollisions.clear();
+
+        waitForAsyncMovement();
+        mAsyncActors.clear();
+        mAsyncNumSteps = 0;
+    }
+
+    void PhysicsSystem::discardAsyncMovement(const Actor* actor)
+    {
+        waitForAsyncMovement();
+        for (ActorFrameData& data : mAsyncActors)
+            if (data.mActor == actor)
+                data.mActor = nullptr;
     }
 
     const PtrVelocityList& PhysicsSystem::applyQueuedMovement(float dt)
     {
+        mLineOfSightCache.clear();
         mMovementResults.clear();
 
-        mTimeAccum += dt;
-
-        const int maxAllowedSteps = 20;
-        int numSteps = mTimeAccum / (mPhysicsDt);
-        numSteps = std::min(numSteps, maxAllowedSteps);
+        if (mAsyncWorkQueue)
+        {
+            // Apply the movement solved while the previous frame was rendered, the movement queued in this frame is
+            // solved by startAsyncMovement
+            waitForAsyncMovement();
+            if (mAsyncNumSteps)
+            {
+                // Collision events should be available on every frame
+                mStandingCollisions.clear();
+            }
+            for (const ActorFrameData& data : mAsyncActors)
+                if (data.mActor)
+                    applyActorMovement(data, mAsyncNumSteps);
+            mAsyncActors.clear();
+            mAsyncNumSteps = 0;
+
+            mAsyncFrameDuration += dt;
+            mAsyncMovementRequested = true;
+            return mMovementResults;
+        }
 
-        mTimeAccum -= numSteps * mPhysicsDt;
+        std::vector<ActorFrameData> actors;
+        const int numSteps = prepareQueuedMovement(dt, actors);
 
         if (numSteps)
         {
@@ -693,8 +1043,82 @@ namespace MWPhysics
             mStandingCollisions.clear();
         }
 
-        const MWWorld::Ptr player = MWMechanics::getPlayer();
+        if (mMovementWorkQueue && actors.size() > 1 && numSteps)
+        {
+            solveActorsMovement(actors, numSteps, mPhysicsDt, mCollisionWorld, mMovementWorkQueue.get(), mMovementThreads);
+            for (ActorFrameData& data : actors)
+                applyActorMovement(data, numSteps);
+        }
+        else
+        {
+            // Apply the movement of each actor before moving the next one, so actors later in the queue collide
+            // against the new positions
+            for (ActorFrameData& data : actors)
+            {
+                solveActorMovement(data, numSteps, mPhysicsDt, mCollisionWorld);
+                applyActorMovement(data, numSteps);
+            }
+        }
+
+        return mMovementResults;
+    }
+
+    void PhysicsSystem::startAsyncMovement()
+    {
+        if (!mAsyncWorkQueue || !mAsyncMovementRequested)
+            return;
+        mAsyncMovementRequested = false;
+
+        mAsyncNumSteps = prepareQueuedMovement(mAsyncFrameDuration, mAsyncActors);
+        mAsyncFrameDuration = 0;
+        if (!mAsyncNumSteps || mAsyncActors.empty())
+            return;
+
+        mAsyncJob = new AsyncMovementWorkItem(mAsyncActors, mAsyncNumSteps, mPhysicsDt, mCollisionWorld,
+                                              mMovementWorkQueue.get(), mMovementThreads);
+        mAsyncWorkQueue->addWorkItem(mAsyncJob, SceneUtil::WorkPriority_Immediate);
+    }
+
+    void PhysicsSystem::waitForAsyncMovement()
+    {
+        if (!mAsyncJob)
+            return;
+
+        const osg::Timer_t waitBegin = osg::Timer::instance()->tick();
+        mAsyncJob->waitTillDone();
+        mAsyncWaitTime = osg::Timer::instance()->delta_s(waitBegin, osg::Timer::instance()->tick());
+        mLastAsyncJob = mAsyncJob;
+        mAsyncJob = nullptr;
+    }
+
+    void PhysicsSystem::reportStats(osg::Timer_t startTick, unsigned int frameNumber, osg::Stats& stats)
+    {
+        if (!mLastAsyncJob)
+            return;
+
+        const osg::Timer* timer = osg::Timer::instance();
+        const double taken = timer->delta_s(mLastAsyncJob->getBeginTick(), mLastAsyncJob->getEndTick());
+        stats.setAttribute(frameNumber, "physics_async_time_begin", timer->delta_s(startTick, mLastAsyncJob->getBeginTick()));
+        stats.setAttribute(frameNumber, "physics_async_time_taken", taken);
+        stats.setAttribute(frameNumber, "physics_async_time_end", timer->delta_s(startTick, mLastAsyncJob->getEndTick()));
+        // The part of the movement solved while the main thread was busy rendering
+        stats.setAttribute(frameNumber, "physics_async_overlap_time_taken", std::max(0.0, taken - mAsyncWaitTime));
+        mLastAsyncJob = nullptr;
+    }
+
+    int PhysicsSystem::prepareQueuedMovement(float dt, std::vector<ActorFrameData>& actors)
+    {
+        mTimeAccum += dt;
+
+        const int maxAllowedSteps = 20;
+        int numSteps = mTimeAccum / (mPhysicsDt);
+        numSteps = std::min(numSteps, maxAllowedSteps);
+
+        mTimeAccum -= numSteps * mPhysicsDt;
+
         const MWBase::World *world = MWBase::Environment::get().getWorld();
+        actors.clear();
+        actors.reserve(mMovementQueue.size());
         PtrVelocityList::iterator iter = mMovementQueue.begin();
         for(;iter != mMovementQueue.end();++iter)
         {
@@ -724,49 +1148,65 @@ namespace MWPhysics
             }
             physicActor->setCanWaterWalk(waterCollision);
 
+            if (numSteps)
+                MovementSolver::jump(iter->first, physicActor);
+
+            ActorFrameData data;
+            data.mPtr = iter->first;
+            data.mActor = physicActor;
+            data.mMovement = iter->second;
+            data.mWaterlevel = waterlevel;
             // Slow fall reduces fall speed by a factor of (effect magnitude / 200)
-            float slowFall = 1.f - std::max(0.f, std::min(1.f, effects.get(ESM::MagicEffect::SlowFall).getMagnitude() * 0.005f));
+            data.mSlowFall = 1.f - std::max(0.f, std::min(1.f, effects.get(ESM::MagicEffect::SlowFall).getMagnitude() * 0.005f));
+            data.mFlying = world->isFlying(iter->first);
+            data.mSwimming = world->isSwimming(iter->first);
+            data.mWasOnGround = physicActor->getOnGround();
+            data.mPosition = physicActor->getPosition();
+            data.mLastStepPosition = data.mPosition;
+            data.mOldHeight = data.mPosition.z();
+            data.mPositionChanged = false;
+            actors.push_back(data);
+        }
 
-            bool flying = world->isFlying(iter->first);
-            bool swimming = world->isSwimming(iter->first);
+        mMovementQueue.clear();
 
-            bool wasOnGround = physicActor->getOnGround();
-            osg::Vec3f position = physicActor->getPosition();
-            float oldHeight = position.z();
-            bool positionChanged = false;
-            for (int i=0; i<numSteps; ++i)
-            {
-                position = MovementSolver::move(position, physicActor->getPtr(), physicActor, iter->second, mPhysicsDt,
-                                                flying, waterlevel, slowFall, mCollisionWorld, mStandingCollisions);
-                if (position != physicActor->getPosition())
-                    positionChanged = true;
-                physicActor->setPosition(position); // always set even if unchanged to make sure interpolation is correct
-            }
-            if (positionChanged)
-                mCollisionWorld->updateSingleAabb(physicActor->getCollisionObject());
+        return numSteps;
+    }
 
-            float interpolationFactor = mTimeAccum / mPhysicsDt;
-            osg::Vec3f interpolated = position * interpolationFactor + physicActor->getPreviousPosition() * (1.f - interpolationFactor);
+    void PhysicsSystem::applyActorMovement(const ActorFrameData& data, int numSteps)
+    {
+        Actor* physicActor = data.mActor;
+        if (numSteps)
+        {
+            // Keep the position of the previous step for the interpolation
+            physicActor->setPosition(data.mLastStepPosition);
+            physicActor->setPosition(data.mPosition);
+        }
+        if (data.mPositionChanged)
+            mCollisionWorld->updateSingleAabb(physicActor->getCollisionObject());
 
-            float heightDiff = position.z() - oldHeight;
+        if (!data.mStandingOn.isEmpty())
+            mStandingCollisions[data.mPtr] = data.mStandingOn;
 
-            MWMechanics::CreatureStats& stats = iter->first.getClass().getCreatureStats(iter->first);
-            bool isStillOnGround = (numSteps > 0 && wasOnGround && physicActor->getOnGround());
-            if (isStillOnGround || flying || swimming || slowFall < 1)
-                stats.land(iter->first == player && (flying || swimming));
-            else if (heightDiff < 0)
-                stats.addToFallHeight(-heightDiff);
+        float interpolationFactor = mTimeAccum / mPhysicsDt;
+        osg::Vec3f interpolated = data.mPosition * interpolationFactor + physicActor->getPreviousPosition() * (1.f - interpolationFactor);
 
-            mMovementResults.push_back(std::make_pair(iter->first, interpolated));
-        }
+        float heightDiff = data.mPosition.z() - data.mOldHeight;
 
-        mMovementQueue.clear();
+        MWMechanics::CreatureStats& stats = data.mPtr.getClass().getCreatureStats(data.mPtr);
+        bool isStillOnGround = (numSteps > 0 && data.mWasOnGround && physicActor->getOnGround());
+        if (isStillOnGround || data.mFlying || data.mSwimming || data.mSlowFall < 1)
+            stats.land(data.mPtr == MWMechanics::getPlayer() && (data.mFlying || data.mSwimming));
+        else if (heightDiff < 0)
+            stats.addToFallHeight(-heightDiff);
 
-        return mMovementResults;
+        mMovementResults.push_back(std::make_pair(data.mPtr, interpolated));
     }
 
     void PhysicsSystem::stepSimulation(float dt)
     {
+        mLineOfSightCache.clear();
+
         for (Object* animatedObject :  mAnimatedObjects)
             animatedObject->animateCollisionShapes(mCollisionWorld);
 
@@ -778,6 +1218,8 @@ namespace MWPhysics
 
     void PhysicsSystem::updateAnimatedCollisionShape(const MWWorld::Ptr& object)
     {
+        mLineOfSightCache.clear();
+
         ObjectMap::iterator found = mObjects.find(object);
         if (found != mObjects.end())
             found->second->animateCollisionShapes(mCollisionWorld);
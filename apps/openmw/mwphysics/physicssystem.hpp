@@ -5,8 +5,11 @@
 #include <map>
 #include <set>
 #include <algorithm>
+#include <vector>
 
 #include <osg/Quat>
+#include <osg/Vec3f>
+#include <osg/Timer>
 #include <osg/ref_ptr>
 
 #include "../mwworld/ptr.hpp"
@@ -17,6 +20,7 @@ namespace osg
 {
     class Group;
     class Object;
+    class Stats;
 }
 
 namespace MWRender
@@ -33,6 +37,7 @@ namespace Resource
 namespace SceneUtil
 {
     class UnrefQueue;
+    class WorkQueue;
 }
 
 class btCollisionWorld;
@@ -49,6 +54,26 @@ namespace MWPhysics
     class HeightField;
     class Object;
     class Actor;
+    class AsyncMovementWorkItem;
+
+    /// Movement of an actor in a frame, prepared and applied by the PhysicsSystem on the main thread and solved in between
+    struct ActorFrameData
+    {
+        MWWorld::Ptr mPtr;
+        Actor* mActor;
+        osg::Vec3f mMovement;
+        float mWaterlevel;
+        float mSlowFall;
+        bool mFlying;
+        bool mSwimming;
+        bool mWasOnGround;
+        float mOldHeight;
+
+        osg::Vec3f mPosition;
+        osg::Vec3f mLastStepPosition; ///< Position before the last physics step
+        bool mPositionChanged;
+        MWWorld::Ptr mStandingOn;
+    };
 
     class PhysicsSystem
     {
@@ -123,9 +148,31 @@ namespace MWPhysics
 
             RayResult castSphere(const osg::Vec3f& from, const osg::Vec3f& to, float radius);
 
+            struct RayRequest
+            {
+                osg::Vec3f mFrom;
+                osg::Vec3f mTo;
+                float mRadius; ///< Cast a sphere of this radius if > 0, otherwise a ray
+                MWWorld::ConstPtr mIgnore; ///< Optional, only used for rays
+                int mMask;
+                int mGroup;
+            };
+
+            /// Cast several rays and spheres at once, split over the actor movement threads if there are any.
+            /// @param results Receives the result of each request, in the same order.
+            /// @note All requests have to be known before any is cast. The rays of AiCombat (backing up) and AiWander
+            /// (destination checks) still use castRay, because each depends on the result of the previous one or on a
+            /// random choice made by the package update of one actor. ObstacleCheck doesn't cast rays.
+            void castRays(const std::vector<RayRequest>& requests, std::vector<RayResult>& results) const;
+
             /// Return true if actor1 can see actor2.
+            /// @note The result is cached until an actor or an obstacle moves, i.e. usually until the next frame.
             bool getLineOfSight(const MWWorld::ConstPtr& actor1, const MWWorld::ConstPtr& actor2) const;
 
+            /// Compute the line of sight of several actor pairs at once, so that the following getLineOfSight() calls
+            /// for these pairs are answered from the cache. Does nothing without actor movement threads.
+            void prefetchLinesOfSight(const std::vector<std::pair<MWWorld::ConstPtr, MWWorld::ConstPtr>>& pairs) const;
+
             bool isOnGround (const MWWorld::Ptr& actor);
 
             bool canMoveToWaterSurface (const MWWorld::ConstPtr &actor, const float waterlevel);
@@ -148,8 +195,21 @@ namespace MWPhysics
             void queueObjectMovement(const MWWorld::Ptr &ptr, const osg::Vec3f &velocity);
 
             /// Apply all queued movements, then clear the list.
+            /// @note With async actor movement, applies the movement solved while the previous frame was rendered
+            /// instead, and leaves the queued movements to startAsyncMovement().
             const PtrVelocityList& applyQueuedMovement(float dt);
 
+            /// Start solving the movements queued in this frame on the physics thread, to be applied by the next
+            /// applyQueuedMovement(). Call right before rendering the frame, and call waitForAsyncMovement() before
+            /// anything else may access the physics. Does nothing unless async actor movement is enabled.
+            void startAsyncMovement();
+
+            /// Wait until the movements started by startAsyncMovement() are solved.
+            void waitForAsyncMovement();
+
+            /// Report how long the last asynchronous movement took and how much of it overlapped with rendering.
+            void reportStats(osg::Timer_t startTick, unsigned int frameNumber, osg::Stats& stats);
+
             /// Clear the queued movements list without applying.
             void clearQueuedMovement();
 
@@ -190,6 +250,15 @@ namespace MWPhysics
 
             void updateWater();
 
+            /// Prepare the queued movements for solving, then clear the queue.
+            /// @return The number of physics steps to solve
+            int prepareQueuedMovement(float dt, std::vector<ActorFrameData>& actors);
+
+            void applyActorMovement(const ActorFrameData& data, int numSteps);
+
+            /// Drop the pending asynchronous movement of an actor
+            void discardAsyncMovement(const Actor* actor);
+
             osg::ref_ptr<SceneUtil::UnrefQueue> mUnrefQueue;
 
             btBroadphaseInterface* mBroadphase;
@@ -213,6 +282,9 @@ namespace MWPhysics
 
             bool mDebugDrawEnabled;
 
+            // Results of getLineOfSight per <actor1, actor2>, until something moves
+            mutable std::map<std::pair<const Actor*, const Actor*>, bool> mLineOfSightCache;
+
             // Tracks standing collisions happening during a single frame. <actor handle, collided handle>
             // This will detect standing on an object, but won't detect running e.g. against a wall.
             typedef std::map<MWWorld::Ptr, MWWorld::Ptr> CollisionMap;
@@ -238,6 +310,19 @@ namespace MWPhysics
 
             float mPhysicsDt;
 
+            int mMovementThreads;
+            osg::ref_ptr<SceneUtil::WorkQueue> mMovementWorkQueue;
+
+            // Asynchronous movement, solved while the frame is rendered and applied in the next frame
+            osg::ref_ptr<SceneUtil::WorkQueue> mAsyncWorkQueue;
+            osg::ref_ptr<AsyncMovementWorkItem> mAsyncJob;
+            osg::ref_ptr<AsyncMovementWorkItem> mLastAsyncJob;
+            std::vector<ActorFrameData> mAsyncActors;
+            int mAsyncNumSteps;
+            float mAsyncFrameDuration;
+            bool mAsyncMovementRequested;
+            double mAsyncWaitTime;
+
             PhysicsSystem (const PhysicsSystem&);
             PhysicsSystem& operator= (const PhysicsSystem&);
     };
@@ -266,7 +266,7 @@ namespace MWRender
         mHeight = mCellSize*(mMaxY-mMinY+1);
 
         mWorkItem = new CreateMapWorkItem(mWidth, mHeight, mMinX, mMinY, mMaxX, mMaxY, mCellSize, esmStore.get<ESM::Land>());
-        mWorkQueue->addWorkItem(mWorkItem);
+        mWorkQueue->addWorkItem(mWorkItem, SceneUtil::WorkPriority_Background);
     }
 
     void GlobalMap::worldPosToImageSpace(float x, float z, float& imageX, float& imageY)
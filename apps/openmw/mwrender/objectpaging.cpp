@@ -0,0 +1,427 @@
+#include "objectpaging.hpp"
+
+#include <osg/MatrixTransform>
+#include <osg/Stats>
+
+#include <osgUtil/IncrementalCompileOperation>
+
+#include <components/debug/debuglog.hpp>
+#include <components/esm/loadcell.hpp>
+#include <components/esm/loadstat.hpp>
+#include <components/misc/constants.hpp>
+#include <components/misc/convert.hpp>
+#include <components/misc/resourcehelpers.hpp>
+#include <components/misc/stringops.hpp>
+#include <components/nifosg/nifloader.hpp>
+#include <components/resource/objectcache.hpp>
+#include <components/resource/scenemanager.hpp>
+#include <components/sceneutil/instancing.hpp>
+#include <components/sceneutil/lightmanager.hpp>
+#include <components/sceneutil/optimizer.hpp>
+#include <components/sceneutil/positionattitudetransform.hpp>
+
+#include "../mwworld/cellstore.hpp"
+#include "../mwworld/esmstore.hpp"
+#include "../mwworld/ptr.hpp"
+
+#include "vismask.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace MWRender
+{
+
+namespace
+{
+    /// Blocks of an active cell per side, each block of the cell gets its own light list
+    const int sBlocksPerCell = 4;
+
+    /// Fewer copies of a model in a block are cheaper to merge with the other objects than to draw instanced
+    const std::size_t sMinInstances = 8;
+
+    bool hasCallbacks(const osg::StateSet* stateSet)
+    {
+        return stateSet && (stateSet->getUpdateCallback() || stateSet->getEventCallback());
+    }
+
+    /// Checks that a copy of a model can be merged with other ones: nothing animated or replaced at runtime, only
+    /// geometry and static transforms. Removes the hidden nodes, which the optimizer would merge with visible ones.
+    class PagingTemplateVisitor : public osg::NodeVisitor
+    {
+    public:
+        PagingTemplateVisitor(unsigned int hiddenNodeMask)
+            : osg::NodeVisitor(TRAVERSE_ALL_CHILDREN)
+            , mHiddenNodeMask(hiddenNodeMask)
+            , mPageable(true)
+        {
+        }
+
+        bool isPageable() const { return mPageable; }
+
+        void apply(osg::Node& node) override
+        {
+            // Switches, LODs, light sources, particle systems...
+            mPageable = false;
+        }
+
+        void apply(osg::Group& group) override
+        {
+            const std::string className = group.className();
+            if (className != "Group" && className != "Geode")
+            {
+                mPageable = false;
+                return;
+            }
+            applyGroup(group);
+        }
+
+        void apply(osg::Transform& transform) override
+        {
+            if (std::string(transform.className()) != "MatrixTransform"
+                    || transform.getReferenceFrame() != osg::Transform::RELATIVE_RF)
+            {
+                mPageable = false;
+                return;
+            }
+            applyGroup(transform);
+        }
+
+        void apply(osg::Drawable& drawable) override
+        {
+            if (std::string(drawable.className()) != "Geometry" || hasNodeCallbacks(drawable)
+                    || drawable.getDrawCallback() || drawable.getComputeBoundingBoxCallback())
+                mPageable = false;
+        }
+
+    private:
+        unsigned int mHiddenNodeMask;
+        bool mPageable;
+
+        static bool hasNodeCallbacks(const osg::Node& node)
+        {
+            return node.getUpdateCallback() || node.getEventCallback() || node.getCullCallback()
+                || hasCallbacks(node.getStateSet());
+        }
+
+        void applyGroup(osg::Group& group)
+        {
+            if (hasNodeCallbacks(group))
+            {
+                mPageable = false;
+                return;
+            }
+
+            for (unsigned int i = group.getNumChildren(); i-- > 0;)
+            {
+                const unsigned int nodeMask = group.getChild(i)->getNodeMask();
+                if (nodeMask == 0 || nodeMask == mHiddenNodeMask)
+                    group.removeChild(i);
+            }
+
+            traverse(group);
+        }
+    };
+}
+
+ObjectPaging::ObjectPaging(Resource::SceneManager* sceneManager, const MWWorld::ESMStore& store,
+                           ToUTF8::Utf8Encoder* encoder, float minSize, bool instancing)
+    : GenericResourceManager<ChunkId>(nullptr)
+    , mSceneManager(sceneManager)
+    , mEncoder(encoder)
+    , mMinSize(minSize)
+    , mInstancing(instancing)
+    , mNumContentFiles(0)
+    , mRevision(0)
+    , mClearedRevision(0)
+{
+    // The cell store gets new exterior cells while the game runs, chunks are built in other threads from this copy
+    const MWWorld::Store<ESM::Cell>& cells = store.get<ESM::Cell>();
+    for (MWWorld::Store<ESM::Cell>::iterator it = cells.extBegin(); it != cells.extEnd(); ++it)
+    {
+        mCells[std::make_pair(it->getGridX(), it->getGridY())] = &*it;
+        for (const ESM::ESM_Context& context : it->mContextList)
+            mNumContentFiles = std::max(mNumContentFiles, static_cast<std::size_t>(context.index) + 1);
+    }
+
+    for (const ESM::Static& record : store.get<ESM::Static>())
+        if (!record.mModel.empty())
+            mModels[Misc::StringUtils::lowerCase(record.mId)] = "meshes\\" + record.mModel;
+}
+
+ObjectPaging::~ObjectPaging()
+{
+}
+
+osg::ref_ptr<osg::Node> ObjectPaging::getChunk(float size, const osg::Vec2f& center, bool activeGrid)
+{
+    // Smaller chunks are parts of an active cell, the one at the cell origin renders the whole cell
+    osg::Vec2f chunkCenter = center;
+    float chunkSize = size;
+    if (size < 1)
+    {
+        const osg::Vec2f origin = center - osg::Vec2f(size, size) / 2.f;
+        if (origin.x() != std::floor(origin.x()) || origin.y() != std::floor(origin.y()))
+            return nullptr;
+        chunkCenter = origin + osg::Vec2f(0.5f, 0.5f);
+        chunkSize = 1;
+    }
+
+    const osg::Vec2f minBound = chunkCenter - osg::Vec2f(chunkSize, chunkSize) / 2.f;
+    const osg::Vec2f maxBound = chunkCenter + osg::Vec2f(chunkSize, chunkSize) / 2.f;
+
+    ChunkId id;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        unsigned int revision = mClearedRevision;
+        for (const auto& cellRevision : mCellRevisions)
+        {
+            const int x = cellRevision.first.first;
+            const int y = cellRevision.first.second;
+            if (x >= minBound.x() && x < maxBound.x() && y >= minBound.y() && y < maxBound.y())
+                revision = std::max(revision, cellRevision.second);
+        }
+        id = std::make_tuple(osg::Vec3f(chunkCenter, chunkSize), activeGrid, revision);
+    }
+
+    const osg::ref_ptr<osg::Object> obj = mBuildOnce.get(*mCache, id,
+        [&] { return osg::ref_ptr<osg::Object>(createChunk(chunkSize, chunkCenter, activeGrid)); });
+    return obj ? obj->asNode() : nullptr;
+}
+
+osg::ref_ptr<osg::Node> ObjectPaging::createChunk(float size, const osg::Vec2f& center, bool activeGrid)
+{
+    const float cellSize = static_cast<float>(Constants::CellSizeInUnits);
+    const int startX = static_cast<int>(std::floor(center.x() - size / 2.f));
+    const int startY = static_cast<int>(std::floor(center.y() - size / 2.f));
+    const int numCells = static_cast<int>(size);
+    const osg::Vec3f worldCenter(center.x() * cellSize, center.y() * cellSize, 0.f);
+    // Distant objects smaller than this are at most a few pixels
+    const float minRadius = activeGrid ? 0.f : mMinSize * size * cellSize;
+
+    const osg::CopyOp copyOp(osg::CopyOp::DEEP_COPY_NODES | osg::CopyOp::DEEP_COPY_DRAWABLES
+        | osg::CopyOp::DEEP_COPY_ARRAYS | osg::CopyOp::DEEP_COPY_PRIMITIVES);
+
+    // Copies of each model per block
+    std::map<int, std::map<const Template*, std::vector<SceneUtil::Instance>>> blocks;
+    std::unique_ptr<Readers> readers = takeReaders();
+
+    for (int cellX = startX; cellX < startX + numCells; ++cellX)
+    {
+        for (int cellY = startY; cellY < startY + numCells; ++cellY)
+        {
+            const auto cell = mCells.find(std::make_pair(cellX, cellY));
+            if (cell == mCells.end())
+                continue;
+
+            std::vector<ESM::CellRef> refs = ESM::loadCellRefs(*cell->second, readers->mReaders);
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                refs.erase(std::remove_if(refs.begin(), refs.end(), [&] (const ESM::CellRef& ref)
+                    { return mBlacklist.count(ref.mRefNum) != 0; }), refs.end());
+            }
+
+            for (const ESM::CellRef& ref : refs)
+            {
+                if (Misc::ResourceHelpers::isHiddenMarker(ref.mRefID))
+                    continue;
+
+                const auto model = mModels.find(ref.mRefID);
+                if (model == mModels.end())
+                    continue;
+
+                const Template* pagingTemplate = getTemplate(model->second);
+                if (!pagingTemplate || pagingTemplate->mRadius * ref.mScale < minRadius)
+                    continue;
+
+                const osg::Vec3f position = ref.mPos.asVec3();
+                int block = 0;
+                if (activeGrid)
+                {
+                    const int blockX = static_cast<int>(std::floor((position.x() / cellSize - cellX) * sBlocksPerCell));
+                    const int blockY = static_cast<int>(std::floor((position.y() / cellSize - cellY) * sBlocksPerCell));
+                    block = std::min(std::max(blockY, 0), sBlocksPerCell - 1) * sBlocksPerCell
+                        + std::min(std::max(blockX, 0), sBlocksPerCell - 1);
+                }
+
+                blocks[block][pagingTemplate].push_back(
+                    SceneUtil::Instance {position - worldCenter, Misc::Convert::makeOsgQuat(ref.mPos), ref.mScale});
+            }
+        }
+    }
+
+    giveBackReaders(std::move(readers));
+
+    osg::ref_ptr<SceneUtil::PositionAttitudeTransform> root (new SceneUtil::PositionAttitudeTransform);
+    root->setPosition(worldCenter);
+    root->setNodeMask(Mask_Static);
+
+    // Objects of a block share one merged geometry per state set, except the models placed often enough to be
+    // drawn instanced
+    SceneUtil::Optimizer optimizer;
+    for (const auto& block : blocks)
+    {
+        osg::ref_ptr<osg::Group> group (new osg::Group);
+        std::vector<osg::ref_ptr<osg::Group>> instanced;
+
+        for (const auto& model : block.second)
+        {
+            const std::vector<SceneUtil::Instance>& instances = model.second;
+            if (mInstancing && instances.size() >= sMinInstances)
+            {
+                osg::ref_ptr<osg::Group> node = SceneUtil::createInstances(*model.first->mNode, instances);
+                mSceneManager->recreateShaders(node);
+                instanced.push_back(node);
+                continue;
+            }
+
+            for (const SceneUtil::Instance& instance : instances)
+            {
+                osg::ref_ptr<osg::MatrixTransform> transform (new osg::MatrixTransform(
+                    osg::Matrix::scale(instance.mScale, instance.mScale, instance.mScale)
+                    * osg::Matrix::rotate(instance.mRotation)
+                    * osg::Matrix::translate(instance.mPosition)));
+                transform->addChild(static_cast<osg::Node*>(model.first->mNode->clone(copyOp)));
+                group->addChild(transform);
+            }
+        }
+
+        // The optimizer would merge the instanced geometries as if they were single copies
+        optimizer.optimize(group, SceneUtil::Optimizer::FLATTEN_STATIC_TRANSFORMS
+            | SceneUtil::Optimizer::REMOVE_REDUNDANT_NODES | SceneUtil::Optimizer::MERGE_GEOMETRY);
+        for (const osg::ref_ptr<osg::Group>& node : instanced)
+            group->addChild(node);
+
+        group->addCullCallback(new SceneUtil::LightListCallback);
+        root->addChild(group);
+    }
+
+    if (mSceneManager->getIncrementalCompileOperation())
+        mSceneManager->getIncrementalCompileOperation()->add(root);
+    else
+        root->getBound();
+
+    return root;
+}
+
+const ObjectPaging::Template* ObjectPaging::getTemplate(const std::string& model)
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        const auto found = mTemplates.find(model);
+        if (found != mTemplates.end())
+            return found->second.mNode ? &found->second : nullptr;
+    }
+
+    Template pagingTemplate {nullptr, 0.f};
+    try
+    {
+        osg::ref_ptr<osg::Node> node = static_cast<osg::Node*>(
+            mSceneManager->getTemplate(model)->clone(osg::CopyOp::DEEP_COPY_NODES));
+        PagingTemplateVisitor visitor(NifOsg::Loader::getHiddenNodeMask());
+        node->accept(visitor);
+        if (visitor.isPageable())
+        {
+            pagingTemplate.mRadius = node->getBound().radius();
+            pagingTemplate.mNode = node;
+        }
+    }
+    catch (const std::exception& e)
+    {
+        Log(Debug::Warning) << "Warning: Failed to prepare " << model << " for object paging: " << e.what();
+    }
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    const auto inserted = mTemplates.emplace(model, pagingTemplate).first;
+    return inserted->second.mNode ? &inserted->second : nullptr;
+}
+
+unsigned int ObjectPaging::getNodeMask()
+{
+    return Mask_Static;
+}
+
+bool ObjectPaging::isPageable(const MWWorld::ConstPtr& ptr) const
+{
+    return ptr.isInCell() && ptr.getCell()->isExterior() && ptr.getCellRef().hasContentFile()
+        && ptr.getTypeName() == typeid(ESM::Static).name();
+}
+
+bool ObjectPaging::isPagedObject(const MWWorld::ConstPtr& ptr)
+{
+    if (!isPageable(ptr) || Misc::ResourceHelpers::isHiddenMarker(ptr.getCellRef().getRefId()))
+        return false;
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (mBlacklist.count(ptr.getCellRef().getRefNum()))
+            return false;
+    }
+
+    const auto model = mModels.find(ptr.getCellRef().getRefId());
+    return model != mModels.end() && getTemplate(model->second) != nullptr;
+}
+
+bool ObjectPaging::blacklistObject(const MWWorld::ConstPtr& ptr)
+{
+    if (!isPageable(ptr))
+        return false;
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (!mBlacklist.insert(ptr.getCellRef().getRefNum()).second)
+        return false;
+
+    // The chunk reading the reference has the cell the reference is listed in, which is the cell it was placed in
+    ++mRevision;
+    const ESM::Cell* cell = ptr.getCell()->getCell();
+    mCellRevisions[std::make_pair(cell->getGridX(), cell->getGridY())] = mRevision;
+    const ESM::Position position = ptr.getCellRef().getPosition();
+    const int cellX = static_cast<int>(std::floor(position.pos[0] / Constants::CellSizeInUnits));
+    const int cellY = static_cast<int>(std::floor(position.pos[1] / Constants::CellSizeInUnits));
+    mCellRevisions[std::make_pair(cellX, cellY)] = mRevision;
+    return true;
+}
+
+void ObjectPaging::clear()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mBlacklist.clear();
+    mCellRevisions.clear();
+    // Chunks still in flight are built with the old blacklist, the new revision keeps them apart
+    mClearedRevision = ++mRevision;
+}
+
+std::unique_ptr<ObjectPaging::Readers> ObjectPaging::takeReaders()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (!mFreeReaders.empty())
+        {
+            std::unique_ptr<Readers> readers = std::move(mFreeReaders.back());
+            mFreeReaders.pop_back();
+            return readers;
+        }
+    }
+
+    // Each thread reads with its own encoder, as the content loader does
+    std::unique_ptr<Readers> readers (new Readers);
+    readers->mEncoder.reset(new ToUTF8::Utf8Encoder(*mEncoder));
+    readers->mReaders.resize(mNumContentFiles);
+    for (ESM::ESMReader& reader : readers->mReaders)
+        reader.setEncoder(readers->mEncoder.get());
+    return readers;
+}
+
+void ObjectPaging::giveBackReaders(std::unique_ptr<Readers> readers)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mFreeReaders.push_back(std::move(readers));
+}
+
+void ObjectPaging::reportStats(unsigned int frameNumber, osg::Stats* stats) const
+{
+    stats->setAttribute(frameNumber, "Object Chunk", mCache->getCacheSize());
+}
+
+}
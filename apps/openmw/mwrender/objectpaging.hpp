@@ -0,0 +1,118 @@
+#ifndef OPENMW_MWRENDER_OBJECTPAGING_H
+#define OPENMW_MWRENDER_OBJECTPAGING_H
+
+#include <components/esm/cellref.hpp>
+#include <components/esm/esmreader.hpp>
+#include <components/resource/buildonce.hpp>
+#include <components/resource/resourcemanager.hpp>
+#include <components/terrain/quadtreeworld.hpp>
+
+#include <osg/Vec3f>
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace ESM
+{
+    struct Cell;
+}
+
+namespace MWWorld
+{
+    class ConstPtr;
+    class ESMStore;
+}
+
+namespace Resource
+{
+    class SceneManager;
+}
+
+namespace MWRender
+{
+
+    typedef std::tuple<osg::Vec3f, bool, unsigned int> ChunkId; // Center and size, active grid, revision
+
+    /// @brief Batches the static references of exterior chunks into merged geometry rendered along with the terrain.
+    /// @par References are read from the content files, not from the cell stores, so that chunks beyond the active
+    /// grid can be built without loading their cells. Objects changed by the game are blacklisted and rendered
+    /// individually again. Outside of the active grid objects too small to be seen from the chunk distance are dropped.
+    class ObjectPaging : public Resource::GenericResourceManager<ChunkId>, public Terrain::QuadTreeWorld::ChunkProvider
+    {
+    public:
+        /// @param minSize fraction of the chunk size under which the radius of an object outside of the active grid
+        /// makes it too small to be rendered
+        /// @param instancing draw the copies of a model placed many times in a block with a single instanced draw per
+        /// geometry instead of merging them, requires SceneUtil::isInstancingSupported
+        ObjectPaging(Resource::SceneManager* sceneManager, const MWWorld::ESMStore& store, ToUTF8::Utf8Encoder* encoder,
+                     float minSize, bool instancing);
+        ~ObjectPaging();
+
+        osg::ref_ptr<osg::Node> getChunk(float size, const osg::Vec2f& center, bool activeGrid) override;
+
+        unsigned int getNodeMask() override;
+
+        /// @return true if the object is rendered by a chunk and needs no node of its own
+        bool isPagedObject(const MWWorld::ConstPtr& ptr);
+
+        /// Render the object individually from now on, call before the object is changed.
+        /// @return true if the object was not blacklisted yet, the views need to be rebuilt then
+        bool blacklistObject(const MWWorld::ConstPtr& ptr);
+
+        /// Forget the blacklist of the previous game.
+        void clear();
+
+        void reportStats(unsigned int frameNumber, osg::Stats* stats) const override;
+
+    private:
+        struct Template
+        {
+            osg::ref_ptr<const osg::Node> mNode;
+            float mRadius;
+        };
+
+        struct Readers
+        {
+            std::unique_ptr<ToUTF8::Utf8Encoder> mEncoder;
+            std::vector<ESM::ESMReader> mReaders;
+        };
+
+        Resource::SceneManager* mSceneManager;
+        ToUTF8::Utf8Encoder* mEncoder;
+        float mMinSize;
+        bool mInstancing;
+        std::size_t mNumContentFiles;
+        std::map<std::pair<int, int>, const ESM::Cell*> mCells;
+        std::map<std::string, std::string> mModels;
+
+        std::mutex mMutex;
+        std::set<ESM::RefNum> mBlacklist;
+        std::map<std::pair<int, int>, unsigned int> mCellRevisions;
+        unsigned int mRevision;
+        unsigned int mClearedRevision;
+        std::map<std::string, Template> mTemplates;
+        std::vector<std::unique_ptr<Readers>> mFreeReaders;
+
+        Resource::BuildOnce<ChunkId> mBuildOnce;
+
+        osg::ref_ptr<osg::Node> createChunk(float size, const osg::Vec2f& center, bool activeGrid);
+
+        /// @return the model prepared for batching, nullptr if it can not be batched
+        const Template* getTemplate(const std::string& model);
+
+        bool isPageable(const MWWorld::ConstPtr& ptr) const;
+
+        std::unique_ptr<Readers> takeReaders();
+
+        void giveBackReaders(std::unique_ptr<Readers> readers);
+    };
+
+}
+
+#endif
@@ -78,6 +78,12 @@ void Objects::insertModel(const MWWorld::Ptr &ptr, const std::string &mesh, bool
     mObjects.insert(std::make_pair(ptr, anim));
 }
 
+void Objects::insertPlaceholder(const MWWorld::Ptr& ptr)
+{
+    insertBegin(ptr);
+    ptr.getRefData().getBaseNode()->setNodeMask(Mask_Static);
+}
+
 void Objects::insertCreature(const MWWorld::Ptr &ptr, const std::string &mesh, bool weaponsShields)
 {
     insertBegin(ptr);
@@ -135,6 +141,14 @@ bool Objects::removeObject (const MWWorld::Ptr& ptr)
         ptr.getRefData().setBaseNode(nullptr);
         return true;
     }
+
+    // Placeholders have no animation
+    if (ptr.getRefData().getBaseNode()->getNumParents() && !ptr.getRefData().getBaseNode()->getNumChildren())
+    {
+        ptr.getRefData().getBaseNode()->getParent(0)->removeChild(ptr.getRefData().getBaseNode());
+        ptr.getRefData().setBaseNode(nullptr);
+        return true;
+    }
     return false;
 }
 
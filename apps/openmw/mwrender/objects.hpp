@@ -81,6 +81,9 @@ public:
     void insertNPC(const MWWorld::Ptr& ptr);
     void insertCreature (const MWWorld::Ptr& ptr, const std::string& model, bool weaponsShields);
 
+    /// Insert only the node keeping the transformation of an object rendered by something else, e.g. terrain chunks.
+    void insertPlaceholder(const MWWorld::Ptr& ptr);
+
     Animation* getAnimation(const MWWorld::Ptr &ptr);
     const Animation* getAnimation(const MWWorld::ConstPtr &ptr) const;
 
@@ -2,6 +2,7 @@
 
 #include <limits>
 #include <cstdlib>
+#include <thread>
 
 #include <osg/Light>
 #include <osg/LightModel>
@@ -42,6 +43,8 @@
 #include <components/sceneutil/unrefqueue.hpp>
 #include <components/sceneutil/writescene.hpp>
 #include <components/sceneutil/shadow.hpp>
+#include <components/sceneutil/instancing.hpp>
+#include <components/sceneutil/glextensions.hpp>
 
 #include <components/terrain/terraingrid.hpp>
 #include <components/terrain/quadtreeworld.hpp>
@@ -69,6 +72,7 @@
 #include "navmesh.hpp"
 #include "actorspaths.hpp"
 #include "recastmesh.hpp"
+#include "objectpaging.hpp"
 
 namespace
 {
@@ -197,7 +201,9 @@ namespace MWRender
 
     RenderingManager::RenderingManager(osgViewer::Viewer* viewer, osg::ref_ptr<osg::Group> rootNode,
                                        Resource::ResourceSystem* resourceSystem, SceneUtil::WorkQueue* workQueue,
-                                       const std::string& resourcePath, DetourNavigator::Navigator& navigator)
+                                       const std::string& resourcePath, DetourNavigator::Navigator& navigator,
+                                       std::shared_ptr<Terrain::ChunkDiskCache> terrainDiskCache,
+                                       const MWWorld::ESMStore& store, ToUTF8::Utf8Encoder* encoder)
         : mViewer(viewer)
         , mRootNode(rootNode)
         , mResourceSystem(resourceSystem)
@@ -236,6 +242,24 @@ namespace MWRender
         mSceneRoot = sceneRoot;
         sceneRoot->setStartLight(1);
 
+        // Stored by the realize operation of the viewer, which is realized before the rendering is set up
+        const osg::GLExtensions* exts = SceneUtil::getGLExtensions();
+
+        bool clusteredLighting = Settings::Manager::getBool("clustered lighting", "Shaders");
+        if (clusteredLighting && !forceShaders)
+        {
+            Log(Debug::Warning) << "Warning: Clustered lighting requires 'force shaders', using per object lights instead";
+            clusteredLighting = false;
+        }
+        else if (clusteredLighting && (!exts || !SceneUtil::isClusteredLightingSupported(*exts)))
+        {
+            Log(Debug::Warning) << "Warning: Clustered lighting is not supported, using per object lights instead";
+            clusteredLighting = false;
+        }
+        // The texture units below 8 are used by the objects and the shadow maps
+        if (clusteredLighting)
+            sceneRoot->setClusteredLighting(8);
+
         int shadowCastingTraversalMask = Mask_Scene;
         if (Settings::Manager::getBool("actor shadows", "Shadows"))
             shadowCastingTraversalMask |= Mask_Actor;
@@ -260,6 +284,7 @@ namespace MWRender
         globalDefines["clamp"] = Settings::Manager::getBool("clamp lighting", "Shaders") ? "1" : "0";
         globalDefines["preLightEnv"] = Settings::Manager::getBool("apply lighting to environment maps", "Shaders") ? "1" : "0";
         globalDefines["radialFog"] = Settings::Manager::getBool("radial fog", "Shaders") ? "1" : "0";
+        globalDefines["clusteredLighting"] = clusteredLighting ? "1" : "0";
 
         // It is unnecessary to stop/start the viewer as no frames are being rendered yet.
         mResourceSystem->getSceneManager()->getShaderManager().setGlobalDefines(globalDefines);
@@ -310,15 +335,34 @@ namespace MWRender
             const int vertexLodMod = Settings::Manager::getInt("vertex lod mod", "Terrain");
             float maxCompGeometrySize = Settings::Manager::getFloat("max composite geometry size", "Terrain");
             maxCompGeometrySize = std::max(maxCompGeometrySize, 1.f);
+            int chunkBuildThreads = Settings::Manager::getInt("chunk build threads", "Terrain");
+            if (chunkBuildThreads <= 0)
+                chunkBuildThreads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
             mTerrain.reset(new Terrain::QuadTreeWorld(
                 sceneRoot, mRootNode, mResourceSystem, mTerrainStorage, Mask_Terrain, Mask_PreCompile, Mask_Debug,
-                compMapResolution, compMapLevel, lodFactor, vertexLodMod, maxCompGeometrySize));
+                compMapResolution, compMapLevel, lodFactor, vertexLodMod, maxCompGeometrySize,
+                static_cast<unsigned int>(chunkBuildThreads)));
+            if (Settings::Manager::getBool("object paging", "Terrain"))
+            {
+                bool instancing = Settings::Manager::getBool("object paging instancing", "Terrain");
+                if (instancing && (!exts || !SceneUtil::isInstancingSupported(*exts)))
+                {
+                    Log(Debug::Warning) << "Warning: Instanced rendering is not supported, merging all paged objects instead";
+                    instancing = false;
+                }
+                mObjectPaging.reset(new ObjectPaging(mResourceSystem->getSceneManager(), store, encoder,
+                    Settings::Manager::getFloat("object paging min size", "Terrain"), instancing));
+                static_cast<Terrain::QuadTreeWorld*>(mTerrain.get())->addChunkProvider(mObjectPaging.get());
+                mResourceSystem->addResourceManager(mObjectPaging.get());
+            }
         }
         else
             mTerrain.reset(new Terrain::TerrainGrid(sceneRoot, mRootNode, mResourceSystem, mTerrainStorage, Mask_Terrain, Mask_PreCompile, Mask_Debug));
 
         mTerrain->setTargetFrameRate(Settings::Manager::getFloat("target framerate", "Cells"));
         mTerrain->setWorkQueue(mWorkQueue.get());
+        if (terrainDiskCache)
+            mTerrain->setDiskCache(terrainDiskCache);
 
         // water goes after terrain for correct waterculling order
         mWater.reset(new Water(mRootNode, sceneRoot, mResourceSystem, mViewer->getIncrementalCompileOperation(), resourcePath));
@@ -398,6 +442,9 @@ namespace MWRender
     {
         // let background loading thread finish before we delete anything else
         mWorkQueue = nullptr;
+
+        if (mObjectPaging)
+            mResourceSystem->removeResourceManager(mObjectPaging.get());
     }
 
     osgUtil::IncrementalCompileOperation* RenderingManager::getIncrementalCompileOperation()
@@ -445,7 +492,7 @@ namespace MWRender
 
         workItem->mTextures.push_back("textures/_land_default.dds");
 
-        mWorkQueue->addWorkItem(workItem);
+        mWorkQueue->addWorkItem(workItem, SceneUtil::WorkPriority_Immediate);
     }
 
     double RenderingManager::getReferenceTime() const
@@ -735,6 +782,24 @@ namespace MWRender
         mWater->removeEmitter(ptr);
     }
 
+    bool RenderingManager::isPagedObject(const MWWorld::ConstPtr& ptr)
+    {
+        return mObjectPaging && mObjectPaging->isPagedObject(ptr);
+    }
+
+    bool RenderingManager::pagingBlacklistObject(const MWWorld::ConstPtr& ptr)
+    {
+        if (!mObjectPaging || !mObjectPaging->blacklistObject(ptr))
+            return false;
+        mTerrain->rebuildViews();
+        return true;
+    }
+
+    void RenderingManager::setActiveGrid(const osg::Vec4i& grid)
+    {
+        mTerrain->setActiveGrid(grid);
+    }
+
     void RenderingManager::setWaterEnabled(bool enabled)
     {
         mWater->setEnabled(enabled);
@@ -1181,6 +1246,12 @@ namespace MWRender
     {
         mSky->setMoonColour(false);
 
+        if (mObjectPaging)
+        {
+            mObjectPaging->clear();
+            mTerrain->rebuildViews();
+        }
+
         notifyWorldSpaceChanged();
     }
 
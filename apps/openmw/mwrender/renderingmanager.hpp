@@ -4,6 +4,7 @@
 #include <osg/ref_ptr>
 #include <osg/Light>
 #include <osg/Camera>
+#include <osg/Vec4i>
 
 #include <components/settings/settings.hpp>
 
@@ -44,9 +45,20 @@ namespace ESM
     struct Cell;
 }
 
+namespace MWWorld
+{
+    class ESMStore;
+}
+
+namespace ToUTF8
+{
+    class Utf8Encoder;
+}
+
 namespace Terrain
 {
     class World;
+    class ChunkDiskCache;
 }
 
 namespace Fallback
@@ -83,13 +95,16 @@ namespace MWRender
     class NavMesh;
     class ActorsPaths;
     class RecastMesh;
+    class ObjectPaging;
 
     class RenderingManager : public MWRender::RenderingInterface
     {
     public:
         RenderingManager(osgViewer::Viewer* viewer, osg::ref_ptr<osg::Group> rootNode,
                          Resource::ResourceSystem* resourceSystem, SceneUtil::WorkQueue* workQueue,
-                         const std::string& resourcePath, DetourNavigator::Navigator& navigator);
+                         const std::string& resourcePath, DetourNavigator::Navigator& navigator,
+                         std::shared_ptr<Terrain::ChunkDiskCache> terrainDiskCache,
+                         const MWWorld::ESMStore& store, ToUTF8::Utf8Encoder* encoder);
         ~RenderingManager();
 
         osgUtil::IncrementalCompileOperation* getIncrementalCompileOperation();
@@ -140,6 +155,17 @@ namespace MWRender
 
         void removeObject(const MWWorld::Ptr& ptr);
 
+        /// @return true if the object is rendered by a terrain chunk, it only needs a node to keep its transformation
+        bool isPagedObject(const MWWorld::ConstPtr& ptr);
+
+        /// Stop rendering the object by terrain chunks, call before the object is moved, rotated, scaled or removed.
+        /// A paged object has to be inserted again to be rendered on its own.
+        /// @return true if the object was not blacklisted yet
+        bool pagingBlacklistObject(const MWWorld::ConstPtr& ptr);
+
+        /// Set the cells loaded by the scene as (minX, minY, maxX, maxY), the maximums are exclusive
+        void setActiveGrid(const osg::Vec4i& grid);
+
         void setWaterEnabled(bool enabled);
         void setWaterHeight(float level);
 
@@ -272,6 +298,7 @@ namespace MWRender
         std::unique_ptr<Pathgrid> mPathgrid;
         std::unique_ptr<Objects> mObjects;
         std::unique_ptr<Water> mWater;
+        std::unique_ptr<ObjectPaging> mObjectPaging;
         std::unique_ptr<Terrain::World> mTerrain;
         TerrainStorage* mTerrainStorage;
         std::unique_ptr<SkyManager> mSky;
@@ -0,0 +1,216 @@
+#include "scriptcache.hpp"
+
+#include <algorithm>
+#include <ctime>
+#include <stdexcept>
+
+#include <boost/filesystem/fstream.hpp>
+#include <boost/filesystem/operations.hpp>
+
+#include <components/debug/debuglog.hpp>
+#include <components/misc/stablehash.hpp>
+
+namespace
+{
+    const char sMagic[] = {'O', 'M', 'W', 'S', 'C', 'R', 'P', 'T'};
+
+    // Increment when the layout of the file changes
+    const std::uint32_t sFormatVersion = 1;
+
+    std::uint64_t hashText (const std::string& text)
+    {
+        Misc::StableHash hash;
+        hash.add (text.data(), text.size());
+        return hash.getValue();
+    }
+
+    template <class T>
+    void write (std::ostream& stream, const T& value)
+    {
+        stream.write (reinterpret_cast<const char*> (&value), sizeof (T));
+    }
+
+    void write (std::ostream& stream, const std::string& value)
+    {
+        write (stream, static_cast<std::uint32_t> (value.size()));
+        stream.write (value.data(), value.size());
+    }
+
+    template <class T>
+    T read (std::istream& stream)
+    {
+        T value;
+        if (!stream.read (reinterpret_cast<char*> (&value), sizeof (T)))
+            throw std::runtime_error ("unexpected end of file");
+        return value;
+    }
+
+    std::string readString (std::istream& stream)
+    {
+        std::string value (read<std::uint32_t> (stream), '\0');
+        if (!stream.read (&value[0], value.size()))
+            throw std::runtime_error ("unexpected end of file");
+        return value;
+    }
+}
+
+namespace MWScript
+{
+    ScriptCache::ScriptCache (const boost::filesystem::path& path, const std::string& key)
+    : mPath (path), mKey (key), mModified (false)
+    {
+        if (!boost::filesystem::exists (mPath))
+            return;
+
+        try
+        {
+            load();
+        }
+        catch (const std::exception& e)
+        {
+            Log(Debug::Warning) << "Warning: failed to load script cache " << mPath << ": " << e.what();
+            mEntries.clear();
+        }
+    }
+
+    void ScriptCache::load()
+    {
+        boost::filesystem::ifstream stream (mPath, std::ios::binary);
+        if (!stream)
+            throw std::runtime_error ("failed to open file");
+
+        char magic[sizeof (sMagic)];
+        if (!stream.read (magic, sizeof (magic)) || !std::equal (magic, magic + sizeof (magic), sMagic))
+            throw std::runtime_error ("not a script cache");
+
+        if (read<std::uint32_t> (stream) != sFormatVersion || readString (stream) != mKey)
+        {
+            Log(Debug::Info) << "Script cache " << mPath << " is outdated, scripts will be recompiled";
+            mModified = true;
+            return;
+        }
+
+        const std::uint32_t count = read<std::uint32_t> (stream);
+        for (std::uint32_t i = 0; i < count; ++i)
+        {
+            const std::string name = readString (stream);
+
+            Entry entry;
+            entry.mTextHash = read<std::uint64_t> (stream);
+
+            entry.mCode.resize (read<std::uint32_t> (stream));
+            if (!stream.read (reinterpret_cast<char*> (entry.mCode.data()),
+                    entry.mCode.size() * sizeof (Interpreter::Type_Code)))
+                throw std::runtime_error ("unexpected end of file");
+
+            for (const char type : {'s', 'l', 'f'})
+            {
+                const std::uint32_t locals = read<std::uint32_t> (stream);
+                for (std::uint32_t j = 0; j < locals; ++j)
+                    entry.mLocals.declare (type, readString (stream));
+            }
+
+            mEntries.insert (std::make_pair (name, std::move (entry)));
+        }
+
+        Log(Debug::Verbose) << "Loaded " << mEntries.size() << " compiled scripts from " << mPath;
+    }
+
+    std::string ScriptCache::makeKey (const std::string& version,
+        const std::vector<boost::filesystem::path>& contentFiles)
+    {
+        std::string key = version;
+
+        for (const boost::filesystem::path& file : contentFiles)
+        {
+            key += '\n' + file.filename().string();
+
+            boost::system::error_code error;
+            const boost::uintmax_t size = boost::filesystem::file_size (file, error);
+            if (!error)
+                key += ' ' + std::to_string (size);
+            const std::time_t time = boost::filesystem::last_write_time (file, error);
+            if (!error)
+                key += ' ' + std::to_string (time);
+        }
+
+        return key;
+    }
+
+    bool ScriptCache::get (const std::string& name, const std::string& text,
+        std::vector<Interpreter::Type_Code>& code, Compiler::Locals& locals) const
+    {
+        const auto it = mEntries.find (name);
+        if (it == mEntries.end() || it->second.mTextHash != hashText (text))
+            return false;
+
+        code = it->second.mCode;
+        locals = it->second.mLocals;
+        return true;
+    }
+
+    void ScriptCache::insert (const std::string& name, const std::string& text,
+        const std::vector<Interpreter::Type_Code>& code, const Compiler::Locals& locals)
+    {
+        Entry& entry = mEntries[name];
+        entry.mTextHash = hashText (text);
+        entry.mCode = code;
+        entry.mLocals = locals;
+        mModified = true;
+    }
+
+    std::size_t ScriptCache::getSize() const
+    {
+        return mEntries.size();
+    }
+
+    void ScriptCache::save()
+    {
+        if (!mModified)
+            return;
+
+        try
+        {
+            boost::filesystem::create_directories (mPath.parent_path());
+
+            // Write to a temporary file first, so that an interrupted write can't leave a truncated cache behind
+            boost::filesystem::path temporary = mPath;
+            temporary += ".tmp";
+
+            {
+                boost::filesystem::ofstream stream (temporary, std::ios::binary);
+                stream.write (sMagic, sizeof (sMagic));
+                write (stream, sFormatVersion);
+                write (stream, mKey);
+                write (stream, static_cast<std::uint32_t> (mEntries.size()));
+
+                for (const auto& it : mEntries)
+                {
+                    write (stream, it.first);
+                    write (stream, it.second.mTextHash);
+                    write (stream, static_cast<std::uint32_t> (it.second.mCode.size()));
+                    stream.write (reinterpret_cast<const char*> (it.second.mCode.data()),
+                        it.second.mCode.size() * sizeof (Interpreter::Type_Code));
+
+                    for (const char type : {'s', 'l', 'f'})
+                    {
+                        const std::vector<std::string>& locals = it.second.mLocals.get (type);
+                        write (stream, static_cast<std::uint32_t> (locals.size()));
+                        for (const std::string& local : locals)
+                            write (stream, local);
+                    }
+                }
+
+                if (!stream)
+                    throw std::runtime_error ("failed to write file");
+            }
+
+            boost::filesystem::rename (temporary, mPath);
+            mModified = false;
+        }
+        catch (const std::exception& e)
+        {
+            Log(Debug::Warning) << "Warning: failed to save script cache " << mPath << ": " << e.what();
+        }
+    }
+}
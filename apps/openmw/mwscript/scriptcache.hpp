@@ -0,0 +1,60 @@
+#ifndef GAME_SCRIPT_SCRIPTCACHE_H
+#define GAME_SCRIPT_SCRIPTCACHE_H
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <boost/filesystem/path.hpp>
+
+#include <components/compiler/locals.hpp>
+#include <components/interpreter/types.hpp>
+
+namespace MWScript
+{
+    /// \brief Compiled scripts persisted between sessions
+    ///
+    /// Entries are keyed by script name and a hash of the script text. The whole cache is discarded when its key
+    /// (the engine version and the content files, see ScriptCache::makeKey) changes, since the compiled code also
+    /// depends on the globals and IDs known at compile time.
+    class ScriptCache
+    {
+            struct Entry
+            {
+                std::uint64_t mTextHash;
+                std::vector<Interpreter::Type_Code> mCode;
+                Compiler::Locals mLocals;
+            };
+
+            boost::filesystem::path mPath;
+            std::string mKey;
+            std::map<std::string, Entry> mEntries;
+            bool mModified;
+
+            void load();
+
+        public:
+
+            ScriptCache (const boost::filesystem::path& path, const std::string& key);
+            ///< Load the cache from \a path, if it exists and was written with the same \a key.
+
+            static std::string makeKey (const std::string& version,
+                const std::vector<boost::filesystem::path>& contentFiles);
+            ///< Combine the engine version with the name, size and modification time of each content file.
+
+            bool get (const std::string& name, const std::string& text,
+                std::vector<Interpreter::Type_Code>& code, Compiler::Locals& locals) const;
+            ///< Get the compiled code of script \a name, if it was compiled from \a text.
+
+            void insert (const std::string& name, const std::string& text,
+                const std::vector<Interpreter::Type_Code>& code, const Compiler::Locals& locals);
+
+            std::size_t getSize() const;
+
+            void save();
+            ///< Write the cache to disk, if it was modified since it was loaded.
+    };
+}
+
+#endif
@@ -24,10 +24,10 @@ namespace MWScript
 {
     ScriptManager::ScriptManager (const MWWorld::ESMStore& store,
         Compiler::Context& compilerContext, int warningsMode,
-        const std::vector<std::string>& scriptBlacklist)
+        const std::vector<std::string>& scriptBlacklist, std::unique_ptr<ScriptCache> cache)
     : mErrorHandler(), mStore (store),
       mCompilerContext (compilerContext), mParser (mErrorHandler, mCompilerContext),
-      mOpcodesInstalled (false), mGlobalScripts (store)
+      mOpcodesInstalled (false), mGlobalScripts (store), mCache (std::move (cache))
     {
         mErrorHandler.setWarningsMode (warningsMode);
 
@@ -38,6 +38,12 @@ namespace MWScript
         std::sort (mScriptBlacklist.begin(), mScriptBlacklist.end());
     }
 
+    ScriptManager::~ScriptManager()
+    {
+        if (mCache)
+            mCache->save();
+    }
+
     bool ScriptManager::compile (const std::string& name)
     {
         mParser.reset();
@@ -45,6 +51,14 @@ namespace MWScript
 
         if (const ESM::Script *script = mStore.get<ESM::Script>().find (name))
         {
+            std::vector<Interpreter::Type_Code> code;
+            Compiler::Locals locals;
+            if (mCache && mCache->get (name, script->mScriptText, code, locals))
+            {
+                mScripts.insert (std::make_pair (name, CompiledScript (code, locals)));
+                return true;
+            }
+
             mErrorHandler.setContext(name);
 
             bool Success = true;
@@ -77,9 +91,11 @@ namespace MWScript
 
             if (Success)
             {
-                std::vector<Interpreter::Type_Code> code;
                 mParser.getCode (code);
-                mScripts.insert (std::make_pair (name, std::make_pair (code, mParser.getLocals())));
+                mScripts.insert (std::make_pair (name, CompiledScript (code, mParser.getLocals())));
+
+                if (mCache)
+                    mCache->insert (name, script->mScriptText, code, mParser.getLocals());
 
                 return true;
             }
@@ -99,7 +115,7 @@ namespace MWScript
             {
                 // failed -> ignore script from now on.
                 std::vector<Interpreter::Type_Code> empty;
-                mScripts.insert (std::make_pair (name, std::make_pair (empty, Compiler::Locals())));
+                mScripts.insert (std::make_pair (name, CompiledScript (empty, Compiler::Locals())));
                 return;
             }
 
@@ -108,7 +124,7 @@ namespace MWScript
         }
 
         // execute script
-        if (!iter->second.first.empty())
+        if (!iter->second.mByteCode.empty())
             try
             {
                 if (!mOpcodesInstalled)
@@ -117,14 +133,19 @@ namespace MWScript
                     mOpcodesInstalled = true;
                 }
 
-                mInterpreter.run (&iter->second.first[0], iter->second.first.size(), interpreterContext);
+                if (!iter->second.mProgram.mCode)
+                    iter->second.mProgram = mInterpreter.decode (&iter->second.mByteCode[0],
+                        iter->second.mByteCode.size());
+
+                mInterpreter.run (iter->second.mProgram, interpreterContext);
             }
             catch (const std::exception& e)
             {
                 Log(Debug::Error) << "Execution of script " << name << " failed:";
                 Log(Debug::Error) << e.what();
 
-                iter->second.first.clear(); // don't execute again.
+                iter->second.mByteCode.clear(); // don't execute again.
+                iter->second.mProgram = Interpreter::Program();
             }
     }
 
@@ -157,7 +178,7 @@ namespace MWScript
             ScriptCollection::iterator iter = mScripts.find (name2);
 
             if (iter!=mScripts.end())
-                return iter->second.second;
+                return iter->second.mLocals;
         }
 
         {
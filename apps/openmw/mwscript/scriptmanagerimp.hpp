@@ -2,6 +2,7 @@
 #define GAME_SCRIPT_SCRIPTMANAGER_H
 
 #include <map>
+#include <memory>
 #include <string>
 
 #include <components/compiler/streamerrorhandler.hpp>
@@ -13,6 +14,7 @@
 #include "../mwbase/scriptmanager.hpp"
 
 #include "globalscripts.hpp"
+#include "scriptcache.hpp"
 
 namespace MWWorld
 {
@@ -41,19 +43,34 @@ namespace MWScript
             Interpreter::Interpreter mInterpreter;
             bool mOpcodesInstalled;
 
-            typedef std::pair<std::vector<Interpreter::Type_Code>, Compiler::Locals> CompiledScript;
+            struct CompiledScript
+            {
+                std::vector<Interpreter::Type_Code> mByteCode;
+                Interpreter::Program mProgram; ///< decoded on first use
+                Compiler::Locals mLocals;
+
+                CompiledScript (const std::vector<Interpreter::Type_Code>& byteCode, const Compiler::Locals& locals)
+                    : mByteCode (byteCode), mLocals (locals)
+                {}
+            };
+
             typedef std::map<std::string, CompiledScript> ScriptCollection;
 
             ScriptCollection mScripts;
             GlobalScripts mGlobalScripts;
             std::map<std::string, Compiler::Locals> mOtherLocals;
             std::vector<std::string> mScriptBlacklist;
+            std::unique_ptr<ScriptCache> mCache;
 
         public:
 
             ScriptManager (const MWWorld::ESMStore& store,
                 Compiler::Context& compilerContext, int warningsMode,
-                const std::vector<std::string>& scriptBlacklist);
+                const std::vector<std::string>& scriptBlacklist,
+                std::unique_ptr<ScriptCache> cache = nullptr);
+            ///< \param cache Compiled scripts from previous sessions, or nullptr to always compile scripts.
+
+            virtual ~ScriptManager();
 
             virtual void run (const std::string& name, Interpreter::Context& interpreterContext);
             ///< Run the script with the given name (compile first, if not compiled yet)
@@ -172,7 +172,7 @@ namespace MWWorld
     class TerrainPreloadItem : public SceneUtil::WorkItem
     {
     public:
-        TerrainPreloadItem(const std::vector<osg::ref_ptr<Terrain::View> >& views, Terrain::World* world, const std::vector<osg::Vec3f>& preloadPositions)
+        TerrainPreloadItem(const std::vector<osg::ref_ptr<Terrain::View> >& views, Terrain::World* world, const std::vector<PositionCellGrid>& preloadPositions)
             : mAbort(false)
             , mTerrainViews(views)
             , mWorld(world)
@@ -191,7 +191,7 @@ namespace MWWorld
             for (unsigned int i=0; i<mTerrainViews.size() && i<mPreloadPositions.size() && !mAbort; ++i)
             {
                 mTerrainViews[i]->reset();
-                mWorld->preload(mTerrainViews[i], mPreloadPositions[i], mAbort);
+                mWorld->preload(mTerrainViews[i], mPreloadPositions[i].mPosition, mPreloadPositions[i].mCellBounds, mAbort);
             }
         }
 
@@ -204,7 +204,7 @@ namespace MWWorld
         std::atomic<bool> mAbort;
         std::vector<osg::ref_ptr<Terrain::View> > mTerrainViews;
         Terrain::World* mWorld;
-        std::vector<osg::Vec3f> mPreloadPositions;
+        std::vector<PositionCellGrid> mPreloadPositions;
     };
 
     /// Worker thread item: update the resource system's cache, effectively deleting unused entries.
@@ -256,7 +256,7 @@ namespace MWWorld
         }
 
         for (PreloadMap::iterator it = mPreloadCells.begin(); it != mPreloadCells.end();++it)
-            it->second.mWorkItem->abort();
+            it->second.mWorkItem->cancel();
 
         for (PreloadMap::iterator it = mPreloadCells.begin(); it != mPreloadCells.end();++it)
             it->second.mWorkItem->waitTillDone();
@@ -264,7 +264,7 @@ namespace MWWorld
         mPreloadCells.clear();
     }
 
-    void CellPreloader::preload(CellStore *cell, double timestamp)
+    void CellPreloader::preload(CellStore *cell, double timestamp, SceneUtil::WorkPriority priority)
     {
         if (!mWorkQueue)
         {
@@ -282,7 +282,13 @@ namespace MWWorld
         {
             // already preloaded, nothing to do other than updating the timestamp
             found->second.mTimeStamp = timestamp;
-            return;
+            if (priority >= found->second.mPriority || found->second.mWorkItem->isDone())
+                return;
+
+            // still waiting behind less important items, queue it again with the new priority
+            found->second.mWorkItem->cancel();
+            mUnrefQueue->push(found->second.mWorkItem);
+            mPreloadCells.erase(found);
         }
 
         while (mPreloadCells.size() >= mMaxCacheSize)
@@ -302,7 +308,7 @@ namespace MWWorld
 
             if (oldestTimestamp + threshold < timestamp)
             {
-                oldestCell->second.mWorkItem->abort();
+                oldestCell->second.mWorkItem->cancel();
                 mPreloadCells.erase(oldestCell);
             }
             else
@@ -310,9 +316,9 @@ namespace MWWorld
         }
 
         osg::ref_ptr<PreloadItem> item (new PreloadItem(cell, mResourceSystem->getSceneManager(), mBulletShapeManager, mResourceSystem->getKeyframeManager(), mTerrain, mLandManager, mPreloadInstances));
-        mWorkQueue->addWorkItem(item);
+        mWorkQueue->addWorkItem(item, priority);
 
-        mPreloadCells[cell] = PreloadEntry(timestamp, item);
+        mPreloadCells[cell] = PreloadEntry(timestamp, item, priority);
     }
 
     void CellPreloader::notifyLoaded(CellStore *cell)
@@ -323,7 +329,7 @@ namespace MWWorld
             // do the deletion in the background thread
             if (found->second.mWorkItem)
             {
-                found->second.mWorkItem->abort();
+                found->second.mWorkItem->cancel();
                 mUnrefQueue->push(mPreloadCells[cell].mWorkItem);
             }
 
@@ -340,7 +346,7 @@ namespace MWWorld
         {
             if (it->second.mWorkItem)
             {
-                it->second.mWorkItem->abort();
+                it->second.mWorkItem->cancel();
                 mUnrefQueue->push(it->second.mWorkItem);
             }
 
@@ -356,7 +362,7 @@ namespace MWWorld
             {
                 if (it->second.mWorkItem)
                 {
-                    it->second.mWorkItem->abort();
+                    it->second.mWorkItem->cancel();
                     mUnrefQueue->push(it->second.mWorkItem);
                 }
                 mPreloadCells.erase(it++);
@@ -369,7 +375,7 @@ namespace MWWorld
         {
             // the resource cache is cleared from the worker thread so that we're not holding up the main thread with delete operations
             mUpdateCacheItem = new UpdateCacheItem(mResourceSystem, timestamp);
-            mWorkQueue->addWorkItem(mUpdateCacheItem, true);
+            mWorkQueue->addWorkItem(mUpdateCacheItem, SceneUtil::WorkPriority_Immediate);
             mLastResourceCacheUpdate = timestamp;
         }
 
@@ -415,7 +421,7 @@ namespace MWWorld
         mUnrefQueue = unrefQueue;
     }
 
-    void CellPreloader::setTerrainPreloadPositions(const std::vector<osg::Vec3f> &positions)
+    void CellPreloader::setTerrainPreloadPositions(const std::vector<PositionCellGrid> &positions)
     {
         if (mTerrainPreloadItem && !mTerrainPreloadItem->isDone())
             return;
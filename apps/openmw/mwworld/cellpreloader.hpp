@@ -4,6 +4,7 @@
 #include <map>
 #include <osg/ref_ptr>
 #include <osg/Vec3f>
+#include <osg/Vec4i>
 #include <components/sceneutil/workqueue.hpp>
 
 namespace Resource
@@ -33,6 +34,17 @@ namespace MWWorld
     class CellStore;
     class TerrainPreloadItem;
 
+    struct PositionCellGrid
+    {
+        osg::Vec3f mPosition;
+        osg::Vec4i mCellBounds; ///< Cells the scene loads around the position, see Terrain::World::setActiveGrid
+    };
+
+    inline bool operator==(const PositionCellGrid& lhs, const PositionCellGrid& rhs)
+    {
+        return lhs.mPosition == rhs.mPosition && lhs.mCellBounds == rhs.mCellBounds;
+    }
+
     class CellPreloader
     {
     public:
@@ -41,7 +53,8 @@ namespace MWWorld
 
         /// Ask a background thread to preload rendering meshes and collision shapes for objects in this cell.
         /// @note The cell itself must be in State_Loaded or State_Preloaded.
-        void preload(MWWorld::CellStore* cell, double timestamp);
+        /// @param priority If the cell is already queued with a lower priority, it is queued again with this one.
+        void preload(MWWorld::CellStore* cell, double timestamp, SceneUtil::WorkPriority priority = SceneUtil::WorkPriority_Predicted);
 
         void notifyLoaded(MWWorld::CellStore* cell);
 
@@ -68,7 +81,7 @@ namespace MWWorld
 
         void setUnrefQueue(SceneUtil::UnrefQueue* unrefQueue);
 
-        void setTerrainPreloadPositions(const std::vector<osg::Vec3f>& positions);
+        void setTerrainPreloadPositions(const std::vector<PositionCellGrid>& positions);
 
     private:
         Resource::ResourceSystem* mResourceSystem;
@@ -86,18 +99,21 @@ namespace MWWorld
 
         struct PreloadEntry
         {
-            PreloadEntry(double timestamp, osg::ref_ptr<SceneUtil::WorkItem> workItem)
+            PreloadEntry(double timestamp, osg::ref_ptr<SceneUtil::WorkItem> workItem, SceneUtil::WorkPriority priority)
                 : mTimeStamp(timestamp)
                 , mWorkItem(workItem)
+                , mPriority(priority)
             {
             }
             PreloadEntry()
                 : mTimeStamp(0.0)
+                , mPriority(SceneUtil::WorkPriority_Predicted)
             {
             }
 
             double mTimeStamp;
             osg::ref_ptr<SceneUtil::WorkItem> mWorkItem;
+            SceneUtil::WorkPriority mPriority;
         };
         typedef std::map<const MWWorld::CellStore*, PreloadEntry> PreloadMap;
 
@@ -105,7 +121,7 @@ namespace MWWorld
         PreloadMap mPreloadCells;
 
         std::vector<osg::ref_ptr<Terrain::View> > mTerrainViews;
-        std::vector<osg::Vec3f> mTerrainPreloadPositions;
+        std::vector<PositionCellGrid> mTerrainPreloadPositions;
         osg::ref_ptr<TerrainPreloadItem> mTerrainPreloadItem;
         osg::ref_ptr<SceneUtil::WorkItem> mUpdateCacheItem;
     };
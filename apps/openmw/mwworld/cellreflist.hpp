@@ -1,18 +1,20 @@
 #ifndef GAME_MWWORLD_CELLREFLIST_H
 #define GAME_MWWORLD_CELLREFLIST_H
 
-#include <list>
+#include <components/misc/stablevector.hpp>
 
 #include "livecellref.hpp"
 
 namespace MWWorld
 {
     /// \brief Collection of references of one type
+    ///
+    /// References are stored in contiguous chunks for fast iteration, and never move, so that Ptrs to them stay valid.
     template <typename X>
     struct CellRefList
     {
         typedef LiveCellRef<X> LiveRef;
-        typedef std::list<LiveRef> List;
+        typedef Misc::StableVector<LiveRef> List;
         List mList;
 
         /// Search for the given reference in the given reclist from
@@ -26,8 +28,7 @@ namespace MWWorld
 
         LiveRef &insert (const LiveRef &item)
         {
-            mList.push_back(item);
-            return mList.back();
+            return mList.push_back(item);
         }
 
         /// Remove all references with the given refNum from this list.
@@ -36,7 +37,7 @@ namespace MWWorld
             for (typename List::iterator it = mList.begin(); it != mList.end();)
             {
                 if (*it == refNum)
-                    mList.erase(it++);
+                    it = mList.erase(it);
                 else
                     ++it;
             }
@@ -362,38 +362,44 @@ bool MWWorld::Cells::readRecord (ESM::ESMReader& reader, uint32_t type,
 {
     if (type==ESM::REC_CSTA)
     {
-        ESM::CellState state;
-        state.mId.load (reader);
+        readCellState (reader, contentFileMap);
+        return true;
+    }
 
-        CellStore *cellStore = 0;
+    return false;
+}
 
-        try
-        {
-            cellStore = getCell (state.mId);
-        }
-        catch (...)
-        {
-            // silently drop cells that don't exist anymore
-            Log(Debug::Warning) << "Warning: Dropping state for cell " << state.mId.mWorldspace << " (cell no longer exists)";
-            reader.skipRecord();
-            return true;
-        }
+MWWorld::CellStore* MWWorld::Cells::readCellState (ESM::ESMReader& reader, const std::map<int, int>& contentFileMap)
+{
+    ESM::CellState state;
+    state.mId.load (reader);
 
-        state.load (reader);
-        cellStore->loadState (state);
+    CellStore *cellStore = 0;
 
-        if (state.mHasFogOfWar)
-            cellStore->readFog(reader);
+    try
+    {
+        cellStore = getCell (state.mId);
+    }
+    catch (...)
+    {
+        // silently drop cells that don't exist anymore
+        Log(Debug::Warning) << "Warning: Dropping state for cell " << state.mId.mWorldspace << " (cell no longer exists)";
+        reader.skipRecord();
+        return nullptr;
+    }
 
-        if (cellStore->getState()!=CellStore::State_Loaded)
-            cellStore->load ();
+    state.load (reader);
+    cellStore->loadState (state);
 
-        GetCellStoreCallback callback(*this);
+    if (state.mHasFogOfWar)
+        cellStore->readFog(reader);
 
-        cellStore->readReferences (reader, contentFileMap, &callback);
+    if (cellStore->getState()!=CellStore::State_Loaded)
+        cellStore->load ();
 
-        return true;
-    }
+    GetCellStoreCallback callback(*this);
 
-    return false;
+    cellStore->readReferences (reader, contentFileMap, &callback);
+
+    return cellStore;
 }
@@ -81,6 +81,10 @@ namespace MWWorld
 
             bool readRecord (ESM::ESMReader& reader, uint32_t type,
                 const std::map<int, int>& contentFileMap);
+
+            /// Read an ESM::REC_CSTA record.
+            /// @return the cell the state is loaded in, nullptr if the cell does not exist anymore
+            CellStore* readCellState (ESM::ESMReader& reader, const std::map<int, int>& contentFileMap);
     };
 }
 
@@ -21,6 +21,12 @@ struct ContentLoader
     {
     }
 
+    /// Called for every content file before any of them is loaded, so that loaders can start
+    /// preparing the files in the background. The files are then passed to load() in the same order.
+    virtual void stage(const boost::filesystem::path& filepath, int index)
+    {
+    }
+
     virtual void load(const boost::filesystem::path& filepath, int& index)
     {
         Log(Debug::Info) << "Loading content file " << filepath.string();
@@ -1,18 +1,128 @@
 #include "esmloader.hpp"
 #include "esmstore.hpp"
 
+#include <algorithm>
+#include <chrono>
+#include <iterator>
+#include <limits>
+
 #include <components/esm/esmreader.hpp>
 
+namespace
+{
+    // Content files with more records than this are split into several parts staged in parallel
+    const std::size_t sRecordsPerPart = 8192;
+
+    long long toMilliseconds(std::chrono::steady_clock::duration duration)
+    {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(duration).count();
+    }
+}
+
 namespace MWWorld
 {
 
 EsmLoader::EsmLoader(MWWorld::ESMStore& store, std::vector<ESM::ESMReader>& readers,
-  ToUTF8::Utf8Encoder* encoder, Loading::Listener& listener)
+  ToUTF8::Utf8Encoder* encoder, Loading::Listener& listener, int threads, bool memoryMapped)
   : ContentLoader(listener)
   , mEsm(readers)
   , mStore(store)
   , mEncoder(encoder)
+  , mMemoryMapped(memoryMapped)
+  , mShouldStop(false)
 {
+    if (threads <= 0)
+        threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+
+    // With a single thread there is nothing to overlap, so keep loading everything in place
+    if (threads > 1)
+    {
+        for (int i = 0; i < threads; ++i)
+            mThreads.emplace_back([&] { run(); });
+    }
+}
+
+EsmLoader::~EsmLoader()
+{
+    {
+        const std::lock_guard<std::mutex> lock(mMutex);
+        mShouldStop = true;
+        mJobs.clear();
+    }
+    mHasJob.notify_all();
+    for (auto& thread : mThreads)
+        thread.join();
+}
+
+void EsmLoader::stage(const boost::filesystem::path& filepath, int index)
+{
+    if (mThreads.empty())
+        return;
+
+    const std::string filename = filepath.string();
+
+    ESM::ESMReader reader;
+    open(reader, filename);
+
+    if (static_cast<std::size_t>(reader.getRecordCount()) <= sRecordsPerPart)
+    {
+        addJob(filename, index, nullptr, std::numeric_limits<std::size_t>::max());
+        return;
+    }
+
+    // Only walk the record headers here, decoding is left to the worker threads
+    std::size_t records = 0;
+    while (reader.hasMoreRecs())
+    {
+        if (records % sRecordsPerPart == 0)
+        {
+            const ESM::ESM_Context start = reader.getContext();
+            addJob(filename, index, &start, sRecordsPerPart);
+        }
+        reader.getRecName();
+        reader.getRecHeader();
+        reader.skipRecord();
+        ++records;
+    }
+}
+
+void EsmLoader::addJob(const std::string& filename, int index, const ESM::ESM_Context* start, std::size_t maxRecords)
+{
+    ToUTF8::Utf8Encoder* encoder = mEncoder;
+    const ESMStore& store = mStore;
+    const bool restore = start != nullptr;
+    const ESM::ESM_Context context = restore ? *start : ESM::ESM_Context();
+
+    std::packaged_task<StagedContent()> job([=, &store]
+    {
+        const auto begin = std::chrono::steady_clock::now();
+
+        // The encoder keeps a conversion buffer, each thread needs its own copy
+        std::unique_ptr<ToUTF8::Utf8Encoder> threadEncoder;
+        if (encoder)
+            threadEncoder.reset(new ToUTF8::Utf8Encoder(*encoder));
+
+        ESM::ESMReader reader;
+        reader.setEncoder(threadEncoder.get());
+        open(reader, filename);
+        if (restore)
+            reader.restoreContext(context);
+        reader.setIndex(index);
+
+        StagedContent content = store.stage(reader, maxRecords);
+
+        Log(Debug::Verbose) << "Staged " << content.mRecords.size() << " records of content file " << filename
+            << " in " << toMilliseconds(std::chrono::steady_clock::now() - begin) << " ms";
+
+        return content;
+    });
+
+    {
+        const std::lock_guard<std::mutex> lock(mMutex);
+        mStaged[index].push_back(job.get_future());
+        mJobs.push_back(std::move(job));
+    }
+    mHasJob.notify_one();
 }
 
 void EsmLoader::load(const boost::filesystem::path& filepath, int& index)
@@ -23,9 +133,66 @@ void EsmLoader::load(const boost::filesystem::path& filepath, int& index)
   lEsm.setEncoder(mEncoder);
   lEsm.setIndex(index);
   lEsm.setGlobalReaderList(&mEsm);
-  lEsm.open(filepath.string());
+  open(lEsm, filepath.string());
   mEsm[index] = lEsm;
-  mStore.load(mEsm[index], &mListener);
+
+  std::vector<std::future<StagedContent>> parts;
+  {
+      const std::lock_guard<std::mutex> lock(mMutex);
+      auto it = mStaged.find(index);
+      if (it != mStaged.end())
+      {
+          parts = std::move(it->second);
+          mStaged.erase(it);
+      }
+  }
+
+  if (parts.empty())
+  {
+      mStore.load(mEsm[index], &mListener);
+      return;
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  StagedContent content = parts.front().get();
+  for (std::size_t i = 1; i < parts.size(); ++i)
+  {
+      StagedContent part = parts[i].get();
+      std::move(part.mRecords.begin(), part.mRecords.end(), std::back_inserter(content.mRecords));
+  }
+  const auto waited = std::chrono::steady_clock::now() - start;
+
+  start = std::chrono::steady_clock::now();
+  mStore.merge(mEsm[index], content, &mListener);
+  const auto merged = std::chrono::steady_clock::now() - start;
+
+  Log(Debug::Verbose) << "Waited " << toMilliseconds(waited) << " ms for content file "
+      << filepath.filename().string() << " to be staged, merged it in " << toMilliseconds(merged) << " ms";
+}
+
+void EsmLoader::open(ESM::ESMReader& reader, const std::string& filename) const
+{
+    if (mMemoryMapped)
+        reader.openMapped(filename);
+    else
+        reader.open(filename);
+}
+
+void EsmLoader::run()
+{
+    while (true)
+    {
+        std::packaged_task<StagedContent()> job;
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mHasJob.wait(lock, [&] { return mShouldStop || !mJobs.empty(); });
+            if (mShouldStop)
+                return;
+            job = std::move(mJobs.front());
+            mJobs.pop_front();
+        }
+        job();
+    }
 }
 
 } /* namespace MWWorld */
@@ -1,6 +1,12 @@
 #ifndef ESMLOADER_HPP
 #define ESMLOADER_HPP
 
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <map>
+#include <mutex>
+#include <thread>
 #include <vector>
 
 #include "contentloader.hpp"
@@ -13,24 +19,47 @@ namespace ToUTF8
 namespace ESM
 {
     class ESMReader;
+    struct ESM_Context;
 }
 
 namespace MWWorld
 {
 
 class ESMStore;
+struct StagedContent;
 
 struct EsmLoader : public ContentLoader
 {
+    /// @param threads Number of threads decoding content files in the background. 1 loads every
+    /// file on the calling thread, 0 or less uses one thread per hardware core.
+    /// @param memoryMapped Read content files through memory mappings instead of file streams
     EsmLoader(MWWorld::ESMStore& store, std::vector<ESM::ESMReader>& readers,
-      ToUTF8::Utf8Encoder* encoder, Loading::Listener& listener);
+      ToUTF8::Utf8Encoder* encoder, Loading::Listener& listener, int threads = 1, bool memoryMapped = false);
 
-    void load(const boost::filesystem::path& filepath, int& index);
+    ~EsmLoader();
+
+    void stage(const boost::filesystem::path& filepath, int index) override;
+
+    void load(const boost::filesystem::path& filepath, int& index) override;
 
     private:
+      void addJob(const std::string& filename, int index, const ESM::ESM_Context* start, std::size_t maxRecords);
+
+      void run();
+
+      void open(ESM::ESMReader& reader, const std::string& filename) const;
+
       std::vector<ESM::ESMReader>& mEsm;
       MWWorld::ESMStore& mStore;
       ToUTF8::Utf8Encoder* mEncoder;
+      bool mMemoryMapped;
+
+      bool mShouldStop;
+      std::mutex mMutex;
+      std::condition_variable mHasJob;
+      std::deque<std::packaged_task<StagedContent()>> mJobs;
+      std::map<int, std::vector<std::future<StagedContent>>> mStaged;
+      std::vector<std::thread> mThreads;
 };
 
 } /* namespace MWWorld */
@@ -1,5 +1,6 @@
 #include "esmstore.hpp"
 
+#include <algorithm>
 #include <set>
 
 #include <boost/filesystem/operations.hpp>
@@ -26,18 +27,53 @@ static bool isCacheableRecord(int id)
     return false;
 }
 
-void ESMStore::load(ESM::ESMReader &esm, Loading::Listener* listener)
+static bool isStageableRecord(int id)
 {
-    listener->setProgressRange(1000);
+    // Records which are neither merged with previously loaded records nor need the state of the store to be decoded
+    if (id == ESM::REC_ACTI || id == ESM::REC_ALCH || id == ESM::REC_APPA || id == ESM::REC_ARMO ||
+        id == ESM::REC_BODY || id == ESM::REC_BOOK || id == ESM::REC_BSGN || id == ESM::REC_CLAS ||
+        id == ESM::REC_CLOT || id == ESM::REC_CONT || id == ESM::REC_CREA || id == ESM::REC_DOOR ||
+        id == ESM::REC_ENCH || id == ESM::REC_FACT || id == ESM::REC_GLOB || id == ESM::REC_GMST ||
+        id == ESM::REC_INGR || id == ESM::REC_LEVC || id == ESM::REC_LEVI || id == ESM::REC_LIGH ||
+        id == ESM::REC_LOCK || id == ESM::REC_MISC || id == ESM::REC_NPC_ || id == ESM::REC_PROB ||
+        id == ESM::REC_RACE || id == ESM::REC_REGN || id == ESM::REC_REPA || id == ESM::REC_SCPT ||
+        id == ESM::REC_SNDG || id == ESM::REC_SOUN || id == ESM::REC_SPEL || id == ESM::REC_SSCR ||
+        id == ESM::REC_STAT || id == ESM::REC_WEAP)
+    {
+        return true;
+    }
+    return false;
+}
 
-    ESM::Dialogue *dialogue = 0;
+namespace
+{
+    /// INFO records are inserted into the preceding dialogue rather than into a store
+    class StagedInfo : public StagedRecord
+    {
+        ESM::DialInfo mInfo;
+        bool mIsDeleted;
 
-    // Land texture loading needs to use a separate internal store for each plugin.
-    // We set the number of plugins here to avoid continual resizes during loading,
-    // and so we can properly verify if valid plugin indices are being passed to the
-    // LandTexture Store retrieval methods.
-    mLandTextures.resize(esm.getGlobalReaderList()->size());
+    public:
+        StagedInfo(ESM::ESMReader &esm)
+          : mIsDeleted(false)
+        {
+            mInfo.load(esm, mIsDeleted);
+        }
+
+        RecordId insert(StoreBase& store) override
+        {
+            throw std::logic_error("INFO records are inserted into their dialogue");
+        }
 
+        void insert(ESM::Dialogue& dialogue, bool merge)
+        {
+            dialogue.addInfo(mInfo, mIsDeleted, merge);
+        }
+    };
+}
+
+void ESMStore::addParentFileIndices(ESM::ESMReader &esm)
+{
     /// \todo Move this to somewhere else. ESMReader?
     // Cache parent esX files by tracking their indices in the global list of
     //  all files/readers used by the engine. This will greaty accelerate
@@ -65,6 +101,68 @@ void ESMStore::load(ESM::ESMReader &esm, Loading::Listener* listener)
         }
         esm.addParentFileIndex(index);
     }
+}
+
+void ESMStore::loadRecord(ESM::ESMReader &esm, ESM::NAME n, ESM::Dialogue *&dialogue)
+{
+    // Look up the record type.
+    std::map<int, StoreBase *>::iterator it = mStores.find(n.intval);
+
+    if (it == mStores.end()) {
+        if (n.intval == ESM::REC_INFO) {
+            if (dialogue)
+            {
+                dialogue->readInfo(esm, esm.getIndex() != 0);
+            }
+            else
+            {
+                Log(Debug::Error) << "Error: info record without dialog";
+                esm.skipRecord();
+            }
+        } else if (n.intval == ESM::REC_MGEF) {
+            mMagicEffects.load (esm);
+        } else if (n.intval == ESM::REC_SKIL) {
+            mSkills.load (esm);
+        }
+        else if (n.intval==ESM::REC_FILT || n.intval == ESM::REC_DBGP)
+        {
+            // ignore project file only records
+            esm.skipRecord();
+        }
+        else {
+            std::stringstream error;
+            error << "Unknown record: " << n.toString();
+            throw std::runtime_error(error.str());
+        }
+    } else {
+        RecordId id = it->second->load(esm);
+        if (id.mIsDeleted)
+        {
+            it->second->eraseStatic(id.mId);
+            return;
+        }
+
+        if (n.intval==ESM::REC_DIAL) {
+            dialogue = const_cast<ESM::Dialogue*>(mDialogs.find(id.mId));
+        } else {
+            dialogue = 0;
+        }
+    }
+}
+
+void ESMStore::load(ESM::ESMReader &esm, Loading::Listener* listener)
+{
+    listener->setProgressRange(1000);
+
+    ESM::Dialogue *dialogue = 0;
+
+    // Land texture loading needs to use a separate internal store for each plugin.
+    // We set the number of plugins here to avoid continual resizes during loading,
+    // and so we can properly verify if valid plugin indices are being passed to the
+    // LandTexture Store retrieval methods.
+    mLandTextures.resize(esm.getGlobalReaderList()->size());
+
+    addParentFileIndices(esm);
 
     // Loop through all records
     while(esm.hasMoreRecs())
@@ -72,50 +170,106 @@ void ESMStore::load(ESM::ESMReader &esm, Loading::Listener* listener)
         ESM::NAME n = esm.getRecName();
         esm.getRecHeader();
 
-        // Look up the record type.
-        std::map<int, StoreBase *>::iterator it = mStores.find(n.intval);
+        loadRecord(esm, n, dialogue);
 
-        if (it == mStores.end()) {
-            if (n.intval == ESM::REC_INFO) {
-                if (dialogue)
-                {
-                    dialogue->readInfo(esm, esm.getIndex() != 0);
-                }
-                else
-                {
-                    Log(Debug::Error) << "Error: info record without dialog";
-                    esm.skipRecord();
-                }
-            } else if (n.intval == ESM::REC_MGEF) {
-                mMagicEffects.load (esm);
-            } else if (n.intval == ESM::REC_SKIL) {
-                mSkills.load (esm);
-            }
-            else if (n.intval==ESM::REC_FILT || n.intval == ESM::REC_DBGP)
-            {
-                // ignore project file only records
-                esm.skipRecord();
-            }
-            else {
-                std::stringstream error;
-                error << "Unknown record: " << n.toString();
-                throw std::runtime_error(error.str());
-            }
-        } else {
-            RecordId id = it->second->load(esm);
-            if (id.mIsDeleted)
-            {
-                it->second->eraseStatic(id.mId);
-                continue;
-            }
+        listener->setProgress(static_cast<size_t>(esm.getFileOffset() / (float)esm.getFileSize() * 1000));
+    }
+}
+
+StagedContent ESMStore::stage(ESM::ESMReader &esm, std::size_t maxRecords) const
+{
+    StagedContent content;
+    content.mRecords.reserve(std::min(static_cast<std::size_t>(std::max(esm.getRecordCount(), 0)), maxRecords));
 
-            if (n.intval==ESM::REC_DIAL) {
-                dialogue = const_cast<ESM::Dialogue*>(mDialogs.find(id.mId));
-            } else {
+    for (std::size_t i = 0; i < maxRecords && esm.hasMoreRecs(); ++i)
+    {
+        StagedContent::Record record;
+        record.mName = esm.getRecName();
+
+        const int type = record.mName.intval;
+        if (type == ESM::REC_INFO)
+        {
+            esm.getRecHeader();
+            record.mRecord.reset(new StagedInfo(esm));
+        }
+        else if (isStageableRecord(type))
+        {
+            esm.getRecHeader();
+            record.mRecord = mStores.find(type)->second->stage(esm);
+        }
+        else if (type == ESM::REC_FILT || type == ESM::REC_DBGP)
+        {
+            // ignore project file only records
+            esm.getRecHeader();
+            esm.skipRecord();
+            continue;
+        }
+        else if (mStores.count(type) || type == ESM::REC_MGEF || type == ESM::REC_SKIL)
+        {
+            record.mContext = esm.getContext();
+            esm.getRecHeader();
+            esm.skipRecord();
+        }
+        else
+        {
+            std::stringstream error;
+            error << "Unknown record: " << record.mName.toString();
+            throw std::runtime_error(error.str());
+        }
+
+        content.mRecords.push_back(std::move(record));
+    }
+
+    return content;
+}
+
+void ESMStore::merge(ESM::ESMReader &esm, StagedContent &content, Loading::Listener* listener)
+{
+    listener->setProgressRange(1000);
+
+    ESM::Dialogue *dialogue = 0;
+
+    mLandTextures.resize(esm.getGlobalReaderList()->size());
+
+    addParentFileIndices(esm);
+
+    const bool mergeInfos = esm.getIndex() != 0;
+    const std::vector<int> parentFileIndices = esm.getParentFileIndices();
+
+    for (size_t i = 0; i < content.mRecords.size(); ++i)
+    {
+        StagedContent::Record& record = content.mRecords[i];
+
+        if (!record.mRecord)
+        {
+            // The staging reader did not know about the parent files
+            record.mContext.parentFileIndices = parentFileIndices;
+            esm.restoreContext(record.mContext);
+            esm.getRecHeader();
+
+            loadRecord(esm, record.mName, dialogue);
+        }
+        else if (record.mName.intval == ESM::REC_INFO)
+        {
+            if (dialogue)
+                static_cast<StagedInfo&>(*record.mRecord).insert(*dialogue, mergeInfos);
+            else
+                Log(Debug::Error) << "Error: info record without dialog";
+        }
+        else
+        {
+            StoreBase* store = mStores[record.mName.intval];
+            RecordId id = record.mRecord->insert(*store);
+            if (id.mIsDeleted)
+                store->eraseStatic(id.mId);
+            else
                 dialogue = 0;
-            }
         }
-        listener->setProgress(static_cast<size_t>(esm.getFileOffset() / (float)esm.getFileSize() * 1000));
+
+        // Staged records are not needed anymore, free them as we go
+        record.mRecord.reset();
+
+        listener->setProgress(static_cast<size_t>((i + 1) / (float)content.mRecords.size() * 1000));
     }
 }
 
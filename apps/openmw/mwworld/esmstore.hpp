@@ -1,9 +1,12 @@
 #ifndef OPENMW_MWWORLD_ESMSTORE_H
 #define OPENMW_MWWORLD_ESMSTORE_H
 
+#include <limits>
+#include <memory>
 #include <sstream>
 #include <stdexcept>
 
+#include <components/esm/esmcommon.hpp>
 #include <components/esm/records.hpp>
 #include "store.hpp"
 
@@ -14,6 +17,23 @@ namespace Loading
 
 namespace MWWorld
 {
+    /// Records of a single content file decoded by ESMStore::stage, in file order.
+    struct StagedContent
+    {
+        struct Record
+        {
+            ESM::NAME mName;
+
+            /// Decoded record, or null if the record has to be read in load order by ESMStore::merge
+            std::unique_ptr<StagedRecord> mRecord;
+
+            /// Position of the record header, only used if mRecord is null
+            ESM::ESM_Context mContext;
+        };
+
+        std::vector<Record> mRecords;
+    };
+
     class ESMStore
     {
         Store<ESM::Activator>       mActivators;
@@ -77,6 +97,12 @@ namespace MWWorld
         /// Validate entries in store after setup
         void validate();
 
+        /// Resolve the indices of the master files requested by the file \a esm is reading
+        void addParentFileIndices(ESM::ESMReader &esm);
+
+        /// Load a record whose header has just been read
+        void loadRecord(ESM::ESMReader &esm, ESM::NAME name, ESM::Dialogue *&dialogue);
+
     public:
         /// \todo replace with SharedIterator<StoreBase>
         typedef std::map<int, StoreBase *>::const_iterator iterator;
@@ -163,6 +189,18 @@ namespace MWWorld
 
         void load(ESM::ESMReader &esm, Loading::Listener* listener);
 
+        /// Decode the records of a content file without modifying the store. Thread safe, so that
+        /// several content files, or several parts of one file, can be staged in parallel.
+        /// @param maxRecords Stop after this many records, leaving the rest of the file unread
+        /// \note Records which depend on previously loaded content (cells, dialogues, ...) are not
+        /// decoded, only their position is remembered.
+        StagedContent stage(ESM::ESMReader &esm, std::size_t maxRecords = std::numeric_limits<std::size_t>::max()) const;
+
+        /// Insert the records of a staged content file. Files must be merged in load order, the
+        /// result is the same as calling load() with \a esm.
+        /// @param esm Reader for the staged file, used for the records that could not be staged
+        void merge(ESM::ESMReader &esm, StagedContent &content, Loading::Listener* listener);
+
         template <class T>
         const Store<T> &get() const {
             throw std::runtime_error("Storage for this type not exist");
@@ -1,5 +1,6 @@
 #include "scene.hpp"
 
+#include <algorithm>
 #include <limits>
 
 #include <BulletCollision/CollisionDispatch/btCollisionObject.h>
@@ -61,17 +62,6 @@ namespace
                 * osg::Quat(zr, osg::Vec3(0, 0, -1));
     }
 
-    osg::Quat makeObjectOsgQuat(const ESM::Position& position)
-    {
-        const float xr = position.rot[0];
-        const float yr = position.rot[1];
-        const float zr = position.rot[2];
-
-        return osg::Quat(zr, osg::Vec3(0, 0, -1))
-            * osg::Quat(yr, osg::Vec3(0, -1, 0))
-            * osg::Quat(xr, osg::Vec3(-1, 0, 0));
-    }
-
     void setNodeRotation(const MWWorld::Ptr& ptr, MWRender::RenderingManager& rendering, RotationOrder order)
     {
         if (!ptr.getRefData().getBaseNode())
@@ -82,7 +72,7 @@ namespace
             ? makeActorOsgQuat(ptr.getRefData().getPosition())
             : (order == RotationOrder::inverse
                 ? makeInversedOrderObjectOsgQuat(ptr.getRefData().getPosition())
-                : makeObjectOsgQuat(ptr.getRefData().getPosition()))
+                : Misc::Convert::makeOsgQuat(ptr.getRefData().getPosition()))
         );
     }
 
@@ -101,10 +91,13 @@ namespace
             model = Misc::ResourceHelpers::correctActorModelPath(model, rendering.getResourceSystem()->getVFS());
 
         std::string id = ptr.getCellRef().getRefId();
-        if (id == "prisonmarker" || id == "divinemarker" || id == "templemarker" || id == "northmarker")
-            model = ""; // marker objects that have a hardcoded function in the game logic, should be hidden from the player
+        if (Misc::ResourceHelpers::isHiddenMarker(id))
+            model = "";
 
-        ptr.getClass().insertObjectRendering(ptr, model, rendering);
+        if (!model.empty() && rendering.isPagedObject(ptr))
+            rendering.getObjects().insertPlaceholder(ptr); // rendered by the terrain chunks
+        else
+            ptr.getClass().insertObjectRendering(ptr, model, rendering);
         setNodeRotation(ptr, rendering, RotationOrder::direct);
 
         ptr.getClass().insertObject (ptr, model, physics);
@@ -140,7 +133,7 @@ namespace
 
                 const auto& transform = object->getCollisionObject()->getWorldTransform();
                 const btTransform closedDoorTransform(
-                    Misc::Convert::toBullet(makeObjectOsgQuat(ptr.getCellRef().getPosition())),
+                    Misc::Convert::toBullet(Misc::Convert::makeOsgQuat(ptr.getCellRef().getPosition())),
                     transform.getOrigin()
                 );
 
@@ -308,6 +301,29 @@ namespace MWWorld
         cellY = (minY + maxY) / 2;
     }
 
+    osg::Vec4i Scene::gridCenterToBounds(int cellX, int cellY) const
+    {
+        return osg::Vec4i(cellX - mHalfGridSize, cellY - mHalfGridSize, cellX + mHalfGridSize + 1, cellY + mHalfGridSize + 1);
+    }
+
+    osg::Vec4i Scene::getGridBoundsAt(const osg::Vec3f& pos, bool keepCurrentGrid)
+    {
+        // Same rule as playerMoved: the grid follows the player only beyond the cell loading threshold
+        if (keepCurrentGrid && !mActiveCells.empty())
+        {
+            int cellX, cellY;
+            getGridCenter(cellX, cellY);
+            float centerX, centerY;
+            MWBase::Environment::get().getWorld()->indexToPosition(cellX, cellY, centerX, centerY, true);
+            const float maxDistance = Constants::CellSizeInUnits / 2 + mCellLoadingThreshold;
+            if (std::max(std::abs(centerX - pos.x()), std::abs(centerY - pos.y())) <= maxDistance)
+                return gridCenterToBounds(cellX, cellY);
+        }
+        int cellX, cellY;
+        MWBase::Environment::get().getWorld()->positionToIndex(pos.x(), pos.y(), cellX, cellY);
+        return gridCenterToBounds(cellX, cellY);
+    }
+
     void Scene::update (float duration, bool paused)
     {
         mPreloadTimer += duration;
@@ -602,6 +618,8 @@ namespace MWWorld
             }
         }
 
+        mRendering.setActiveGrid(gridCenterToBounds(playerCellX, playerCellY));
+
         CellStore* current = MWBase::Environment::get().getWorld()->getExterior(playerCellX, playerCellY);
         MWBase::Environment::get().getWindowManager()->changeCell(current);
 
@@ -761,6 +779,8 @@ namespace MWWorld
         mPhysics->setUnrefQueue(rendering.getUnrefQueue());
 
         rendering.getResourceSystem()->setExpiryDelay(Settings::Manager::getFloat("cache expiry delay", "Cells"));
+        rendering.getResourceSystem()->setMaxCacheMemorySize(
+            static_cast<std::size_t>(std::max(0, Settings::Manager::getInt("cache memory budget", "Cells"))) * 1024 * 1024);
 
         mPreloader->setExpiryDelay(Settings::Manager::getFloat("preload cell expiry delay", "Cells"));
         mPreloader->setMinCacheSize(Settings::Manager::getInt("preload cell cache min", "Cells"));
@@ -976,7 +996,7 @@ namespace MWWorld
 
     void Scene::preloadCells(float dt)
     {
-        std::vector<osg::Vec3f> exteriorPositions;
+        std::vector<PositionCellGrid> exteriorPositions;
 
         const MWWorld::ConstPtr player = MWBase::Environment::get().getWorld()->getPlayerPtr();
         osg::Vec3f playerPos = player.getRefData().getPosition().asVec3();
@@ -984,7 +1004,7 @@ namespace MWWorld
         osg::Vec3f predictedPos = playerPos + moved / dt * mPredictionTime;
 
         if (mCurrentCell->isExterior())
-            exteriorPositions.push_back(predictedPos);
+            exteriorPositions.push_back(PositionCellGrid {predictedPos, getGridBoundsAt(predictedPos, true)});
 
         mLastPlayerPos = playerPos;
 
@@ -1001,7 +1021,7 @@ namespace MWWorld
         mPreloader->setTerrainPreloadPositions(exteriorPositions);
     }
 
-    void Scene::preloadTeleportDoorDestinations(const osg::Vec3f& playerPos, const osg::Vec3f& predictedPos, std::vector<osg::Vec3f>& exteriorPositions)
+    void Scene::preloadTeleportDoorDestinations(const osg::Vec3f& playerPos, const osg::Vec3f& predictedPos, std::vector<PositionCellGrid>& exteriorPositions)
     {
         std::vector<MWWorld::ConstPtr> teleportDoors;
         for (const MWWorld::CellStore* cellStore : mActiveCells)
@@ -1028,14 +1048,14 @@ namespace MWWorld
                 try
                 {
                     if (!door.getCellRef().getDestCell().empty())
-                        preloadCell(MWBase::Environment::get().getWorld()->getInterior(door.getCellRef().getDestCell()));
+                        preloadCell(MWBase::Environment::get().getWorld()->getInterior(door.getCellRef().getDestCell()), false, SceneUtil::WorkPriority_Background);
                     else
                     {
                         osg::Vec3f pos = door.getCellRef().getDoorDest().asVec3();
                         int x,y;
                         MWBase::Environment::get().getWorld()->positionToIndex (pos.x(), pos.y(), x, y);
-                        preloadCell(MWBase::Environment::get().getWorld()->getExterior(x,y), true);
-                        exteriorPositions.push_back(pos);
+                        preloadCell(MWBase::Environment::get().getWorld()->getExterior(x,y), true, SceneUtil::WorkPriority_Background);
+                        exteriorPositions.push_back(PositionCellGrid {pos, gridCenterToBounds(x, y)});
                     }
                 }
                 catch (std::exception& e)
@@ -1080,7 +1100,7 @@ namespace MWWorld
         }
     }
 
-    void Scene::preloadCell(CellStore *cell, bool preloadSurrounding)
+    void Scene::preloadCell(CellStore *cell, bool preloadSurrounding, SceneUtil::WorkPriority priority)
     {
         if (preloadSurrounding && cell->isExterior())
         {
@@ -1091,20 +1111,22 @@ namespace MWWorld
             {
                 for (int dy = -mHalfGridSize; dy <= mHalfGridSize; ++dy)
                 {
-                    mPreloader->preload(MWBase::Environment::get().getWorld()->getExterior(x+dx, y+dy), mRendering.getReferenceTime());
+                    mPreloader->preload(MWBase::Environment::get().getWorld()->getExterior(x+dx, y+dy), mRendering.getReferenceTime(), priority);
                     if (++numpreloaded >= mPreloader->getMaxCacheSize())
                         break;
                 }
             }
         }
         else
-            mPreloader->preload(cell, mRendering.getReferenceTime());
+            mPreloader->preload(cell, mRendering.getReferenceTime(), priority);
     }
 
     void Scene::preloadTerrain(const osg::Vec3f &pos)
     {
-        std::vector<osg::Vec3f> vec;
-        vec.push_back(pos);
+        int x, y;
+        MWBase::Environment::get().getWorld()->positionToIndex(pos.x(), pos.y(), x, y);
+        std::vector<PositionCellGrid> vec;
+        vec.push_back(PositionCellGrid {pos, gridCenterToBounds(x, y)});
         mPreloader->setTerrainPreloadPositions(vec);
     }
 
@@ -1138,7 +1160,7 @@ namespace MWWorld
         std::vector<ESM::Transport::Dest> mList;
     };
 
-    void Scene::preloadFastTravelDestinations(const osg::Vec3f& playerPos, const osg::Vec3f& /*predictedPos*/, std::vector<osg::Vec3f>& exteriorPositions) // ignore predictedPos here since opening dialogue with travel service takes extra time
+    void Scene::preloadFastTravelDestinations(const osg::Vec3f& playerPos, const osg::Vec3f& /*predictedPos*/, std::vector<PositionCellGrid>& exteriorPositions) // ignore predictedPos here since opening dialogue with travel service takes extra time
     {
         const MWWorld::ConstPtr player = MWBase::Environment::get().getWorld()->getPlayerPtr();
         ListFastTravelDestinationsVisitor listVisitor(mPreloadDistance, player.getRefData().getPosition().asVec3());
@@ -1152,14 +1174,14 @@ namespace MWWorld
         for (ESM::Transport::Dest& dest : listVisitor.mList)
         {
             if (!dest.mCellName.empty())
-                preloadCell(MWBase::Environment::get().getWorld()->getInterior(dest.mCellName));
+                preloadCell(MWBase::Environment::get().getWorld()->getInterior(dest.mCellName), false, SceneUtil::WorkPriority_Background);
             else
             {
                 osg::Vec3f pos = dest.mPos.asVec3();
                 int x,y;
                 MWBase::Environment::get().getWorld()->positionToIndex( pos.x(), pos.y(), x, y);
-                preloadCell(MWBase::Environment::get().getWorld()->getExterior(x,y), true);
-                exteriorPositions.push_back(pos);
+                preloadCell(MWBase::Environment::get().getWorld()->getExterior(x,y), true, SceneUtil::WorkPriority_Background);
+                exteriorPositions.push_back(PositionCellGrid {pos, gridCenterToBounds(x, y)});
             }
         }
     }
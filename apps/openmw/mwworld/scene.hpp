@@ -4,9 +4,14 @@
 #include "ptr.hpp"
 #include "globals.hpp"
 
+#include <osg/Vec4i>
+
 #include <set>
 #include <memory>
 #include <unordered_map>
+#include <vector>
+
+#include <components/sceneutil/workqueue.hpp>
 
 namespace osg
 {
@@ -50,6 +55,7 @@ namespace MWWorld
     class Player;
     class CellStore;
     class CellPreloader;
+    struct PositionCellGrid;
 
     enum class RotationOrder
     {
@@ -92,10 +98,16 @@ namespace MWWorld
 
             void getGridCenter(int& cellX, int& cellY);
 
+            /// Cells loaded around the given grid center as (minX, minY, maxX, maxY) with exclusive maximums
+            osg::Vec4i gridCenterToBounds(int cellX, int cellY) const;
+
+            /// Cells that will be loaded once the player is at \a pos, with the current grid while it is kept
+            osg::Vec4i getGridBoundsAt(const osg::Vec3f& pos, bool keepCurrentGrid);
+
             void preloadCells(float dt);
-            void preloadTeleportDoorDestinations(const osg::Vec3f& playerPos, const osg::Vec3f& predictedPos, std::vector<osg::Vec3f>& exteriorPositions);
+            void preloadTeleportDoorDestinations(const osg::Vec3f& playerPos, const osg::Vec3f& predictedPos, std::vector<PositionCellGrid>& exteriorPositions);
             void preloadExteriorGrid(const osg::Vec3f& playerPos, const osg::Vec3f& predictedPos);
-            void preloadFastTravelDestinations(const osg::Vec3f& playerPos, const osg::Vec3f& predictedPos, std::vector<osg::Vec3f>& exteriorPositions);
+            void preloadFastTravelDestinations(const osg::Vec3f& playerPos, const osg::Vec3f& predictedPos, std::vector<PositionCellGrid>& exteriorPositions);
 
         public:
 
@@ -104,7 +116,7 @@ namespace MWWorld
 
             ~Scene();
 
-            void preloadCell(MWWorld::CellStore* cell, bool preloadSurrounding=false);
+            void preloadCell(MWWorld::CellStore* cell, bool preloadSurrounding=false, SceneUtil::WorkPriority priority=SceneUtil::WorkPriority_Predicted);
             void preloadTerrain(const osg::Vec3f& pos);
 
             void unloadCell (CellStoreCollection::iterator iter, bool test = false);
@@ -45,6 +45,24 @@ namespace
             return x->mX < y.first;
         }
     };
+
+    template <typename T>
+    class StagedStoreRecord : public MWWorld::StagedRecord
+    {
+        T mRecord;
+        bool mIsDeleted;
+
+    public:
+        StagedStoreRecord(const T& record, bool isDeleted)
+          : mRecord(record), mIsDeleted(isDeleted)
+        { }
+
+        MWWorld::RecordId insert(MWWorld::StoreBase& store) override
+        {
+            static_cast<MWWorld::Store<T>&>(store).insertStatic(mRecord);
+            return MWWorld::RecordId(mRecord.mId, mIsDeleted);
+        }
+    };
 }
 
 namespace MWWorld
@@ -53,6 +71,11 @@ namespace MWWorld
         : mId(id), mIsDeleted(isDeleted)
     {}
 
+    std::unique_ptr<StagedRecord> StoreBase::stage(ESM::ESMReader &esm) const
+    {
+        throw std::logic_error("Records of this type can not be staged");
+    }
+
     template<typename T> 
     IndexedStore<T>::IndexedStore()
     {
@@ -206,6 +229,17 @@ namespace MWWorld
         return RecordId(record.mId, isDeleted);
     }
     template<typename T>
+    std::unique_ptr<StagedRecord> Store<T>::stage(ESM::ESMReader &esm) const
+    {
+        T record;
+        bool isDeleted = false;
+
+        record.load(esm, isDeleted);
+        Misc::StringUtils::lowerCaseInPlace(record.mId);
+
+        return std::make_unique<StagedStoreRecord<T>>(record, isDeleted);
+    }
+    template<typename T>
     void Store<T>::setUp()
     {
     }
@@ -1092,8 +1126,9 @@ namespace MWWorld
         }
         else
         {
+            // Only the ID is needed from here on, don't copy the infos loaded so far
             found->second.loadData(esm, isDeleted);
-            dialogue = found->second;
+            dialogue.mId = found->second.mId;
         }
 
         return RecordId(dialogue.mId, isDeleted);
@@ -4,6 +4,7 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <memory>
 
 #include "recordcmp.hpp"
 
@@ -27,6 +28,19 @@ namespace MWWorld
         RecordId(const std::string &id = "", bool isDeleted = false);
     };
 
+    class StoreBase;
+
+    /// A record decoded ahead of time by StoreBase::stage, waiting to be inserted in load order.
+    class StagedRecord
+    {
+    public:
+        virtual ~StagedRecord() {}
+
+        /// Insert the record into the store that decoded it.
+        /// \return Same as StoreBase::load would have returned for this record.
+        virtual RecordId insert(StoreBase& store) = 0;
+    };
+
     class StoreBase
     {
     public:
@@ -41,6 +55,10 @@ namespace MWWorld
         virtual int getDynamicSize() const { return 0; }
         virtual RecordId load(ESM::ESMReader &esm) = 0;
 
+        /// Decode a record without modifying the store. Must be thread safe, since content files
+        /// can be staged in parallel. Only supported by stores that do not merge records.
+        virtual std::unique_ptr<StagedRecord> stage(ESM::ESMReader &esm) const;
+
         virtual bool eraseStatic(const std::string &id) {return false;}
         virtual void clearDynamic() {}
 
@@ -199,6 +217,7 @@ namespace MWWorld
         bool erase(const T &item);
 
         RecordId load(ESM::ESMReader &esm);
+        std::unique_ptr<StagedRecord> stage(ESM::ESMReader &esm) const;
         void write(ESM::ESMWriter& writer, Loading::Listener& progress) const;
         RecordId read(ESM::ESMReader& reader);
     };
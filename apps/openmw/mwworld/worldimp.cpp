@@ -6,6 +6,8 @@
 #include <BulletCollision/CollisionDispatch/btCollisionWorld.h>
 #include <BulletCollision/CollisionShapes/btCompoundShape.h>
 
+#include <boost/filesystem/path.hpp>
+
 #include <components/debug/debuglog.hpp>
 
 #include <components/esm/esmreader.hpp>
@@ -23,6 +25,7 @@
 #include <components/resource/resourcesystem.hpp>
 
 #include <components/sceneutil/positionattitudetransform.hpp>
+#include <components/terrain/chunkdiskcache.hpp>
 
 #include <components/detournavigator/debug.hpp>
 #include <components/detournavigator/navigatorimpl.hpp>
@@ -99,6 +102,13 @@ namespace MWWorld
             return mLoaders.insert(std::make_pair(extension, loader)).second;
         }
 
+        void stage(const boost::filesystem::path& filepath, int index)
+        {
+            LoadersContainer::iterator it(mLoaders.find(Misc::StringUtils::lowerCase(filepath.extension().string())));
+            if (it != mLoaders.end())
+                it->second->stage(filepath, index);
+        }
+
         void load(const boost::filesystem::path& filepath, int& index)
         {
             LoadersContainer::iterator it(mLoaders.find(Misc::StringUtils::lowerCase(filepath.extension().string())));
@@ -160,7 +170,7 @@ namespace MWWorld
         const std::vector<std::string>& contentFiles,
         ToUTF8::Utf8Encoder* encoder, int activationDistanceOverride,
         const std::string& startCell, const std::string& startupScript,
-        const std::string& resourcePath, const std::string& userDataPath)
+        const std::string& resourcePath, const std::string& userDataPath, const std::string& cachePath)
     : mResourceSystem(resourceSystem), mLocalScripts (mStore),
       mSky (true), mCells (mStore, mEsm),
       mGodMode(false), mScriptsEnabled(true), mContentFiles (contentFiles), mUserDataPath(userDataPath),
@@ -174,7 +184,9 @@ namespace MWWorld
         listener->loadingOn();
 
         GameContentLoader gameContentLoader(*listener);
-        EsmLoader esmLoader(mStore, mEsm, encoder, *listener);
+        EsmLoader esmLoader(mStore, mEsm, encoder, *listener,
+            Settings::Manager::getInt("content loading threads", "General"),
+            Settings::Manager::getBool("memory mapped content files", "General"));
 
         gameContentLoader.addLoader(".esm", &esmLoader);
         gameContentLoader.addLoader(".esp", &esmLoader);
@@ -182,7 +194,8 @@ namespace MWWorld
         gameContentLoader.addLoader(".omwaddon", &esmLoader);
         gameContentLoader.addLoader(".project", &esmLoader);
 
-        loadContentFiles(fileCollections, contentFiles, gameContentLoader);
+        const std::vector<boost::filesystem::path> contentPaths
+            = loadContentFiles(fileCollections, contentFiles, gameContentLoader);
 
         listener->loadingOff();
 
@@ -204,6 +217,7 @@ namespace MWWorld
             navigatorSettings->mMaxClimb = MWPhysics::sStepSizeUp;
             navigatorSettings->mMaxSlope = MWPhysics::sMaxSlope;
             navigatorSettings->mSwimHeightScale = mSwimHeightScale;
+            navigatorSettings->mNavMeshDiskCachePath = (boost::filesystem::path(cachePath) / "navmesh").string();
             DetourNavigator::RecastGlobalAllocator::init();
             mNavigator.reset(new DetourNavigator::NavigatorImpl(*navigatorSettings));
         }
@@ -212,7 +226,25 @@ namespace MWWorld
             mNavigator.reset(new DetourNavigator::NavigatorStub());
         }
 
-        mRendering.reset(new MWRender::RenderingManager(viewer, rootNode, resourceSystem, workQueue, resourcePath, *mNavigator));
+        std::shared_ptr<Terrain::ChunkDiskCache> terrainDiskCache;
+        if (Settings::Manager::getBool("enable terrain disk cache", "Terrain"))
+        {
+            // The default texture is what ESMTerrain::Storage uses for land without textures
+            std::vector<std::string> landTextures(1, "textures/_land_default.dds");
+            const MWWorld::Store<ESM::LandTexture>& landTextureStore = mStore.get<ESM::LandTexture>();
+            for (std::size_t plugin = 0; plugin < landTextureStore.getSize(); ++plugin)
+                for (auto it = landTextureStore.begin(plugin); it != landTextureStore.end(plugin); ++it)
+                    landTextures.push_back(Misc::ResourceHelpers::correctTexturePath(it->mTexture,
+                                                                                     resourceSystem->getVFS()));
+
+            const int maxSize = Settings::Manager::getInt("max terrain disk cache size", "Terrain");
+            terrainDiskCache = std::make_shared<Terrain::ChunkDiskCache>(boost::filesystem::path(cachePath) / "terrain",
+                static_cast<std::size_t>(std::max(0, maxSize)), Terrain::ChunkDiskCache::makeContentHash(contentPaths),
+                Terrain::ChunkDiskCache::makeTexturesHash(*resourceSystem->getVFS(), landTextures));
+        }
+
+        mRendering.reset(new MWRender::RenderingManager(viewer, rootNode, resourceSystem, workQueue, resourcePath,
+            *mNavigator, terrainDiskCache, mStore, encoder));
         mProjectileManager.reset(new ProjectileManager(mRendering->getLightRoot(), resourceSystem, mRendering.get(), mPhysics.get()));
         mRendering->preloadCommonAssets();
 
@@ -400,11 +432,24 @@ namespace MWWorld
                 reader.getHNT(mTeleportEnabled, "TELE");
                 reader.getHNT(mLevitationEnabled, "LEVT");
                 return;
+            case ESM::REC_CSTA:
+                if (CellStore* cellStore = mCells.readCellState(reader, contentFileMap))
+                {
+                    // The terrain chunks read the objects from the content files
+                    if (cellStore->isExterior())
+                        cellStore->forEachConst([this] (const ConstPtr& ptr)
+                        {
+                            if (ptr.getRefData().hasChanged() || ptr.getCellRef().hasChanged())
+                                mRendering->pagingBlacklistObject(ptr);
+                            return true;
+                        });
+                }
+                break;
             case ESM::REC_PLAY:
                 mPlayer->readRecord(reader, type);
                 if (getPlayerPtr().isInCell())
                 {
-                    mWorldScene->preloadCell(getPlayerPtr().getCell(), true);
+                    mWorldScene->preloadCell(getPlayerPtr().getCell(), true, SceneUtil::WorkPriority_Immediate);
                     if (getPlayerPtr().getCell()->isExterior())
                         mWorldScene->preloadTerrain(getPlayerPtr().getRefData().getPosition().asVec3());
                 }
@@ -861,6 +906,7 @@ namespace MWWorld
                 throw std::runtime_error("can not disable player object");
 
             reference.getRefData().disable();
+            mRendering->pagingBlacklistObject(reference);
 
             if(mWorldScene->getActiveCells().find (reference.getCell())!=mWorldScene->getActiveCells().end() && reference.getRefData().getCount())
                 mWorldScene->removeObjectFromScene (reference);
@@ -1179,6 +1225,7 @@ namespace MWWorld
                 throw std::runtime_error("can not delete player object");
 
             ptr.getRefData().setCount(0);
+            mRendering->pagingBlacklistObject(ptr);
 
             if (ptr.isInCell()
                 && mWorldScene->getActiveCells().find(ptr.getCell()) != mWorldScene->getActiveCells().end()
@@ -1212,6 +1259,8 @@ namespace MWWorld
 
     MWWorld::Ptr World::moveObject(const Ptr &ptr, CellStore* newCell, float x, float y, float z, bool movePhysics)
     {
+        unpageObject(ptr);
+
         ESM::Position pos = ptr.getRefData().getPosition();
 
         pos.pos[0] = x;
@@ -1346,6 +1395,9 @@ namespace MWWorld
 
     void World::scaleObject (const Ptr& ptr, float scale)
     {
+        if (scale != ptr.getCellRef().getScale())
+            unpageObject(ptr);
+
         if (mPhysics->getActor(ptr))
             mNavigator->removeAgent(getPathfindingHalfExtents(ptr));
 
@@ -1361,6 +1413,8 @@ namespace MWWorld
 
     void World::rotateObjectImp(const Ptr& ptr, const osg::Vec3f& rot, MWBase::RotationFlags flags)
     {
+        unpageObject(ptr);
+
         const float pi = static_cast<float>(osg::PI);
 
         ESM::Position pos = ptr.getRefData().getPosition();
@@ -1406,6 +1460,19 @@ namespace MWWorld
         }
     }
 
+    void World::unpageObject(const Ptr& ptr)
+    {
+        const bool paged = mRendering->isPagedObject(ptr);
+        if (!mRendering->pagingBlacklistObject(ptr) || !paged)
+            return;
+
+        if (ptr.getRefData().getBaseNode() && mWorldScene->isCellActive(*ptr.getCell()))
+        {
+            mWorldScene->removeObjectFromScene(ptr);
+            mWorldScene->addObjectToScene(ptr);
+        }
+    }
+
     void World::adjustPosition(const Ptr &ptr, bool force)
     {
         osg::Vec3f pos (ptr.getRefData().getPosition().asVec3());
@@ -1895,6 +1962,17 @@ namespace MWWorld
         }
     }
 
+    void World::startAsyncPhysics()
+    {
+        mPhysics->startAsyncMovement();
+    }
+
+    void World::finishAsyncPhysics(osg::Timer_t startTick, unsigned int frameNumber, osg::Stats& stats)
+    {
+        mPhysics->waitForAsyncMovement();
+        mPhysics->reportStats(startTick, frameNumber, stats);
+    }
+
     void World::updatePlayer()
     {
         MWWorld::Ptr player = getPlayerPtr();
@@ -2775,6 +2853,11 @@ namespace MWWorld
         return mPhysics->getLineOfSight(actor, targetActor);
     }
 
+    void World::prefetchLOS(const std::vector<std::pair<MWWorld::ConstPtr, MWWorld::ConstPtr>>& pairs)
+    {
+        mPhysics->prefetchLinesOfSight(pairs);
+    }
+
     float World::getDistToNearestRayHit(const osg::Vec3f& from, const osg::Vec3f& dir, float maxDist, bool includeWater)
     {
         osg::Vec3f to (dir);
@@ -2958,25 +3041,37 @@ namespace MWWorld
         return mScriptsEnabled;
     }
 
-    void World::loadContentFiles(const Files::Collections& fileCollections,
+    std::vector<boost::filesystem::path> World::loadContentFiles(const Files::Collections& fileCollections,
         const std::vector<std::string>& content, ContentLoader& contentLoader)
     {
-        int idx = 0;
+        std::vector<boost::filesystem::path> paths;
+        paths.reserve(content.size());
         for (const std::string &file : content)
         {
             boost::filesystem::path filename(file);
             const Files::MultiDirCollection& col = fileCollections.getCollection(filename.extension().string());
             if (col.doesExist(file))
             {
-                contentLoader.load(col.getPath(file), idx);
+                paths.push_back(col.getPath(file));
             }
             else
             {
                 std::string message = "Failed loading " + file + ": the content file does not exist";
                 throw std::runtime_error(message);
             }
+        }
+
+        for (std::size_t i = 0; i < paths.size(); ++i)
+            contentLoader.stage(paths[i], static_cast<int>(i));
+
+        int idx = 0;
+        for (const boost::filesystem::path &path : paths)
+        {
+            contentLoader.load(path, idx);
             idx++;
         }
+
+        return paths;
     }
 
     bool World::startSpellCast(const Ptr &actor)
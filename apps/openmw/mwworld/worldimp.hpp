@@ -3,6 +3,8 @@
 
 #include <osg/ref_ptr>
 
+#include <boost/filesystem/path.hpp>
+
 #include <components/settings/settings.hpp>
 #include <components/fallback/fallback.hpp>
 
@@ -128,6 +130,9 @@ namespace MWWorld
 
             void rotateObjectImp (const Ptr& ptr, const osg::Vec3f& rot, MWBase::RotationFlags flags);
 
+            void unpageObject (const Ptr& ptr);
+            ///< Render the object on its own instead of by the terrain chunks, call before it is transformed
+
             Ptr moveObjectImp (const Ptr& ptr, float x, float y, float z, bool movePhysics=true, bool moveToActive=false);
             ///< @return an updated Ptr in case the Ptr's cell changes
 
@@ -167,8 +172,9 @@ namespace MWWorld
              * @param fileCollections- Container which holds content file names and their paths
              * @param content - Container which holds content file names
              * @param contentLoader -
+             * @return paths of the loaded content files
              */
-            void loadContentFiles(const Files::Collections& fileCollections,
+            std::vector<boost::filesystem::path> loadContentFiles(const Files::Collections& fileCollections,
                 const std::vector<std::string>& content, ContentLoader& contentLoader);
 
             float mSwimHeightScale;
@@ -200,7 +206,7 @@ namespace MWWorld
                 const std::vector<std::string>& contentFiles,
                 ToUTF8::Utf8Encoder* encoder, int activationDistanceOverride,
                 const std::string& startCell, const std::string& startupScript,
-                const std::string& resourcePath, const std::string& userDataPath);
+                const std::string& resourcePath, const std::string& userDataPath, const std::string& cachePath);
 
             virtual ~World();
 
@@ -491,6 +497,12 @@ namespace MWWorld
             void update (float duration, bool paused) override;
             void updatePhysics (float duration, bool paused) override;
 
+            void startAsyncPhysics () override;
+            ///< Start the physics work that may overlap with rendering the frame.
+
+            void finishAsyncPhysics (osg::Timer_t startTick, unsigned int frameNumber, osg::Stats& stats) override;
+            ///< Wait for the physics work started by startAsyncPhysics and report its timing.
+
             void updateWindowManager () override;
 
             MWWorld::Ptr placeObject (const MWWorld::ConstPtr& object, float cursorX, float cursorY, int amount) override;
@@ -572,6 +584,10 @@ namespace MWWorld
             bool getLOS(const MWWorld::ConstPtr& actor,const MWWorld::ConstPtr& targetActor) override;
             ///< get Line of Sight (morrowind stupid implementation)
 
+            void prefetchLOS(const std::vector<std::pair<MWWorld::ConstPtr, MWWorld::ConstPtr>>& pairs) override;
+            ///< Compute the line of sight of several pairs of actors at once, if worthwhile. The following getLOS calls
+            /// for these pairs in this frame are then cheap.
+
             float getDistToNearestRayHit(const osg::Vec3f& from, const osg::Vec3f& dir, float maxDist, bool includeWater = false) override;
 
             void enableActorCollision(const MWWorld::Ptr& actor, bool enable) override;
@@ -0,0 +1,83 @@
+#include <components/detournavigator/asyncnavmeshupdater.hpp>
+#include <components/detournavigator/makenavmesh.hpp>
+#include <components/detournavigator/settings.hpp>
+
+#include <osg/Stats>
+
+#include <gtest/gtest.h>
+
+namespace
+{
+    using namespace testing;
+    using namespace DetourNavigator;
+
+    struct DetourNavigatorAsyncNavMeshUpdaterTest : Test
+    {
+        Settings mSettings;
+        osg::Vec3f mAgentHalfExtents {29, 29, 66};
+        osg::ref_ptr<osg::Stats> mStats {new osg::Stats("test")};
+
+        DetourNavigatorAsyncNavMeshUpdaterTest()
+        {
+            mSettings.mBorderSize = 16;
+            mSettings.mCellHeight = 0.2f;
+            mSettings.mCellSize = 0.2f;
+            mSettings.mRecastScaleFactor = 0.017647058823529415f;
+            mSettings.mTileSize = 64;
+            mSettings.mTrianglesPerChunk = 256;
+            mSettings.mMaxPolys = 4096;
+            mSettings.mMaxTilesNumber = 512;
+            mSettings.mMaxNavMeshTilesCacheSize = 1024 * 1024;
+            mSettings.mAsyncNavMeshUpdaterThreads = 0;
+        }
+
+        double getStat(AsyncNavMeshUpdater& updater, const std::string& name)
+        {
+            updater.reportStats(0, *mStats);
+            double value = -1;
+            mStats->getAttribute(0, name, value);
+            return value;
+        }
+    };
+
+    TEST_F(DetourNavigatorAsyncNavMeshUpdaterTest, post_for_waiting_tile_should_merge_jobs)
+    {
+        TileCachedRecastMeshManager recastMeshManager(mSettings);
+        OffMeshConnectionsManager offMeshConnectionsManager(mSettings);
+        AsyncNavMeshUpdater updater(mSettings, recastMeshManager, offMeshConnectionsManager);
+        const auto navMeshCacheItem = std::make_shared<GuardedNavMeshCacheItem>(makeEmptyNavMesh(mSettings), 1);
+        const TilePosition playerTile(0, 0);
+        updater.post(mAgentHalfExtents, navMeshCacheItem, playerTile, {{TilePosition(0, 0), ChangeType::add}});
+        updater.post(mAgentHalfExtents, navMeshCacheItem, playerTile, {{TilePosition(0, 0), ChangeType::update}});
+        updater.post(mAgentHalfExtents, navMeshCacheItem, playerTile, {{TilePosition(1, 0), ChangeType::add}});
+        EXPECT_EQ(getStat(updater, "NavMesh UpdateJobs"), 2);
+        EXPECT_EQ(getStat(updater, "NavMesh CoalescedJobs"), 1);
+    }
+
+    TEST_F(DetourNavigatorAsyncNavMeshUpdaterTest, post_with_far_player_tile_should_evict_jobs_out_of_range)
+    {
+        TileCachedRecastMeshManager recastMeshManager(mSettings);
+        OffMeshConnectionsManager offMeshConnectionsManager(mSettings);
+        AsyncNavMeshUpdater updater(mSettings, recastMeshManager, offMeshConnectionsManager);
+        const auto navMeshCacheItem = std::make_shared<GuardedNavMeshCacheItem>(makeEmptyNavMesh(mSettings), 1);
+        updater.post(mAgentHalfExtents, navMeshCacheItem, TilePosition(0, 0),
+                     {{TilePosition(0, 0), ChangeType::add}, {TilePosition(100, 100), ChangeType::add}});
+        updater.post(mAgentHalfExtents, navMeshCacheItem, TilePosition(100, 101), {});
+        EXPECT_EQ(getStat(updater, "NavMesh UpdateJobs"), 1);
+        EXPECT_EQ(getStat(updater, "NavMesh EvictedJobs"), 1);
+    }
+
+    TEST_F(DetourNavigatorAsyncNavMeshUpdaterTest, post_for_expired_nav_mesh_should_evict_its_jobs)
+    {
+        TileCachedRecastMeshManager recastMeshManager(mSettings);
+        OffMeshConnectionsManager offMeshConnectionsManager(mSettings);
+        AsyncNavMeshUpdater updater(mSettings, recastMeshManager, offMeshConnectionsManager);
+        auto expired = std::make_shared<GuardedNavMeshCacheItem>(makeEmptyNavMesh(mSettings), 1);
+        updater.post(mAgentHalfExtents, expired, TilePosition(0, 0), {{TilePosition(0, 0), ChangeType::add}});
+        expired.reset();
+        const auto navMeshCacheItem = std::make_shared<GuardedNavMeshCacheItem>(makeEmptyNavMesh(mSettings), 2);
+        updater.post(mAgentHalfExtents, navMeshCacheItem, TilePosition(0, 1), {});
+        EXPECT_EQ(getStat(updater, "NavMesh UpdateJobs"), 0);
+        EXPECT_EQ(getStat(updater, "NavMesh EvictedJobs"), 1);
+    }
+}
@@ -2,6 +2,8 @@
 
 #include <components/detournavigator/navigatorimpl.hpp>
 #include <components/detournavigator/exceptions.hpp>
+#include <components/detournavigator/findsmoothpath.hpp>
+#include <components/detournavigator/settingsutils.hpp>
 #include <components/misc/rng.hpp>
 
 #include <BulletCollision/CollisionShapes/btHeightfieldTerrainShape.h>
@@ -146,6 +148,35 @@ namespace
         ));
     }
 
+    TEST_F(DetourNavigatorNavigatorTest, update_then_find_path_over_many_tiles_should_return_path_to_end)
+    {
+        const std::array<btScalar, 5 * 5> heightfieldData {{
+            0, 0, 0, 0, 0,
+            0, 0, 0, 0, 0,
+            0, 0, 0, 0, 0,
+            0, 0, 0, 0, 0,
+            0, 0, 0, 0, 0,
+        }};
+        btHeightfieldTerrainShape shape(5, 5, heightfieldData.data(), 1, 0, 0, 2, PHY_FLOAT, false);
+        shape.setLocalScaling(btVector3(2048, 2048, 1));
+
+        mNavigator->addAgent(mAgentHalfExtents);
+        mNavigator->addObject(ObjectId(&shape), shape, btTransform::getIdentity());
+        mNavigator->update(mPlayerPosition);
+        mNavigator->wait();
+
+        const osg::Vec3f start(-3000, 3000, 0);
+        const osg::Vec3f end(3000, -3000, 0);
+
+        EXPECT_EQ(mNavigator->findPath(mAgentHalfExtents, mStepSize, start, end, Flag_walk, mOut), Status::Success);
+
+        ASSERT_FALSE(mPath.empty());
+        EXPECT_NEAR(mPath.front().x(), start.x(), 1);
+        EXPECT_NEAR(mPath.front().y(), start.y(), 1);
+        EXPECT_NEAR(mPath.back().x(), end.x(), 1);
+        EXPECT_NEAR(mPath.back().y(), end.y(), 1);
+    }
+
     TEST_F(DetourNavigatorNavigatorTest, add_object_should_change_navmesh)
     {
         const std::array<btScalar, 5 * 5> heightfieldData {{
@@ -672,6 +703,74 @@ namespace
         ));
     }
 
+    TEST_F(DetourNavigatorNavigatorTest, remove_object_then_update_with_far_player_should_remove_tiles)
+    {
+        const std::array<btScalar, 5 * 5> heightfieldData {{
+            0,   0,    0,    0,    0,
+            0, -25,  -25,  -25,  -25,
+            0, -25, -100, -100, -100,
+            0, -25, -100, -100, -100,
+            0, -25, -100, -100, -100,
+        }};
+        btHeightfieldTerrainShape shape(5, 5, heightfieldData.data(), 1, 0, 0, 2, PHY_FLOAT, false);
+        shape.setLocalScaling(btVector3(128, 128, 1));
+
+        const auto countTiles = [&]
+        {
+            const auto locked = mNavigator->getNavMesh(mAgentHalfExtents)->lockConst();
+            const dtNavMesh& navMesh = locked->getImpl();
+            int result = 0;
+            for (int i = 0; i < navMesh.getMaxTiles(); ++i)
+                if (navMesh.getTile(i)->header != nullptr)
+                    ++result;
+            return result;
+        };
+
+        mNavigator->addAgent(mAgentHalfExtents);
+        mNavigator->addObject(ObjectId(&shape), shape, btTransform::getIdentity());
+        mNavigator->update(mPlayerPosition);
+        mNavigator->wait();
+        ASSERT_GT(countTiles(), 0);
+
+        // The cell is unloaded while the player moves away, the removal jobs are still queued on the second update
+        mNavigator->removeObject(ObjectId(&shape));
+        mNavigator->update(mPlayerPosition);
+        mNavigator->update(osg::Vec3f(1e5f, 1e5f, 0));
+        mNavigator->wait();
+
+        EXPECT_EQ(countTiles(), 0);
+    }
+
+    TEST_F(DetourNavigatorNavigatorTest, find_path_to_unreachable_end_over_many_tiles_should_succeed_with_partial_path)
+    {
+        const std::array<btScalar, 5 * 5> heightfieldData {{
+            0, 0, 0, 0, 0,
+            0, 0, 0, 0, 0,
+            0, 0, 0, 0, 0,
+            0, 0, 0, 0, 0,
+            0, 0, 0, 0, 0,
+        }};
+        btHeightfieldTerrainShape startShape(5, 5, heightfieldData.data(), 1, 0, 0, 2, PHY_FLOAT, false);
+        startShape.setLocalScaling(btVector3(128, 128, 1));
+        btHeightfieldTerrainShape endShape(5, 5, heightfieldData.data(), 1, 0, 0, 2, PHY_FLOAT, false);
+        endShape.setLocalScaling(btVector3(128, 128, 1));
+
+        // Islands more than maxPortalsPerPathQuery tiles apart, so the tile graph is searched first and finds no route
+        const btTransform endTransform(btMatrix3x3::getIdentity(), btVector3(5000, 0, 0));
+        ASSERT_GT(std::abs(getTilePosition(mSettings, toNavMeshCoordinates(mSettings, osg::Vec3f(5000, 0, 0))).x()
+                           - getTilePosition(mSettings, toNavMeshCoordinates(mSettings, osg::Vec3f(0, 0, 0))).x()),
+                  static_cast<int>(maxPortalsPerPathQuery));
+
+        mNavigator->addAgent(mAgentHalfExtents);
+        mNavigator->addObject(ObjectId(&startShape), startShape, btTransform::getIdentity());
+        mNavigator->addObject(ObjectId(&endShape), endShape, endTransform);
+        mNavigator->update(mPlayerPosition);
+        mNavigator->wait();
+
+        EXPECT_EQ(mNavigator->findPath(mAgentHalfExtents, mStepSize, osg::Vec3f(0, 0, 1), osg::Vec3f(5000, 0, 1),
+                                       Flag_walk, mOut), Status::Success);
+    }
+
     TEST_F(DetourNavigatorNavigatorTest, update_then_find_random_point_around_circle_should_return_position)
     {
         const std::array<btScalar, 5 * 5> heightfieldData {{
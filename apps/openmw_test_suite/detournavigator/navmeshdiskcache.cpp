@@ -0,0 +1,133 @@
+#include "../tempdirectory.hpp"
+
+#include <components/detournavigator/navmeshdiskcache.hpp>
+#include <components/detournavigator/recastmesh.hpp>
+#include <components/detournavigator/settings.hpp>
+
+#include <DetourNavMesh.h>
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+
+namespace
+{
+    using namespace testing;
+    using namespace DetourNavigator;
+
+    struct DetourNavigatorNavMeshDiskCacheTest : TestingOpenMW::TempDirectoryTest
+    {
+        const osg::Vec3f mAgentHalfExtents {1, 2, 3};
+        const TilePosition mTilePosition {1, 2};
+        const std::size_t mGeneration = 0;
+        const std::size_t mRevision = 0;
+        const std::vector<int> mIndices {{0, 1, 2}};
+        const std::vector<float> mVertices {{0, 0, 0, 1, 0, 0, 1, 1, 0}};
+        const std::vector<AreaType> mAreaTypes {1, AreaType_ground};
+        const std::vector<RecastMesh::Water> mWater {};
+        const std::size_t mTrianglesPerChunk {1};
+        const RecastMesh mRecastMesh {mGeneration, mRevision, mIndices, mVertices,
+                                      mAreaTypes, mWater, mTrianglesPerChunk};
+        const std::vector<OffMeshConnection> mOffMeshConnections {};
+        const std::size_t mMaxSize = 1024 * 1024;
+        Settings mSettings;
+
+        DetourNavigatorNavMeshDiskCacheTest()
+        {
+            mSettings.mCellSize = 0.2f;
+            mSettings.mTileSize = 64;
+        }
+
+        NavMeshData makeTileData(const TilePosition& tilePosition, int size = sizeof(dtMeshHeader) + 64)
+        {
+            NavMeshData result(static_cast<unsigned char*>(dtAlloc(static_cast<std::size_t>(size), DT_ALLOC_PERM)),
+                               size);
+            for (int i = 0; i < size; ++i)
+                result.mValue.get()[i] = static_cast<unsigned char>(i);
+            dtMeshHeader header {};
+            header.magic = DT_NAVMESH_MAGIC;
+            header.version = DT_NAVMESH_VERSION;
+            header.x = tilePosition.x();
+            header.y = tilePosition.y();
+            std::memcpy(result.mValue.get(), &header, sizeof(header));
+            return result;
+        }
+
+        void set(NavMeshDiskCache& cache, const TilePosition& tilePosition, const NavMeshData& data)
+        {
+            cache.set(mAgentHalfExtents, tilePosition, mRecastMesh, mOffMeshConnections, data.mValue.get(),
+                      data.mSize);
+        }
+
+        NavMeshData get(NavMeshDiskCache& cache, const TilePosition& tilePosition)
+        {
+            return cache.get(mAgentHalfExtents, tilePosition, mRecastMesh, mOffMeshConnections);
+        }
+
+        static bool isEqual(const NavMeshData& lhs, const NavMeshData& rhs)
+        {
+            return lhs.mSize == rhs.mSize && std::memcmp(lhs.mValue.get(), rhs.mValue.get(), lhs.mSize) == 0;
+        }
+    };
+
+    TEST_F(DetourNavigatorNavMeshDiskCacheTest, get_for_empty_cache_should_return_empty_value)
+    {
+        NavMeshDiskCache cache(mPath, mMaxSize, mSettings);
+        EXPECT_FALSE(get(cache, mTilePosition).mValue);
+        EXPECT_EQ(cache.getSize(), 0u);
+    }
+
+    TEST_F(DetourNavigatorNavMeshDiskCacheTest, get_after_set_should_return_stored_value)
+    {
+        NavMeshDiskCache cache(mPath, mMaxSize, mSettings);
+        const auto data = makeTileData(mTilePosition);
+        set(cache, mTilePosition, data);
+        const auto result = get(cache, mTilePosition);
+        ASSERT_TRUE(result.mValue);
+        EXPECT_NE(result.mValue.get(), data.mValue.get());
+        EXPECT_TRUE(isEqual(result, data));
+        EXPECT_GT(cache.getSize(), static_cast<std::size_t>(data.mSize));
+    }
+
+    TEST_F(DetourNavigatorNavMeshDiskCacheTest, get_for_other_recast_mesh_should_return_empty_value)
+    {
+        NavMeshDiskCache cache(mPath, mMaxSize, mSettings);
+        set(cache, mTilePosition, makeTileData(mTilePosition));
+        const std::vector<float> vertices {{0, 0, 0, 1, 0, 0, 1, 1, 1}};
+        const RecastMesh recastMesh {mGeneration, mRevision, mIndices, vertices, mAreaTypes, mWater,
+                                     mTrianglesPerChunk};
+        EXPECT_FALSE(cache.get(mAgentHalfExtents, mTilePosition, recastMesh, mOffMeshConnections).mValue);
+        EXPECT_FALSE(cache.get(osg::Vec3f(1, 1, 1), mTilePosition, mRecastMesh, mOffMeshConnections).mValue);
+        EXPECT_FALSE(get(cache, TilePosition(0, 0)).mValue);
+    }
+
+    TEST_F(DetourNavigatorNavMeshDiskCacheTest, get_for_same_triangles_in_other_order_should_return_stored_value)
+    {
+        const std::vector<int> indices {{0, 1, 2, 3, 4, 5}};
+        const std::vector<float> vertices {{0, 0, 0, 1, 0, 0, 1, 1, 0, 0, 0, 1, 1, 0, 1, 1, 1, 1}};
+        const std::vector<AreaType> areaTypes {AreaType_ground, AreaType_null};
+        const RecastMesh recastMesh {mGeneration, mRevision, indices, vertices, areaTypes, mWater,
+                                     mTrianglesPerChunk};
+        const std::vector<float> reorderedVertices {{0, 0, 1, 1, 0, 1, 1, 1, 1, 0, 0, 0, 1, 0, 0, 1, 1, 0}};
+        const std::vector<AreaType> reorderedAreaTypes {AreaType_null, AreaType_ground};
+        const RecastMesh reorderedRecastMesh {mGeneration, mRevision, indices, reorderedVertices,
+                                              reorderedAreaTypes, mWater, mTrianglesPerChunk};
+        NavMeshDiskCache cache(mPath, mMaxSize, mSettings);
+        const auto data = makeTileData(mTilePosition);
+        cache.set(mAgentHalfExtents, mTilePosition, recastMesh, mOffMeshConnections, data.mValue.get(), data.mSize);
+        const auto result = cache.get(mAgentHalfExtents, mTilePosition, reorderedRecastMesh, mOffMeshConnections);
+        ASSERT_TRUE(result.mValue);
+        EXPECT_TRUE(isEqual(result, data));
+    }
+
+    TEST_F(DetourNavigatorNavMeshDiskCacheTest, get_for_other_settings_should_return_empty_value)
+    {
+        {
+            NavMeshDiskCache cache(mPath, mMaxSize, mSettings);
+            set(cache, mTilePosition, makeTileData(mTilePosition));
+        }
+        mSettings.mCellSize = 0.1f;
+        NavMeshDiskCache cache(mPath, mMaxSize, mSettings);
+        EXPECT_FALSE(get(cache, mTilePosition).mValue);
+    }
+}
@@ -413,4 +413,44 @@ namespace
             RecastMesh::Water {1000, btTransform(btMatrix3x3::getIdentity(), btVector3(100, 200, 300))}
         }));
     }
+
+    TEST_F(DetourNavigatorRecastMeshBuilderTest, add_released_triangles_should_offset_indices)
+    {
+        btTriangleMesh mesh;
+        mesh.addTriangle(btVector3(-1, -1, 0), btVector3(-1, 1, 0), btVector3(1, -1, 0));
+        btBvhTriangleMeshShape shape(&mesh, true);
+
+        RecastMeshBuilder objectBuilder(mSettings, mBounds);
+        objectBuilder.addObject(static_cast<const btCollisionShape&>(shape), btTransform::getIdentity(), AreaType_ground);
+        const auto triangles = objectBuilder.releaseTriangles();
+
+        RecastMeshBuilder builder(mSettings, mBounds);
+        builder.addTriangles(triangles);
+        builder.addTriangles(triangles);
+        const auto recastMesh = builder.create(mGeneration, mRevision);
+        EXPECT_EQ(recastMesh->getVertices(), std::vector<float>({
+            1, 0, -1,
+            -1, 0, 1,
+            -1, 0, -1,
+            1, 0, -1,
+            -1, 0, 1,
+            -1, 0, -1,
+        }));
+        EXPECT_EQ(recastMesh->getIndices(), std::vector<int>({0, 1, 2, 3, 4, 5}));
+        EXPECT_EQ(recastMesh->getAreaTypes(), std::vector<AreaType>({AreaType_ground, AreaType_ground}));
+        EXPECT_EQ(objectBuilder.create(mGeneration, mRevision)->getIndices(), std::vector<int>());
+    }
+
+    TEST_F(DetourNavigatorRecastMeshBuilderTest, is_same_voxels_should_ignore_moves_less_than_half_voxel)
+    {
+        mSettings.mCellSize = 0.2f;
+        mSettings.mCellHeight = 0.2f;
+        const RecastMeshTriangles triangles {{0, 1, 2}, {0, 0, 0, 1, 0, 0, 0, 0, 1}, {AreaType_ground}};
+        RecastMeshTriangles moved = triangles;
+        for (auto& v : moved.mVertices)
+            v += 0.05f;
+        EXPECT_TRUE(isSameVoxels(triangles, moved, mSettings));
+        moved.mVertices[4] += 0.1f;
+        EXPECT_FALSE(isSameVoxels(triangles, moved, mSettings));
+    }
 }
@@ -96,6 +96,34 @@ namespace
         );
     }
 
+    TEST_F(DetourNavigatorTileCachedRecastMeshManagerTest, update_object_for_object_moved_less_than_half_voxel_should_return_empty)
+    {
+        mSettings.mCellHeight = 0.2f;
+        TileCachedRecastMeshManager manager(mSettings);
+        const btBoxShape boxShape(btVector3(20, 20, 100));
+        manager.addObject(ObjectId(&boxShape), boxShape, btTransform::getIdentity(), AreaType::AreaType_ground);
+        const btTransform moved(btMatrix3x3::getIdentity(), btVector3(1, 1, 1));
+        EXPECT_EQ(
+            manager.updateObject(ObjectId(&boxShape), boxShape, moved, AreaType::AreaType_ground),
+            std::vector<TilePosition>()
+        );
+    }
+
+    TEST_F(DetourNavigatorTileCachedRecastMeshManagerTest, update_object_for_object_moved_by_small_steps_should_return_changed_tiles_when_they_add_up)
+    {
+        mSettings.mCellHeight = 0.2f;
+        TileCachedRecastMeshManager manager(mSettings);
+        const btBoxShape boxShape(btVector3(20, 20, 100));
+        manager.addObject(ObjectId(&boxShape), boxShape, btTransform::getIdentity(), AreaType::AreaType_ground);
+        manager.updateObject(ObjectId(&boxShape), boxShape, btTransform(btMatrix3x3::getIdentity(), btVector3(0, 0, 3)),
+                             AreaType::AreaType_ground);
+        EXPECT_THAT(
+            manager.updateObject(ObjectId(&boxShape), boxShape, btTransform(btMatrix3x3::getIdentity(), btVector3(0, 0, 6)),
+                                 AreaType::AreaType_ground),
+            ElementsAre(TilePosition(-1, -1), TilePosition(-1, 0), TilePosition(0, -1), TilePosition(0, 0))
+        );
+    }
+
     TEST_F(DetourNavigatorTileCachedRecastMeshManagerTest, get_mesh_after_add_object_should_return_recast_mesh_for_each_used_tile)
     {
         TileCachedRecastMeshManager manager(mSettings);
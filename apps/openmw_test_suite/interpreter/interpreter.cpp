@@ -0,0 +1,192 @@
+#include <components/compiler/context.hpp>
+#include <components/compiler/exception.hpp>
+#include <components/compiler/extensions.hpp>
+#include <components/compiler/fileparser.hpp>
+#include <components/compiler/scanner.hpp>
+#include <components/compiler/streamerrorhandler.hpp>
+#include <components/interpreter/context.hpp>
+#include <components/interpreter/installopcodes.hpp>
+#include <components/interpreter/interpreter.hpp>
+
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <stdexcept>
+
+namespace
+{
+    using namespace testing;
+
+    struct CompilerContext : Compiler::Context
+    {
+        bool canDeclareLocals() const override { return true; }
+        char getGlobalType(const std::string&) const override { return ' '; }
+        std::pair<char, bool> getMemberType(const std::string&, const std::string&) const override { return {' ', false}; }
+        bool isId(const std::string&) const override { return false; }
+        bool isJournalId(const std::string&) const override { return false; }
+    };
+
+    /// Only supports local variables, which is all the tests need
+    struct InterpreterContext : Interpreter::Context
+    {
+        std::vector<int> mShorts = std::vector<int>(8, 0);
+        std::vector<int> mLongs = std::vector<int>(8, 0);
+        std::vector<float> mFloats = std::vector<float>(8, 0);
+
+        int getLocalShort(int index) const override { return mShorts.at(index); }
+        int getLocalLong(int index) const override { return mLongs.at(index); }
+        float getLocalFloat(int index) const override { return mFloats.at(index); }
+        void setLocalShort(int index, int value) override { mShorts.at(index) = value; }
+        void setLocalLong(int index, int value) override { mLongs.at(index) = value; }
+        void setLocalFloat(int index, float value) override { mFloats.at(index) = value; }
+        void messageBox(const std::string&, const std::vector<std::string>&) override { unsupported(); }
+        void report(const std::string&) override { unsupported(); }
+        bool menuMode() override { unsupported(); }
+        int getGlobalShort(const std::string&) const override { unsupported(); }
+        int getGlobalLong(const std::string&) const override { unsupported(); }
+        float getGlobalFloat(const std::string&) const override { unsupported(); }
+        void setGlobalShort(const std::string&, int) override { unsupported(); }
+        void setGlobalLong(const std::string&, int) override { unsupported(); }
+        void setGlobalFloat(const std::string&, float) override { unsupported(); }
+        std::vector<std::string> getGlobals() const override { unsupported(); }
+        char getGlobalType(const std::string&) const override { unsupported(); }
+        std::string getActionBinding(const std::string&) const override { unsupported(); }
+        std::string getActorName() const override { unsupported(); }
+        std::string getNPCRace() const override { unsupported(); }
+        std::string getNPCClass() const override { unsupported(); }
+        std::string getNPCFaction() const override { unsupported(); }
+        std::string getNPCRank() const override { unsupported(); }
+        std::string getPCName() const override { unsupported(); }
+        std::string getPCRace() const override { unsupported(); }
+        std::string getPCClass() const override { unsupported(); }
+        std::string getPCRank() const override { unsupported(); }
+        std::string getPCNextRank() const override { unsupported(); }
+        int getPCBounty() const override { unsupported(); }
+        std::string getCurrentCellName() const override { unsupported(); }
+        bool isScriptRunning(const std::string&) const override { unsupported(); }
+        void startScript(const std::string&, const std::string&) override { unsupported(); }
+        void stopScript(const std::string&) override { unsupported(); }
+        float getDistance(const std::string&, const std::string&) const override { unsupported(); }
+        float getSecondsPassed() const override { unsupported(); }
+        bool isDisabled(const std::string&) const override { unsupported(); }
+        void enable(const std::string&) override { unsupported(); }
+        void disable(const std::string&) override { unsupported(); }
+        int getMemberShort(const std::string&, const std::string&, bool) const override { unsupported(); }
+        int getMemberLong(const std::string&, const std::string&, bool) const override { unsupported(); }
+        float getMemberFloat(const std::string&, const std::string&, bool) const override { unsupported(); }
+        void setMemberShort(const std::string&, const std::string&, int, bool) override { unsupported(); }
+        void setMemberLong(const std::string&, const std::string&, int, bool) override { unsupported(); }
+        void setMemberFloat(const std::string&, const std::string&, float, bool) override { unsupported(); }
+        std::string getTargetId() const override { unsupported(); }
+
+        [[noreturn]] static void unsupported()
+        {
+            throw std::logic_error("unsupported in test");
+        }
+    };
+
+    struct InterpreterTest : Test
+    {
+        CompilerContext mCompilerContext;
+        Compiler::Extensions mExtensions;
+        Compiler::StreamErrorHandler mErrorHandler;
+        Interpreter::Interpreter mInterpreter;
+
+        InterpreterTest()
+        {
+            mCompilerContext.setExtensions(&mExtensions);
+            Interpreter::installOpcodes(mInterpreter);
+        }
+
+        std::vector<Interpreter::Type_Code> compile(const std::string& text)
+        {
+            Compiler::FileParser parser(mErrorHandler, mCompilerContext);
+            std::istringstream input(text);
+            Compiler::Scanner scanner(mErrorHandler, input, &mExtensions);
+            scanner.scan(parser);
+            EXPECT_TRUE(mErrorHandler.isGood());
+            std::vector<Interpreter::Type_Code> code;
+            parser.getCode(code);
+            return code;
+        }
+
+        InterpreterContext run(const std::vector<Interpreter::Type_Code>& code, bool superinstructions)
+        {
+            InterpreterContext context;
+            const Interpreter::Program program = mInterpreter.decode(code.data(), static_cast<int>(code.size()),
+                superinstructions);
+            mInterpreter.run(program, context);
+            return context;
+        }
+    };
+
+    const std::string sConditionsScript = R"(
+        Begin conditions
+            short a
+            long b
+            float c
+            short i
+
+            set b to 3
+            set c to 2.5
+            while ( i < 10 )
+                if ( i == 2 )
+                    set a to a + 100
+                elseif ( i >= 7 )
+                    set a to a + 10
+                else
+                    set a to a + 1
+                endif
+                if ( c > 2.0 )
+                    set c to c + 0.5
+                endif
+                if ( b != 3 )
+                    set b to 0
+                endif
+                set i to i + 1
+            endwhile
+        End
+    )";
+
+    TEST_F(InterpreterTest, superinstructions_should_not_change_the_result)
+    {
+        const std::vector<Interpreter::Type_Code> code = compile(sConditionsScript);
+        for (bool superinstructions : {false, true})
+        {
+            const InterpreterContext context = run(code, superinstructions);
+            EXPECT_EQ(context.mShorts[0], 100 + 3 * 10 + 6) << superinstructions;
+            EXPECT_EQ(context.mLongs[0], 3) << superinstructions;
+            EXPECT_EQ(context.mFloats[0], 7.5f) << superinstructions;
+            EXPECT_EQ(context.mShorts[1], 10) << superinstructions;
+        }
+    }
+
+    TEST_F(InterpreterTest, decode_should_fuse_fetch_literal_compare_and_jump)
+    {
+        const std::vector<Interpreter::Type_Code> code = compile(sConditionsScript);
+        const Interpreter::Program program = mInterpreter.decode(code.data(), static_cast<int>(code.size()));
+        ASSERT_EQ(program.mInstructions.size(), code[0]);
+        int compareJumps = 0;
+        for (const auto& instruction : program.mInstructions)
+            if (instruction.mKind == Interpreter::Program::Kind_CompareIntJump
+                || instruction.mKind == Interpreter::Program::Kind_CompareFloatJump)
+                ++compareJumps;
+        EXPECT_EQ(compareJumps, 5);
+    }
+
+    TEST_F(InterpreterTest, should_count_executed_instructions)
+    {
+        const std::vector<Interpreter::Type_Code> code = compile(sConditionsScript);
+        run(code, false);
+        const std::size_t executed = mInterpreter.getExecutedInstructions();
+        EXPECT_GT(executed, code[0]);
+    }
+
+    TEST_F(InterpreterTest, unknown_opcode_should_throw_when_executed)
+    {
+        Interpreter::Interpreter interpreter;
+        const std::vector<Interpreter::Type_Code> code = compile(sConditionsScript);
+        InterpreterContext context;
+        EXPECT_THROW(interpreter.run(code.data(), static_cast<int>(code.size()), context), std::runtime_error);
+    }
+}
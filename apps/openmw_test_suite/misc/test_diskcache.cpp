@@ -0,0 +1,117 @@
+#include "../tempdirectory.hpp"
+
+#include <components/misc/diskcache.hpp>
+
+#include <boost/filesystem/fstream.hpp>
+#include <boost/filesystem/operations.hpp>
+
+#include <gtest/gtest.h>
+
+namespace
+{
+    using namespace testing;
+    using namespace Misc;
+
+    const char sMagic[] = "OMWTESTS";
+    const char sExtension[] = ".test";
+    const char sDescription[] = "test entry";
+
+    struct MiscDiskCacheTest : TestingOpenMW::TempDirectoryTest
+    {
+        const std::size_t mMaxSize = 1024 * 1024;
+        const std::string mPayload = "payload";
+
+        void write(DiskCache& cache, std::uint64_t hash)
+        {
+            cache.write(cache.makeName(hash), hash, mPayload.data(), mPayload.size());
+        }
+
+        std::string read(DiskCache& cache, std::uint64_t hash)
+        {
+            const std::vector<char> payload = cache.read(cache.makeName(hash), hash);
+            return std::string(payload.begin(), payload.end());
+        }
+    };
+
+    TEST_F(MiscDiskCacheTest, read_for_empty_cache_should_return_empty_payload)
+    {
+        DiskCache cache(mPath, mMaxSize, sMagic, 1, sExtension, sDescription);
+        EXPECT_EQ(read(cache, 1), "");
+    }
+
+    TEST_F(MiscDiskCacheTest, read_should_return_payload_written_in_previous_session)
+    {
+        {
+            DiskCache cache(mPath, mMaxSize, sMagic, 1, sExtension, sDescription);
+            write(cache, 1);
+        }
+        DiskCache cache(mPath, mMaxSize, sMagic, 1, sExtension, sDescription);
+        EXPECT_EQ(read(cache, 1), mPayload);
+        EXPECT_GT(cache.getSize(), mPayload.size());
+    }
+
+    TEST_F(MiscDiskCacheTest, read_for_other_check_hash_should_return_empty_payload)
+    {
+        DiskCache cache(mPath, mMaxSize, sMagic, 1, sExtension, sDescription);
+        cache.write(cache.makeName(1), 2, mPayload.data(), mPayload.size());
+        EXPECT_EQ(read(cache, 1), "");
+    }
+
+    TEST_F(MiscDiskCacheTest, read_for_other_format_version_should_return_empty_payload)
+    {
+        {
+            DiskCache cache(mPath, mMaxSize, sMagic, 1, sExtension, sDescription);
+            write(cache, 1);
+        }
+        DiskCache cache(mPath, mMaxSize, sMagic, 2, sExtension, sDescription);
+        EXPECT_EQ(read(cache, 1), "");
+    }
+
+    TEST_F(MiscDiskCacheTest, write_over_max_size_should_remove_least_recently_used)
+    {
+        std::size_t entrySize = 0;
+        {
+            DiskCache cache(mPath, mMaxSize, sMagic, 1, sExtension, sDescription);
+            write(cache, 1);
+            entrySize = cache.getSize();
+        }
+        DiskCache cache(mPath, 2 * entrySize, sMagic, 1, sExtension, sDescription);
+        write(cache, 2);
+        EXPECT_EQ(read(cache, 1), mPayload);
+        write(cache, 3);
+        EXPECT_EQ(cache.getSize(), 2 * entrySize);
+        EXPECT_EQ(read(cache, 1), mPayload);
+        EXPECT_EQ(read(cache, 2), "");
+        EXPECT_EQ(read(cache, 3), mPayload);
+    }
+
+    TEST_F(MiscDiskCacheTest, read_for_truncated_file_should_return_empty_payload_and_remove_it)
+    {
+        {
+            DiskCache cache(mPath, mMaxSize, sMagic, 1, sExtension, sDescription);
+            write(cache, 1);
+        }
+        DiskCache cache(mPath, mMaxSize, sMagic, 1, sExtension, sDescription);
+        boost::filesystem::resize_file(mPath / cache.makeName(1), 20);
+        EXPECT_EQ(read(cache, 1), "");
+        EXPECT_EQ(cache.getSize(), 0u);
+        EXPECT_TRUE(boost::filesystem::is_empty(mPath));
+    }
+
+    TEST_F(MiscDiskCacheTest, discard_should_remove_entry)
+    {
+        DiskCache cache(mPath, mMaxSize, sMagic, 1, sExtension, sDescription);
+        write(cache, 1);
+        cache.discard(cache.makeName(1));
+        EXPECT_EQ(cache.getSize(), 0u);
+        EXPECT_EQ(read(cache, 1), "");
+    }
+
+    TEST_F(MiscDiskCacheTest, constructor_should_remove_files_left_by_interrupted_writes)
+    {
+        boost::filesystem::create_directories(mPath);
+        boost::filesystem::ofstream(mPath / "0000000000000001.test.tmp") << "garbage";
+        DiskCache cache(mPath, mMaxSize, sMagic, 1, sExtension, sDescription);
+        EXPECT_TRUE(boost::filesystem::is_empty(mPath));
+    }
+}
@@ -0,0 +1,133 @@
+#include <gtest/gtest.h>
+#include "components/misc/stablevector.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <string>
+
+namespace
+{
+    std::vector<int> toVector(const Misc::StableVector<int>& values)
+    {
+        return std::vector<int>(values.begin(), values.end());
+    }
+
+    TEST(StableVectorTest, push_back_should_keep_insertion_order)
+    {
+        Misc::StableVector<int> values;
+        EXPECT_TRUE(values.empty());
+        EXPECT_EQ(values.begin(), values.end());
+
+        for (int i = 0; i < 1000; ++i)
+            EXPECT_EQ(values.push_back(i), i);
+
+        EXPECT_EQ(values.size(), 1000u);
+        EXPECT_EQ(values.front(), 0);
+        EXPECT_EQ(values.back(), 999);
+        std::vector<int> expected(1000);
+        for (int i = 0; i < 1000; ++i)
+            expected[i] = i;
+        EXPECT_EQ(toVector(values), expected);
+    }
+
+    TEST(StableVectorTest, push_back_should_not_move_elements)
+    {
+        Misc::StableVector<std::string> values;
+        std::vector<const std::string*> addresses;
+        for (int i = 0; i < 1000; ++i)
+            addresses.push_back(&values.push_back(std::to_string(i)));
+
+        int i = 0;
+        for (const std::string& value : values)
+        {
+            EXPECT_EQ(&value, addresses[i]);
+            EXPECT_EQ(value, std::to_string(i));
+            ++i;
+        }
+    }
+
+    TEST(StableVectorTest, iterators_should_stay_valid_after_push_back)
+    {
+        Misc::StableVector<int> values;
+        values.push_back(1);
+        const Misc::StableVector<int>::iterator first = values.begin();
+        const Misc::StableVector<int>::iterator last = --values.end();
+        for (int i = 0; i < 100; ++i)
+            values.push_back(2);
+        EXPECT_EQ(first, values.begin());
+        EXPECT_EQ(*last, 1);
+    }
+
+    TEST(StableVectorTest, erase_should_skip_erased_elements_and_keep_others_in_place)
+    {
+        Misc::StableVector<int> values;
+        std::vector<const int*> addresses;
+        for (int i = 0; i < 20; ++i)
+            addresses.push_back(&values.push_back(i));
+
+        for (auto it = values.begin(); it != values.end();)
+        {
+            if (*it % 3 == 0)
+                it = values.erase(it);
+            else
+                ++it;
+        }
+
+        EXPECT_EQ(toVector(values), std::vector<int>({1, 2, 4, 5, 7, 8, 10, 11, 13, 14, 16, 17, 19}));
+        EXPECT_EQ(values.size(), 13u);
+        EXPECT_EQ(values.front(), 1);
+        EXPECT_EQ(values.back(), 19);
+        EXPECT_EQ(&values.back(), addresses[19]);
+        EXPECT_EQ(&*std::find(values.begin(), values.end(), 8), addresses[8]);
+
+        values.erase(--values.end());
+        EXPECT_EQ(values.back(), 17);
+    }
+
+    TEST(StableVectorTest, erase_should_destroy_element)
+    {
+        const auto counter = std::make_shared<int>(0);
+        Misc::StableVector<std::shared_ptr<int>> values;
+        values.push_back(counter);
+        values.push_back(counter);
+        EXPECT_EQ(counter.use_count(), 3);
+        values.erase(values.begin());
+        EXPECT_EQ(counter.use_count(), 2);
+        values.erase(values.begin());
+        EXPECT_EQ(counter.use_count(), 1);
+        EXPECT_TRUE(values.empty());
+        EXPECT_EQ(values.begin(), values.end());
+    }
+
+    TEST(StableVectorTest, copy_should_contain_only_remaining_elements)
+    {
+        Misc::StableVector<int> values;
+        for (int i = 0; i < 10; ++i)
+            values.push_back(i);
+        values.erase(values.begin());
+
+        Misc::StableVector<int> copy(values);
+        EXPECT_EQ(toVector(copy), toVector(values));
+        EXPECT_NE(&copy.front(), &values.front());
+
+        Misc::StableVector<int> assigned;
+        assigned.push_back(42);
+        assigned = copy;
+        EXPECT_EQ(toVector(assigned), toVector(values));
+
+        Misc::StableVector<int> moved(std::move(assigned));
+        EXPECT_EQ(toVector(moved), toVector(values));
+        EXPECT_TRUE(assigned.empty());
+    }
+
+    TEST(StableVectorTest, const_iterator_should_be_comparable_with_iterator)
+    {
+        Misc::StableVector<int> values;
+        values.push_back(1);
+        const Misc::StableVector<int>& constValues = values;
+        Misc::StableVector<int>::const_iterator it = values.begin();
+        EXPECT_EQ(it, constValues.begin());
+        EXPECT_TRUE(it == values.begin());
+        EXPECT_TRUE(++it == values.end());
+    }
+}
@@ -0,0 +1,47 @@
+#include "apps/openmw/mwphysics/movementqueue.hpp"
+
+#include <gtest/gtest.h>
+
+#include <map>
+#include <string>
+
+namespace
+{
+    using namespace testing;
+    using namespace MWPhysics;
+
+    using MovementQueue = std::vector<std::pair<std::string, float>>;
+
+    TEST(MWPhysicsUpdateMovementQueuePtrTest, should_replace_old_ptr_by_updated)
+    {
+        MovementQueue queue {{"a", 1}, {"b", 2}};
+        updateMovementQueuePtr(queue, std::string("a"), std::string("c"));
+        EXPECT_EQ(queue, (MovementQueue {{"c", 1}, {"b", 2}}));
+    }
+
+    TEST(MWPhysicsUpdateMovementQueuePtrTest, should_keep_queue_without_old_ptr)
+    {
+        MovementQueue queue {{"a", 1}, {"b", 2}};
+        updateMovementQueuePtr(queue, std::string("d"), std::string("c"));
+        EXPECT_EQ(queue, (MovementQueue {{"a", 1}, {"b", 2}}));
+    }
+
+    TEST(MWPhysicsUpdateMovementQueuePtrTest, cell_change_between_queueing_and_async_step_should_keep_movement)
+    {
+        // Actors are looked up by the updated Ptr when the async step is started
+        std::map<std::string, float> actors {{"a", 0}};
+        MovementQueue queue {{"a", 1}};
+
+        actors.erase("a");
+        actors.emplace("a-in-new-cell", 0);
+        updateMovementQueuePtr(queue, std::string("a"), std::string("a-in-new-cell"));
+
+        for (const auto& entry : queue)
+        {
+            const auto actor = actors.find(entry.first);
+            ASSERT_NE(actor, actors.end());
+            actor->second += entry.second;
+        }
+        EXPECT_EQ(actors.at("a-in-new-cell"), 1);
+    }
+}
@@ -0,0 +1,86 @@
+#include "apps/openmw/mwscript/scriptcache.hpp"
+
+#include <boost/filesystem/operations.hpp>
+
+#include <gtest/gtest.h>
+
+namespace
+{
+    using namespace testing;
+    using namespace MWScript;
+
+    struct MWScriptScriptCacheTest : Test
+    {
+        const boost::filesystem::path mPath = boost::filesystem::temp_directory_path()
+            / boost::filesystem::unique_path("%%%%-%%%%-%%%%-%%%%.bin");
+        const std::string mText = "begin test\nshort value\nend";
+        std::vector<Interpreter::Type_Code> mCode {{3, 0, 0, 0, 0xc8000014, 1, 2}};
+        Compiler::Locals mLocals;
+
+        MWScriptScriptCacheTest()
+        {
+            mLocals.declare('s', "value");
+            mLocals.declare('f', "timer");
+        }
+
+        ~MWScriptScriptCacheTest()
+        {
+            boost::filesystem::remove(mPath);
+        }
+
+        void saveCache(const std::string& key)
+        {
+            ScriptCache cache(mPath, key);
+            cache.insert("test", mText, mCode, mLocals);
+            cache.save();
+        }
+    };
+
+    TEST_F(MWScriptScriptCacheTest, get_should_return_saved_script)
+    {
+        saveCache("key");
+        const ScriptCache cache(mPath, "key");
+        std::vector<Interpreter::Type_Code> code;
+        Compiler::Locals locals;
+        ASSERT_TRUE(cache.get("test", mText, code, locals));
+        EXPECT_EQ(code, mCode);
+        const Compiler::Locals& expected = mLocals;
+        const Compiler::Locals& actual = locals;
+        for (const char type : {'s', 'l', 'f'})
+            EXPECT_EQ(actual.get(type), expected.get(type)) << type;
+    }
+
+    TEST_F(MWScriptScriptCacheTest, get_should_ignore_script_with_changed_text)
+    {
+        saveCache("key");
+        const ScriptCache cache(mPath, "key");
+        std::vector<Interpreter::Type_Code> code;
+        Compiler::Locals locals;
+        EXPECT_FALSE(cache.get("test", mText + "\n", code, locals));
+        EXPECT_FALSE(cache.get("other", mText, code, locals));
+    }
+
+    TEST_F(MWScriptScriptCacheTest, cache_with_different_key_should_be_discarded)
+    {
+        saveCache("key");
+        ScriptCache cache(mPath, "other key");
+        EXPECT_EQ(cache.getSize(), 0u);
+        cache.save();
+        EXPECT_EQ(ScriptCache(mPath, "key").getSize(), 0u);
+    }
+
+    TEST_F(MWScriptScriptCacheTest, truncated_cache_should_be_discarded)
+    {
+        saveCache("key");
+        boost::filesystem::resize_file(mPath, boost::filesystem::file_size(mPath) - 4);
+        EXPECT_EQ(ScriptCache(mPath, "key").getSize(), 0u);
+    }
+
+    TEST_F(MWScriptScriptCacheTest, make_key_should_depend_on_content_files)
+    {
+        const std::string key = ScriptCache::makeKey("version", {"Morrowind.esm"});
+        EXPECT_EQ(key, ScriptCache::makeKey("version", {"Morrowind.esm"}));
+        EXPECT_NE(key, ScriptCache::makeKey("version", {"Morrowind.esm", "Tribunal.esm"}));
+        EXPECT_NE(key, ScriptCache::makeKey("other version", {"Morrowind.esm"}));
+    }
+}
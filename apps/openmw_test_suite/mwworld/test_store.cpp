@@ -313,3 +313,90 @@ TEST_F(StoreTest, overwrite_test)
 
     ASSERT_TRUE (overwrittenRec && overwrittenRec->mModel == "the_new_model");
 }
+
+/// Tests that staging content files and merging them gives the same results as loading them directly.
+TEST_F(StoreTest, stage_and_merge_test)
+{
+    typedef ESM::Apparatus RecordType;
+
+    RecordType record;
+    record.blank();
+    record.mId = "Foobar";
+    record.mModel = "the_model";
+
+    const std::vector<std::pair<std::string, bool>> plugins = {
+        {"the_model", false},
+        {"the_new_model", false},
+        {"the_new_model", true},
+        {"the_newest_model", false},
+    };
+
+    MWWorld::ESMStore mergedStore;
+
+    ESM::ESMReader reader;
+    std::vector<ESM::ESMReader> readerList;
+    readerList.push_back(reader);
+    reader.setGlobalReaderList(&readerList);
+
+    for (const auto& plugin : plugins)
+    {
+        record.mModel = plugin.first;
+
+        reader.open(getEsmFile(record, plugin.second), "filename");
+        mEsmStore.load(reader, &dummyListener);
+        mEsmStore.setUp();
+
+        ESM::ESMReader stagingReader;
+        stagingReader.open(getEsmFile(record, plugin.second), "filename");
+        MWWorld::StagedContent content = mergedStore.stage(stagingReader);
+
+        reader.open(getEsmFile(record, plugin.second), "filename");
+        mergedStore.merge(reader, content, &dummyListener);
+        mergedStore.setUp();
+
+        ASSERT_EQ(mEsmStore.get<RecordType>().getSize(), mergedStore.get<RecordType>().getSize());
+    }
+
+    const RecordType* loaded = mEsmStore.get<RecordType>().search("foobar");
+    const RecordType* merged = mergedStore.get<RecordType>().search("foobar");
+
+    ASSERT_TRUE (loaded != nullptr);
+    ASSERT_TRUE (merged != nullptr);
+    EXPECT_EQ (loaded->mId, merged->mId);
+    EXPECT_EQ (merged->mModel, "the_newest_model");
+}
+
+/// Tests that records are read the same way from a memory mapped file.
+TEST_F(StoreTest, memory_mapped_test)
+{
+    typedef ESM::Apparatus RecordType;
+
+    RecordType record;
+    record.blank();
+    record.mId = "foobar";
+    record.mModel = "the_model";
+
+    const boost::filesystem::path path = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+    {
+        boost::filesystem::ofstream stream(path, std::ios::binary);
+        stream << getEsmFile(record, false)->rdbuf();
+    }
+
+    ESM::ESMReader reader;
+    std::vector<ESM::ESMReader> readerList;
+    readerList.push_back(reader);
+    reader.setGlobalReaderList(&readerList);
+    reader.openMapped(path.string());
+
+    ASSERT_TRUE (reader.isMapped());
+
+    mEsmStore.load(reader, &dummyListener);
+    mEsmStore.setUp();
+    reader.close();
+    boost::filesystem::remove(path);
+
+    const RecordType* loaded = mEsmStore.get<RecordType>().search("foobar");
+
+    ASSERT_TRUE (loaded != nullptr);
+    EXPECT_EQ (loaded->mModel, "the_model");
+}
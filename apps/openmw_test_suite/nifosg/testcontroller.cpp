@@ -0,0 +1,75 @@
+#include <components/nifosg/controller.hpp>
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+namespace
+{
+    using namespace testing;
+    using namespace NifOsg;
+
+    struct NifOsgValueInterpolatorTest : Test
+    {
+        std::shared_ptr<Nif::FloatKeyMap> mKeys = std::make_shared<Nif::FloatKeyMap>();
+
+        void addKey(float time, float value)
+        {
+            Nif::FloatKey key;
+            key.mValue = value;
+            mKeys->addKey(time, key);
+        }
+    };
+
+    TEST_F(NifOsgValueInterpolatorTest, empty_interpolator_should_return_default_value)
+    {
+        const FloatInterpolator interpolator(mKeys, 42.f);
+        EXPECT_EQ(interpolator.interpKey(1.f), 42.f);
+    }
+
+    TEST_F(NifOsgValueInterpolatorTest, add_key_should_keep_keys_sorted_and_replace_keys_at_same_time)
+    {
+        addKey(2.f, 20.f);
+        addKey(0.f, 0.f);
+        addKey(1.f, 10.f);
+        addKey(1.f, 15.f);
+        EXPECT_EQ(mKeys->mTimes, std::vector<float>({0.f, 1.f, 2.f}));
+        ASSERT_EQ(mKeys->mKeys.size(), 3u);
+        EXPECT_EQ(mKeys->mKeys[1].mValue, 15.f);
+    }
+
+    TEST_F(NifOsgValueInterpolatorTest, should_clamp_outside_of_key_range)
+    {
+        addKey(1.f, 10.f);
+        addKey(2.f, 20.f);
+        const FloatInterpolator interpolator(mKeys);
+        EXPECT_EQ(interpolator.interpKey(0.f), 10.f);
+        EXPECT_EQ(interpolator.interpKey(3.f), 20.f);
+    }
+
+    TEST_F(NifOsgValueInterpolatorTest, should_interpolate_linearly_for_any_sequence_of_times)
+    {
+        for (int i = 0; i <= 10; ++i)
+            addKey(static_cast<float>(i), static_cast<float>(i * i));
+        const FloatInterpolator interpolator(mKeys);
+
+        const float times[] = {0.5f, 0.75f, 1.f, 1.25f, 2.5f, 6.5f, 6.75f, 1.5f, 9.5f, 9.5f, 0.25f};
+        for (float time : times)
+        {
+            const float low = std::floor(time);
+            const float high = low + 1;
+            const float expected = low * low + (high * high - low * low) * (time - low);
+            EXPECT_FLOAT_EQ(interpolator.interpKey(time), expected) << time;
+        }
+    }
+
+    TEST_F(NifOsgValueInterpolatorTest, constant_interpolation_should_pick_nearest_key)
+    {
+        addKey(0.f, 0.f);
+        addKey(1.f, 10.f);
+        mKeys->mInterpolationType = Nif::InterpolationType_Constant;
+        const FloatInterpolator interpolator(mKeys);
+        EXPECT_EQ(interpolator.interpKey(0.25f), 0.f);
+        EXPECT_EQ(interpolator.interpKey(0.75f), 10.f);
+    }
+}
@@ -0,0 +1,71 @@
+#include <components/resource/buildonce.hpp>
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <future>
+#include <stdexcept>
+#include <thread>
+
+namespace
+{
+    using namespace testing;
+
+    struct ResourceBuildOnceTest : Test
+    {
+        osg::ref_ptr<Resource::ObjectCache> mCache {new Resource::ObjectCache};
+        Resource::BuildOnce<std::string> mBuildOnce;
+    };
+
+    TEST_F(ResourceBuildOnceTest, get_should_add_created_object_to_cache)
+    {
+        const osg::ref_ptr<osg::Object> object(new osg::Node);
+        EXPECT_EQ(mBuildOnce.get(*mCache, "foo", [&] { return object; }).get(), object.get());
+        EXPECT_EQ(mCache->getRefFromObjectCache("foo").get(), object.get());
+    }
+
+    TEST_F(ResourceBuildOnceTest, get_for_cached_object_should_not_create_it)
+    {
+        const osg::ref_ptr<osg::Object> object(new osg::Node);
+        mCache->addEntryToObjectCache("foo", object.get());
+        const auto create = [] () -> osg::ref_ptr<osg::Object> { throw std::logic_error("unexpected create"); };
+        EXPECT_EQ(mBuildOnce.get(*mCache, "foo", create).get(), object.get());
+    }
+
+    TEST_F(ResourceBuildOnceTest, get_after_create_throws_should_create_again)
+    {
+        const auto fail = [] () -> osg::ref_ptr<osg::Object> { throw std::runtime_error("failed"); };
+        EXPECT_THROW(mBuildOnce.get(*mCache, "foo", fail), std::runtime_error);
+        const osg::ref_ptr<osg::Object> object(new osg::Node);
+        EXPECT_EQ(mBuildOnce.get(*mCache, "foo", [&] { return object; }).get(), object.get());
+    }
+
+    TEST_F(ResourceBuildOnceTest, get_while_other_thread_creates_should_wait_for_its_object)
+    {
+        const osg::ref_ptr<osg::Object> object(new osg::Node);
+        std::atomic<int> created {0};
+        std::promise<void> started;
+        std::promise<void> release;
+        std::shared_future<void> released = release.get_future().share();
+        const auto create = [&]
+        {
+            if (++created == 1)
+                started.set_value();
+            released.wait();
+            return object;
+        };
+
+        osg::ref_ptr<osg::Object> firstResult;
+        std::thread first([&] { firstResult = mBuildOnce.get(*mCache, "foo", create); });
+        started.get_future().wait();
+        osg::ref_ptr<osg::Object> secondResult;
+        std::thread second([&] { secondResult = mBuildOnce.get(*mCache, "foo", create); });
+        release.set_value();
+        first.join();
+        second.join();
+
+        EXPECT_EQ(created, 1);
+        EXPECT_EQ(firstResult.get(), object.get());
+        EXPECT_EQ(secondResult.get(), object.get());
+    }
+}
@@ -0,0 +1,107 @@
+#include <components/resource/objectcache.hpp>
+
+#include <gtest/gtest.h>
+
+#include <thread>
+
+namespace
+{
+    using namespace testing;
+
+    struct ResourceObjectCacheTest : Test
+    {
+        osg::ref_ptr<Resource::ObjectCache> mCache {new Resource::ObjectCache};
+    };
+
+    TEST_F(ResourceObjectCacheTest, get_should_return_added_object)
+    {
+        osg::ref_ptr<osg::Object> object(new osg::Node);
+        mCache->addEntryToObjectCache("foo", object.get());
+        EXPECT_EQ(mCache->getRefFromObjectCache("foo").get(), object.get());
+        EXPECT_EQ(mCache->getRefFromObjectCache("bar").get(), nullptr);
+        EXPECT_EQ(mCache->getCacheSize(), 1u);
+    }
+
+    TEST_F(ResourceObjectCacheTest, should_account_size_of_objects)
+    {
+        mCache->addEntryToObjectCache("foo", new osg::Node, 0.0, 100);
+        mCache->addEntryToObjectCache("bar", new osg::Node, 0.0, 20);
+        EXPECT_EQ(mCache->getCacheMemorySize(), 120u);
+        mCache->addEntryToObjectCache("foo", new osg::Node, 0.0, 10);
+        EXPECT_EQ(mCache->getCacheMemorySize(), 30u);
+        mCache->removeFromObjectCache("bar");
+        EXPECT_EQ(mCache->getCacheMemorySize(), 10u);
+        mCache->clear();
+        EXPECT_EQ(mCache->getCacheMemorySize(), 0u);
+        EXPECT_EQ(mCache->getCacheSize(), 0u);
+    }
+
+    TEST_F(ResourceObjectCacheTest, without_budget_should_remove_expired_objects)
+    {
+        mCache->addEntryToObjectCache("foo", new osg::Node, 0.0, 100);
+        mCache->updateTimeStampOfObjectsInCacheWithExternalReferences(1.0);
+        mCache->removeExpiredObjectsInCache(0.5);
+        EXPECT_EQ(mCache->getCacheSize(), 1u);
+        mCache->removeExpiredObjectsInCache(1.0);
+        EXPECT_EQ(mCache->getCacheSize(), 0u);
+        EXPECT_EQ(mCache->getCacheMemorySize(), 0u);
+    }
+
+    TEST_F(ResourceObjectCacheTest, with_budget_should_only_expire_objects_without_size)
+    {
+        mCache->setMaxCacheMemorySize(1000);
+        mCache->addEntryToObjectCache("foo", new osg::Node, 0.0, 100);
+        mCache->addEntryToObjectCache("bar", new osg::Node);
+        mCache->updateTimeStampOfObjectsInCacheWithExternalReferences(1.0);
+        mCache->removeExpiredObjectsInCache(2.0);
+        EXPECT_NE(mCache->getRefFromObjectCache("foo").get(), nullptr);
+        EXPECT_EQ(mCache->getRefFromObjectCache("bar").get(), nullptr);
+    }
+
+    TEST_F(ResourceObjectCacheTest, over_budget_should_remove_least_recently_used_unreferenced_objects)
+    {
+        mCache->setMaxCacheMemorySize(250);
+        osg::ref_ptr<osg::Object> referenced(new osg::Node);
+        mCache->addEntryToObjectCache("referenced", referenced.get(), 1.0, 100);
+        mCache->addEntryToObjectCache("old", new osg::Node, 2.0, 100);
+        mCache->addEntryToObjectCache("recent", new osg::Node, 4.0, 100);
+        mCache->addEntryToObjectCache("older", new osg::Node, 1.5, 100);
+
+        mCache->removeExpiredObjectsInCache(3.0);
+
+        EXPECT_NE(mCache->getRefFromObjectCache("referenced").get(), nullptr);
+        EXPECT_NE(mCache->getRefFromObjectCache("recent").get(), nullptr);
+        EXPECT_EQ(mCache->getRefFromObjectCache("old").get(), nullptr);
+        EXPECT_EQ(mCache->getRefFromObjectCache("older").get(), nullptr);
+        EXPECT_EQ(mCache->getCacheMemorySize(), 200u);
+    }
+
+    TEST_F(ResourceObjectCacheTest, should_support_tuple_keys)
+    {
+        typedef std::tuple<osg::Vec2f, unsigned char, unsigned int> Key;
+        osg::ref_ptr<Resource::GenericObjectCache<Key>> cache(new Resource::GenericObjectCache<Key>);
+        osg::ref_ptr<osg::Object> object(new osg::Node);
+        cache->addEntryToObjectCache(Key(osg::Vec2f(1, 2), 3, 4), object.get());
+        EXPECT_EQ(cache->getRefFromObjectCache(Key(osg::Vec2f(1, 2), 3, 4)).get(), object.get());
+        EXPECT_EQ(cache->getRefFromObjectCache(Key(osg::Vec2f(2, 1), 3, 4)).get(), nullptr);
+    }
+
+    TEST_F(ResourceObjectCacheTest, should_support_concurrent_access)
+    {
+        std::vector<std::thread> threads;
+        for (int thread = 0; thread < 4; ++thread)
+            threads.emplace_back([&, thread]
+            {
+                for (int i = 0; i < 1000; ++i)
+                {
+                    const std::string key = std::to_string(thread) + "_" + std::to_string(i);
+                    mCache->addEntryToObjectCache(key, new osg::Node, 0.0, 1);
+                    EXPECT_NE(mCache->getRefFromObjectCache(key).get(), nullptr);
+                }
+            });
+        for (auto& thread : threads)
+            thread.join();
+        EXPECT_EQ(mCache->getCacheSize(), 4000u);
+        EXPECT_EQ(mCache->getCacheMemorySize(), 4000u);
+    }
+}
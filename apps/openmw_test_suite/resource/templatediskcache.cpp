@@ -0,0 +1,118 @@
+#include "../tempdirectory.hpp"
+
+#include <components/resource/templatediskcache.hpp>
+#include <components/nifosg/userdata.hpp>
+
+#include <osg/Geometry>
+#include <osg/MatrixTransform>
+#include <osg/Program>
+#include <osg/Texture2D>
+
+#include <gtest/gtest.h>
+
+namespace
+{
+    using namespace testing;
+    using namespace Resource;
+
+    struct ResourceTemplateDiskCacheTest : TestingOpenMW::TempDirectoryTest
+    {
+        const std::string mName = "meshes/x/ex_common_house.nif";
+        const std::string mVersion = "42 1";
+        osg::ref_ptr<osg::Geometry> mGeometry {new osg::Geometry};
+        osg::ref_ptr<osg::MatrixTransform> mTemplate {new osg::MatrixTransform(osg::Matrix::translate(1, 2, 3))};
+
+        ResourceTemplateDiskCacheTest()
+        {
+            osg::ref_ptr<osg::Vec3Array> positions (new osg::Vec3Array);
+            positions->push_back(osg::Vec3f(0, 0, 0));
+            positions->push_back(osg::Vec3f(1, 0, 0));
+            positions->push_back(osg::Vec3f(0, 1, 0));
+            mGeometry->setVertexArray(positions);
+            mGeometry->addPrimitiveSet(new osg::DrawArrays(GL_TRIANGLES, 0, 3));
+
+            Nif::Matrix3 rotationScale;
+            rotationScale.mValues[0][1] = 0.5f;
+            mTemplate->getOrCreateUserDataContainer()->addUserObject(new NifOsg::NodeUserData(7, 2.f, rotationScale));
+            mTemplate->addChild(mGeometry);
+        }
+    };
+
+    TEST_F(ResourceTemplateDiskCacheTest, get_for_empty_cache_should_return_nullptr)
+    {
+        TemplateDiskCache cache(mPath);
+        EXPECT_FALSE(cache.get(mName, mVersion, nullptr));
+    }
+
+    TEST_F(ResourceTemplateDiskCacheTest, get_should_return_stored_template)
+    {
+        TemplateDiskCache cache(mPath);
+        cache.set(mName, mVersion, *mTemplate);
+        const osg::ref_ptr<osg::Node> node = cache.get(mName, mVersion, nullptr);
+        ASSERT_TRUE(node);
+        const osg::MatrixTransform* transform = node->asTransform()->asMatrixTransform();
+        ASSERT_TRUE(transform);
+        EXPECT_EQ(transform->getMatrix(), mTemplate->getMatrix());
+        ASSERT_EQ(transform->getNumChildren(), 1u);
+        const osg::Geometry* geometry = transform->getChild(0)->asDrawable()->asGeometry();
+        ASSERT_TRUE(geometry);
+        const osg::Vec3Array* positions = dynamic_cast<const osg::Vec3Array*>(geometry->getVertexArray());
+        ASSERT_TRUE(positions);
+        EXPECT_EQ(positions->asVector(), static_cast<const osg::Vec3Array*>(mGeometry->getVertexArray())->asVector());
+    }
+
+    TEST_F(ResourceTemplateDiskCacheTest, get_should_return_template_with_node_user_data)
+    {
+        TemplateDiskCache cache(mPath);
+        cache.set(mName, mVersion, *mTemplate);
+        const osg::ref_ptr<osg::Node> node = cache.get(mName, mVersion, nullptr);
+        ASSERT_TRUE(node);
+        ASSERT_TRUE(node->getUserDataContainer());
+        const NifOsg::NodeUserData* userData = dynamic_cast<const NifOsg::NodeUserData*>(
+            node->getUserDataContainer()->getUserObject(0));
+        ASSERT_TRUE(userData);
+        EXPECT_EQ(userData->mIndex, 7);
+        EXPECT_EQ(userData->mScale, 2.f);
+        EXPECT_EQ(userData->mRotationScale.mValues[0][1], 0.5f);
+        EXPECT_EQ(userData->mRotationScale.mValues[1][1], 1.f);
+    }
+
+    TEST_F(ResourceTemplateDiskCacheTest, get_for_other_version_should_return_nullptr)
+    {
+        TemplateDiskCache cache(mPath);
+        cache.set(mName, mVersion, *mTemplate);
+        EXPECT_FALSE(cache.get(mName, "43 1", nullptr));
+    }
+
+    TEST_F(ResourceTemplateDiskCacheTest, set_should_leave_out_programs)
+    {
+        mGeometry->getOrCreateStateSet()->setAttributeAndModes(new osg::Program);
+        TemplateDiskCache cache(mPath);
+        cache.set(mName, mVersion, *mTemplate);
+        const osg::ref_ptr<osg::Node> node = cache.get(mName, mVersion, nullptr);
+        ASSERT_TRUE(node);
+        const osg::StateSet* stateSet = node->asGroup()->getChild(0)->getStateSet();
+        ASSERT_TRUE(stateSet);
+        EXPECT_FALSE(stateSet->getAttribute(osg::StateAttribute::PROGRAM));
+        EXPECT_TRUE(mGeometry->getStateSet()->getAttribute(osg::StateAttribute::PROGRAM));
+    }
+
+    TEST_F(ResourceTemplateDiskCacheTest, set_for_template_with_callback_should_not_store_it)
+    {
+        mGeometry->setUpdateCallback(new osg::Callback);
+        EXPECT_FALSE(TemplateDiskCache::isStorable(*mTemplate));
+        TemplateDiskCache cache(mPath);
+        cache.set(mName, mVersion, *mTemplate);
+        EXPECT_FALSE(cache.get(mName, mVersion, nullptr));
+    }
+
+    TEST_F(ResourceTemplateDiskCacheTest, is_storable_for_texture_of_image_without_file_should_return_false)
+    {
+        osg::ref_ptr<osg::Image> image (new osg::Image);
+        image->allocateImage(1, 1, 1, GL_RGB, GL_UNSIGNED_BYTE);
+        mGeometry->getOrCreateStateSet()->setTextureAttributeAndModes(0, new osg::Texture2D(image));
+        EXPECT_FALSE(TemplateDiskCache::isStorable(*mTemplate));
+        image->setFileName("textures/tx_a.dds");
+        EXPECT_TRUE(TemplateDiskCache::isStorable(*mTemplate));
+    }
+}
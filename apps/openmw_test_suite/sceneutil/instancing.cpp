@@ -0,0 +1,115 @@
+#include <components/sceneutil/instancing.hpp>
+
+#include <osg/Geometry>
+#include <osg/MatrixTransform>
+#include <osg/VertexAttribDivisor>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+
+namespace
+{
+    using namespace testing;
+    using namespace SceneUtil;
+
+    struct SceneUtilInstancingTest : Test
+    {
+        osg::ref_ptr<osg::Geometry> mGeometry {new osg::Geometry};
+        osg::ref_ptr<osg::MatrixTransform> mTransform {new osg::MatrixTransform(osg::Matrix::translate(1, 0, 0))};
+        osg::ref_ptr<osg::Group> mModel {new osg::Group};
+        std::vector<Instance> mInstances {
+            Instance {osg::Vec3f(0, 0, 0), osg::Quat(), 1.f},
+            Instance {osg::Vec3f(100, 0, 0), osg::Quat(osg::PI_2, osg::Vec3f(0, 0, 1)), 2.f},
+        };
+
+        SceneUtilInstancingTest()
+        {
+            osg::ref_ptr<osg::Vec3Array> positions (new osg::Vec3Array);
+            positions->push_back(osg::Vec3f(0, 0, 0));
+            positions->push_back(osg::Vec3f(1, 0, 0));
+            positions->push_back(osg::Vec3f(0, 1, 0));
+            osg::ref_ptr<osg::Vec3Array> normals (new osg::Vec3Array(3));
+            std::fill(normals->begin(), normals->end(), osg::Vec3f(0, 0, 1));
+            mGeometry->setVertexArray(positions);
+            mGeometry->setNormalArray(normals, osg::Array::BIND_PER_VERTEX);
+            mGeometry->addPrimitiveSet(new osg::DrawArrays(GL_TRIANGLES, 0, 3));
+
+            mTransform->addChild(mGeometry);
+            mModel->addChild(mTransform);
+        }
+
+        osg::Geometry* getGeometry(osg::Group& instances, unsigned int index)
+        {
+            return instances.getChild(index)->asDrawable()->asGeometry();
+        }
+    };
+
+    TEST_F(SceneUtilInstancingTest, should_create_an_instanced_copy_of_each_geometry)
+    {
+        mTransform->addChild(new osg::Geometry(*mGeometry, osg::CopyOp::SHALLOW_COPY));
+        const osg::ref_ptr<osg::Group> instances = createInstances(*mModel, mInstances);
+        ASSERT_EQ(instances->getNumChildren(), 2u);
+        for (unsigned int i = 0; i < instances->getNumChildren(); ++i)
+        {
+            const osg::Geometry* geometry = getGeometry(*instances, i);
+            ASSERT_TRUE(geometry);
+            EXPECT_NE(geometry, mGeometry.get());
+            EXPECT_EQ(geometry->getPrimitiveSet(0)->getNumInstances(), 2);
+            EXPECT_EQ(mGeometry->getPrimitiveSet(0)->getNumInstances(), 0);
+        }
+    }
+
+    TEST_F(SceneUtilInstancingTest, should_pass_instance_transforms_as_vertex_attributes)
+    {
+        const osg::ref_ptr<osg::Group> instances = createInstances(*mModel, mInstances);
+        const osg::Geometry* geometry = getGeometry(*instances, 0);
+        const osg::Vec4Array* offsets = dynamic_cast<const osg::Vec4Array*>(
+            geometry->getVertexAttribArray(InstanceAttribute_Offset));
+        const osg::Vec4Array* rotations = dynamic_cast<const osg::Vec4Array*>(
+            geometry->getVertexAttribArray(InstanceAttribute_Rotation));
+        ASSERT_TRUE(offsets);
+        ASSERT_TRUE(rotations);
+        EXPECT_EQ(offsets->asVector(), std::vector<osg::Vec4f>({osg::Vec4f(0, 0, 0, 1), osg::Vec4f(100, 0, 0, 2)}));
+        EXPECT_EQ(rotations->asVector(), std::vector<osg::Vec4f>({mInstances[0].mRotation.asVec4(),
+                                                                  mInstances[1].mRotation.asVec4()}));
+        const osg::StateSet* stateSet = geometry->getStateSet();
+        ASSERT_TRUE(stateSet);
+        EXPECT_TRUE(stateSet->getAttribute(osg::StateAttribute::VERTEX_ATTRIB_DIVISOR, InstanceAttribute_Offset));
+        EXPECT_TRUE(stateSet->getAttribute(osg::StateAttribute::VERTEX_ATTRIB_DIVISOR, InstanceAttribute_Rotation));
+    }
+
+    TEST_F(SceneUtilInstancingTest, should_bake_model_transforms_into_vertices)
+    {
+        const osg::ref_ptr<osg::Group> instances = createInstances(*mModel, mInstances);
+        const osg::Vec3Array* positions = static_cast<const osg::Vec3Array*>(getGeometry(*instances, 0)->getVertexArray());
+        EXPECT_EQ(positions->asVector(), std::vector<osg::Vec3f>({
+            osg::Vec3f(1, 0, 0), osg::Vec3f(2, 0, 0), osg::Vec3f(1, 1, 0)}));
+        const osg::Vec3Array* source = static_cast<const osg::Vec3Array*>(mGeometry->getVertexArray());
+        EXPECT_EQ(source->at(0), osg::Vec3f(0, 0, 0));
+    }
+
+    TEST_F(SceneUtilInstancingTest, should_merge_state_sets_of_the_model_into_geometries)
+    {
+        mModel->getOrCreateStateSet()->addUniform(new osg::Uniform("parent", 1));
+        mGeometry->getOrCreateStateSet()->addUniform(new osg::Uniform("geometry", 2));
+        const osg::ref_ptr<osg::Group> instances = createInstances(*mModel, mInstances);
+        const osg::StateSet* stateSet = getGeometry(*instances, 0)->getStateSet();
+        EXPECT_TRUE(stateSet->getUniform("parent"));
+        EXPECT_TRUE(stateSet->getUniform("geometry"));
+        EXPECT_FALSE(mGeometry->getStateSet()->getAttribute(osg::StateAttribute::VERTEX_ATTRIB_DIVISOR,
+                                                            InstanceAttribute_Offset));
+    }
+
+    TEST_F(SceneUtilInstancingTest, bound_should_contain_all_instances)
+    {
+        const osg::ref_ptr<osg::Group> instances = createInstances(*mModel, mInstances);
+        const osg::BoundingBox& box = getGeometry(*instances, 0)->getBoundingBox();
+        // Vertices of the second instance are scaled by 2, rotated by 90 degrees around z and moved by 100 on x
+        EXPECT_TRUE(box.contains(osg::Vec3f(1, 0, 0)));
+        EXPECT_TRUE(box.contains(osg::Vec3f(100, 2, 0)));
+        EXPECT_TRUE(box.contains(osg::Vec3f(100, 4, 0)));
+        EXPECT_TRUE(box.contains(osg::Vec3f(98, 2, 0)));
+        EXPECT_FALSE(box.contains(osg::Vec3f(120, 0, 0)));
+    }
+}
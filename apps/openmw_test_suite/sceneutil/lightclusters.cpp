@@ -0,0 +1,124 @@
+#include <components/sceneutil/lightclusters.hpp>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+
+namespace
+{
+    using namespace testing;
+    using namespace SceneUtil;
+
+    struct SceneUtilLightClusterGridTest : Test
+    {
+        const float mNear = 4.f;
+        const float mFar = 8192.f;
+        const osg::Matrixd mProjection = osg::Matrixd::perspective(60.0, 16.0 / 9.0, mNear, mFar);
+        LightClusterGrid mGrid {16, 9, 24, 64, 1024 * 64};
+
+        bool hasLight(const osg::Vec3f& viewPos, unsigned int light) const
+        {
+            const LightClusterGrid::Cluster& cluster = mGrid.getCluster(viewPos);
+            const auto begin = mGrid.getIndices().begin() + cluster.mOffset;
+            const auto end = begin + cluster.mCount;
+            return std::find(begin, end, light) != end;
+        }
+    };
+
+    TEST_F(SceneUtilLightClusterGridTest, assign_without_lights_should_leave_all_clusters_empty)
+    {
+        mGrid.assign(mProjection, mNear, mFar, {});
+        EXPECT_TRUE(mGrid.getIndices().empty());
+        for (const LightClusterGrid::Cluster& cluster : mGrid.getClusters())
+            EXPECT_EQ(cluster.mCount, 0u);
+    }
+
+    TEST_F(SceneUtilLightClusterGridTest, get_slice_should_clamp_depth_to_near_and_far)
+    {
+        mGrid.assign(mProjection, mNear, mFar, {});
+        EXPECT_EQ(mGrid.getSlice(-100.f), 0);
+        EXPECT_EQ(mGrid.getSlice(mNear), 0);
+        EXPECT_EQ(mGrid.getSlice(mNear * 1.01f), 0);
+        EXPECT_EQ(mGrid.getSlice(mFar * 0.99f), 23);
+        EXPECT_EQ(mGrid.getSlice(mFar * 10), 23);
+    }
+
+    TEST_F(SceneUtilLightClusterGridTest, positions_inside_light_should_find_it)
+    {
+        const std::vector<osg::BoundingSphere> lights {
+            osg::BoundingSphere(osg::Vec3f(0, 0, -500), 200),
+            osg::BoundingSphere(osg::Vec3f(-700, 300, -1000), 400),
+            osg::BoundingSphere(osg::Vec3f(100, -50, -20), 300),
+        };
+        mGrid.assign(mProjection, mNear, mFar, lights);
+        for (unsigned int light = 0; light < lights.size(); ++light)
+        {
+            const osg::Vec3f center = lights[light].center();
+            const float offset = lights[light].radius() * 0.99f;
+            EXPECT_TRUE(hasLight(center, light)) << light;
+            EXPECT_TRUE(hasLight(center + osg::Vec3f(offset, 0, 0), light)) << light;
+            EXPECT_TRUE(hasLight(center - osg::Vec3f(offset, 0, 0), light)) << light;
+            EXPECT_TRUE(hasLight(center + osg::Vec3f(0, offset, 0), light)) << light;
+            EXPECT_TRUE(hasLight(center - osg::Vec3f(0, offset, 0), light)) << light;
+            EXPECT_TRUE(hasLight(center + osg::Vec3f(0, 0, offset), light)) << light;
+            EXPECT_TRUE(hasLight(center - osg::Vec3f(0, 0, offset), light)) << light;
+        }
+    }
+
+    TEST_F(SceneUtilLightClusterGridTest, positions_far_from_light_should_not_find_it)
+    {
+        mGrid.assign(mProjection, mNear, mFar, {osg::BoundingSphere(osg::Vec3f(0, 0, -500), 100)});
+        EXPECT_TRUE(hasLight(osg::Vec3f(0, 0, -500), 0));
+        EXPECT_FALSE(hasLight(osg::Vec3f(0, 0, -2000), 0));
+        EXPECT_FALSE(hasLight(osg::Vec3f(0, 0, -100), 0));
+        EXPECT_FALSE(hasLight(osg::Vec3f(400, 0, -500), 0));
+        EXPECT_FALSE(hasLight(osg::Vec3f(0, -300, -500), 0));
+    }
+
+    TEST_F(SceneUtilLightClusterGridTest, positions_off_screen_should_find_light_off_screen)
+    {
+        const osg::BoundingSphere light (osg::Vec3f(-2000, 0, -500), 100);
+        mGrid.assign(mProjection, mNear, mFar, {light});
+        EXPECT_TRUE(hasLight(light.center(), 0));
+    }
+
+    TEST_F(SceneUtilLightClusterGridTest, positions_behind_eye_should_find_light_reaching_them)
+    {
+        const osg::BoundingSphere light (osg::Vec3f(0, 0, 50), 100);
+        mGrid.assign(mProjection, mNear, mFar, {light});
+        EXPECT_TRUE(hasLight(light.center(), 0));
+        EXPECT_TRUE(hasLight(osg::Vec3f(0, 0, -10), 0));
+        EXPECT_TRUE(hasLight(osg::Vec3f(30, 40, 0), 0));
+    }
+
+    TEST_F(SceneUtilLightClusterGridTest, orthographic_projection_positions_inside_light_should_find_it)
+    {
+        const osg::BoundingSphere light (osg::Vec3f(300, -200, -100), 150);
+        mGrid.assign(osg::Matrixd::ortho(-1000, 1000, -1000, 1000, -500, 500), mNear, mFar, {light});
+        EXPECT_TRUE(hasLight(light.center(), 0));
+        EXPECT_TRUE(hasLight(light.center() + osg::Vec3f(140, 0, 0), 0));
+        EXPECT_TRUE(hasLight(light.center() + osg::Vec3f(0, 0, 140), 0));
+        EXPECT_FALSE(hasLight(osg::Vec3f(-300, -200, -100), 0));
+    }
+
+    TEST_F(SceneUtilLightClusterGridTest, cluster_should_keep_first_lights_up_to_limit)
+    {
+        LightClusterGrid grid (16, 9, 24, 2, 1024);
+        const std::vector<osg::BoundingSphere> lights(3, osg::BoundingSphere(osg::Vec3f(0, 0, -500), 100));
+        grid.assign(mProjection, mNear, mFar, lights);
+        const LightClusterGrid::Cluster& cluster = grid.getCluster(osg::Vec3f(0, 0, -500));
+        ASSERT_EQ(cluster.mCount, 2u);
+        EXPECT_EQ(grid.getIndices()[cluster.mOffset], 0u);
+        EXPECT_EQ(grid.getIndices()[cluster.mOffset + 1], 1u);
+    }
+
+    TEST_F(SceneUtilLightClusterGridTest, assign_should_not_exceed_max_indices)
+    {
+        LightClusterGrid grid (16, 9, 24, 64, 10);
+        const std::vector<osg::BoundingSphere> lights(5, osg::BoundingSphere(osg::Vec3f(0, 0, -500), 1000));
+        grid.assign(mProjection, mNear, mFar, lights);
+        EXPECT_EQ(grid.getIndices().size(), 10u);
+        for (const LightClusterGrid::Cluster& cluster : grid.getClusters())
+            EXPECT_LE(cluster.mOffset + cluster.mCount, 10u);
+    }
+}
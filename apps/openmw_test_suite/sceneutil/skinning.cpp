@@ -0,0 +1,154 @@
+#include <components/sceneutil/skinning.hpp>
+
+#include <osg/Geometry>
+
+#include <gtest/gtest.h>
+
+namespace
+{
+    using namespace testing;
+    using namespace SceneUtil;
+
+    struct SceneUtilSkinningTest : Test
+    {
+        osg::ref_ptr<osg::Geometry> mSource {new osg::Geometry};
+        osg::ref_ptr<osg::Vec3Array> mPositions {new osg::Vec3Array};
+        osg::ref_ptr<osg::Vec3Array> mNormals {new osg::Vec3Array};
+        osg::ref_ptr<osg::Vec4Array> mTangents {new osg::Vec4Array};
+        std::vector<osg::Matrixf> mInvBindMatrices;
+        std::vector<SkinningData::VertexWeights> mWeights;
+
+        void addVertex(const osg::Vec3f& position, const osg::Vec3f& normal, const osg::Vec4f& tangent)
+        {
+            mPositions->push_back(position);
+            mNormals->push_back(normal);
+            mTangents->push_back(tangent);
+        }
+
+        osg::ref_ptr<SkinningData> createSkinningData()
+        {
+            mSource->setVertexArray(mPositions);
+            mSource->setNormalArray(mNormals);
+            mSource->setTexCoordArray(7, mTangents);
+
+            std::vector<const SkinningData::VertexWeights*> boneWeights;
+            for (const auto& weights : mWeights)
+                boneWeights.push_back(&weights);
+            return new SkinningData(mInvBindMatrices, boneWeights, *mSource);
+        }
+    };
+
+    void expectNear(const osg::Vec3f& expected, const osg::Vec3f& actual)
+    {
+        EXPECT_NEAR(expected.x(), actual.x(), 1e-4f);
+        EXPECT_NEAR(expected.y(), actual.y(), 1e-4f);
+        EXPECT_NEAR(expected.z(), actual.z(), 1e-4f);
+    }
+
+    TEST_F(SceneUtilSkinningTest, should_blend_bone_transforms_by_weight)
+    {
+        addVertex(osg::Vec3f(1, 0, 0), osg::Vec3f(0, 0, 1), osg::Vec4f(1, 0, 0, -1));
+        addVertex(osg::Vec3f(0, 1, 0), osg::Vec3f(0, 0, 1), osg::Vec4f(1, 0, 0, 1));
+        addVertex(osg::Vec3f(0, 0, 1), osg::Vec3f(0, 0, 1), osg::Vec4f(1, 0, 0, 1));
+        mInvBindMatrices = {osg::Matrixf(), osg::Matrixf()};
+        mWeights = {{{0, 1.f}, {2, 0.5f}}, {{1, 1.f}, {2, 0.5f}}};
+        const osg::ref_ptr<SkinningData> data = createSkinningData();
+        EXPECT_EQ(data->getNumBones(), 2u);
+        EXPECT_EQ(data->getNumGroups(), 3u);
+        EXPECT_EQ(data->getNumVertices(), 3u);
+
+        const osg::Matrixf bone0 = osg::Matrixf::translate(2, 0, 0);
+        const osg::Matrixf bone1 = osg::Matrixf::scale(2, 2, 2);
+        std::vector<osg::Matrixf> groupMatrices;
+        data->computeGroupMatrices({&bone0, &bone1}, nullptr, groupMatrices);
+
+        for (const bool vectorized : {false, true})
+        {
+            osg::ref_ptr<osg::Vec3Array> positions (new osg::Vec3Array(3));
+            osg::ref_ptr<osg::Vec3Array> normals (new osg::Vec3Array(3));
+            osg::ref_ptr<osg::Vec4Array> tangents (new osg::Vec4Array(3));
+            data->skin(groupMatrices, *positions, normals, tangents, vectorized);
+
+            expectNear(osg::Vec3f(3, 0, 0), (*positions)[0]);
+            expectNear(osg::Vec3f(0, 2, 0), (*positions)[1]);
+            expectNear(osg::Vec3f(1, 0, 1.5f), (*positions)[2]);
+            expectNear(osg::Vec3f(0, 0, 1), (*normals)[0]);
+            expectNear(osg::Vec3f(0, 0, 2), (*normals)[1]);
+            expectNear(osg::Vec3f(0, 0, 1.5f), (*normals)[2]);
+            expectNear(osg::Vec3f(2, 0, 0), osg::Vec3f((*tangents)[1].x(), (*tangents)[1].y(), (*tangents)[1].z()));
+            EXPECT_EQ((*tangents)[0].w(), -1.f);
+            EXPECT_EQ((*tangents)[1].w(), 1.f);
+        }
+    }
+
+    TEST_F(SceneUtilSkinningTest, vectorized_kernel_should_match_scalar_kernel)
+    {
+        const int numVertices = 1000;
+        const int numBones = 8;
+        mInvBindMatrices.resize(numBones);
+        mWeights.resize(numBones);
+        for (int i = 0; i < numVertices; ++i)
+        {
+            addVertex(osg::Vec3f(i * 0.1f, i * -0.2f, i * 0.3f), osg::Vec3f(0, 1, 0), osg::Vec4f(1, 0, 0, i % 2 ? 1 : -1));
+            mWeights[i % numBones].emplace_back(i, 0.75f);
+            mWeights[(i * 7 + 3) % numBones].emplace_back(i, 0.25f);
+        }
+
+        std::vector<osg::Matrixf> boneMatrices;
+        std::vector<const osg::Matrixf*> bonePointers;
+        for (int i = 0; i < numBones; ++i)
+        {
+            mInvBindMatrices[i] = osg::Matrixf::translate(-i, 0, 0);
+            boneMatrices.push_back(osg::Matrixf::rotate(i * 0.3f, 0, 0, 1) * osg::Matrixf::translate(i, i * 2.f, 1));
+        }
+        for (const osg::Matrixf& matrix : boneMatrices)
+            bonePointers.push_back(&matrix);
+
+        const osg::ref_ptr<SkinningData> data = createSkinningData();
+        std::vector<osg::Matrixf> groupMatrices;
+        const osg::Matrix geomToSkelMatrix = osg::Matrix::scale(0.5f, 0.5f, 0.5f);
+        data->computeGroupMatrices(bonePointers, &geomToSkelMatrix, groupMatrices);
+
+        osg::ref_ptr<osg::Vec3Array> scalarPositions (new osg::Vec3Array(numVertices));
+        osg::ref_ptr<osg::Vec3Array> scalarNormals (new osg::Vec3Array(numVertices));
+        osg::ref_ptr<osg::Vec4Array> scalarTangents (new osg::Vec4Array(numVertices));
+        data->skin(groupMatrices, *scalarPositions, scalarNormals, scalarTangents, false);
+
+        osg::ref_ptr<osg::Vec3Array> positions (new osg::Vec3Array(numVertices));
+        osg::ref_ptr<osg::Vec3Array> normals (new osg::Vec3Array(numVertices));
+        osg::ref_ptr<osg::Vec4Array> tangents (new osg::Vec4Array(numVertices));
+        data->skin(groupMatrices, *positions, normals, tangents, true);
+
+        for (int i = 0; i < numVertices; ++i)
+        {
+            expectNear((*scalarPositions)[i], (*positions)[i]);
+            expectNear((*scalarNormals)[i], (*normals)[i]);
+            EXPECT_EQ((*scalarTangents)[i].w(), (*tangents)[i].w());
+        }
+    }
+
+    TEST_F(SceneUtilSkinningTest, should_ignore_missing_bones)
+    {
+        addVertex(osg::Vec3f(1, 1, 1), osg::Vec3f(0, 0, 1), osg::Vec4f(1, 0, 0, 1));
+        mInvBindMatrices = {osg::Matrixf(), osg::Matrixf()};
+        mWeights = {{{0, 0.5f}}, {{0, 0.5f}}};
+        const osg::ref_ptr<SkinningData> data = createSkinningData();
+
+        const osg::Matrixf bone1 = osg::Matrixf::translate(0, 0, 2);
+        std::vector<osg::Matrixf> groupMatrices;
+        data->computeGroupMatrices({nullptr, &bone1}, nullptr, groupMatrices);
+
+        osg::ref_ptr<osg::Vec3Array> positions (new osg::Vec3Array(1));
+        data->skin(groupMatrices, *positions, nullptr, nullptr);
+        expectNear(osg::Vec3f(0.5f, 0.5f, 1.5f), (*positions)[0]);
+    }
+
+    TEST_F(SceneUtilSkinningTest, should_skip_vertices_out_of_range)
+    {
+        addVertex(osg::Vec3f(1, 1, 1), osg::Vec3f(0, 0, 1), osg::Vec4f(1, 0, 0, 1));
+        mInvBindMatrices = {osg::Matrixf()};
+        mWeights = {{{0, 1.f}, {5, 1.f}}};
+        const osg::ref_ptr<SkinningData> data = createSkinningData();
+        EXPECT_EQ(data->getNumVertices(), 1u);
+    }
+}
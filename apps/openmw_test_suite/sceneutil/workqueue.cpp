@@ -0,0 +1,115 @@
+#include <components/sceneutil/workqueue.hpp>
+
+#include <gtest/gtest.h>
+
+#include <mutex>
+
+namespace
+{
+    using namespace testing;
+    using namespace SceneUtil;
+
+    /// Blocks the work thread until released, to queue up items behind it
+    struct BlockingWorkItem : WorkItem
+    {
+        std::mutex mMutex;
+
+        BlockingWorkItem() { mMutex.lock(); }
+
+        void doWork() override
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+        }
+
+        void release() { mMutex.unlock(); }
+    };
+
+    struct RecordingWorkItem : WorkItem
+    {
+        int mId;
+        std::vector<int>& mOrder;
+        std::mutex& mMutex;
+
+        RecordingWorkItem(int id, std::vector<int>& order, std::mutex& mutex)
+            : mId(id), mOrder(order), mMutex(mutex) {}
+
+        void doWork() override
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mOrder.push_back(mId);
+        }
+    };
+
+    struct SceneUtilWorkQueueTest : Test
+    {
+        std::vector<int> mOrder;
+        std::mutex mMutex;
+
+        osg::ref_ptr<RecordingWorkItem> makeItem(int id)
+        {
+            return new RecordingWorkItem(id, mOrder, mMutex);
+        }
+    };
+
+    TEST_F(SceneUtilWorkQueueTest, should_start_items_with_higher_priority_first)
+    {
+        osg::ref_ptr<WorkQueue> queue(new WorkQueue(1));
+        osg::ref_ptr<BlockingWorkItem> blocking(new BlockingWorkItem);
+        queue->addWorkItem(blocking);
+        while (queue->getNumItems() != 0) {}
+
+        std::vector<osg::ref_ptr<RecordingWorkItem>> items;
+        const WorkPriority priorities[] = {WorkPriority_Background, WorkPriority_Predicted, WorkPriority_Background,
+                                           WorkPriority_Immediate, WorkPriority_Predicted};
+        for (int i = 0; i < 5; ++i)
+        {
+            items.push_back(makeItem(i));
+            queue->addWorkItem(items.back(), priorities[i]);
+        }
+        EXPECT_EQ(queue->getNumItems(), 5u);
+        EXPECT_EQ(queue->getNumItems(WorkPriority_Background), 2u);
+
+        blocking->release();
+        for (auto& item : items)
+            item->waitTillDone();
+
+        EXPECT_EQ(mOrder, std::vector<int>({3, 1, 4, 0, 2}));
+    }
+
+    TEST_F(SceneUtilWorkQueueTest, cancelled_item_should_be_done_without_doing_work)
+    {
+        osg::ref_ptr<WorkQueue> queue(new WorkQueue(1));
+        osg::ref_ptr<BlockingWorkItem> blocking(new BlockingWorkItem);
+        queue->addWorkItem(blocking);
+        while (queue->getNumItems() != 0) {}
+
+        osg::ref_ptr<RecordingWorkItem> cancelled = makeItem(0);
+        osg::ref_ptr<RecordingWorkItem> kept = makeItem(1);
+        queue->addWorkItem(cancelled);
+        queue->addWorkItem(kept);
+        cancelled->cancel();
+
+        blocking->release();
+        cancelled->waitTillDone();
+        kept->waitTillDone();
+
+        EXPECT_TRUE(cancelled->isCancelled());
+        EXPECT_EQ(mOrder, std::vector<int>({1}));
+    }
+
+    TEST_F(SceneUtilWorkQueueTest, all_items_should_be_done_with_multiple_threads)
+    {
+        osg::ref_ptr<WorkQueue> queue(new WorkQueue(4));
+        std::vector<osg::ref_ptr<RecordingWorkItem>> items;
+        for (int i = 0; i < 1000; ++i)
+        {
+            items.push_back(makeItem(i));
+            queue->addWorkItem(items.back(), static_cast<WorkPriority>(i % WorkPriority_Count));
+        }
+        for (auto& item : items)
+            item->waitTillDone();
+
+        EXPECT_EQ(mOrder.size(), 1000u);
+        EXPECT_EQ(queue->getNumItems(), 0u);
+    }
+}
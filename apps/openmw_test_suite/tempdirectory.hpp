@@ -0,0 +1,23 @@
+#ifndef OPENMW_TEST_SUITE_TEMPDIRECTORY_H
+#define OPENMW_TEST_SUITE_TEMPDIRECTORY_H
+
+#include <boost/filesystem/operations.hpp>
+
+#include <gtest/gtest.h>
+
+namespace TestingOpenMW
+{
+    /// Fixture owning a unique directory under the system temporary path, removed with its content after the test
+    struct TempDirectoryTest : testing::Test
+    {
+        const boost::filesystem::path mPath = boost::filesystem::temp_directory_path()
+            / boost::filesystem::unique_path("openmw-test-%%%%-%%%%-%%%%");
+
+        ~TempDirectoryTest()
+        {
+            boost::filesystem::remove_all(mPath);
+        }
+    };
+}
+
+#endif
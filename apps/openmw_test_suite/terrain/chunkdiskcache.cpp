@@ -0,0 +1,194 @@
+#include "../tempdirectory.hpp"
+
+#include <components/terrain/chunkdiskcache.hpp>
+#include <components/vfs/archive.hpp>
+#include <components/vfs/manager.hpp>
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+
+namespace
+{
+    using namespace testing;
+    using namespace Terrain;
+
+    struct StampedFile : VFS::File
+    {
+        std::uint64_t mStamp;
+
+        explicit StampedFile(std::uint64_t stamp) : mStamp(stamp) {}
+
+        Files::IStreamPtr open() override { return nullptr; }
+
+        std::uint64_t getStamp() override { return mStamp; }
+    };
+
+    /// Archive of files with the given names and stamps
+    struct StampedArchive : VFS::Archive
+    {
+        std::map<std::string, StampedFile> mFiles;
+
+        StampedArchive(const std::map<std::string, std::uint64_t>& files)
+        {
+            for (const auto& file : files)
+                mFiles.emplace(file.first, StampedFile(file.second));
+        }
+
+        void listResources(std::map<std::string, VFS::File*>& out, char (*/*normalize_function*/) (char)) override
+        {
+            for (auto& file : mFiles)
+                out[file.first] = &file.second;
+        }
+    };
+
+    std::uint64_t makeTexturesHash(const std::map<std::string, std::uint64_t>& files)
+    {
+        VFS::Manager vfs(false);
+        vfs.addArchive(new StampedArchive(files));
+        vfs.buildIndex();
+        return ChunkDiskCache::makeTexturesHash(vfs, {"textures\\Tx_Grass.dds"});
+    }
+
+    struct TerrainChunkDiskCacheTest : TestingOpenMW::TempDirectoryTest
+    {
+        const std::size_t mMaxSize = 1024 * 1024;
+        const std::uint64_t mContentHash = 42;
+        const std::uint64_t mTexturesHash = 13;
+        const osg::Vec2f mCenter {0.5f, -1.5f};
+        osg::ref_ptr<osg::Vec3Array> mPositions {new osg::Vec3Array};
+        osg::ref_ptr<osg::Vec3Array> mNormals {new osg::Vec3Array};
+        osg::ref_ptr<osg::Vec4ubArray> mColours {new osg::Vec4ubArray};
+
+        TerrainChunkDiskCacheTest()
+        {
+            for (int i = 0; i < 9; ++i)
+            {
+                mPositions->push_back(osg::Vec3f(i % 3, i / 3, i));
+                mNormals->push_back(osg::Vec3f(0, 0, 1));
+                mColours->push_back(osg::Vec4ub(i, 255, 255, 255));
+            }
+        }
+
+        osg::ref_ptr<osg::Image> makeImage(unsigned int resolution)
+        {
+            osg::ref_ptr<osg::Image> image (new osg::Image);
+            image->allocateImage(resolution, resolution, 1, GL_RGB, GL_UNSIGNED_BYTE);
+            for (unsigned int i = 0; i < image->getTotalSizeInBytes(); ++i)
+                image->data()[i] = static_cast<unsigned char>(i);
+            return image;
+        }
+    };
+
+    TEST_F(TerrainChunkDiskCacheTest, get_vertex_buffers_for_empty_cache_should_return_false)
+    {
+        ChunkDiskCache cache(mPath, mMaxSize, mContentHash, mTexturesHash);
+        osg::ref_ptr<osg::Vec3Array> positions (new osg::Vec3Array);
+        osg::ref_ptr<osg::Vec3Array> normals (new osg::Vec3Array);
+        osg::ref_ptr<osg::Vec4ubArray> colours (new osg::Vec4ubArray);
+        EXPECT_FALSE(cache.getVertexBuffers(0, 1, mCenter, *positions, *normals, *colours));
+        EXPECT_TRUE(positions->empty());
+    }
+
+    TEST_F(TerrainChunkDiskCacheTest, get_vertex_buffers_should_return_stored_ones)
+    {
+        ChunkDiskCache cache(mPath, mMaxSize, mContentHash, mTexturesHash);
+        cache.setVertexBuffers(1, 2, mCenter, *mPositions, *mNormals, *mColours);
+        osg::ref_ptr<osg::Vec3Array> positions (new osg::Vec3Array);
+        osg::ref_ptr<osg::Vec3Array> normals (new osg::Vec3Array);
+        osg::ref_ptr<osg::Vec4ubArray> colours (new osg::Vec4ubArray);
+        ASSERT_TRUE(cache.getVertexBuffers(1, 2, mCenter, *positions, *normals, *colours));
+        EXPECT_EQ(positions->asVector(), mPositions->asVector());
+        EXPECT_EQ(normals->asVector(), mNormals->asVector());
+        EXPECT_EQ(colours->asVector(), mColours->asVector());
+    }
+
+    TEST_F(TerrainChunkDiskCacheTest, get_vertex_buffers_for_other_lod_should_return_false)
+    {
+        ChunkDiskCache cache(mPath, mMaxSize, mContentHash, mTexturesHash);
+        cache.setVertexBuffers(1, 2, mCenter, *mPositions, *mNormals, *mColours);
+        osg::ref_ptr<osg::Vec3Array> positions (new osg::Vec3Array);
+        osg::ref_ptr<osg::Vec3Array> normals (new osg::Vec3Array);
+        osg::ref_ptr<osg::Vec4ubArray> colours (new osg::Vec4ubArray);
+        EXPECT_FALSE(cache.getVertexBuffers(2, 2, mCenter, *positions, *normals, *colours));
+    }
+
+    TEST_F(TerrainChunkDiskCacheTest, get_vertex_buffers_for_other_content_should_return_false)
+    {
+        {
+            ChunkDiskCache cache(mPath, mMaxSize, mContentHash, mTexturesHash);
+            cache.setVertexBuffers(1, 2, mCenter, *mPositions, *mNormals, *mColours);
+        }
+        ChunkDiskCache cache(mPath, mMaxSize, mContentHash + 1, mTexturesHash);
+        osg::ref_ptr<osg::Vec3Array> positions (new osg::Vec3Array);
+        osg::ref_ptr<osg::Vec3Array> normals (new osg::Vec3Array);
+        osg::ref_ptr<osg::Vec4ubArray> colours (new osg::Vec4ubArray);
+        EXPECT_FALSE(cache.getVertexBuffers(1, 2, mCenter, *positions, *normals, *colours));
+    }
+
+    TEST_F(TerrainChunkDiskCacheTest, get_composite_map_should_return_stored_image)
+    {
+        ChunkDiskCache cache(mPath, mMaxSize, mContentHash, mTexturesHash);
+        const osg::ref_ptr<osg::Image> image = makeImage(16);
+        cache.setCompositeMap(4, mCenter, *image);
+        const osg::ref_ptr<osg::Image> result = cache.getCompositeMap(4, mCenter, 16);
+        ASSERT_TRUE(result);
+        ASSERT_EQ(result->getTotalSizeInBytes(), image->getTotalSizeInBytes());
+        EXPECT_EQ(std::memcmp(result->data(), image->data(), image->getTotalSizeInBytes()), 0);
+    }
+
+    TEST_F(TerrainChunkDiskCacheTest, get_composite_map_for_other_resolution_should_return_null)
+    {
+        ChunkDiskCache cache(mPath, mMaxSize, mContentHash, mTexturesHash);
+        cache.setCompositeMap(4, mCenter, *makeImage(16));
+        EXPECT_FALSE(cache.getCompositeMap(4, mCenter, 32));
+    }
+
+    TEST_F(TerrainChunkDiskCacheTest, get_composite_map_for_other_textures_should_return_null)
+    {
+        {
+            ChunkDiskCache cache(mPath, mMaxSize, mContentHash, mTexturesHash);
+            cache.setCompositeMap(4, mCenter, *makeImage(16));
+        }
+        ChunkDiskCache cache(mPath, mMaxSize, mContentHash, mTexturesHash + 1);
+        EXPECT_FALSE(cache.getCompositeMap(4, mCenter, 16));
+    }
+
+    TEST_F(TerrainChunkDiskCacheTest, get_vertex_buffers_for_other_textures_should_return_stored_ones)
+    {
+        {
+            ChunkDiskCache cache(mPath, mMaxSize, mContentHash, mTexturesHash);
+            cache.setVertexBuffers(1, 2, mCenter, *mPositions, *mNormals, *mColours);
+        }
+        ChunkDiskCache cache(mPath, mMaxSize, mContentHash, mTexturesHash + 1);
+        osg::ref_ptr<osg::Vec3Array> positions (new osg::Vec3Array);
+        osg::ref_ptr<osg::Vec3Array> normals (new osg::Vec3Array);
+        osg::ref_ptr<osg::Vec4ubArray> colours (new osg::Vec4ubArray);
+        EXPECT_TRUE(cache.getVertexBuffers(1, 2, mCenter, *positions, *normals, *colours));
+    }
+
+    TEST(TerrainChunkDiskCacheTexturesHashTest, make_textures_hash_should_change_with_texture_stamp)
+    {
+        EXPECT_NE(makeTexturesHash({{"textures/tx_grass.dds", 1}}), makeTexturesHash({{"textures/tx_grass.dds", 2}}));
+    }
+
+    TEST(TerrainChunkDiskCacheTexturesHashTest, make_textures_hash_should_change_with_variant_stamp)
+    {
+        EXPECT_NE(makeTexturesHash({{"textures/tx_grass.dds", 1}, {"textures/tx_grass_spec.dds", 1}}),
+                  makeTexturesHash({{"textures/tx_grass.dds", 1}, {"textures/tx_grass_spec.dds", 2}}));
+    }
+
+    TEST(TerrainChunkDiskCacheTexturesHashTest, make_textures_hash_should_change_with_added_replacer)
+    {
+        EXPECT_NE(makeTexturesHash({{"textures/tx_grass.tga", 1}}),
+                  makeTexturesHash({{"textures/tx_grass.tga", 1}, {"textures/tx_grass.dds", 1}}));
+    }
+
+    TEST(TerrainChunkDiskCacheTexturesHashTest, make_textures_hash_should_not_depend_on_other_stamps)
+    {
+        EXPECT_EQ(makeTexturesHash({{"textures/tx_grass.dds", 1}, {"textures/tx_rock.dds", 1}}),
+                  makeTexturesHash({{"textures/tx_grass.dds", 1}, {"textures/tx_rock.dds", 2}}));
+        EXPECT_EQ(makeTexturesHash({{"textures/tx_grass.dds", 1}}),
+                  makeTexturesHash({{"textures/tx_grass.dds", 1}, {"meshes/m/misc_com_bottle_01.nif", 1}}));
+    }
+}
@@ -0,0 +1,147 @@
+#include <components/vfs/archive.hpp>
+#include <components/vfs/manager.hpp>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <iterator>
+#include <sstream>
+
+namespace
+{
+    using namespace testing;
+
+    struct StringFile : VFS::File
+    {
+        std::string mContent;
+
+        StringFile(const std::string& content) : mContent(content) {}
+
+        Files::IStreamPtr open() override
+        {
+            return Files::IStreamPtr(new std::istringstream(mContent));
+        }
+    };
+
+    /// Archive with files named as given, each file contains its own original name
+    struct StringArchive : VFS::Archive
+    {
+        std::map<std::string, StringFile> mFiles;
+
+        StringArchive(const std::vector<std::string>& names)
+        {
+            for (const std::string& name : names)
+                mFiles.emplace(name, StringFile(name));
+        }
+
+        void listResources(std::map<std::string, VFS::File*>& out, char (*normalize_function) (char)) override
+        {
+            for (auto& file : mFiles)
+            {
+                std::string normalized;
+                std::transform(file.first.begin(), file.first.end(), std::back_inserter(normalized), normalize_function);
+                out[normalized] = &file.second;
+            }
+        }
+    };
+
+    std::string read(Files::IStreamPtr stream)
+    {
+        std::stringstream result;
+        result << stream->rdbuf();
+        return result.str();
+    }
+
+    struct VFSManagerTest : Test
+    {
+        VFS::Manager mManager {false};
+
+        VFSManagerTest()
+        {
+            std::vector<std::string> names;
+            for (int i = 0; i < 1000; ++i)
+                names.push_back("Meshes\\X\\Ex_Static_" + std::to_string(i) + ".NIF");
+            mManager.addArchive(new StringArchive(names));
+            mManager.addArchive(new StringArchive({"meshes\\x\\ex_static_1.nif", "textures/tx_a.dds"}));
+            mManager.buildIndex();
+        }
+    };
+
+    TEST_F(VFSManagerTest, exists_should_normalize_name)
+    {
+        EXPECT_TRUE(mManager.exists("meshes/x/ex_static_0.nif"));
+        EXPECT_TRUE(mManager.exists("MESHES\\X\\EX_STATIC_999.NIF"));
+        EXPECT_TRUE(mManager.exists("Textures\\Tx_A.dds"));
+        EXPECT_FALSE(mManager.exists("meshes/x/ex_static_1000.nif"));
+        EXPECT_FALSE(mManager.exists("meshes/x/ex_static_0.ni"));
+        EXPECT_FALSE(mManager.exists(""));
+    }
+
+    TEST_F(VFSManagerTest, exists_normalized_should_not_normalize_name)
+    {
+        EXPECT_TRUE(mManager.existsNormalized("meshes/x/ex_static_0.nif"));
+        EXPECT_FALSE(mManager.existsNormalized("Meshes\\X\\Ex_Static_0.NIF"));
+    }
+
+    TEST_F(VFSManagerTest, get_should_return_file_from_last_added_archive)
+    {
+        EXPECT_EQ(read(mManager.get("Meshes/X/Ex_Static_0.nif")), "Meshes\\X\\Ex_Static_0.NIF");
+        EXPECT_EQ(read(mManager.get("Meshes/X/Ex_Static_1.nif")), "meshes\\x\\ex_static_1.nif");
+        EXPECT_EQ(read(mManager.getNormalized("meshes/x/ex_static_1.nif")), "meshes\\x\\ex_static_1.nif");
+    }
+
+    TEST_F(VFSManagerTest, get_should_throw_for_missing_file)
+    {
+        EXPECT_THROW(mManager.get("Meshes/Missing.nif"), std::runtime_error);
+        EXPECT_THROW(mManager.getNormalized("Meshes/X/Ex_Static_0.NIF"), std::runtime_error);
+    }
+
+    TEST_F(VFSManagerTest, index_should_contain_normalized_names)
+    {
+        EXPECT_EQ(mManager.getIndex().size(), 1001u);
+        EXPECT_EQ(mManager.getIndex().count("textures/tx_a.dds"), 1u);
+    }
+
+    TEST(VFSManagerStrictTest, exists_should_only_convert_slashes)
+    {
+        VFS::Manager manager(true);
+        manager.addArchive(new StringArchive({"Meshes\\Foo.nif"}));
+        manager.buildIndex();
+        EXPECT_TRUE(manager.exists("Meshes/Foo.nif"));
+        EXPECT_TRUE(manager.exists("Meshes\\Foo.nif"));
+        EXPECT_FALSE(manager.exists("meshes/foo.nif"));
+    }
+
+    TEST(VFSManagerEmptyTest, exists_should_return_false)
+    {
+        VFS::Manager manager(false);
+        EXPECT_FALSE(manager.exists("meshes/foo.nif"));
+        manager.buildIndex();
+        EXPECT_FALSE(manager.exists("meshes/foo.nif"));
+    }
+
+    TEST(VFSManagerIndexStampTest, get_index_stamp_should_change_when_file_is_added)
+    {
+        VFS::Manager first(false);
+        first.addArchive(new StringArchive({"textures/foo.tga"}));
+        first.buildIndex();
+        VFS::Manager second(false);
+        second.addArchive(new StringArchive({"textures/foo.tga"}));
+        second.addArchive(new StringArchive({"textures/foo.dds"}));
+        second.buildIndex();
+        EXPECT_NE(first.getIndexStamp(), second.getIndexStamp());
+    }
+
+    TEST(VFSManagerIndexStampTest, get_index_stamp_should_not_depend_on_archive_order_for_same_names)
+    {
+        VFS::Manager first(false);
+        first.addArchive(new StringArchive({"meshes/foo.nif"}));
+        first.addArchive(new StringArchive({"textures/foo.dds"}));
+        first.buildIndex();
+        VFS::Manager second(false);
+        second.addArchive(new StringArchive({"textures/foo.dds"}));
+        second.addArchive(new StringArchive({"meshes/foo.nif"}));
+        second.buildIndex();
+        EXPECT_EQ(first.getIndexStamp(), second.getIndexStamp());
+    }
+}
@@ -5,6 +5,8 @@
 
 #include <components/debug/debuglog.hpp>
 
+#include <DetourNavMesh.h>
+
 #include <osg/Stats>
 
 namespace
@@ -16,6 +18,22 @@ namespace
     {
         return std::abs(lhs.x() - rhs.x()) + std::abs(lhs.y() - rhs.y());
     }
+
+    const std::array<const char*, 5> jobLatencyStatNames {{
+        "NavMesh JobLatency<10ms",
+        "NavMesh JobLatency<100ms",
+        "NavMesh JobLatency<1s",
+        "NavMesh JobLatency<10s",
+        "NavMesh JobLatency>=10s",
+    }};
+
+    std::size_t getJobLatencyBucket(std::chrono::steady_clock::duration latency)
+    {
+        std::size_t bucket = 0;
+        for (std::chrono::milliseconds limit(10); bucket + 1 < jobLatencyStatNames.size() && latency >= limit; limit *= 10)
+            ++bucket;
+        return bucket;
+    }
 }
 
 namespace DetourNavigator
@@ -46,8 +64,14 @@ namespace DetourNavigator
         , mRecastMeshManager(recastMeshManager)
         , mOffMeshConnectionsManager(offMeshConnectionsManager)
         , mShouldStop()
+        , mCoalescedJobs(0)
+        , mEvictedJobs(0)
+        , mJobLatencies()
         , mNavMeshTilesCache(settings.mMaxNavMeshTilesCacheSize)
     {
+        if (settings.mEnableNavMeshDiskCache && !settings.mNavMeshDiskCachePath.empty())
+            mNavMeshDiskCache.reset(new NavMeshDiskCache(settings.mNavMeshDiskCachePath,
+                                                         settings.mMaxNavMeshDiskCacheSize, settings));
         for (std::size_t i = 0; i < mSettings.get().mAsyncNavMeshUpdaterThreads; ++i)
             mThreads.emplace_back([&] { process(); });
     }
@@ -56,7 +80,8 @@ namespace DetourNavigator
     {
         mShouldStop = true;
         std::unique_lock<std::mutex> lock(mMutex);
-        mJobs = decltype(mJobs)();
+        mPushed.clear();
+        mJobs.clear();
         mHasJob.notify_all();
         lock.unlock();
         for (auto& thread : mThreads)
@@ -67,29 +92,56 @@ namespace DetourNavigator
         const SharedNavMeshCacheItem& navMeshCacheItem, const TilePosition& playerTile,
         const std::map<TilePosition, ChangeType>& changedTiles)
     {
-        *mPlayerTile.lock() = playerTile;
+        bool playerTileChanged = false;
+
+        {
+            auto locked = mPlayerTile.lock();
+            playerTileChanged = *locked != playerTile;
+            *locked = playerTile;
+        }
 
-        if (changedTiles.empty())
+        if (changedTiles.empty() && !playerTileChanged)
             return;
 
+        const auto maxTiles = playerTileChanged
+            ? std::min(mSettings.get().mMaxTilesNumber, navMeshCacheItem->lockConst()->getImpl().getParams()->maxTiles)
+            : 0;
+        const auto now = std::chrono::steady_clock::now();
+
         const std::lock_guard<std::mutex> lock(mMutex);
 
+        if (playerTileChanged)
+            evictJobs(agentHalfExtents, navMeshCacheItem, playerTile, maxTiles);
+
         for (const auto& changedTile : changedTiles)
         {
-            if (mPushed[agentHalfExtents].insert(changedTile.first).second)
-            {
-                Job job;
+            const auto pushed = mPushed.find(JobKey(agentHalfExtents, changedTile.first));
 
-                job.mAgentHalfExtents = agentHalfExtents;
-                job.mNavMeshCacheItem = navMeshCacheItem;
-                job.mChangedTile = changedTile.first;
+            if (pushed != mPushed.end())
+            {
+                // The priority changes, so the job is queued again
+                Job job = std::move(pushed->second->second);
+                mJobs.erase(pushed->second);
                 job.mTryNumber = 0;
-                job.mChangeType = changedTile.second;
-                job.mDistanceToPlayer = getManhattanDistance(changedTile.first, playerTile);
-                job.mDistanceToOrigin = getManhattanDistance(changedTile.first, TilePosition {0, 0});
-
-                mJobs.push(std::move(job));
+                job.mChangeType = addChangeType(job.mChangeType, changedTile.second);
+                const JobPriority priority = job.getPriority();
+                pushed->second = mJobs.emplace(priority, std::move(job));
+                ++mCoalescedJobs;
+                continue;
             }
+
+            Job job;
+
+            job.mAgentHalfExtents = agentHalfExtents;
+            job.mNavMeshCacheItem = navMeshCacheItem;
+            job.mChangedTile = changedTile.first;
+            job.mTryNumber = 0;
+            job.mChangeType = changedTile.second;
+            job.mDistanceToPlayer = getManhattanDistance(changedTile.first, playerTile);
+            job.mDistanceToOrigin = getManhattanDistance(changedTile.first, TilePosition {0, 0});
+            job.mPostTime = now;
+
+            pushJob(std::move(job));
         }
 
         Log(Debug::Debug) << "Posted " << mJobs.size() << " navigator jobs";
@@ -101,21 +153,35 @@ namespace DetourNavigator
     void AsyncNavMeshUpdater::wait()
     {
         std::unique_lock<std::mutex> lock(mMutex);
-        mDone.wait(lock, [&] { return mJobs.empty(); });
+        mDone.wait(lock, [&] { return mJobs.empty() && mProcessingTiles.empty(); });
     }
 
     void AsyncNavMeshUpdater::reportStats(unsigned int frameNumber, osg::Stats& stats) const
     {
         std::size_t jobs = 0;
+        std::size_t coalescedJobs = 0;
+        std::size_t evictedJobs = 0;
+        std::array<std::size_t, 5> jobLatencies;
 
         {
             const std::lock_guard<std::mutex> lock(mMutex);
             jobs = mJobs.size();
+            coalescedJobs = mCoalescedJobs;
+            evictedJobs = mEvictedJobs;
+            jobLatencies = mJobLatencies;
         }
 
         stats.setAttribute(frameNumber, "NavMesh UpdateJobs", jobs);
+        stats.setAttribute(frameNumber, "NavMesh CoalescedJobs", coalescedJobs);
+        stats.setAttribute(frameNumber, "NavMesh EvictedJobs", evictedJobs);
+
+        for (std::size_t i = 0; i < jobLatencies.size(); ++i)
+            stats.setAttribute(frameNumber, jobLatencyStatNames[i], jobLatencies[i]);
 
         mNavMeshTilesCache.reportStats(frameNumber, stats);
+
+        if (mNavMeshDiskCache)
+            mNavMeshDiskCache->reportStats(frameNumber, stats);
     }
 
     void AsyncNavMeshUpdater::process() throw()
@@ -127,10 +193,17 @@ namespace DetourNavigator
             {
                 if (auto job = getNextJob())
                 {
-                    const auto processed = processJob(*job);
-                    unlockTile(job->mAgentHalfExtents, job->mChangedTile);
-                    if (!processed)
-                        repost(std::move(*job));
+                    bool processed = false;
+                    try
+                    {
+                        processed = processJob(*job);
+                    }
+                    catch (...)
+                    {
+                        releaseJob(std::move(*job), true);
+                        throw;
+                    }
+                    releaseJob(std::move(*job), processed);
                 }
             }
             catch (const std::exception& e)
@@ -159,7 +232,7 @@ namespace DetourNavigator
         const auto offMeshConnections = mOffMeshConnectionsManager.get().get(job.mChangedTile);
 
         const auto status = updateNavMesh(job.mAgentHalfExtents, recastMesh.get(), job.mChangedTile, playerTile,
-            offMeshConnections, mSettings, navMeshCacheItem, mNavMeshTilesCache);
+            offMeshConnections, mSettings, navMeshCacheItem, mNavMeshTilesCache, mNavMeshDiskCache.get());
 
         const auto finish = std::chrono::steady_clock::now();
 
@@ -183,47 +256,79 @@ namespace DetourNavigator
     {
         std::unique_lock<std::mutex> lock(mMutex);
 
-        const auto threadId = std::this_thread::get_id();
-        auto& threadQueue = mThreadsQueues[threadId];
+        auto job = mJobs.end();
+        const auto hasJob = [&] { job = getReadyJob(); return job != mJobs.end(); };
 
-        while (true)
+        if (!mHasJob.wait_for(lock, std::chrono::milliseconds(10), hasJob))
         {
-            const auto hasJob = [&] { return !mJobs.empty() || !threadQueue.mPushed.empty(); };
-
-            if (!mHasJob.wait_for(lock, std::chrono::milliseconds(10), hasJob))
+            if (mProcessingTiles.empty())
             {
                 mFirstStart.lock()->reset();
                 mDone.notify_all();
-                return boost::none;
             }
+            return boost::none;
+        }
 
-            Log(Debug::Debug) << "Got " << mJobs.size() << " navigator jobs and "
-                << threadQueue.mJobs.size() << " thread jobs";
+        Log(Debug::Debug) << "Got " << mJobs.size() << " navigator jobs and "
+            << mProcessingTiles.size() << " processing tiles";
 
-            auto job = threadQueue.mJobs.empty()
-                ? getJob(mJobs, mPushed)
-                : getJob(threadQueue.mJobs, threadQueue.mPushed);
+        const JobKey key(job->second.mAgentHalfExtents, job->second.mChangedTile);
+        mPushed.erase(key);
+        mProcessingTiles.insert(key);
+        ++mJobLatencies[getJobLatencyBucket(std::chrono::steady_clock::now() - job->second.mPostTime)];
 
-            const auto owner = lockTile(job.mAgentHalfExtents, job.mChangedTile);
+        Job result = std::move(job->second);
+        mJobs.erase(job);
+        return result;
+    }
 
-            if (owner == threadId)
-                return job;
+    AsyncNavMeshUpdater::Jobs::iterator AsyncNavMeshUpdater::getReadyJob()
+    {
+        // Jobs of a tile processed by other thread wait until it's done, any other job can be taken by any thread.
+        // Only the jobs of the few processing tiles are skipped before the most important ready one.
+        for (auto it = mJobs.begin(); it != mJobs.end(); ++it)
+            if (mProcessingTiles.empty() || !mProcessingTiles.count(JobKey(it->second.mAgentHalfExtents, it->second.mChangedTile)))
+                return it;
+        return mJobs.end();
+    }
 
-            postThreadJob(std::move(job), mThreadsQueues[owner]);
-        }
+    void AsyncNavMeshUpdater::pushJob(Job&& job)
+    {
+        const JobKey key(job.mAgentHalfExtents, job.mChangedTile);
+        const JobPriority priority = job.getPriority();
+        mPushed.emplace(key, mJobs.emplace(priority, std::move(job)));
     }
 
-    AsyncNavMeshUpdater::Job AsyncNavMeshUpdater::getJob(Jobs& jobs, Pushed& pushed)
+    void AsyncNavMeshUpdater::evictJobs(const osg::Vec3f& agentHalfExtents,
+        const SharedNavMeshCacheItem& navMeshCacheItem, const TilePosition& playerTile, int maxTiles)
     {
-        auto job = jobs.top();
-        jobs.pop();
+        // Only the jobs of tiles missing from the nav mesh are dropped. A job of a present tile may be the removal of
+        // geometry the recast mesh manager doesn't have anymore, nothing would post it again.
+        const auto locked = navMeshCacheItem->lockConst();
+        const auto& navMesh = locked->getImpl();
 
-        const auto it = pushed.find(job.mAgentHalfExtents);
-        it->second.erase(job.mChangedTile);
-        if (it->second.empty())
-            pushed.erase(it);
+        // The distances to the player change, so the remaining jobs are ordered again
+        Jobs jobs;
+        for (auto& entry : mJobs)
+        {
+            Job& job = entry.second;
+            const JobKey key(job.mAgentHalfExtents, job.mChangedTile);
 
-        return job;
+            if (job.mNavMeshCacheItem.expired()
+                || (job.mAgentHalfExtents == agentHalfExtents && !shouldAddTile(job.mChangedTile, playerTile, maxTiles)
+                    && !navMesh.getTileAt(job.mChangedTile.x(), job.mChangedTile.y(), 0)))
+            {
+                mPushed.erase(key);
+                ++mEvictedJobs;
+                continue;
+            }
+
+            job.mDistanceToPlayer = getManhattanDistance(job.mChangedTile, playerTile);
+            const JobPriority priority = job.getPriority();
+            mPushed[key] = jobs.emplace(priority, std::move(job));
+        }
+        // Unlike assignment, swap keeps the iterators stored in mPushed valid
+        mJobs.swap(jobs);
     }
 
     void AsyncNavMeshUpdater::writeDebugFiles(const Job& job, const RecastMesh* recastMesh) const
@@ -257,74 +362,23 @@ namespace DetourNavigator
         return *locked.get();
     }
 
-    void AsyncNavMeshUpdater::repost(Job&& job)
+    void AsyncNavMeshUpdater::releaseJob(Job&& job, bool processed)
     {
-        if (mShouldStop || job.mTryNumber > 2)
-            return;
-
         const std::lock_guard<std::mutex> lock(mMutex);
 
-        if (mPushed[job.mAgentHalfExtents].insert(job.mChangedTile).second)
+        const JobKey key(job.mAgentHalfExtents, job.mChangedTile);
+        mProcessingTiles.erase(key);
+
+        if (!processed && !mShouldStop && job.mTryNumber <= 2 && !mPushed.count(key))
         {
             ++job.mTryNumber;
-            mJobs.push(std::move(job));
-            mHasJob.notify_all();
+            job.mPostTime = std::chrono::steady_clock::now();
+            pushJob(std::move(job));
         }
-    }
 
-    void AsyncNavMeshUpdater::postThreadJob(Job&& job, Queue& queue)
-    {
-        if (queue.mPushed[job.mAgentHalfExtents].insert(job.mChangedTile).second)
-        {
-            queue.mJobs.push(std::move(job));
+        if (!mJobs.empty())
             mHasJob.notify_all();
-        }
-    }
-
-    std::thread::id AsyncNavMeshUpdater::lockTile(const osg::Vec3f& agentHalfExtents, const TilePosition& changedTile)
-    {
-        if (mSettings.get().mAsyncNavMeshUpdaterThreads <= 1)
-            return std::this_thread::get_id();
-
-        auto locked = mProcessingTiles.lock();
-
-        auto agent = locked->find(agentHalfExtents);
-        if (agent == locked->end())
-        {
-            const auto threadId = std::this_thread::get_id();
-            locked->emplace(agentHalfExtents, std::map<TilePosition, std::thread::id>({{changedTile, threadId}}));
-            return threadId;
-        }
-
-        auto tile = agent->second.find(changedTile);
-        if (tile == agent->second.end())
-        {
-            const auto threadId = std::this_thread::get_id();
-            agent->second.emplace(changedTile, threadId);
-            return threadId;
-        }
-
-        return tile->second;
-    }
-
-    void AsyncNavMeshUpdater::unlockTile(const osg::Vec3f& agentHalfExtents, const TilePosition& changedTile)
-    {
-        if (mSettings.get().mAsyncNavMeshUpdaterThreads <= 1)
-            return;
-
-        auto locked = mProcessingTiles.lock();
-
-        auto agent = locked->find(agentHalfExtents);
-        if (agent == locked->end())
-            return;
-
-        auto tile = agent->second.find(changedTile);
-        if (tile == agent->second.end())
-            return;
-
-        agent->second.erase(tile);
-
-        if (agent->second.empty())
-            locked->erase(agent);
+        else if (mProcessingTiles.empty())
+            mDone.notify_all();
     }
 }
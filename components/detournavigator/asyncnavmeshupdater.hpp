@@ -6,17 +6,19 @@
 #include "tilecachedrecastmeshmanager.hpp"
 #include "tileposition.hpp"
 #include "navmeshtilescache.hpp"
+#include "navmeshdiskcache.hpp"
 
 #include <osg/Vec3f>
 
 #include <boost/optional.hpp>
 
+#include <array>
 #include <atomic>
 #include <chrono>
 #include <condition_variable>
+#include <map>
 #include <memory>
 #include <mutex>
-#include <queue>
 #include <set>
 #include <thread>
 
@@ -32,6 +34,17 @@ namespace DetourNavigator
         update = 3,
     };
 
+    inline ChangeType addChangeType(const ChangeType current, const ChangeType add)
+    {
+        return current == add ? current : ChangeType::mixed;
+    }
+
+    /// \brief Updates nav mesh tiles in background threads.
+    ///
+    /// Any idle thread takes the most important job of a tile that is not processed by another thread. Jobs posted
+    /// again for a waiting tile are merged into one, and jobs of tiles that got too far from the player and are missing
+    /// from the nav mesh are dropped.
+
     class AsyncNavMeshUpdater
     {
     public:
@@ -47,6 +60,8 @@ namespace DetourNavigator
         void reportStats(unsigned int frameNumber, osg::Stats& stats) const;
 
     private:
+        using JobPriority = std::tuple<unsigned, ChangeType, int, int>;
+
         struct Job
         {
             osg::Vec3f mAgentHalfExtents;
@@ -56,28 +71,17 @@ namespace DetourNavigator
             ChangeType mChangeType;
             int mDistanceToPlayer;
             int mDistanceToOrigin;
+            std::chrono::steady_clock::time_point mPostTime;
 
-            std::tuple<unsigned, ChangeType, int, int> getPriority() const
+            JobPriority getPriority() const
             {
                 return std::make_tuple(mTryNumber, mChangeType, mDistanceToPlayer, mDistanceToOrigin);
             }
-
-            friend inline bool operator <(const Job& lhs, const Job& rhs)
-            {
-                return lhs.getPriority() > rhs.getPriority();
-            }
         };
 
-        using Jobs = std::priority_queue<Job, std::deque<Job>>;
-        using Pushed = std::map<osg::Vec3f, std::set<TilePosition>>;
-
-        struct Queue
-        {
-            Jobs mJobs;
-            Pushed mPushed;
-
-            Queue() = default;
-        };
+        /// Ordered by priority, the jobs of equal priority in the order they were posted
+        using Jobs = std::multimap<JobPriority, Job>;
+        using JobKey = std::tuple<osg::Vec3f, TilePosition>;
 
         std::reference_wrapper<const Settings> mSettings;
         std::reference_wrapper<TileCachedRecastMeshManager> mRecastMeshManager;
@@ -87,12 +91,15 @@ namespace DetourNavigator
         std::condition_variable mHasJob;
         std::condition_variable mDone;
         Jobs mJobs;
-        std::map<osg::Vec3f, std::set<TilePosition>> mPushed;
+        std::map<JobKey, Jobs::iterator> mPushed;
+        std::set<JobKey> mProcessingTiles;
+        std::size_t mCoalescedJobs;
+        std::size_t mEvictedJobs;
+        std::array<std::size_t, 5> mJobLatencies;
         Misc::ScopeGuarded<TilePosition> mPlayerTile;
         Misc::ScopeGuarded<boost::optional<std::chrono::steady_clock::time_point>> mFirstStart;
         NavMeshTilesCache mNavMeshTilesCache;
-        Misc::ScopeGuarded<std::map<osg::Vec3f, std::map<TilePosition, std::thread::id>>> mProcessingTiles;
-        std::map<std::thread::id, Queue> mThreadsQueues;
+        std::unique_ptr<NavMeshDiskCache> mNavMeshDiskCache;
         std::vector<std::thread> mThreads;
 
         void process() throw();
@@ -101,19 +108,18 @@ namespace DetourNavigator
 
         boost::optional<Job> getNextJob();
 
-        static Job getJob(Jobs& jobs, Pushed& pushed);
+        Jobs::iterator getReadyJob();
 
-        void postThreadJob(Job&& job, Queue& queue);
+        void pushJob(Job&& job);
+
+        void evictJobs(const osg::Vec3f& agentHalfExtents, const SharedNavMeshCacheItem& navMeshCacheItem,
+            const TilePosition& playerTile, int maxTiles);
 
         void writeDebugFiles(const Job& job, const RecastMesh* recastMesh) const;
 
         std::chrono::steady_clock::time_point setFirstStart(const std::chrono::steady_clock::time_point& value);
 
-        void repost(Job&& job);
-
-        std::thread::id lockTile(const osg::Vec3f& agentHalfExtents, const TilePosition& changedTile);
-
-        void unlockTile(const osg::Vec3f& agentHalfExtents, const TilePosition& changedTile);
+        void releaseJob(Job&& job, bool processed);
     };
 }
 
@@ -140,4 +140,51 @@ namespace DetourNavigator
 
         return result;
     }
+
+    boost::optional<std::vector<dtPolyRef>> findHierarchicalPath(const dtNavMesh& navMesh,
+        const dtNavMeshQuery& navMeshQuery, const TileGraph& tileGraph, const dtPolyRef startRef,
+        const dtPolyRef endRef, const osg::Vec3f& startPos, const osg::Vec3f& endPos, const dtQueryFilter& queryFilter,
+        const std::size_t maxSize)
+    {
+        const auto route = tileGraph.findRoute(navMesh, startRef, endRef);
+
+        // The end is unreachable, a single query gives the partial path towards the closest reachable polygon
+        if (!route)
+            return findPath(navMeshQuery, startRef, endRef, startPos, endPos, queryFilter, maxSize);
+
+        std::vector<dtPolyRef> result;
+        dtPolyRef partStartRef = startRef;
+        osg::Vec3f partStartPos = startPos;
+
+        for (std::size_t crossed = 0; result.size() < maxSize;)
+        {
+            crossed = std::min(crossed + maxPortalsPerPathQuery, route->size());
+            const bool last = crossed == route->size();
+            const dtPolyRef partEndRef = last ? endRef : (*route)[crossed - 1].mTo;
+            osg::Vec3f partEndPos = endPos;
+
+            if (!last && dtStatusFailed(navMeshQuery.closestPointOnPoly(partEndRef, endPos.ptr(),
+                                                                          partEndPos.ptr(), nullptr)))
+                return {};
+
+            // Each part starts from the last polygon of the previous one
+            const std::size_t skip = result.empty() ? 0 : 1;
+            const auto part = findPath(navMeshQuery, partStartRef, partEndRef, partStartPos, partEndPos, queryFilter,
+                                       maxSize - result.size() + skip);
+
+            if (!part)
+                return {};
+
+            if (part->size() > skip)
+                result.insert(result.end(), part->begin() + static_cast<std::ptrdiff_t>(skip), part->end());
+
+            if (last || part->empty() || part->back() != partEndRef)
+                break;
+
+            partStartRef = partEndRef;
+            partStartPos = partEndPos;
+        }
+
+        return result;
+    }
 }
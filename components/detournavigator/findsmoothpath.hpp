@@ -8,6 +8,7 @@
 #include "settingsutils.hpp"
 #include "debug.hpp"
 #include "status.hpp"
+#include "tilegraph.hpp"
 
 #include <DetourCommon.h>
 #include <DetourNavMesh.h>
@@ -143,6 +144,16 @@ namespace DetourNavigator
         return {std::move(result)};
     }
 
+    /// Number of tiles to cross by a single nav mesh query of a long path, it's limited by the query nodes
+    const std::size_t maxPortalsPerPathQuery = 4;
+
+    boost::optional<std::vector<dtPolyRef>> findHierarchicalPath(const dtNavMesh& navMesh,
+        const dtNavMeshQuery& navMeshQuery, const TileGraph& tileGraph, const dtPolyRef startRef,
+        const dtPolyRef endRef, const osg::Vec3f& startPos, const osg::Vec3f& endPos, const dtQueryFilter& queryFilter,
+        const std::size_t maxSize);
+    ///< Finds the route over the tile graph first and then the polygons between each few portals on the route.
+    /// Without a route to the end, gives the partial path of a single query like findPath.
+
     inline boost::optional<float> getPolyHeight(const dtNavMeshQuery& navMeshQuery, const dtPolyRef ref, const osg::Vec3f& pos)
     {
         float result = 0.0f;
@@ -268,7 +279,8 @@ namespace DetourNavigator
     }
 
     template <class OutputIterator>
-    Status findSmoothPath(const dtNavMesh& navMesh, const osg::Vec3f& halfExtents, const float stepSize,
+    Status findSmoothPath(const dtNavMesh& navMesh, const TileGraph& tileGraph, const osg::Vec3f& halfExtents,
+            const float stepSize,
             const osg::Vec3f& start, const osg::Vec3f& end, const Flags includeFlags,
             const Settings& settings, OutputIterator& out)
     {
@@ -305,8 +317,14 @@ namespace DetourNavigator
         if (endRef == 0)
             return Status::EndPolygonNotFound;
 
-        const auto polygonPath = findPath(navMeshQuery, startRef, endRef, start, end, queryFilter,
-                                          settings.mMaxPolygonPathSize);
+        const auto startTile = getTilePosition(settings, start);
+        const auto endTile = getTilePosition(settings, end);
+        const auto tilesDistance = std::abs(startTile.x() - endTile.x()) + std::abs(startTile.y() - endTile.y());
+
+        const auto polygonPath = static_cast<std::size_t>(tilesDistance) > maxPortalsPerPathQuery
+            ? findHierarchicalPath(navMesh, navMeshQuery, tileGraph, startRef, endRef, start, end, queryFilter,
+                                   settings.mMaxPolygonPathSize)
+            : findPath(navMeshQuery, startRef, endRef, start, end, queryFilter, settings.mMaxPolygonPathSize);
 
         if (!polygonPath)
             return Status::FindPathOverPolygonsFailed;
@@ -443,6 +443,21 @@ namespace
 
 
 
+    Bounds getRecastMeshBounds(const osg::Vec3f& agentHalfExtents, const RecastMesh& recastMesh,
+        const Settings& settings)
+    {
+        auto result = recastMesh.getBounds();
+
+        for (const auto& water : recastMesh.getWater())
+        {
+            const auto waterBounds = getWaterBounds(water, settings, agentHalfExtents);
+            result.mMin.y() = std::min(result.mMin.y(), waterBounds.mMin.y());
+            result.mMax.y() = std::max(result.mMax.y(), waterBounds.mMax.y());
+        }
+
+        return result;
+    }
+
     template <class T>
     unsigned long getMinValuableBitsNumber(const T value)
     {
@@ -483,10 +498,27 @@ namespace DetourNavigator
         return navMesh;
     }
 
+    NavMeshData makeNavMeshTile(const osg::Vec3f& agentHalfExtents, const RecastMesh& recastMesh,
+        const std::vector<OffMeshConnection>& offMeshConnections, const TilePosition& tile, const Settings& settings)
+    {
+        const auto recastMeshBounds = getRecastMeshBounds(agentHalfExtents, recastMesh, settings);
+
+        if (isEmpty(recastMeshBounds))
+            return NavMeshData();
+
+        const auto tileBounds = makeTileBounds(settings, tile);
+        const osg::Vec3f tileBorderMin(tileBounds.mMin.x(), recastMeshBounds.mMin.y() - 1, tileBounds.mMin.y());
+        const osg::Vec3f tileBorderMax(tileBounds.mMax.x(), recastMeshBounds.mMax.y() + 1, tileBounds.mMax.y());
+
+        return makeNavMeshTileData(agentHalfExtents, recastMesh, offMeshConnections, tile, tileBorderMin,
+                                   tileBorderMax, settings);
+    }
+
     UpdateNavMeshStatus updateNavMesh(const osg::Vec3f& agentHalfExtents, const RecastMesh* recastMesh,
         const TilePosition& changedTile, const TilePosition& playerTile,
         const std::vector<OffMeshConnection>& offMeshConnections, const Settings& settings,
-        const SharedNavMeshCacheItem& navMeshCacheItem, NavMeshTilesCache& navMeshTilesCache)
+        const SharedNavMeshCacheItem& navMeshCacheItem, NavMeshTilesCache& navMeshTilesCache,
+        NavMeshDiskCache* navMeshDiskCache)
     {
         Log(Debug::Debug) << std::fixed << std::setprecision(2) <<
             "Update NavMesh with multiple tiles:" <<
@@ -506,16 +538,7 @@ namespace DetourNavigator
             return navMeshCacheItem->lock()->removeTile(changedTile);
         }
 
-        auto recastMeshBounds = recastMesh->getBounds();
-
-        for (const auto& water : recastMesh->getWater())
-        {
-            const auto waterBounds = getWaterBounds(water, settings, agentHalfExtents);
-            recastMeshBounds.mMin.y() = std::min(recastMeshBounds.mMin.y(), waterBounds.mMin.y());
-            recastMeshBounds.mMax.y() = std::max(recastMeshBounds.mMax.y(), waterBounds.mMax.y());
-        }
-
-        if (isEmpty(recastMeshBounds))
+        if (isEmpty(getRecastMeshBounds(agentHalfExtents, *recastMesh, settings)))
         {
             Log(Debug::Debug) << "Ignore add tile: recastMesh is empty";
             return navMeshCacheItem->lock()->removeTile(changedTile);
@@ -531,17 +554,24 @@ namespace DetourNavigator
 
         if (!cachedNavMeshData)
         {
-            const auto tileBounds = makeTileBounds(settings, changedTile);
-            const osg::Vec3f tileBorderMin(tileBounds.mMin.x(), recastMeshBounds.mMin.y() - 1, tileBounds.mMin.y());
-            const osg::Vec3f tileBorderMax(tileBounds.mMax.x(), recastMeshBounds.mMax.y() + 1, tileBounds.mMax.y());
-
-            auto navMeshData = makeNavMeshTileData(agentHalfExtents, *recastMesh, offMeshConnections, changedTile,
-                tileBorderMin, tileBorderMax, settings);
+            NavMeshData navMeshData;
+            if (navMeshDiskCache)
+                navMeshData = navMeshDiskCache->get(agentHalfExtents, changedTile, *recastMesh, offMeshConnections);
 
             if (!navMeshData.mValue)
             {
-                Log(Debug::Debug) << "Ignore add tile: NavMeshData is null";
-                return navMeshCacheItem->lock()->removeTile(changedTile);
+                navMeshData = makeNavMeshTile(agentHalfExtents, *recastMesh, offMeshConnections, changedTile,
+                                              settings);
+
+                if (!navMeshData.mValue)
+                {
+                    Log(Debug::Debug) << "Ignore add tile: NavMeshData is null";
+                    return navMeshCacheItem->lock()->removeTile(changedTile);
+                }
+
+                if (navMeshDiskCache)
+                    navMeshDiskCache->set(agentHalfExtents, changedTile, *recastMesh, offMeshConnections,
+                        navMeshData.mValue.get(), navMeshData.mSize);
             }
 
             try
@@ -8,6 +8,7 @@
 #include "tilebounds.hpp"
 #include "sharednavmesh.hpp"
 #include "navmeshtilescache.hpp"
+#include "navmeshdiskcache.hpp"
 
 #include <osg/Vec3f>
 
@@ -38,10 +39,15 @@ namespace DetourNavigator
 
     NavMeshPtr makeEmptyNavMesh(const Settings& settings);
 
+    NavMeshData makeNavMeshTile(const osg::Vec3f& agentHalfExtents, const RecastMesh& recastMesh,
+        const std::vector<OffMeshConnection>& offMeshConnections, const TilePosition& tile, const Settings& settings);
+    ///< \return empty value when there is nothing to walk on in the tile
+
     UpdateNavMeshStatus updateNavMesh(const osg::Vec3f& agentHalfExtents, const RecastMesh* recastMesh,
         const TilePosition& changedTile, const TilePosition& playerTile,
         const std::vector<OffMeshConnection>& offMeshConnections, const Settings& settings,
-        const SharedNavMeshCacheItem& navMeshCacheItem, NavMeshTilesCache& navMeshTilesCache);
+        const SharedNavMeshCacheItem& navMeshCacheItem, NavMeshTilesCache& navMeshTilesCache,
+        NavMeshDiskCache* navMeshDiskCache = nullptr);
 }
 
 #endif
@@ -175,7 +175,9 @@ namespace DetourNavigator
             if (!navMesh)
                 return Status::NavMeshNotFound;
             const auto settings = getSettings();
-            return findSmoothPath(navMesh->lockConst()->getImpl(), toNavMeshCoordinates(settings, agentHalfExtents),
+            const auto locked = navMesh->lockConst();
+            return findSmoothPath(locked->getImpl(), locked->getTileGraph(),
+                toNavMeshCoordinates(settings, agentHalfExtents),
                 toNavMeshCoordinates(settings, stepSize), toNavMeshCoordinates(settings, start),
                 toNavMeshCoordinates(settings, end), includeFlags, settings, out);
         }
@@ -4,6 +4,7 @@
 #include "sharednavmesh.hpp"
 #include "tileposition.hpp"
 #include "navmeshtilescache.hpp"
+#include "tilegraph.hpp"
 #include "dtstatus.hpp"
 
 #include <components/misc/guarded.hpp>
@@ -123,6 +124,11 @@ namespace DetourNavigator
             return mNavMeshRevision;
         }
 
+        const TileGraph& getTileGraph() const
+        {
+            return mTileGraph;
+        }
+
         template <class T>
         UpdateNavMeshStatus updateTile(const TilePosition& position, T&& navMeshData)
         {
@@ -153,23 +159,27 @@ namespace DetourNavigator
         NavMeshPtr mImpl;
         std::size_t mGeneration;
         std::size_t mNavMeshRevision;
+        TileGraph mTileGraph;
         std::map<TilePosition, std::pair<NavMeshTilesCache::Value, NavMeshData>> mUsedTiles;
 
         void setUsedTile(const TilePosition& tilePosition, NavMeshTilesCache::Value value)
         {
             mUsedTiles[tilePosition] = std::make_pair(std::move(value), NavMeshData());
+            mTileGraph.updateTile(*mImpl, tilePosition);
             ++mNavMeshRevision;
         }
 
         void setUsedTile(const TilePosition& tilePosition, NavMeshData value)
         {
             mUsedTiles[tilePosition] = std::make_pair(NavMeshTilesCache::Value(), std::move(value));
+            mTileGraph.updateTile(*mImpl, tilePosition);
             ++mNavMeshRevision;
         }
 
         void removeUsedTile(const TilePosition& tilePosition)
         {
             mUsedTiles.erase(tilePosition);
+            mTileGraph.updateTile(*mImpl, tilePosition);
             ++mNavMeshRevision;
         }
 
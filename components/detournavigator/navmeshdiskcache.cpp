@@ -0,0 +1,215 @@
+#include "navmeshdiskcache.hpp"
+#include "recastmesh.hpp"
+#include "settings.hpp"
+
+#include <components/debug/debuglog.hpp>
+#include <components/misc/stablehash.hpp>
+
+#include <DetourAlloc.h>
+#include <DetourNavMesh.h>
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace
+{
+    using namespace DetourNavigator;
+
+    const char sMagic[] = {'O', 'M', 'W', 'N', 'A', 'V', 'M', 'T'};
+
+    // Increment when the layout of the file or the generated data changes, e.g. on recastnavigation update
+    const std::uint32_t sFormatVersion = 3;
+
+    const char sExtension[] = ".tile";
+
+    /// Adds the geometry types of the recast mesh, member by member to skip padding bytes
+    struct Hash : Misc::StableHash
+    {
+        using Misc::StableHash::StableHash;
+        using Misc::StableHash::add;
+
+        template <class T>
+        void add(const std::vector<T>& values)
+        {
+            add(static_cast<std::uint64_t>(values.size()));
+            add(values.data(), values.size() * sizeof(T));
+        }
+
+        void add(const btVector3& value)
+        {
+            add(value.x());
+            add(value.y());
+            add(value.z());
+        }
+
+        void add(const osg::Vec3f& value)
+        {
+            add(value.x());
+            add(value.y());
+            add(value.z());
+        }
+
+        void add(const btTransform& value)
+        {
+            add(value.getOrigin());
+            for (int i = 0; i < 3; ++i)
+                add(value.getBasis().getRow(i));
+        }
+    };
+
+    /// Objects are added to the recast mesh manager in an order which depends on the loaded cells and the addresses
+    /// of the objects, so the triangles, water and off mesh connections are hashed one by one and sorted to get the
+    /// same key for the same geometry in every session and in navmeshtool.
+    std::vector<std::uint64_t> makeElementHashes(const RecastMesh& recastMesh,
+        const std::vector<OffMeshConnection>& offMeshConnections)
+    {
+        std::vector<std::uint64_t> result;
+        result.reserve(recastMesh.getTrianglesCount() + recastMesh.getWater().size() + offMeshConnections.size());
+
+        const auto& indices = recastMesh.getIndices();
+        const auto& vertices = recastMesh.getVertices();
+        const auto& areaTypes = recastMesh.getAreaTypes();
+        for (std::size_t triangle = 0; triangle < recastMesh.getTrianglesCount(); ++triangle)
+        {
+            Hash hash;
+            hash.add('t');
+            for (std::size_t vertex = 0; vertex < 3; ++vertex)
+                hash.add(&vertices[static_cast<std::size_t>(indices[triangle * 3 + vertex]) * 3], 3 * sizeof(float));
+            hash.add(areaTypes[triangle]);
+            result.push_back(hash.getValue());
+        }
+
+        for (const auto& water : recastMesh.getWater())
+        {
+            Hash hash;
+            hash.add('w');
+            hash.add(water.mCellSize);
+            hash.add(water.mTransform);
+            result.push_back(hash.getValue());
+        }
+
+        for (const auto& connection : offMeshConnections)
+        {
+            Hash hash;
+            hash.add('c');
+            hash.add(connection.mStart);
+            hash.add(connection.mEnd);
+            result.push_back(hash.getValue());
+        }
+
+        std::sort(result.begin(), result.end());
+        return result;
+    }
+
+    std::uint64_t makeSettingsHash(const Settings& settings)
+    {
+        Hash hash;
+        hash.add(settings.mCellHeight);
+        hash.add(settings.mCellSize);
+        hash.add(settings.mDetailSampleDist);
+        hash.add(settings.mDetailSampleMaxError);
+        hash.add(settings.mMaxClimb);
+        hash.add(settings.mMaxSimplificationError);
+        hash.add(settings.mMaxSlope);
+        hash.add(settings.mRecastScaleFactor);
+        hash.add(settings.mSwimHeightScale);
+        hash.add(settings.mBorderSize);
+        hash.add(settings.mMaxEdgeLen);
+        hash.add(settings.mMaxPolys);
+        hash.add(settings.mMaxVertsPerPoly);
+        hash.add(settings.mRegionMergeSize);
+        hash.add(settings.mRegionMinSize);
+        hash.add(settings.mTileSize);
+        return hash.getValue();
+    }
+}
+
+namespace DetourNavigator
+{
+    NavMeshDiskCache::NavMeshDiskCache(const boost::filesystem::path& path, std::size_t maxSize,
+            const Settings& settings)
+        : mCache(path, maxSize, sMagic, sFormatVersion, sExtension, "nav mesh tile")
+        , mSettingsHash(makeSettingsHash(settings))
+    {
+    }
+
+    NavMeshData NavMeshDiskCache::get(const osg::Vec3f& agentHalfExtents, const TilePosition& changedTile,
+        const RecastMesh& recastMesh, const std::vector<OffMeshConnection>& offMeshConnections)
+    {
+        const auto key = makeKey(agentHalfExtents, changedTile, recastMesh, offMeshConnections);
+        const auto payload = mCache.read(key.mName, key.mCheckHash);
+        if (payload.empty())
+            return NavMeshData();
+
+        try
+        {
+            if (payload.size() < sizeof(dtMeshHeader))
+                throw std::runtime_error("invalid tile size");
+
+            NavMeshData result(static_cast<unsigned char*>(dtAlloc(payload.size(), DT_ALLOC_PERM)),
+                               static_cast<int>(payload.size()));
+            if (!result.mValue)
+                throw std::bad_alloc();
+            std::memcpy(result.mValue.get(), payload.data(), payload.size());
+
+            const auto header = reinterpret_cast<const dtMeshHeader*>(result.mValue.get());
+            if (header->magic != DT_NAVMESH_MAGIC || header->version != DT_NAVMESH_VERSION
+                    || header->x != changedTile.x() || header->y != changedTile.y())
+                throw std::runtime_error("invalid tile header");
+
+            return result;
+        }
+        catch (const std::exception& e)
+        {
+            Log(Debug::Warning) << "Warning: failed to read nav mesh tile " << (mCache.getPath() / key.mName) << ": "
+                << e.what();
+            mCache.discard(key.mName);
+            return NavMeshData();
+        }
+    }
+
+    void NavMeshDiskCache::set(const osg::Vec3f& agentHalfExtents, const TilePosition& changedTile,
+        const RecastMesh& recastMesh, const std::vector<OffMeshConnection>& offMeshConnections,
+        const unsigned char* data, int size)
+    {
+        if (size <= 0)
+            return;
+        const auto key = makeKey(agentHalfExtents, changedTile, recastMesh, offMeshConnections);
+        mCache.write(key.mName, key.mCheckHash, reinterpret_cast<const char*>(data), static_cast<std::size_t>(size));
+    }
+
+    std::size_t NavMeshDiskCache::getSize() const
+    {
+        return mCache.getSize();
+    }
+
+    void NavMeshDiskCache::reportStats(unsigned int frameNumber, osg::Stats& stats) const
+    {
+        mCache.reportStats(frameNumber, stats, "NavMesh");
+    }
+
+    NavMeshDiskCache::Key NavMeshDiskCache::makeKey(const osg::Vec3f& agentHalfExtents,
+        const TilePosition& changedTile, const RecastMesh& recastMesh,
+        const std::vector<OffMeshConnection>& offMeshConnections) const
+    {
+        const auto elements = makeElementHashes(recastMesh, offMeshConnections);
+
+        const auto makeHash = [&] (std::uint64_t offsetBasis)
+        {
+            Hash hash(offsetBasis);
+            hash.add(mSettingsHash);
+            hash.add(agentHalfExtents);
+            hash.add(changedTile.x());
+            hash.add(changedTile.y());
+            hash.add(elements);
+            return hash;
+        };
+
+        // The same data hashed with two offset bases, a collision in both is not a practical concern
+        const auto nameHash = makeHash(Misc::StableHash::sOffsetBasis);
+        auto checkHash = makeHash(Misc::StableHash::sAlternativeOffsetBasis);
+        checkHash.add(nameHash.getSize());
+        return Key {mCache.makeName(nameHash.getValue()), checkHash.getValue()};
+    }
+}
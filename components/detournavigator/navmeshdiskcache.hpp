@@ -0,0 +1,68 @@
+#ifndef OPENMW_COMPONENTS_DETOURNAVIGATOR_NAVMESHDISKCACHE_H
+#define OPENMW_COMPONENTS_DETOURNAVIGATOR_NAVMESHDISKCACHE_H
+
+#include "offmeshconnection.hpp"
+#include "navmeshdata.hpp"
+#include "tileposition.hpp"
+
+#include <components/misc/diskcache.hpp>
+
+#include <osg/Vec3f>
+
+#include <boost/filesystem/path.hpp>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace osg
+{
+    class Stats;
+}
+
+namespace DetourNavigator
+{
+    class RecastMesh;
+    struct Settings;
+
+    /// \brief Generated nav mesh tiles persisted between sessions
+    ///
+    /// Each tile is stored in its own file, named by a hash of the agent half extents, tile position, recast mesh,
+    /// off mesh connections and the settings affecting nav mesh generation. The order of the recast mesh triangles,
+    /// water and off mesh connections doesn't affect the hash. A second hash of the key and its size is
+    /// stored in the file to verify the entry on load. Least recently used files are removed when the total size
+    /// of the cache exceeds the limit. All functions are thread safe.
+    class NavMeshDiskCache
+    {
+    public:
+        NavMeshDiskCache(const boost::filesystem::path& path, std::size_t maxSize, const Settings& settings);
+
+        NavMeshData get(const osg::Vec3f& agentHalfExtents, const TilePosition& changedTile,
+            const RecastMesh& recastMesh, const std::vector<OffMeshConnection>& offMeshConnections);
+        ///< \return empty value when the tile is not cached
+
+        void set(const osg::Vec3f& agentHalfExtents, const TilePosition& changedTile,
+            const RecastMesh& recastMesh, const std::vector<OffMeshConnection>& offMeshConnections,
+            const unsigned char* data, int size);
+
+        std::size_t getSize() const;
+        ///< Total size of the cached files in bytes
+
+        void reportStats(unsigned int frameNumber, osg::Stats& stats) const;
+
+    private:
+        struct Key
+        {
+            std::string mName;
+            std::uint64_t mCheckHash;
+        };
+
+        Misc::DiskCache mCache;
+        std::uint64_t mSettingsHash;
+
+        Key makeKey(const osg::Vec3f& agentHalfExtents, const TilePosition& changedTile,
+            const RecastMesh& recastMesh, const std::vector<OffMeshConnection>& offMeshConnections) const;
+    };
+}
+
+#endif
@@ -12,13 +12,6 @@
 
 namespace
 {
-    using DetourNavigator::ChangeType;
-
-    ChangeType addChangeType(const ChangeType current, const ChangeType add)
-    {
-        return current == add ? current : ChangeType::mixed;
-    }
-
     /// Safely reset shared_ptr with definite underlying object destrutor call.
     /// Assuming there is another thread holding copy of this shared_ptr or weak_ptr to this shared_ptr.
     template <class T>
@@ -17,11 +17,33 @@
 #include <LinearMath/btAabbUtil2.h>
 
 #include <algorithm>
+#include <cmath>
 
 namespace DetourNavigator
 {
     using BulletHelpers::makeProcessTriangleCallback;
 
+    bool isSameVoxels(const RecastMeshTriangles& lhs, const RecastMeshTriangles& rhs, const Settings& settings)
+    {
+        if (lhs.mIndices != rhs.mIndices || lhs.mAreaTypes != rhs.mAreaTypes
+                || lhs.mVertices.size() != rhs.mVertices.size())
+            return false;
+
+        // Recast uses y axis as up
+        const float maxHorizontalShift = settings.mCellSize / 2;
+        const float maxVerticalShift = settings.mCellHeight / 2;
+
+        for (std::size_t i = 0; i < lhs.mVertices.size(); i += 3)
+        {
+            if (std::abs(lhs.mVertices[i] - rhs.mVertices[i]) >= maxHorizontalShift
+                    || std::abs(lhs.mVertices[i + 1] - rhs.mVertices[i + 1]) >= maxVerticalShift
+                    || std::abs(lhs.mVertices[i + 2] - rhs.mVertices[i + 2]) >= maxHorizontalShift)
+                return false;
+        }
+
+        return true;
+    }
+
     RecastMeshBuilder::RecastMeshBuilder(const Settings& settings, const TileBounds& bounds)
         : mSettings(settings)
         , mBounds(bounds)
@@ -112,6 +134,23 @@ namespace DetourNavigator
         mWater.push_back(RecastMesh::Water {cellSize, transform});
     }
 
+    void RecastMeshBuilder::addTriangles(const RecastMeshTriangles& triangles)
+    {
+        const auto indexOffset = static_cast<int>(mVertices.size() / 3);
+
+        std::transform(triangles.mIndices.begin(), triangles.mIndices.end(), std::back_inserter(mIndices),
+            [&] (int index) { return index + indexOffset; });
+        mVertices.insert(mVertices.end(), triangles.mVertices.begin(), triangles.mVertices.end());
+        mAreaTypes.insert(mAreaTypes.end(), triangles.mAreaTypes.begin(), triangles.mAreaTypes.end());
+    }
+
+    RecastMeshTriangles RecastMeshBuilder::releaseTriangles()
+    {
+        RecastMeshTriangles result {std::move(mIndices), std::move(mVertices), std::move(mAreaTypes)};
+        reset();
+        return result;
+    }
+
     std::shared_ptr<RecastMesh> RecastMeshBuilder::create(std::size_t generation, std::size_t revision) const
     {
         return std::make_shared<RecastMesh>(generation, revision, mIndices, mVertices, mAreaTypes,
@@ -17,6 +17,17 @@ namespace DetourNavigator
 {
     struct Settings;
 
+    /// Triangles of a single object clipped by the tile bounds, in nav mesh coordinates
+    struct RecastMeshTriangles
+    {
+        std::vector<int> mIndices;
+        std::vector<float> mVertices;
+        std::vector<AreaType> mAreaTypes;
+    };
+
+    bool isSameVoxels(const RecastMeshTriangles& lhs, const RecastMeshTriangles& rhs, const Settings& settings);
+    ///< Triangles having the same topology and vertices moved by less than a half of the voxel size
+
     class RecastMeshBuilder
     {
     public:
@@ -34,6 +45,12 @@ namespace DetourNavigator
 
         void addWater(const int mCellSize, const btTransform& transform);
 
+        void addTriangles(const RecastMeshTriangles& triangles);
+        ///< Appends triangles made by other builder with the same bounds
+
+        RecastMeshTriangles releaseTriangles();
+        ///< Moves out the triangles added after the last reset
+
         std::shared_ptr<RecastMesh> create(std::size_t generation, std::size_t revision) const;
 
         void reset();
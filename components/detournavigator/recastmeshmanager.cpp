@@ -5,20 +5,21 @@
 namespace DetourNavigator
 {
     RecastMeshManager::RecastMeshManager(const Settings& settings, const TileBounds& bounds, std::size_t generation)
-        : mGeneration(generation)
+        : mSettings(settings)
+        , mGeneration(generation)
         , mMeshBuilder(settings, bounds)
+        , mObjectBuilder(settings, bounds)
     {
     }
 
     bool RecastMeshManager::addObject(const ObjectId id, const btCollisionShape& shape, const btTransform& transform,
                                       const AreaType areaType)
     {
-        const auto iterator = mObjectsOrder.emplace(mObjectsOrder.end(), RecastMeshObject(shape, transform, areaType));
-        if (!mObjects.emplace(id, iterator).second)
-        {
-            mObjectsOrder.erase(iterator);
+        if (mObjects.count(id))
             return false;
-        }
+        RecastMeshObject object(shape, transform, areaType);
+        auto triangles = makeTriangles(object);
+        mObjects.emplace(id, mObjectsOrder.emplace(mObjectsOrder.end(), Object {std::move(object), std::move(triangles)}));
         ++mRevision;
         return true;
     }
@@ -28,8 +29,13 @@ namespace DetourNavigator
         const auto object = mObjects.find(id);
         if (object == mObjects.end())
             return false;
-        if (!object->second->update(transform, areaType))
+        if (!object->second->mObject.update(transform, areaType))
+            return false;
+        auto triangles = makeTriangles(object->second->mObject);
+        // Keep the old triangles so the small moves accumulate until they are big enough to change the nav mesh
+        if (isSameVoxels(object->second->mTriangles, triangles, mSettings))
             return false;
+        object->second->mTriangles = std::move(triangles);
         ++mRevision;
         return true;
     }
@@ -39,7 +45,8 @@ namespace DetourNavigator
         const auto object = mObjects.find(id);
         if (object == mObjects.end())
             return boost::none;
-        const RemovedRecastMeshObject result {object->second->getShape(), object->second->getTransform()};
+        const RemovedRecastMeshObject result {object->second->mObject.getShape(),
+                                              object->second->mObject.getTransform()};
         mObjectsOrder.erase(object->second);
         mObjects.erase(object);
         ++mRevision;
@@ -90,7 +97,14 @@ namespace DetourNavigator
         for (const auto& v : mWaterOrder)
             mMeshBuilder.addWater(v.mCellSize, v.mTransform);
         for (const auto& v : mObjectsOrder)
-            mMeshBuilder.addObject(v.getShape(), v.getTransform(), v.getAreaType());
+            mMeshBuilder.addTriangles(v.mTriangles);
         mLastBuildRevision = mRevision;
     }
+
+    RecastMeshTriangles RecastMeshManager::makeTriangles(const RecastMeshObject& object)
+    {
+        mObjectBuilder.reset();
+        mObjectBuilder.addObject(object.getShape(), object.getTransform(), object.getAreaType());
+        return mObjectBuilder.releaseTriangles();
+    }
 }
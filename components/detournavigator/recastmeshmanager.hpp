@@ -52,16 +52,27 @@ namespace DetourNavigator
         bool isEmpty() const;
 
     private:
+        /// Object with its own triangles, so a change of one object doesn't process the shapes of others
+        struct Object
+        {
+            RecastMeshObject mObject;
+            RecastMeshTriangles mTriangles;
+        };
+
+        std::reference_wrapper<const Settings> mSettings;
         std::size_t mRevision = 0;
         std::size_t mLastBuildRevision = 0;
         std::size_t mGeneration;
         RecastMeshBuilder mMeshBuilder;
-        std::list<RecastMeshObject> mObjectsOrder;
-        std::unordered_map<ObjectId, std::list<RecastMeshObject>::iterator> mObjects;
+        RecastMeshBuilder mObjectBuilder;
+        std::list<Object> mObjectsOrder;
+        std::unordered_map<ObjectId, std::list<Object>::iterator> mObjects;
         std::list<Water> mWaterOrder;
         std::map<osg::Vec2i, std::list<Water>::iterator> mWater;
 
         void rebuild();
+
+        RecastMeshTriangles makeTriangles(const RecastMeshObject& object);
     };
 }
 
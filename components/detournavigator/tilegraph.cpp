@@ -0,0 +1,190 @@
+#include "tilegraph.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <numeric>
+#include <queue>
+
+namespace DetourNavigator
+{
+    void TileGraph::updateTile(const dtNavMesh& navMesh, const TilePosition& position)
+    {
+        // Links to the changed tile are stored by its neighbours
+        for (int x = -1; x <= 1; ++x)
+            for (int y = -1; y <= 1; ++y)
+                buildTile(navMesh, position + TilePosition(x, y));
+    }
+
+    boost::optional<std::vector<TileGraph::Portal>> TileGraph::findRoute(const dtNavMesh& navMesh,
+        dtPolyRef start, dtPolyRef end) const
+    {
+        const auto startNode = getNode(navMesh, start);
+        const auto endNode = getNode(navMesh, end);
+
+        if (!startNode || !endNode)
+            return {};
+
+        struct Visit
+        {
+            float mCost;
+            Node mPrevious;
+            Portal mPortal;
+            bool mClosed;
+        };
+
+        const osg::Vec3f goal = getRegion(*endNode).mCenter;
+        std::map<Node, Visit> visits;
+        using Open = std::pair<float, Node>;
+        std::priority_queue<Open, std::vector<Open>, std::greater<Open>> open;
+
+        visits.emplace(*startNode, Visit {0, *startNode, Portal {0, 0}, false});
+        open.emplace((getRegion(*startNode).mCenter - goal).length(), *startNode);
+
+        while (!open.empty())
+        {
+            const Node node = open.top().second;
+            open.pop();
+
+            auto& visit = visits.at(node);
+            if (visit.mClosed)
+                continue;
+            visit.mClosed = true;
+
+            if (node == *endNode)
+            {
+                std::vector<Portal> result;
+                for (Node current = node; !(current == *startNode);)
+                {
+                    const auto& currentVisit = visits.at(current);
+                    result.push_back(currentVisit.mPortal);
+                    current = currentVisit.mPrevious;
+                }
+                std::reverse(result.begin(), result.end());
+                return result;
+            }
+
+            const Region& region = getRegion(node);
+
+            for (const Portal& portal : region.mPortals)
+            {
+                const auto next = getNode(navMesh, portal.mTo);
+                if (!next)
+                    continue;
+                const Region& nextRegion = getRegion(*next);
+                const float cost = visit.mCost + (nextRegion.mCenter - region.mCenter).length();
+                const auto inserted = visits.emplace(*next, Visit {cost, node, portal, false});
+                if (!inserted.second)
+                {
+                    if (inserted.first->second.mClosed || inserted.first->second.mCost <= cost)
+                        continue;
+                    inserted.first->second = Visit {cost, node, portal, false};
+                }
+                open.emplace(cost + (nextRegion.mCenter - goal).length(), *next);
+            }
+        }
+
+        return {};
+    }
+
+    std::size_t TileGraph::getRegionsCount() const
+    {
+        return std::accumulate(mTiles.begin(), mTiles.end(), std::size_t(0),
+            [] (std::size_t sum, const std::pair<const TilePosition, Tile>& v) { return sum + v.second.mRegions.size(); });
+    }
+
+    void TileGraph::buildTile(const dtNavMesh& navMesh, const TilePosition& position)
+    {
+        const int layer = 0;
+        const dtMeshTile* const tile = navMesh.getTileAt(position.x(), position.y(), layer);
+
+        if (tile == nullptr || tile->header == nullptr)
+        {
+            mTiles.erase(position);
+            return;
+        }
+
+        const auto polyCount = static_cast<std::size_t>(tile->header->polyCount);
+        const dtPolyRef base = navMesh.getPolyRefBase(tile);
+        const auto tileIndex = navMesh.decodePolyIdTile(base);
+
+        // Join polygons linked inside the tile into regions
+        std::vector<std::size_t> parents(polyCount);
+        std::iota(parents.begin(), parents.end(), std::size_t(0));
+
+        const auto findRoot = [&] (std::size_t index)
+        {
+            while (parents[index] != index)
+                index = parents[index] = parents[parents[index]];
+            return index;
+        };
+
+        for (std::size_t i = 0; i < polyCount; ++i)
+            for (unsigned link = tile->polys[i].firstLink; link != DT_NULL_LINK; link = tile->links[link].next)
+                if (navMesh.decodePolyIdTile(tile->links[link].ref) == tileIndex)
+                    parents[findRoot(i)] = findRoot(navMesh.decodePolyIdPoly(tile->links[link].ref));
+
+        Tile& result = mTiles[position];
+        result.mPolyRegions.assign(polyCount, 0);
+        result.mRegions.clear();
+
+        std::map<std::size_t, std::size_t> rootRegions;
+        std::vector<std::size_t> regionPolys;
+
+        for (std::size_t i = 0; i < polyCount; ++i)
+        {
+            const auto region = rootRegions.emplace(findRoot(i), result.mRegions.size());
+            if (region.second)
+            {
+                result.mRegions.emplace_back();
+                regionPolys.push_back(0);
+            }
+            result.mPolyRegions[i] = region.first->second;
+
+            const dtPoly& poly = tile->polys[i];
+            osg::Vec3f center;
+            for (unsigned char vertex = 0; vertex < poly.vertCount; ++vertex)
+                center += osg::Vec3f(tile->verts[poly.verts[vertex] * 3], tile->verts[poly.verts[vertex] * 3 + 1],
+                                     tile->verts[poly.verts[vertex] * 3 + 2]);
+            if (poly.vertCount > 0)
+                center /= static_cast<float>(poly.vertCount);
+
+            Region& target = result.mRegions[region.first->second];
+            target.mCenter += center;
+            ++regionPolys[region.first->second];
+
+            for (unsigned link = poly.firstLink; link != DT_NULL_LINK; link = tile->links[link].next)
+                if (navMesh.decodePolyIdTile(tile->links[link].ref) != tileIndex)
+                    target.mPortals.push_back(Portal {base | static_cast<dtPolyRef>(i), tile->links[link].ref});
+        }
+
+        for (std::size_t i = 0; i < result.mRegions.size(); ++i)
+            result.mRegions[i].mCenter /= static_cast<float>(regionPolys[i]);
+    }
+
+    boost::optional<TileGraph::Node> TileGraph::getNode(const dtNavMesh& navMesh, dtPolyRef ref) const
+    {
+        const dtMeshTile* tile = nullptr;
+        const dtPoly* poly = nullptr;
+
+        if (dtStatusFailed(navMesh.getTileAndPolyByRef(ref, &tile, &poly)))
+            return {};
+
+        const TilePosition position(tile->header->x, tile->header->y);
+        const auto it = mTiles.find(position);
+
+        if (it == mTiles.end())
+            return {};
+
+        const auto index = static_cast<std::size_t>(navMesh.decodePolyIdPoly(ref));
+
+        if (index >= it->second.mPolyRegions.size())
+            return {};
+
+        return Node {position, it->second.mPolyRegions[index]};
+    }
+
+    const TileGraph::Region& TileGraph::getRegion(const Node& node) const
+    {
+        return mTiles.at(node.mTile).mRegions[node.mRegion];
+    }
+}
@@ -0,0 +1,78 @@
+#ifndef OPENMW_COMPONENTS_DETOURNAVIGATOR_TILEGRAPH_H
+#define OPENMW_COMPONENTS_DETOURNAVIGATOR_TILEGRAPH_H
+
+#include "tileposition.hpp"
+
+#include <DetourNavMesh.h>
+
+#include <osg/Vec3f>
+
+#include <boost/optional.hpp>
+
+#include <map>
+#include <tuple>
+#include <vector>
+
+namespace DetourNavigator
+{
+    /// \brief Abstraction of the nav mesh for long paths.
+    ///
+    /// A node is a region of a tile: polygons connected inside the tile. An edge is a portal, a link from a polygon
+    /// of a region to a polygon of a neighbour tile. The graph is updated for each changed tile and its neighbours.
+    class TileGraph
+    {
+    public:
+        struct Portal
+        {
+            dtPolyRef mFrom;
+            dtPolyRef mTo;
+        };
+
+        void updateTile(const dtNavMesh& navMesh, const TilePosition& position);
+        ///< Call after the tile is added, replaced or removed
+
+        boost::optional<std::vector<Portal>> findRoute(const dtNavMesh& navMesh, dtPolyRef start, dtPolyRef end) const;
+        ///< \return portals to cross on the way from start to end polygon, none if there is no way
+
+        std::size_t getRegionsCount() const;
+
+    private:
+        struct Region
+        {
+            osg::Vec3f mCenter;
+            std::vector<Portal> mPortals;
+        };
+
+        struct Tile
+        {
+            std::vector<std::size_t> mPolyRegions;
+            std::vector<Region> mRegions;
+        };
+
+        struct Node
+        {
+            TilePosition mTile;
+            std::size_t mRegion;
+
+            friend inline bool operator <(const Node& lhs, const Node& rhs)
+            {
+                return std::tie(lhs.mTile, lhs.mRegion) < std::tie(rhs.mTile, rhs.mRegion);
+            }
+
+            friend inline bool operator ==(const Node& lhs, const Node& rhs)
+            {
+                return lhs.mTile == rhs.mTile && lhs.mRegion == rhs.mRegion;
+            }
+        };
+
+        std::map<TilePosition, Tile> mTiles;
+
+        void buildTile(const dtNavMesh& navMesh, const TilePosition& position);
+
+        boost::optional<Node> getNode(const dtNavMesh& navMesh, dtPolyRef ref) const;
+
+        const Region& getRegion(const Node& node) const;
+    };
+}
+
+#endif
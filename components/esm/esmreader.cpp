@@ -1,7 +1,10 @@
 #include "esmreader.hpp"
 
+#include <cstring>
 #include <stdexcept>
 
+#include <boost/iostreams/device/mapped_file.hpp>
+
 namespace ESM
 {
 
@@ -15,12 +18,13 @@ using namespace Misc;
 ESM_Context ESMReader::getContext()
 {
     // Update the file position before returning
-    mCtx.filePos = mEsm->tellg();
+    mCtx.filePos = getFileOffset();
     return mCtx;
 }
 
 ESMReader::ESMReader()
-    : mRecordFlags(0)
+    : mPosition(0)
+    , mRecordFlags(0)
     , mBuffer(50*1024)
     , mGlobalReaderList(nullptr)
     , mEncoder(nullptr)
@@ -38,18 +42,28 @@ void ESMReader::restoreContext(const ESM_Context &rc)
 {
     // Reopen the file if necessary
     if (mCtx.filename != rc.filename)
-        openRaw(rc.filename);
+    {
+        if (mData)
+            openRawMapped(rc.filename);
+        else
+            openRaw(rc.filename);
+    }
 
     // Copy the data
     mCtx = rc;
 
     // Make sure we seek to the right place
-    mEsm->seekg(mCtx.filePos);
+    if (mData)
+        mPosition = mCtx.filePos;
+    else
+        mEsm->seekg(mCtx.filePos);
 }
 
 void ESMReader::close()
 {
     mEsm.reset();
+    mData.reset();
+    mPosition = 0;
     clearCtx();
     mHeader.blank();
 }
@@ -80,10 +94,26 @@ void ESMReader::openRaw(const std::string& filename)
     openRaw(Files::openConstrainedFileStream(filename.c_str()), filename);
 }
 
-void ESMReader::open(Files::IStreamPtr _esm, const std::string &name)
+void ESMReader::openRawMapped(const std::string& filename)
 {
-    openRaw(_esm, name);
+    close();
+    std::shared_ptr<boost::iostreams::mapped_file_source> file;
+    try
+    {
+        file = std::make_shared<boost::iostreams::mapped_file_source>(filename);
+    }
+    catch (std::exception& e)
+    {
+        throw std::runtime_error("Failed to map " + filename + ": " + e.what());
+    }
+    // The mapping lives as long as any reader copy or context still points into it
+    mData = std::shared_ptr<const char>(file, file->data());
+    mCtx.filename = filename;
+    mCtx.leftFile = mFileSize = file->size();
+}
 
+void ESMReader::loadHeader()
+{
     if (getRecName() != "TES3")
         fail("Not a valid Morrowind file");
 
@@ -92,11 +122,23 @@ void ESMReader::open(Files::IStreamPtr _esm, const std::string &name)
     mHeader.load (*this);
 }
 
+void ESMReader::open(Files::IStreamPtr _esm, const std::string &name)
+{
+    openRaw(_esm, name);
+    loadHeader();
+}
+
 void ESMReader::open(const std::string &file)
 {
     open (Files::openConstrainedFileStream (file.c_str ()), file);
 }
 
+void ESMReader::openMapped(const std::string &file)
+{
+    openRawMapped(file);
+    loadHeader();
+}
+
 int64_t ESMReader::getHNLong(const char *name)
 {
     int64_t val;
@@ -126,7 +168,7 @@ std::string ESMReader::getHString()
     // them. For some reason, they break the rules, and contain a byte
     // (value 0) even if the header says there is no data. If
     // Morrowind accepts it, so should we.
-    if (mCtx.leftSub == 0 && !mEsm->peek())
+    if (mCtx.leftSub == 0 && (mData ? mPosition < mFileSize && !mData.get()[mPosition] : !mEsm->peek()))
     {
         // Skip the following zero byte
         mCtx.leftRec--;
@@ -321,6 +363,15 @@ void ESMReader::getRecHeader(uint32_t &flags)
 
 void ESMReader::getExact(void*x, int size)
 {
+    if (mData)
+    {
+        if (size < 0 || mPosition + size > mFileSize)
+            fail("Read error: attempt to read past the end of file");
+        std::memcpy(x, mData.get() + mPosition, size);
+        mPosition += size;
+        return;
+    }
+
     try
     {
         mEsm->read((char*)x, size);
@@ -333,6 +384,22 @@ void ESMReader::getExact(void*x, int size)
 
 std::string ESMReader::getString(int size)
 {
+    if (mData)
+    {
+        // Decode straight from the mapping, no need for an intermediate copy
+        if (size < 0 || mPosition + size > mFileSize)
+            fail("Read error: attempt to read past the end of file");
+        const char *ptr = mData.get() + mPosition;
+        mPosition += size;
+
+        size = strnlen(ptr, size);
+
+        if (mEncoder)
+            return mEncoder->getUtf8(ptr, size);
+
+        return std::string (ptr, size);
+    }
+
     size_t s = size;
     if (mBuffer.size() <= s)
         // Add some extra padding to reduce the chance of having to resize
@@ -365,7 +432,9 @@ void ESMReader::fail(const std::string &msg)
     ss << "\n  File: " << mCtx.filename;
     ss << "\n  Record: " << mCtx.recName.toString();
     ss << "\n  Subrecord: " << mCtx.subName.toString();
-    if (mEsm.get())
+    if (mData)
+        ss << "\n  Offset: 0x" << hex << mPosition;
+    else if (mEsm.get())
         ss << "\n  Offset: 0x" << hex << mEsm->tellg();
     throw std::runtime_error(ss.str());
 }
@@ -377,11 +446,18 @@ void ESMReader::setEncoder(ToUTF8::Utf8Encoder* encoder)
 
 size_t ESMReader::getFileOffset()
 {
+    if (mData)
+        return mPosition;
     return mEsm->tellg();
 }
 
 void ESMReader::skip(int bytes)
 {
+    if (mData)
+    {
+        mPosition += bytes;
+        return;
+    }
     mEsm->seekg(getFileOffset()+bytes);
 }
 
@@ -3,6 +3,7 @@
 
 #include <cstdint>
 #include <cassert>
+#include <memory>
 #include <vector>
 #include <sstream>
 
@@ -72,6 +73,16 @@ public:
 
   void openRaw(const std::string &filename);
 
+  /// Like open(), but maps the whole file into memory instead of opening a stream. All reads
+  /// then work directly on the mapped buffer, and restoring a context of the same file is free.
+  void openMapped(const std::string &file);
+
+  /// Like openRaw(), but maps the whole file into memory.
+  void openRawMapped(const std::string &filename);
+
+  /// Is the file read from a memory mapping rather than a stream?
+  bool isMapped() const { return mData != nullptr; }
+
   /// Get the current position in the file. Make sure that the file has been opened!
   size_t getFileOffset();
 
@@ -272,8 +283,15 @@ public:
 private:
   void clearCtx();
 
+  /// Parse the TES3 header at the start of the opened file
+  void loadHeader();
+
   Files::IStreamPtr mEsm;
 
+  // Contents of the whole file when it is memory mapped, mEsm is unused then
+  std::shared_ptr<const char> mData;
+  size_t mPosition;
+
   ESM_Context mCtx;
 
   unsigned int mRecordFlags;
@@ -1,10 +1,13 @@
 #include "loadcell.hpp"
 
+#include <algorithm>
 #include <string>
 #include <list>
+#include <map>
 
 #include <boost/concept_check.hpp>
 
+#include <components/debug/debuglog.hpp>
 #include <components/misc/stringops.hpp>
 
 #include "esmreader.hpp"
@@ -290,4 +293,49 @@ namespace ESM
     {
         return mCellId;
     }
+
+    std::vector<CellRef> loadCellRefs(const Cell& cell, std::vector<ESMReader>& readers)
+    {
+        std::map<RefNum, std::pair<CellRef, bool>> refs;
+
+        for (std::size_t i = 0; i < cell.mContextList.size(); ++i)
+        {
+            try
+            {
+                const int index = cell.mContextList[i].index;
+                cell.restore(readers[index], static_cast<int>(i));
+
+                CellRef ref;
+                ref.mRefNum.mContentFile = RefNum::RefNum_NoContentFile;
+
+                bool deleted = false;
+                while (Cell::getNextRef(readers[index], ref, deleted))
+                {
+                    // Moved references are loaded with the cell they are moved to
+                    if (std::find(cell.mMovedRefs.begin(), cell.mMovedRefs.end(), ref.mRefNum) != cell.mMovedRefs.end())
+                        continue;
+                    refs[ref.mRefNum] = std::make_pair(ref, deleted);
+                }
+            }
+            catch (const std::exception& e)
+            {
+                Log(Debug::Error) << "An error occurred loading references for cell " << cell.getDescription()
+                                  << ": " << e.what();
+            }
+        }
+
+        for (const auto& leased : cell.mLeasedRefs)
+            refs[leased.first.mRefNum] = leased;
+
+        std::vector<CellRef> result;
+        result.reserve(refs.size());
+        for (auto& ref : refs)
+        {
+            if (ref.second.second)
+                continue;
+            Misc::StringUtils::lowerCaseInPlace(ref.second.first.mRefID);
+            result.push_back(std::move(ref.second.first));
+        }
+        return result;
+    }
 }
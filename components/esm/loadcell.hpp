@@ -197,5 +197,10 @@ struct Cell
 
     const CellId& getCellId() const;
 };
+
+/// Not deleted references of the cell, merged by reference number the way MWWorld::CellStore::loadRefs does.
+/// Moved references are left to the cell they are moved to, the reference ids are lowercase.
+/// \param readers the readers of the content files, indexed like ESM::ESM_Context::index
+std::vector<CellRef> loadCellRefs(const Cell& cell, std::vector<ESMReader>& readers);
 }
 #endif
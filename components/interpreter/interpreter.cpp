@@ -1,116 +1,335 @@
 #include "interpreter.hpp"
 
 #include <cassert>
+#include <cstring>
 #include <stdexcept>
 
+#include "context.hpp"
 #include "opcodes.hpp"
 
-namespace Interpreter
+namespace
 {
-    void Interpreter::execute (Type_Code code)
+    // codes of the built-in instructions used in superinstructions, see docs/vmformat.txt
+    const unsigned int sSegment0PushInt = 0;
+    const unsigned int sSegment0JumpForward = 1;
+    const unsigned int sSegment0JumpBackward = 2;
+    const unsigned int sSegment5FetchIntLiteral = 4;
+    const unsigned int sSegment5FetchFloatLiteral = 5;
+    const unsigned int sSegment5FetchLocalShort = 21;
+    const unsigned int sSegment5FetchLocalLong = 22;
+    const unsigned int sSegment5FetchLocalFloat = 23;
+    const unsigned int sSegment5SkipNonZero = 25;
+    const unsigned int sSegment5EqualInt = 26;
+    const unsigned int sSegment5GreaterOrEqualInt = 31;
+    const unsigned int sSegment5EqualFloat = 32;
+    const unsigned int sSegment5GreaterOrEqualFloat = 37;
+
+    /// \a op is the offset of the compare instruction from the equal instruction of its type
+    template <class T>
+    bool compare (unsigned int op, T left, T right)
     {
-        unsigned int segSpec = code>>30;
+        switch (op)
+        {
+            case 0: return left==right;
+            case 1: return left!=right;
+            case 2: return left<right;
+            case 3: return left<=right;
+            case 4: return left>right;
+            default: return left>=right;
+        }
+    }
+
+    bool isSegment0 (Interpreter::Type_Code code, unsigned int opcode)
+    {
+        return (code>>30)==0 && (code>>24)==opcode;
+    }
 
-        switch (segSpec)
+    bool isSegment5 (Interpreter::Type_Code code, unsigned int opcode)
+    {
+        return (code>>26)==0x32 && (code & 0x3ffffff)==opcode;
+    }
+}
+
+namespace Interpreter
+{
+    Program::Instruction Interpreter::decodeInstruction (Type_Code code) const
+    {
+        Program::Instruction instruction;
+        instruction.mKind = Program::Kind_UnknownSegment;
+        instruction.mSize = 1;
+        instruction.mOpcode0 = nullptr;
+        instruction.mArg0 = code;
+        instruction.mArg1 = 0;
+        instruction.mTarget = 0;
+        instruction.mLiteral.mInteger = 0;
+
+        unsigned int segment = 0;
+        unsigned int opcode = 0;
+        bool known = false;
+
+        switch (code>>30)
         {
             case 0:
-            {
-                int opcode = code>>24;
-                unsigned int arg0 = code & 0xffffff;
 
-                std::map<int, Opcode1 *>::iterator iter = mSegment0.find (opcode);
+                segment = 0;
+                opcode = code>>24;
+                instruction.mOpcode1 = mSegment0.find (opcode);
+                known = instruction.mOpcode1!=nullptr;
+                instruction.mKind = Program::Kind_Opcode1;
+                instruction.mArg0 = code & 0xffffff;
+                break;
 
-                if (iter==mSegment0.end())
-                    abortUnknownCode (0, opcode);
+            case 1:
 
-                iter->second->execute (mRuntime, arg0);
+                segment = 1;
+                opcode = (code>>24) & 0x3f;
+                instruction.mOpcode2 = mSegment1.find (opcode);
+                known = instruction.mOpcode2!=nullptr;
+                instruction.mKind = Program::Kind_Opcode2;
+                instruction.mArg0 = (code>>16) & 0xfff;
+                instruction.mArg1 = code & 0xfff;
+                break;
 
-                return;
-            }
+            case 2:
 
-            case 1:
-            {
-                int opcode = (code>>24) & 0x3f;
-                unsigned int arg0 = (code>>16) & 0xfff;
-                unsigned int arg1 = code & 0xfff;
+                segment = 2;
+                opcode = (code>>20) & 0x3ff;
+                instruction.mOpcode1 = mSegment2.find (opcode);
+                known = instruction.mOpcode1!=nullptr;
+                instruction.mKind = Program::Kind_Opcode1;
+                instruction.mArg0 = code & 0xfffff;
+                break;
+
+            default:
+
+                switch (code>>26)
+                {
+                    case 0x30:
+
+                        segment = 3;
+                        opcode = (code>>8) & 0x3ffff;
+                        instruction.mOpcode1 = mSegment3.find (opcode);
+                        known = instruction.mOpcode1!=nullptr;
+                        instruction.mKind = Program::Kind_Opcode1;
+                        instruction.mArg0 = code & 0xff;
+                        break;
+
+                    case 0x31:
+
+                        segment = 4;
+                        opcode = (code>>16) & 0x3ff;
+                        instruction.mOpcode2 = mSegment4.find (opcode);
+                        known = instruction.mOpcode2!=nullptr;
+                        instruction.mKind = Program::Kind_Opcode2;
+                        instruction.mArg0 = (code>>8) & 0xff;
+                        instruction.mArg1 = code & 0xff;
+                        break;
+
+                    case 0x32:
+
+                        segment = 5;
+                        opcode = code & 0x3ffffff;
+                        instruction.mOpcode0 = mSegment5.find (opcode);
+                        known = instruction.mOpcode0!=nullptr;
+                        instruction.mKind = Program::Kind_Opcode0;
+                        instruction.mArg0 = 0;
+                        break;
+
+                    default:
+
+                        return instruction;
+                }
+        }
 
-                std::map<int, Opcode2 *>::iterator iter = mSegment1.find (opcode);
+        if (!known)
+        {
+            instruction.mKind = Program::Kind_UnknownOpcode;
+            instruction.mArg0 = segment;
+            instruction.mArg1 = opcode;
+        }
 
-                if (iter==mSegment1.end())
-                    abortUnknownCode (1, opcode);
+        return instruction;
+    }
 
-                iter->second->execute (mRuntime, arg0, arg1);
+    void Interpreter::fuseInstructions (Program& program, int index) const
+    {
+        const Type_Code *codeBlock = program.mCode + 4;
+        const int opcodes = static_cast<int> (program.mCode[0]);
+        const int available = opcodes - index;
+        const Type_Code *code = codeBlock + index;
+        Program::Instruction& instruction = program.mInstructions[index];
+
+        // Only fuse sequences of installed built-in instructions, everything else keeps its regular behaviour
+        auto isInstalled = [&] (int offset)
+        {
+            const Program::Kind kind = program.mInstructions[index + offset].mKind;
+            return kind!=Program::Kind_UnknownOpcode && kind!=Program::Kind_UnknownSegment;
+        };
 
-                return;
+        auto getJumpTarget = [&] (int offset, int& target)
+        {
+            const Type_Code jump = code[offset];
+            const int distance = static_cast<int> (jump & 0xffffff);
+            if (!isInstalled (offset) || distance==0)
+                return false;
+            if (isSegment0 (jump, sSegment0JumpForward))
+                target = index + offset + distance;
+            else if (isSegment0 (jump, sSegment0JumpBackward))
+                target = index + offset - distance;
+            else
+                return false;
+            return true;
+        };
+
+        if (available>=2 && isSegment5 (code[0], sSegment5SkipNonZero) && isInstalled (0))
+        {
+            int target = 0;
+            if (getJumpTarget (1, target))
+            {
+                instruction.mKind = Program::Kind_JumpOnZero;
+                instruction.mSize = 2;
+                instruction.mTarget = target;
             }
+            return;
+        }
 
-            case 2:
-            {
-                int opcode = (code>>20) & 0x3ff;
-                unsigned int arg0 = code & 0xfffff;
+        if (available<2 || !isSegment0 (code[0], sSegment0PushInt) || !isInstalled (0) || !isInstalled (1))
+            return;
 
-                std::map<int, Opcode1 *>::iterator iter = mSegment2.find (opcode);
+        const unsigned int index0 = code[0] & 0xffffff;
+        const unsigned int intLiterals = program.mCode[1];
+        const unsigned int floatLiterals = program.mCode[2];
 
-                if (iter==mSegment2.end())
-                    abortUnknownCode (2, opcode);
+        Program::Kind fetchLocal = Program::Kind_Opcode1;
+        if (isSegment5 (code[1], sSegment5FetchLocalShort))
+            fetchLocal = Program::Kind_FetchLocalShort;
+        else if (isSegment5 (code[1], sSegment5FetchLocalLong))
+            fetchLocal = Program::Kind_FetchLocalLong;
+        else if (isSegment5 (code[1], sSegment5FetchLocalFloat))
+            fetchLocal = Program::Kind_FetchLocalFloat;
 
-                iter->second->execute (mRuntime, arg0);
+        if (fetchLocal!=Program::Kind_Opcode1)
+        {
+            instruction.mKind = fetchLocal;
+            instruction.mSize = 2;
+            instruction.mArg0 = index0;
+            return;
+        }
 
-                return;
-            }
+        bool isFloat = false;
+        if (isSegment5 (code[1], sSegment5FetchIntLiteral) && index0<intLiterals)
+            std::memcpy (&instruction.mLiteral, &codeBlock[opcodes + index0], sizeof (Type_Code));
+        else if (isSegment5 (code[1], sSegment5FetchFloatLiteral) && index0<floatLiterals)
+        {
+            std::memcpy (&instruction.mLiteral, &codeBlock[opcodes + intLiterals + index0], sizeof (Type_Code));
+            isFloat = true;
         }
+        else
+            return;
 
-        segSpec = code>>26;
+        instruction.mKind = Program::Kind_PushLiteral;
+        instruction.mSize = 2;
 
-        switch (segSpec)
+        // compare with the literal and jump when false, the usual form of an if or while condition
+        if (available<5 || !isInstalled (2) || !isInstalled (3) || !isSegment5 (code[3], sSegment5SkipNonZero))
+            return;
+
+        const unsigned int equal = isFloat ? sSegment5EqualFloat : sSegment5EqualInt;
+        const unsigned int greaterOrEqual = isFloat ? sSegment5GreaterOrEqualFloat : sSegment5GreaterOrEqualInt;
+        const unsigned int compareCode = code[2] & 0x3ffffff;
+        int target = 0;
+
+        if ((code[2]>>26)==0x32 && compareCode>=equal && compareCode<=greaterOrEqual && getJumpTarget (4, target))
         {
-            case 0x30:
-            {
-                int opcode = (code>>8) & 0x3ffff;
-                unsigned int arg0 = code & 0xff;
+            instruction.mKind = isFloat ? Program::Kind_CompareFloatJump : Program::Kind_CompareIntJump;
+            instruction.mSize = 5;
+            instruction.mArg0 = compareCode - equal;
+            instruction.mTarget = target;
+        }
+    }
 
-                std::map<int, Opcode1 *>::iterator iter = mSegment3.find (opcode);
+    void Interpreter::execute (const Program::Instruction& instruction)
+    {
+        switch (instruction.mKind)
+        {
+            case Program::Kind_Opcode0:
 
-                if (iter==mSegment3.end())
-                    abortUnknownCode (3, opcode);
+                instruction.mOpcode0->execute (mRuntime);
+                return;
 
-                iter->second->execute (mRuntime, arg0);
+            case Program::Kind_Opcode1:
 
+                instruction.mOpcode1->execute (mRuntime, instruction.mArg0);
                 return;
-            }
 
-            case 0x31:
-            {
-                int opcode = (code>>16) & 0x3ff;
-                unsigned int arg0 = (code>>8) & 0xff;
-                unsigned int arg1 = code & 0xff;
+            case Program::Kind_Opcode2:
+
+                instruction.mOpcode2->execute (mRuntime, instruction.mArg0, instruction.mArg1);
+                return;
+
+            case Program::Kind_UnknownOpcode:
+
+                abortUnknownCode (instruction.mArg0, instruction.mArg1);
+                return;
+
+            case Program::Kind_UnknownSegment:
+
+                abortUnknownSegment (instruction.mArg0);
+                return;
+
+            case Program::Kind_PushLiteral:
+
+                mRuntime.push (instruction.mLiteral);
+                return;
 
-                std::map<int, Opcode2 *>::iterator iter = mSegment4.find (opcode);
+            case Program::Kind_FetchLocalShort:
 
-                if (iter==mSegment4.end())
-                    abortUnknownCode (4, opcode);
+                mRuntime.push (mRuntime.getContext().getLocalShort (instruction.mArg0));
+                return;
+
+            case Program::Kind_FetchLocalLong:
+
+                mRuntime.push (mRuntime.getContext().getLocalLong (instruction.mArg0));
+                return;
+
+            case Program::Kind_FetchLocalFloat:
+
+                mRuntime.push (mRuntime.getContext().getLocalFloat (instruction.mArg0));
+                return;
+
+            case Program::Kind_JumpOnZero:
+            {
+                Type_Integer data = mRuntime[0].mInteger;
+                mRuntime.pop();
 
-                iter->second->execute (mRuntime, arg0, arg1);
+                if (data==0)
+                    mRuntime.setPC (instruction.mTarget);
 
                 return;
             }
 
-            case 0x32:
+            case Program::Kind_CompareIntJump:
             {
-                int opcode = code & 0x3ffffff;
+                bool result = compare (instruction.mArg0, mRuntime[0].mInteger, instruction.mLiteral.mInteger);
+                mRuntime.pop();
 
-                std::map<int, Opcode0 *>::iterator iter = mSegment5.find (opcode);
+                if (!result)
+                    mRuntime.setPC (instruction.mTarget);
+
+                return;
+            }
 
-                if (iter==mSegment5.end())
-                    abortUnknownCode (5, opcode);
+            case Program::Kind_CompareFloatJump:
+            {
+                bool result = compare (instruction.mArg0, mRuntime[0].mFloat, instruction.mLiteral.mFloat);
+                mRuntime.pop();
 
-                iter->second->execute (mRuntime);
+                if (!result)
+                    mRuntime.setPC (instruction.mTarget);
 
                 return;
             }
         }
-
-        abortUnknownSegment (code);
     }
 
     void Interpreter::abortUnknownCode (int segment, int opcode)
@@ -152,99 +371,113 @@ namespace Interpreter
         }
     }
 
-    Interpreter::Interpreter() : mRunning (false)
+    Interpreter::Interpreter()
+    : mRunning (false), mSegment0 (32), mSegment1 (32), mSegment2 (512), mSegment3 (131072), mSegment4 (512),
+      mSegment5 (33554432), mExecutedInstructions (0)
     {}
 
     Interpreter::~Interpreter()
-    {
-        for (std::map<int, Opcode1 *>::iterator iter (mSegment0.begin());
-            iter!=mSegment0.end(); ++iter)
-            delete iter->second;
-
-        for (std::map<int, Opcode2 *>::iterator iter (mSegment1.begin());
-            iter!=mSegment1.end(); ++iter)
-            delete iter->second;
-
-        for (std::map<int, Opcode1 *>::iterator iter (mSegment2.begin());
-            iter!=mSegment2.end(); ++iter)
-            delete iter->second;
-
-        for (std::map<int, Opcode1 *>::iterator iter (mSegment3.begin());
-            iter!=mSegment3.end(); ++iter)
-            delete iter->second;
-
-        for (std::map<int, Opcode2 *>::iterator iter (mSegment4.begin());
-            iter!=mSegment4.end(); ++iter)
-            delete iter->second;
-
-        for (std::map<int, Opcode0 *>::iterator iter (mSegment5.begin());
-            iter!=mSegment5.end(); ++iter)
-            delete iter->second;
-    }
+    {}
 
     void Interpreter::installSegment0 (int code, Opcode1 *opcode)
     {
-        assert(mSegment0.find(code) == mSegment0.end());
-        mSegment0.insert (std::make_pair (code, opcode));
+        bool installed = mSegment0.install (code, opcode);
+        assert (installed);
+        (void)installed;
     }
 
     void Interpreter::installSegment1 (int code, Opcode2 *opcode)
     {
-        assert(mSegment1.find(code) == mSegment1.end());
-        mSegment1.insert (std::make_pair (code, opcode));
+        bool installed = mSegment1.install (code, opcode);
+        assert (installed);
+        (void)installed;
     }
 
     void Interpreter::installSegment2 (int code, Opcode1 *opcode)
     {
-        assert(mSegment2.find(code) == mSegment2.end());
-        mSegment2.insert (std::make_pair (code, opcode));
+        bool installed = mSegment2.install (code, opcode);
+        assert (installed);
+        (void)installed;
     }
 
     void Interpreter::installSegment3 (int code, Opcode1 *opcode)
     {
-        assert(mSegment3.find(code) == mSegment3.end());
-        mSegment3.insert (std::make_pair (code, opcode));
+        bool installed = mSegment3.install (code, opcode);
+        assert (installed);
+        (void)installed;
     }
 
     void Interpreter::installSegment4 (int code, Opcode2 *opcode)
     {
-        assert(mSegment4.find(code) == mSegment4.end());
-        mSegment4.insert (std::make_pair (code, opcode));
+        bool installed = mSegment4.install (code, opcode);
+        assert (installed);
+        (void)installed;
     }
 
     void Interpreter::installSegment5 (int code, Opcode0 *opcode)
     {
-        assert(mSegment5.find(code) == mSegment5.end());
-        mSegment5.insert (std::make_pair (code, opcode));
+        bool installed = mSegment5.install (code, opcode);
+        assert (installed);
+        (void)installed;
     }
 
-    void Interpreter::run (const Type_Code *code, int codeSize, Context& context)
+    Program Interpreter::decode (const Type_Code *code, int codeSize, bool superinstructions) const
     {
         assert (codeSize>=4);
 
+        Program program;
+        program.mCode = code;
+        program.mCodeSize = codeSize;
+
+        const int opcodes = static_cast<int> (code[0]);
+        program.mInstructions.reserve (opcodes);
+
+        for (int i = 0; i<opcodes; ++i)
+            program.mInstructions.push_back (decodeInstruction (code[4 + i]));
+
+        if (superinstructions)
+            for (int i = 0; i<opcodes; ++i)
+                fuseInstructions (program, i);
+
+        return program;
+    }
+
+    void Interpreter::run (const Program& program, Context& context)
+    {
         begin();
 
+        const Program::Instruction *instructions = program.mInstructions.data();
+        const int size = static_cast<int> (program.mInstructions.size());
+        std::size_t executed = 0;
+
         try
         {
-            mRuntime.configure (code, codeSize, context);
-
-            int opcodes = static_cast<int> (code[0]);
+            mRuntime.configure (program.mCode, program.mCodeSize, context);
 
-            const Type_Code *codeBlock = code + 4;
+            int pc = 0;
 
-            while (mRuntime.getPC()>=0 && mRuntime.getPC()<opcodes)
+            while (pc>=0 && pc<size)
             {
-                Type_Code runCode = codeBlock[mRuntime.getPC()];
-                mRuntime.setPC (mRuntime.getPC()+1);
-                execute (runCode);
+                const Program::Instruction& instruction = instructions[pc];
+                mRuntime.setPC (pc + instruction.mSize);
+                executed += instruction.mSize;
+                execute (instruction);
+                pc = mRuntime.getPC();
             }
         }
         catch (...)
         {
+            mExecutedInstructions += executed;
             end();
             throw;
         }
 
+        mExecutedInstructions += executed;
         end();
     }
+
+    void Interpreter::run (const Type_Code *code, int codeSize, Context& context)
+    {
+        run (decode (code, codeSize), context);
+    }
 }
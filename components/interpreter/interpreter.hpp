@@ -1,8 +1,9 @@
 #ifndef INTERPRETER_INTERPRETER_H_INCLUDED
 #define INTERPRETER_INTERPRETER_H_INCLUDED
 
-#include <map>
+#include <cstddef>
 #include <stack>
+#include <vector>
 
 #include "runtime.hpp"
 #include "types.hpp"
@@ -13,23 +14,125 @@ namespace Interpreter
     class Opcode1;
     class Opcode2;
 
+    /// Dense opcode lookup table for one code segment.
+    ///
+    /// Opcodes are split into two arrays, one for the opcodes below the extension range of the segment and one
+    /// for the extension range, so that both stay small.
+    template <class T>
+    class OpcodeTable
+    {
+            std::vector<T *> mBase;
+            std::vector<T *> mExtensions;
+            unsigned int mExtensionBase;
+
+            // not implemented
+            OpcodeTable (const OpcodeTable&);
+            OpcodeTable& operator= (const OpcodeTable&);
+
+        public:
+
+            explicit OpcodeTable (unsigned int extensionBase) : mExtensionBase (extensionBase) {}
+
+            ~OpcodeTable()
+            {
+                for (T *opcode : mBase)
+                    delete opcode;
+                for (T *opcode : mExtensions)
+                    delete opcode;
+            }
+
+            bool install (unsigned int code, T *opcode)
+            {
+                std::vector<T *>& table = code<mExtensionBase ? mBase : mExtensions;
+                const std::size_t index = code<mExtensionBase ? code : code-mExtensionBase;
+
+                if (index>=table.size())
+                    table.resize (index+1, nullptr);
+                else if (table[index])
+                    return false;
+
+                table[index] = opcode;
+                return true;
+            }
+
+            T *find (unsigned int code) const
+            {
+                const std::vector<T *>& table = code<mExtensionBase ? mBase : mExtensions;
+                const std::size_t index = code<mExtensionBase ? code : code-mExtensionBase;
+                return index<table.size() ? table[index] : nullptr;
+            }
+    };
+
+    /// Compiled script code decoded ahead of execution, see Interpreter::decode.
+    ///
+    /// There is one instruction per code word, so that jump targets stay the same. An instruction at the start of a
+    /// common code sequence may be a superinstruction, which executes the whole sequence at once; the following
+    /// instructions are still valid on their own and are used when a jump lands inside the sequence.
+    struct Program
+    {
+        enum Kind
+        {
+            Kind_Opcode0,
+            Kind_Opcode1,
+            Kind_Opcode2,
+            Kind_UnknownOpcode,
+            Kind_UnknownSegment,
+
+            // superinstructions
+            Kind_PushLiteral,       ///< push int; fetch int/float literal
+            Kind_FetchLocalShort,   ///< push int; fetch local short
+            Kind_FetchLocalLong,    ///< push int; fetch local long
+            Kind_FetchLocalFloat,   ///< push int; fetch local float
+            Kind_JumpOnZero,        ///< skip on non-zero; jump
+            Kind_CompareIntJump,    ///< push int; fetch int literal; compare int; skip on non-zero; jump
+            Kind_CompareFloatJump   ///< push int; fetch float literal; compare float; skip on non-zero; jump
+        };
+
+        struct Instruction
+        {
+            Kind mKind;
+            int mSize; ///< number of code words executed by this instruction
+            union
+            {
+                Opcode0 *mOpcode0;
+                Opcode1 *mOpcode1;
+                Opcode2 *mOpcode2;
+            };
+            unsigned int mArg0;
+            unsigned int mArg1;
+            int mTarget; ///< program counter after a jump
+            Data mLiteral;
+        };
+
+        const Type_Code *mCode;
+        int mCodeSize;
+        std::vector<Instruction> mInstructions;
+
+        Program() : mCode (nullptr), mCodeSize (0) {}
+    };
+
     class Interpreter
     {
             std::stack<Runtime> mCallstack;
             bool mRunning;
             Runtime mRuntime;
-            std::map<int, Opcode1 *> mSegment0;
-            std::map<int, Opcode2 *> mSegment1;
-            std::map<int, Opcode1 *> mSegment2;
-            std::map<int, Opcode1 *> mSegment3;
-            std::map<int, Opcode2 *> mSegment4;
-            std::map<int, Opcode0 *> mSegment5;
+            OpcodeTable<Opcode1> mSegment0;
+            OpcodeTable<Opcode2> mSegment1;
+            OpcodeTable<Opcode1> mSegment2;
+            OpcodeTable<Opcode1> mSegment3;
+            OpcodeTable<Opcode2> mSegment4;
+            OpcodeTable<Opcode0> mSegment5;
+            std::size_t mExecutedInstructions;
 
             // not implemented
             Interpreter (const Interpreter&);
             Interpreter& operator= (const Interpreter&);
 
-            void execute (Type_Code code);
+            Program::Instruction decodeInstruction (Type_Code code) const;
+
+            void fuseInstructions (Program& program, int index) const;
+
+            void execute (const Program::Instruction& instruction);
 
             void abortUnknownCode (int segment, int opcode);
 
@@ -63,7 +166,18 @@ namespace Interpreter
             void installSegment5 (int code, Opcode0 *opcode);
             ///< ownership of \a opcode is transferred to *this.
 
+            Program decode (const Type_Code *code, int codeSize, bool superinstructions = true) const;
+            ///< Look up the opcodes of \a code once, and fuse common code sequences into superinstructions.
+            /// \a code must exist as long as the returned program is used. Opcodes installed after decoding are
+            /// not seen by the program.
+
+            void run (const Program& program, Context& context);
+
             void run (const Type_Code *code, int codeSize, Context& context);
+            ///< Decode and run \a code. Prefer decoding once for code that is run repeatedly.
+
+            std::size_t getExecutedInstructions() const { return mExecutedInstructions; }
+            ///< Number of code words executed so far, counting each word of a superinstruction.
     };
 }
 
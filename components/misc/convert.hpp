@@ -1,6 +1,8 @@
 #ifndef OPENMW_COMPONENTS_MISC_CONVERT_H
 #define OPENMW_COMPONENTS_MISC_CONVERT_H
 
+#include <components/esm/defs.hpp>
+
 #include <LinearMath/btTransform.h>
 #include <LinearMath/btVector3.h>
 #include <LinearMath/btQuaternion.h>
@@ -40,6 +42,14 @@ namespace Convert
     {
         return osg::Quat(quat.x(), quat.y(), quat.z(), quat.w());
     }
+
+    /// Rotation of an object placed at the given position in the game world
+    inline osg::Quat makeOsgQuat(const ESM::Position& position)
+    {
+        return osg::Quat(position.rot[2], osg::Vec3f(0, 0, -1))
+            * osg::Quat(position.rot[1], osg::Vec3f(0, -1, 0))
+            * osg::Quat(position.rot[0], osg::Vec3f(-1, 0, 0));
+    }
 }
 }
 
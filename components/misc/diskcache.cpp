@@ -0,0 +1,281 @@
+#include "diskcache.hpp"
+
+#include <components/debug/debuglog.hpp>
+
+#include <osg/Stats>
+
+#include <boost/filesystem/fstream.hpp>
+#include <boost/filesystem/operations.hpp>
+
+#include <algorithm>
+#include <ctime>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <tuple>
+
+namespace
+{
+    const std::size_t sMagicSize = 8;
+
+    template <class T>
+    void writeValue(std::ostream& stream, const T& value)
+    {
+        stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    template <class T>
+    T readValue(std::istream& stream)
+    {
+        T value;
+        if (!stream.read(reinterpret_cast<char*>(&value), sizeof(T)))
+            throw std::runtime_error("unexpected end of file");
+        return value;
+    }
+}
+
+namespace Misc
+{
+    DiskCache::DiskCache(const boost::filesystem::path& path, std::size_t maxSize, const char* magic,
+            std::uint32_t formatVersion, const std::string& extension, const std::string& description)
+        : mPath(path)
+        , mMaxSize(maxSize)
+        , mMagic(magic, sMagicSize)
+        , mFormatVersion(formatVersion)
+        , mExtension(extension)
+        , mDescription(description)
+        , mSize(0)
+        , mHits(0)
+        , mMisses(0)
+    {
+        try
+        {
+            boost::filesystem::create_directories(mPath);
+
+            std::vector<std::tuple<std::time_t, std::string, std::uint64_t>> files;
+            for (boost::filesystem::directory_iterator it(mPath), end; it != end; ++it)
+            {
+                if (!boost::filesystem::is_regular_file(it->status()))
+                    continue;
+                if (it->path().extension() != mExtension)
+                {
+                    // Left behind by an interrupted write
+                    if (it->path().extension() == ".tmp")
+                        boost::filesystem::remove(it->path());
+                    continue;
+                }
+                files.emplace_back(boost::filesystem::last_write_time(it->path()), it->path().filename().string(),
+                                   boost::filesystem::file_size(it->path()));
+            }
+
+            // Files are touched on use, so the modification time gives the order of use from the previous sessions
+            std::sort(files.begin(), files.end());
+            const std::lock_guard<std::mutex> lock(mMutex);
+            for (const auto& file : files)
+                addEntryUnsafe(std::get<1>(file), std::get<2>(file));
+            while (mSize > mMaxSize && !mLeastRecentlyUsed.empty())
+            {
+                const std::string name = mLeastRecentlyUsed.front();
+                removeEntryUnsafe(name);
+                boost::filesystem::remove(mPath / name);
+            }
+
+            Log(Debug::Verbose) << "Found " << mEntries.size() << " " << mDescription << " files (" << mSize
+                << " bytes) in " << mPath;
+        }
+        catch (const std::exception& e)
+        {
+            Log(Debug::Warning) << "Warning: failed to read " << mDescription << " disk cache " << mPath << ": "
+                << e.what();
+        }
+    }
+
+    std::string DiskCache::makeName(std::uint64_t hash) const
+    {
+        std::ostringstream stream;
+        stream << std::hex << std::setfill('0') << std::setw(16) << hash << mExtension;
+        return stream.str();
+    }
+
+    std::vector<char> DiskCache::read(const std::string& name, std::uint64_t checkHash)
+    {
+        const boost::filesystem::path path = mPath / name;
+
+        {
+            const std::lock_guard<std::mutex> lock(mMutex);
+            const auto entry = mEntries.find(name);
+            if (entry == mEntries.end())
+            {
+                ++mMisses;
+                return std::vector<char>();
+            }
+            mLeastRecentlyUsed.splice(mLeastRecentlyUsed.end(), mLeastRecentlyUsed, entry->second.mLeastRecentlyUsed);
+        }
+
+        try
+        {
+            boost::filesystem::ifstream stream(path, std::ios::binary);
+            if (!stream)
+                throw std::runtime_error("failed to open file");
+
+            char magic[sMagicSize];
+            if (!stream.read(magic, sizeof(magic)) || !std::equal(magic, magic + sizeof(magic), mMagic.begin()))
+                throw std::runtime_error("not a " + mDescription);
+
+            // Different key with the same name hash, an outdated format or a stale entry
+            if (readValue<std::uint32_t>(stream) != mFormatVersion || readValue<std::uint64_t>(stream) != checkHash)
+            {
+                const std::lock_guard<std::mutex> lock(mMutex);
+                ++mMisses;
+                return std::vector<char>();
+            }
+
+            const auto size = readValue<std::uint64_t>(stream);
+            if (size == 0 || boost::filesystem::file_size(path) != getHeaderSize() + size)
+                throw std::runtime_error("unexpected end of file");
+
+            std::vector<char> payload(static_cast<std::size_t>(size));
+            if (!stream.read(payload.data(), payload.size()))
+                throw std::runtime_error("unexpected end of file");
+
+            boost::system::error_code error;
+            boost::filesystem::last_write_time(path, std::time(nullptr), error);
+
+            const std::lock_guard<std::mutex> lock(mMutex);
+            ++mHits;
+            return payload;
+        }
+        catch (const std::exception& e)
+        {
+            Log(Debug::Warning) << "Warning: failed to read " << mDescription << " " << path << ": " << e.what();
+            removeFile(name);
+            const std::lock_guard<std::mutex> lock(mMutex);
+            removeEntryUnsafe(name);
+            ++mMisses;
+            return std::vector<char>();
+        }
+    }
+
+    void DiskCache::write(const std::string& name, std::uint64_t checkHash, const char* payload, std::size_t size)
+    {
+        const boost::filesystem::path path = mPath / name;
+        const std::uint64_t fileSize = getHeaderSize() + size;
+
+        if (size == 0 || fileSize > mMaxSize)
+            return;
+
+        {
+            // Another thread building the same entry writes the same file
+            const std::lock_guard<std::mutex> lock(mMutex);
+            if (!mWriting.insert(name).second)
+                return;
+        }
+
+        bool written = false;
+
+        try
+        {
+            boost::filesystem::path temporary = path;
+            temporary += ".tmp";
+
+            {
+                boost::filesystem::ofstream stream(temporary, std::ios::binary);
+                stream.write(mMagic.data(), mMagic.size());
+                writeValue(stream, mFormatVersion);
+                writeValue(stream, checkHash);
+                writeValue(stream, static_cast<std::uint64_t>(size));
+                stream.write(payload, size);
+                if (!stream)
+                    throw std::runtime_error("failed to write file");
+            }
+
+            boost::filesystem::rename(temporary, path);
+            written = true;
+        }
+        catch (const std::exception& e)
+        {
+            Log(Debug::Warning) << "Warning: failed to write " << mDescription << " " << path << ": " << e.what();
+        }
+
+        std::vector<std::string> removed;
+
+        {
+            const std::lock_guard<std::mutex> lock(mMutex);
+            mWriting.erase(name);
+            if (!written)
+                return;
+            removeEntryUnsafe(name);
+            addEntryUnsafe(name, fileSize);
+            while (mSize > mMaxSize && mLeastRecentlyUsed.front() != name)
+            {
+                removed.push_back(mLeastRecentlyUsed.front());
+                removeEntryUnsafe(removed.back());
+            }
+        }
+
+        for (const std::string& file : removed)
+            removeFile(file);
+    }
+
+    void DiskCache::discard(const std::string& name)
+    {
+        removeFile(name);
+        const std::lock_guard<std::mutex> lock(mMutex);
+        removeEntryUnsafe(name);
+        if (mHits > 0)
+            --mHits;
+        ++mMisses;
+    }
+
+    std::size_t DiskCache::getSize() const
+    {
+        const std::lock_guard<std::mutex> lock(mMutex);
+        return mSize;
+    }
+
+    void DiskCache::reportStats(unsigned int frameNumber, osg::Stats& stats, const std::string& prefix) const
+    {
+        std::size_t size = 0;
+        std::size_t hits = 0;
+        std::size_t misses = 0;
+
+        {
+            const std::lock_guard<std::mutex> lock(mMutex);
+            size = mSize;
+            hits = mHits;
+            misses = mMisses;
+        }
+
+        stats.setAttribute(frameNumber, prefix + " DiskCacheSize", size);
+        stats.setAttribute(frameNumber, prefix + " DiskCacheHits", hits);
+        stats.setAttribute(frameNumber, prefix + " DiskCacheMisses", misses);
+    }
+
+    std::uint64_t DiskCache::getHeaderSize() const
+    {
+        return mMagic.size() + sizeof(mFormatVersion) + 2 * sizeof(std::uint64_t);
+    }
+
+    void DiskCache::addEntryUnsafe(const std::string& name, std::uint64_t size)
+    {
+        const auto leastRecentlyUsed = mLeastRecentlyUsed.insert(mLeastRecentlyUsed.end(), name);
+        mEntries.emplace(name, Entry {size, leastRecentlyUsed});
+        mSize += size;
+    }
+
+    void DiskCache::removeEntryUnsafe(const std::string& name)
+    {
+        const auto entry = mEntries.find(name);
+        if (entry == mEntries.end())
+            return;
+        mSize -= entry->second.mSize;
+        mLeastRecentlyUsed.erase(entry->second.mLeastRecentlyUsed);
+        mEntries.erase(entry);
+    }
+
+    void DiskCache::removeFile(const std::string& name) const
+    {
+        boost::system::error_code error;
+        boost::filesystem::remove(mPath / name, error);
+    }
+}
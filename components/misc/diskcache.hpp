@@ -0,0 +1,89 @@
+#ifndef OPENMW_COMPONENTS_MISC_DISKCACHE_H
+#define OPENMW_COMPONENTS_MISC_DISKCACHE_H
+
+#include <boost/filesystem/path.hpp>
+
+#include <cstdint>
+#include <list>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace osg
+{
+    class Stats;
+}
+
+namespace Misc
+{
+    /// \brief Directory of files persisted between sessions, the least recently used ones are removed when the total
+    /// size exceeds the limit
+    ///
+    /// Each file starts with a header of the magic, the format version, a check hash and the payload size. The file
+    /// name is derived from a hash of the key by the owner, the check hash is a second hash of the key to detect
+    /// collisions and stale entries. Files are written under a temporary name first, so an interrupted write can't
+    /// leave a truncated entry behind, and touched on use to keep their order between sessions. All functions are
+    /// thread safe.
+    class DiskCache
+    {
+        public:
+            /// \param magic identifies the kind of the entries, the first 8 characters are used
+            /// \param description name of an entry for the log, e.g. "nav mesh tile"
+            DiskCache(const boost::filesystem::path& path, std::size_t maxSize, const char* magic,
+                      std::uint32_t formatVersion, const std::string& extension, const std::string& description);
+
+            /// \return name of the file for the given hash of a key
+            std::string makeName(std::uint64_t hash) const;
+
+            /// \return payload of the entry, empty when it is missing, has another check hash or can't be read
+            std::vector<char> read(const std::string& name, std::uint64_t checkHash);
+
+            /// Does nothing for an empty payload, a payload over the size limit or an entry being written by another
+            /// thread.
+            void write(const std::string& name, std::uint64_t checkHash, const char* payload, std::size_t size);
+
+            /// Removes an entry with a payload the owner couldn't use, the read is counted as a miss.
+            void discard(const std::string& name);
+
+            const boost::filesystem::path& getPath() const { return mPath; }
+
+            std::size_t getSize() const;
+            ///< Total size of the files in bytes
+
+            /// Reports the size, hits and misses as "<prefix> DiskCacheSize" and so on
+            void reportStats(unsigned int frameNumber, osg::Stats& stats, const std::string& prefix) const;
+
+        private:
+            struct Entry
+            {
+                std::uint64_t mSize;
+                std::list<std::string>::iterator mLeastRecentlyUsed;
+            };
+
+            const boost::filesystem::path mPath;
+            const std::size_t mMaxSize;
+            const std::string mMagic;
+            const std::uint32_t mFormatVersion;
+            const std::string mExtension;
+            const std::string mDescription;
+            mutable std::mutex mMutex;
+            std::size_t mSize;
+            std::size_t mHits;
+            std::size_t mMisses;
+            std::map<std::string, Entry> mEntries;
+            std::list<std::string> mLeastRecentlyUsed;
+            std::set<std::string> mWriting;
+
+            std::uint64_t getHeaderSize() const;
+
+            void addEntryUnsafe(const std::string& name, std::uint64_t size);
+
+            void removeEntryUnsafe(const std::string& name);
+
+            void removeFile(const std::string& name) const;
+    };
+}
+
+#endif
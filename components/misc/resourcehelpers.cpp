@@ -138,3 +138,8 @@ std::string Misc::ResourceHelpers::correctActorModelPath(const std::string &resP
     }
     return mdlname;
 }
+
+bool Misc::ResourceHelpers::isHiddenMarker(const std::string& refId)
+{
+    return refId == "prisonmarker" || refId == "divinemarker" || refId == "templemarker" || refId == "northmarker";
+}
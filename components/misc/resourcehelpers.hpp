@@ -23,6 +23,8 @@ namespace Misc
         std::string correctBookartPath(const std::string &resPath, int width, int height, const VFS::Manager* vfs);
         /// Use "xfoo.nif" instead of "foo.nif" if available
         std::string correctActorModelPath(const std::string &resPath, const VFS::Manager* vfs);
+        /// Marker objects have a hardcoded function in the game logic and are hidden from the player
+        bool isHiddenMarker(const std::string& refId);
     }
 }
 
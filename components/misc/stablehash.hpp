@@ -0,0 +1,67 @@
+#ifndef OPENMW_COMPONENTS_MISC_STABLEHASH_H
+#define OPENMW_COMPONENTS_MISC_STABLEHASH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+
+namespace Misc
+{
+    /// \brief 64-bit FNV-1a hash
+    ///
+    /// Unlike std::hash, the value only depends on the hashed bytes, so it can be stored in files and compared between
+    /// sessions. Values are hashed by their object representation: structures with padding need to be added member by
+    /// member, and the hash of multibyte values depends on the byte order of the platform.
+    class StableHash
+    {
+        public:
+            static const std::uint64_t sOffsetBasis = 14695981039346656037ull;
+
+            /// Gives a second hash of the same data, independent enough to verify an entry found by the first one
+            static const std::uint64_t sAlternativeOffsetBasis = 10188205945632480317ull;
+
+            explicit StableHash(std::uint64_t offsetBasis = sOffsetBasis)
+                : mValue(offsetBasis)
+                , mSize(0)
+            {
+            }
+
+            void add(const void* data, std::size_t size)
+            {
+                const auto bytes = static_cast<const unsigned char*>(data);
+                for (std::size_t i = 0; i < size; ++i)
+                {
+                    mValue ^= bytes[i];
+                    mValue *= 1099511628211ull;
+                }
+                mSize += size;
+            }
+
+            template <class T>
+            void add(const T& value)
+            {
+                static_assert(std::is_arithmetic<T>::value || std::is_enum<T>::value,
+                              "Only values without padding can be hashed as a whole");
+                add(&value, sizeof(T));
+            }
+
+            /// The length is hashed too, so that consecutive strings can't be confused with other ones
+            void add(const std::string& value)
+            {
+                add(static_cast<std::uint64_t>(value.size()));
+                add(value.data(), value.size());
+            }
+
+            std::uint64_t getValue() const { return mValue; }
+
+            /// Number of hashed bytes
+            std::uint64_t getSize() const { return mSize; }
+
+        private:
+            std::uint64_t mValue;
+            std::uint64_t mSize;
+    };
+}
+
+#endif
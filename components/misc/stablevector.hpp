@@ -0,0 +1,285 @@
+#ifndef OPENMW_COMPONENTS_MISC_STABLEVECTOR_H
+#define OPENMW_COMPONENTS_MISC_STABLEVECTOR_H
+
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace Misc
+{
+    /// \brief Sequence container with stable element addresses and contiguous chunks of storage
+    ///
+    /// Elements are appended to chunks of growing capacity that are never reallocated, so pointers and references
+    /// to elements stay valid until the element is erased, like with std::list, while iteration walks linearly
+    /// through memory. Erasing an element only destroys it and marks its slot as free; the slot is not reused, so
+    /// the order of insertion is kept. Iterators stay valid as long as their element is not erased, but as with
+    /// std::vector, push_back may turn the past-the-end iterator into an iterator to the new element.
+    template <class T>
+    class StableVector
+    {
+            static const std::size_t sMinChunkSize = 8;
+            static const std::size_t sMaxChunkSize = 256;
+
+            struct Chunk
+            {
+                typedef typename std::aligned_storage<sizeof (T), alignof (T)>::type Storage;
+
+                std::unique_ptr<Storage[]> mStorage;
+                std::unique_ptr<bool[]> mAlive;
+                std::size_t mCapacity;
+                std::size_t mUsed;
+
+                explicit Chunk (std::size_t capacity)
+                : mStorage (new Storage[capacity]), mAlive (new bool[capacity]), mCapacity (capacity), mUsed (0)
+                {}
+
+                ~Chunk()
+                {
+                    for (std::size_t i = 0; i < mUsed; ++i)
+                        if (mAlive[i])
+                            get (i).~T();
+                }
+
+                T& get (std::size_t index)
+                {
+                    return *reinterpret_cast<T*> (&mStorage[index]);
+                }
+            };
+
+            std::vector<std::unique_ptr<Chunk>> mChunks;
+            std::size_t mSize;
+
+            template <class Value, class Owner>
+            class IteratorBase
+            {
+                    Owner *mOwner;
+                    std::size_t mChunk;
+                    std::size_t mIndex;
+
+                    friend class StableVector;
+                    template <class, class> friend class IteratorBase;
+
+                    IteratorBase (Owner *owner, std::size_t chunk, std::size_t index)
+                    : mOwner (owner), mChunk (chunk), mIndex (index)
+                    {}
+
+                    // Move forward to the next live element, or to the end
+                    void skipForward()
+                    {
+                        for (; mChunk < mOwner->mChunks.size(); ++mChunk, mIndex = 0)
+                        {
+                            const Chunk& chunk = *mOwner->mChunks[mChunk];
+                            while (mIndex < chunk.mUsed && !chunk.mAlive[mIndex])
+                                ++mIndex;
+                            if (mIndex < chunk.mUsed)
+                                return;
+                        }
+                        mIndex = 0;
+                    }
+
+                public:
+
+                    typedef std::bidirectional_iterator_tag iterator_category;
+                    typedef Value value_type;
+                    typedef std::ptrdiff_t difference_type;
+                    typedef Value *pointer;
+                    typedef Value& reference;
+
+                    IteratorBase() : mOwner (nullptr), mChunk (0), mIndex (0) {}
+
+                    template <class OtherValue, class OtherOwner,
+                        class = typename std::enable_if<std::is_convertible<OtherValue*, Value*>::value>::type>
+                    IteratorBase (const IteratorBase<OtherValue, OtherOwner>& other)
+                    : mOwner (other.mOwner), mChunk (other.mChunk), mIndex (other.mIndex)
+                    {}
+
+                    Value& operator*() const
+                    {
+                        return mOwner->mChunks[mChunk]->get (mIndex);
+                    }
+
+                    Value *operator->() const
+                    {
+                        return &**this;
+                    }
+
+                    IteratorBase& operator++()
+                    {
+                        ++mIndex;
+                        skipForward();
+                        return *this;
+                    }
+
+                    IteratorBase operator++ (int)
+                    {
+                        IteratorBase result = *this;
+                        ++*this;
+                        return result;
+                    }
+
+                    IteratorBase& operator--()
+                    {
+                        while (true)
+                        {
+                            if (mIndex == 0)
+                                mIndex = mOwner->mChunks[--mChunk]->mUsed;
+                            else if (mOwner->mChunks[mChunk]->mAlive[--mIndex])
+                                return *this;
+                        }
+                    }
+
+                    IteratorBase operator-- (int)
+                    {
+                        IteratorBase result = *this;
+                        --*this;
+                        return result;
+                    }
+
+                    template <class OtherValue, class OtherOwner>
+                    bool operator== (const IteratorBase<OtherValue, OtherOwner>& other) const
+                    {
+                        return mChunk == other.mChunk && mIndex == other.mIndex && mOwner == other.mOwner;
+                    }
+
+                    template <class OtherValue, class OtherOwner>
+                    bool operator!= (const IteratorBase<OtherValue, OtherOwner>& other) const
+                    {
+                        return !(*this == other);
+                    }
+            };
+
+        public:
+
+            typedef T value_type;
+            typedef std::size_t size_type;
+            typedef T& reference;
+            typedef const T& const_reference;
+            typedef IteratorBase<T, StableVector> iterator;
+            typedef IteratorBase<const T, const StableVector> const_iterator;
+
+            StableVector() : mSize (0) {}
+
+            StableVector (const StableVector& other) : mSize (0)
+            {
+                for (const T& value : other)
+                    push_back (value);
+            }
+
+            StableVector (StableVector&& other) : mChunks (std::move (other.mChunks)), mSize (other.mSize)
+            {
+                other.mChunks.clear();
+                other.mSize = 0;
+            }
+
+            StableVector& operator= (const StableVector& other)
+            {
+                if (this != &other)
+                {
+                    StableVector copy (other);
+                    swap (copy);
+                }
+                return *this;
+            }
+
+            StableVector& operator= (StableVector&& other)
+            {
+                swap (other);
+                other.clear();
+                return *this;
+            }
+
+            void swap (StableVector& other)
+            {
+                mChunks.swap (other.mChunks);
+                std::swap (mSize, other.mSize);
+            }
+
+            bool empty() const { return mSize == 0; }
+
+            size_type size() const { return mSize; }
+
+            iterator begin()
+            {
+                iterator result (this, 0, 0);
+                result.skipForward();
+                return result;
+            }
+
+            const_iterator begin() const
+            {
+                const_iterator result (this, 0, 0);
+                result.skipForward();
+                return result;
+            }
+
+            iterator end() { return iterator (this, mChunks.size(), 0); }
+
+            const_iterator end() const { return const_iterator (this, mChunks.size(), 0); }
+
+            T& front() { return *begin(); }
+
+            const T& front() const { return *begin(); }
+
+            T& back() { return *--end(); }
+
+            const T& back() const { return *--end(); }
+
+            template <class ... Args>
+            T& emplace_back (Args&& ... args)
+            {
+                if (mChunks.empty() || mChunks.back()->mUsed == mChunks.back()->mCapacity)
+                {
+                    std::size_t capacity = mChunks.empty() ? sMinChunkSize : mChunks.back()->mCapacity * 2;
+                    if (capacity > sMaxChunkSize)
+                        capacity = sMaxChunkSize;
+                    mChunks.emplace_back (new Chunk (capacity));
+                }
+
+                Chunk& chunk = *mChunks.back();
+                T *value = new (&chunk.mStorage[chunk.mUsed]) T (std::forward<Args> (args)...);
+                chunk.mAlive[chunk.mUsed++] = true;
+                ++mSize;
+                return *value;
+            }
+
+            T& push_back (const T& value)
+            {
+                return emplace_back (value);
+            }
+
+            T& push_back (T&& value)
+            {
+                return emplace_back (std::move (value));
+            }
+
+            /// Destroy the element at \a position, without moving any other element.
+            /// \return Iterator to the element following the erased one.
+            iterator erase (const_iterator position)
+            {
+                Chunk& chunk = *mChunks[position.mChunk];
+                chunk.get (position.mIndex).~T();
+                chunk.mAlive[position.mIndex] = false;
+
+                iterator next (this, position.mChunk, position.mIndex);
+                if (--mSize == 0)
+                {
+                    clear();
+                    return end();
+                }
+                ++next;
+                return next;
+            }
+
+            void clear()
+            {
+                mChunks.clear();
+                mSize = 0;
+            }
+    };
+}
+
+#endif
@@ -8,10 +8,10 @@ namespace Nif
 {
 
 /// Open a NIF stream. The name is used for error messages.
-NIFFile::NIFFile(Files::IStreamPtr stream, const std::string &name)
+NIFFile::NIFFile(Files::IStreamPtr stream, const std::string &name, bool buffered)
     : filename(name)
 {
-    parse(stream);
+    parse(stream, buffered);
 }
 
 NIFFile::~NIFFile()
@@ -131,9 +131,9 @@ std::string NIFFile::printVersion(unsigned int version)
     return stream.str();
 }
 
-void NIFFile::parse(Files::IStreamPtr stream)
+void NIFFile::parse(Files::IStreamPtr stream, bool buffered)
 {
-    NIFStream nif (this, stream);
+    NIFStream nif (this, stream, buffered);
 
     // Check the header string
     std::string head = nif.getVersionString();
@@ -63,7 +63,7 @@ class NIFFile final : public File
     bool mUseSkinning = false;
 
     /// Parse the file
-    void parse(Files::IStreamPtr stream);
+    void parse(Files::IStreamPtr stream, bool buffered);
 
     /// Get the file's version in a human readable form
     ///\returns A string containing a human readable NIF version number
@@ -94,7 +94,7 @@ public:
     };
 
     /// Used if file parsing fails
-    void fail(const std::string &msg) const
+    [[noreturn]] void fail(const std::string &msg) const
     {
         std::string err = " NIFFile Error: " + msg;
         err += "\nFile: " + filename;
@@ -107,7 +107,9 @@ public:
     }
 
     /// Open a NIF stream. The name is used for error messages.
-    NIFFile(Files::IStreamPtr stream, const std::string &name);
+    /// @param buffered read the whole file into memory before decoding it, which avoids going through the stream for
+    /// each value. Reading past the end of the file then fails instead of giving undefined values.
+    NIFFile(Files::IStreamPtr stream, const std::string &name, bool buffered = true);
     ~NIFFile();
 
     /// Get a given record
@@ -5,8 +5,9 @@
 
 #include "nifstream.hpp"
 
+#include <algorithm>
 #include <sstream>
-#include <map>
+#include <vector>
 
 #include "niffile.hpp"
 
@@ -43,13 +44,18 @@ using QuaternionKey = KeyT<osg::Quat>;
 
 template<typename T, T (NIFStream::*getValue)()>
 struct KeyMapT {
-    using MapType = std::map<float, KeyT<T>>;
-
     using ValueType = T;
     using KeyType = KeyT<T>;
 
     unsigned int mInterpolationType = InterpolationType_Linear;
-    MapType mKeys;
+
+    // Keys sorted by time, with times and values in separate arrays to keep searches cache friendly
+    std::vector<float> mTimes;
+    std::vector<KeyType> mKeys;
+
+    std::size_t size() const { return mTimes.size(); }
+
+    bool empty() const { return mTimes.empty(); }
 
     //Read in a KeyGroup (see http://niftools.sourceforge.net/doc/nif/NiKeyframeData.html)
     void read(NIFStream *nif, bool force=false)
@@ -62,6 +68,7 @@ struct KeyMapT {
         if(count == 0 && !force)
             return;
 
+        mTimes.clear();
         mKeys.clear();
 
         mInterpolationType = nif->getUInt();
@@ -72,29 +79,32 @@ struct KeyMapT {
         if (mInterpolationType == InterpolationType_Linear
          || mInterpolationType == InterpolationType_Constant)
         {
+            reserve(count);
             for(size_t i = 0;i < count;i++)
             {
                 float time = nif->getFloat();
                 readValue(nifReference, key);
-                mKeys[time] = key;
+                addKey(time, key);
             }
         }
         else if (mInterpolationType == InterpolationType_Quadratic)
         {
+            reserve(count);
             for(size_t i = 0;i < count;i++)
             {
                 float time = nif->getFloat();
                 readQuadratic(nifReference, key);
-                mKeys[time] = key;
+                addKey(time, key);
             }
         }
         else if (mInterpolationType == InterpolationType_TBC)
         {
+            reserve(count);
             for(size_t i = 0;i < count;i++)
             {
                 float time = nif->getFloat();
                 readTBC(nifReference, key);
-                mKeys[time] = key;
+                addKey(time, key);
             }
         }
         //XYZ keys aren't actually read here.
@@ -126,7 +136,36 @@ struct KeyMapT {
         }
     }
 
+    /// Add a key, replacing a key at the same time. Keys are stored in order, so adding them by increasing time is
+    /// the fast path; keys out of order are inserted at their place.
+    void addKey(float time, const KeyType& key)
+    {
+        if (mTimes.empty() || time > mTimes.back())
+        {
+            mTimes.push_back(time);
+            mKeys.push_back(key);
+            return;
+        }
+
+        const auto it = std::lower_bound(mTimes.begin(), mTimes.end(), time);
+        const std::size_t index = it - mTimes.begin();
+        if (*it == time)
+        {
+            mKeys[index] = key;
+            return;
+        }
+
+        mTimes.insert(it, time);
+        mKeys.insert(mKeys.begin() + index, key);
+    }
+
 private:
+    void reserve(std::size_t count)
+    {
+        mTimes.reserve(count);
+        mKeys.reserve(count);
+    }
+
     static void readValue(NIFStream &nif, KeyT<T> &key)
     {
         key.mValue = (nif.*getValue)();
@@ -4,10 +4,49 @@
 
 namespace Nif
 {
+    NIFStream::NIFStream(NIFFile* file, Files::IStreamPtr inp, bool buffered)
+        : inp(inp)
+        , mBuffered(buffered)
+        , file(file)
+    {
+        if (!mBuffered)
+            return;
+
+        // Streams of files in archives may not be able to tell their size, read them in chunks then
+        std::size_t size = 0;
+        inp->seekg(0, std::ios::end);
+        const std::streamoff end = inp->tellg();
+        inp->seekg(0, std::ios::beg);
+        inp->clear();
+        if (end > 0)
+        {
+            mBuffer.resize(static_cast<std::size_t>(end));
+            inp->read(mBuffer.data(), mBuffer.size());
+            size = static_cast<std::size_t>(inp->gcount());
+        }
+        else
+        {
+            const std::size_t chunkSize = 64 * 1024;
+            do
+            {
+                mBuffer.resize(size + chunkSize);
+                inp->read(mBuffer.data() + size, chunkSize);
+                size += static_cast<std::size_t>(inp->gcount());
+            }
+            while (*inp);
+        }
+        mBuffer.resize(size);
+    }
+
+    void NIFStream::failEndOfFile() const
+    {
+        file->fail("Unexpected end of file");
+    }
+
     osg::Quat NIFStream::getQuaternion()
     {
         float f[4];
-        readLittleEndianBufferOfType<4, float,uint32_t>(inp, (float*)&f);
+        readLittleEndianBuffer<float,uint32_t>(f, 4);
         osg::Quat quat;
         quat.w() = f[0];
         quat.x() = f[1];
@@ -3,7 +3,9 @@
 #ifndef OPENMW_COMPONENTS_NIF_NIFSTREAM_HPP
 #define OPENMW_COMPONENTS_NIF_NIFSTREAM_HPP
 
+#include <algorithm>
 #include <cassert>
+#include <cstring>
 #include <stdint.h>
 #include <stdexcept>
 #include <vector>
@@ -21,50 +23,27 @@ namespace Nif
 
 class NIFFile;
 
-/* 
-    readLittleEndianBufferOfType: This template should only be used with non POD data types
+/*
+    convertLittleEndianBufferOfType: Convert values read as little endian bytes to the native byte order in place.
+    This template should only be used with non POD data types
 */
-template <uint32_t numInstances, typename T, typename IntegerT> inline void readLittleEndianBufferOfType(Files::IStreamPtr &pIStream, T* dest)
+template <typename T, typename IntegerT> inline void convertLittleEndianBufferOfType(T* dest, std::size_t numInstances)
 {
 #if defined(__x86_64__) || defined(_M_X64) || defined(__i386) || defined(_M_IX86)
-    pIStream->read((char*)dest, numInstances * sizeof(T));
+    (void)dest;
+    (void)numInstances;
 #else
     uint8_t* destByteBuffer = (uint8_t*)dest;
-    pIStream->read((char*)dest, numInstances * sizeof(T));
     /*
-        Due to the loop iterations being known at compile time,
-        this nested loop will most likely be unrolled
+        For the single values and vectors, the number of instances is known at compile time once inlined,
+        so this nested loop will most likely be unrolled
         For example, for 2 instances of a 4 byte data type, you should get the below result
     */
     union {
         IntegerT i;
         T t;
     } u;
-    for (uint32_t i = 0; i < numInstances; i++)
-    {
-        u = { 0 };
-        for (uint32_t byte = 0; byte < sizeof(T); byte++)
-            u.i |= (((IntegerT)destByteBuffer[i * sizeof(T) + byte]) << (byte * 8));
-        dest[i] = u.t;
-    }
-#endif
-}
-
-/*
-    readLittleEndianDynamicBufferOfType: This template should only be used with non POD data types
-*/
-template <typename T, typename IntegerT> inline void readLittleEndianDynamicBufferOfType(Files::IStreamPtr &pIStream, T* dest, uint32_t numInstances)
-{
-#if defined(__x86_64__) || defined(_M_X64) || defined(__i386) || defined(_M_IX86)
-    pIStream->read((char*)dest, numInstances * sizeof(T));
-#else
-    uint8_t* destByteBuffer = (uint8_t*)dest;
-    pIStream->read((char*)dest, numInstances * sizeof(T));
-    union {
-        IntegerT i;
-        T t;
-    } u;
-    for (uint32_t i = 0; i < numInstances; i++)
+    for (std::size_t i = 0; i < numInstances; i++)
     {
         u.i = 0;
         for (uint32_t byte = 0; byte < sizeof(T); byte++)
@@ -73,81 +52,129 @@ template <typename T, typename IntegerT> inline void readLittleEndianDynamicBuff
     }
 #endif
 }
-template<typename type, typename IntegerT> type inline readLittleEndianType(Files::IStreamPtr &pIStream)
-{
-    type val;
-    readLittleEndianBufferOfType<1,type,IntegerT>(pIStream, (type*)&val);
-    return val;
-}
 
 class NIFStream
 {
     /// Input stream
     Files::IStreamPtr inp;
 
+    /// The whole file when buffered, values are then copied from it rather than read from the stream one by one
+    std::vector<char> mBuffer;
+    std::size_t mOffset = 0;
+    bool mBuffered;
+
+    /// @return the next bytes of the buffer, which are then skipped
+    const char* take(std::size_t size)
+    {
+        if (mBuffer.size() - mOffset < size)
+            failEndOfFile();
+        const char* data = mBuffer.data() + mOffset;
+        mOffset += size;
+        return data;
+    }
+
+    /// Fails before a vector is resized for a count the rest of the buffer can't hold, e.g. read from a corrupt file
+    void checkAvailable(std::size_t count, std::size_t minElementSize)
+    {
+        if (mBuffered && (mBuffer.size() - mOffset) / minElementSize < count)
+            failEndOfFile();
+    }
+
+    void read(char* dest, std::size_t size)
+    {
+        if (mBuffered)
+            std::memcpy(dest, take(size), size);
+        else
+            inp->read(dest, size);
+    }
+
+    template <typename T, typename IntegerT>
+    void readLittleEndianBuffer(T* dest, std::size_t numInstances)
+    {
+        read(reinterpret_cast<char*>(dest), numInstances * sizeof(T));
+        convertLittleEndianBufferOfType<T, IntegerT>(dest, numInstances);
+    }
+
+    template <typename T, typename IntegerT>
+    T readLittleEndianType()
+    {
+        T val;
+        readLittleEndianBuffer<T, IntegerT>(&val, 1);
+        return val;
+    }
+
+    [[noreturn]] void failEndOfFile() const;
+
 public:
 
     NIFFile * const file;
 
-    NIFStream (NIFFile * file, Files::IStreamPtr inp): inp (inp), file (file) {}
+    /// @param buffered read the whole stream into memory first, instead of reading each value from the stream
+    NIFStream (NIFFile * file, Files::IStreamPtr inp, bool buffered);
 
-    void skip(size_t size) { inp->ignore(size); }
+    void skip(size_t size)
+    {
+        if (mBuffered)
+            take(size);
+        else
+            inp->ignore(size);
+    }
 
     char getChar()
     {
-        return readLittleEndianType<char,char>(inp);
+        return readLittleEndianType<char,char>();
     }
 
     short getShort()
     {
-        return readLittleEndianType<short,short>(inp);
+        return readLittleEndianType<short,short>();
     }
 
     unsigned short getUShort()
     {
-        return readLittleEndianType<unsigned short,unsigned short>(inp);
+        return readLittleEndianType<unsigned short,unsigned short>();
     }
 
     int getInt()
     {
-        return readLittleEndianType<int,int>(inp);
+        return readLittleEndianType<int,int>();
     }
 
     unsigned int getUInt()
     {
-        return readLittleEndianType<unsigned int,unsigned int>(inp);
+        return readLittleEndianType<unsigned int,unsigned int>();
     }
 
     float getFloat()
     {
-        return readLittleEndianType<float,uint32_t>(inp);
+        return readLittleEndianType<float,uint32_t>();
     }
 
     osg::Vec2f getVector2()
     {
         osg::Vec2f vec;
-        readLittleEndianBufferOfType<2,float,uint32_t>(inp, (float*)&vec._v[0]);
+        readLittleEndianBuffer<float,uint32_t>((float*)&vec._v[0], 2);
         return vec;
     }
 
     osg::Vec3f getVector3()
     {
         osg::Vec3f vec;
-        readLittleEndianBufferOfType<3, float,uint32_t>(inp, (float*)&vec._v[0]);
+        readLittleEndianBuffer<float,uint32_t>((float*)&vec._v[0], 3);
         return vec;
     }
 
     osg::Vec4f getVector4()
     {
         osg::Vec4f vec;
-        readLittleEndianBufferOfType<4, float,uint32_t>(inp, (float*)&vec._v[0]);
+        readLittleEndianBuffer<float,uint32_t>((float*)&vec._v[0], 4);
         return vec;
     }
 
     Matrix3 getMatrix3()
     {
         Matrix3 mat;
-        readLittleEndianBufferOfType<9, float,uint32_t>(inp, (float*)&mat.mValues);
+        readLittleEndianBuffer<float,uint32_t>((float*)&mat.mValues, 9);
         return mat;
     }
 
@@ -172,6 +199,12 @@ public:
     ///Read in a string of the given length
     std::string getSizedString(size_t length)
     {
+        if (mBuffered)
+        {
+            const char* data = take(length);
+            return std::string(data, std::find(data, data + length, '\0'));
+        }
+
         std::vector<char> str(length + 1, 0);
 
         inp->read(str.data(), length);
@@ -181,20 +214,28 @@ public:
     ///Read in a string of the length specified in the file
     std::string getSizedString()
     {
-        size_t size = readLittleEndianType<uint32_t,uint32_t>(inp);
+        size_t size = readLittleEndianType<uint32_t,uint32_t>();
         return getSizedString(size);
     }
 
     ///Specific to Bethesda headers, uses a byte for length
     std::string getExportString()
     {
-        size_t size = static_cast<size_t>(readLittleEndianType<uint8_t,uint8_t>(inp));
+        size_t size = static_cast<size_t>(readLittleEndianType<uint8_t,uint8_t>());
         return getSizedString(size);
     }
 
     ///This is special since the version string doesn't start with a number, and ends with "\n"
     std::string getVersionString()
     {
+        if (mBuffered)
+        {
+            const auto begin = mBuffer.cbegin() + mOffset;
+            const auto end = std::find(begin, mBuffer.cend(), '\n');
+            mOffset = std::min<std::size_t>(end - mBuffer.cbegin() + 1, mBuffer.size());
+            return std::string(begin, end);
+        }
+
         std::string result;
         std::getline(*inp, result);
         return result;
@@ -202,51 +243,59 @@ public:
 
     void getUShorts(std::vector<unsigned short> &vec, size_t size)
     {
+        checkAvailable(size, sizeof(unsigned short));
         vec.resize(size);
-        readLittleEndianDynamicBufferOfType<unsigned short,unsigned short>(inp, vec.data(), size);
+        readLittleEndianBuffer<unsigned short,unsigned short>(vec.data(), size);
     }
 
     void getFloats(std::vector<float> &vec, size_t size)
     {
+        checkAvailable(size, sizeof(float));
         vec.resize(size);
-        readLittleEndianDynamicBufferOfType<float,uint32_t>(inp, vec.data(), size);
+        readLittleEndianBuffer<float,uint32_t>(vec.data(), size);
     }
 
     void getInts(std::vector<int> &vec, size_t size)
     {
+        checkAvailable(size, sizeof(int));
         vec.resize(size);
-        readLittleEndianDynamicBufferOfType<int,int>(inp, vec.data(), size);
+        readLittleEndianBuffer<int,int>(vec.data(), size);
     }
 
     void getUInts(std::vector<unsigned int> &vec, size_t size)
     {
+        checkAvailable(size, sizeof(unsigned int));
         vec.resize(size);
-        readLittleEndianDynamicBufferOfType<unsigned int,unsigned int>(inp, vec.data(), size);
+        readLittleEndianBuffer<unsigned int,unsigned int>(vec.data(), size);
     }
 
     void getVector2s(std::vector<osg::Vec2f> &vec, size_t size)
     {
+        checkAvailable(size, 2 * sizeof(float));
         vec.resize(size);
         /* The packed storage of each Vec2f is 2 floats exactly */
-        readLittleEndianDynamicBufferOfType<float,uint32_t>(inp,(float*)vec.data(), size*2);
+        readLittleEndianBuffer<float,uint32_t>((float*)vec.data(), size*2);
     }
 
     void getVector3s(std::vector<osg::Vec3f> &vec, size_t size)
     {
+        checkAvailable(size, 3 * sizeof(float));
         vec.resize(size);
         /* The packed storage of each Vec3f is 3 floats exactly */
-        readLittleEndianDynamicBufferOfType<float,uint32_t>(inp, (float*)vec.data(), size*3);
+        readLittleEndianBuffer<float,uint32_t>((float*)vec.data(), size*3);
     }
 
     void getVector4s(std::vector<osg::Vec4f> &vec, size_t size)
     {
+        checkAvailable(size, 4 * sizeof(float));
         vec.resize(size);
         /* The packed storage of each Vec4f is 4 floats exactly */
-        readLittleEndianDynamicBufferOfType<float,uint32_t>(inp, (float*)vec.data(), size*4);
+        readLittleEndianBuffer<float,uint32_t>((float*)vec.data(), size*4);
     }
 
     void getQuaternions(std::vector<osg::Quat> &quat, size_t size)
     {
+        checkAvailable(size, 4 * sizeof(float));
         quat.resize(size);
         for (size_t i = 0;i < quat.size();i++)
             quat[i] = getQuaternion();
@@ -254,6 +303,8 @@ public:
 
     void getStrings(std::vector<std::string> &vec, size_t size)
     {
+        // Both a string table index and the length of a sized string take 4 bytes
+        checkAvailable(size, sizeof(uint32_t));
         vec.resize(size);
         for (size_t i = 0; i < vec.size(); i++)
             vec[i] = getString();
@@ -261,6 +312,8 @@ public:
     /// We need to use this when the string table isn't actually initialized.
     void getSizedStrings(std::vector<std::string> &vec, size_t size)
     {
+        // The length of each string takes 4 bytes
+        checkAvailable(size, sizeof(uint32_t));
         vec.resize(size);
         for (size_t i = 0; i < vec.size(); i++)
             vec[i] = getSizedString();
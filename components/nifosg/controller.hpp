@@ -38,23 +38,23 @@ namespace NifOsg
     template <typename MapT>
     class ValueInterpolator
     {
-        typename MapT::MapType::const_iterator retrieveKey(float time) const
+        std::size_t retrieveKey(float time) const
         {
-            // retrieve the current position in the map, optimized for the most common case
+            // retrieve the index of the key following the time, optimized for the most common case
             // where time moves linearly along the keyframe track
-            if (mLastHighKey != mKeys->mKeys.end())
+            const std::vector<float>& times = mKeys->mTimes;
+            std::size_t index = mLastHighKey;
+            if (index < times.size() && time > times[index - 1])
             {
-                if (time > mLastHighKey->first)
-                {
-                    // try if we're there by incrementing one
-                    ++mLastLowKey;
-                    ++mLastHighKey;
-                }
-                if (mLastHighKey != mKeys->mKeys.end() && time >= mLastLowKey->first && time <= mLastHighKey->first)
-                    return mLastHighKey;
+                if (time <= times[index])
+                    return index;
+                // try if we're there by incrementing one
+                ++index;
+                if (index < times.size() && time <= times[index])
+                    return index;
             }
 
-            return mKeys->mKeys.lower_bound(time);
+            return std::lower_bound(times.begin(), times.end(), time) - times.begin();
         }
 
     public:
@@ -66,11 +66,6 @@ namespace NifOsg
             : mKeys(keys)
             , mDefaultVal(defaultVal)
         {
-            if (keys)
-            {
-                mLastLowKey = mKeys->mKeys.end();
-                mLastHighKey = mKeys->mKeys.end();
-            }
         }
 
         ValueT interpKey(float time) const
@@ -78,31 +73,28 @@ namespace NifOsg
             if (empty())
                 return mDefaultVal;
 
-            const typename MapT::MapType & keys = mKeys->mKeys;
+            const std::vector<float>& times = mKeys->mTimes;
+            const auto& keys = mKeys->mKeys;
 
-            if(time <= keys.begin()->first)
-                return keys.begin()->second.mValue;
+            if(time <= times.front())
+                return keys.front().mValue;
 
-            typename MapT::MapType::const_iterator it = retrieveKey(time);
+            if(time >= times.back())
+                return keys.back().mValue;
 
-            // now do the actual interpolation
-            if (it != keys.end())
-            {
-                // cache for next time
-                mLastHighKey = it;
-                mLastLowKey = --it;
-
-                float a = (time - mLastLowKey->first) / (mLastHighKey->first - mLastLowKey->first);
+            // cache for next time
+            mLastHighKey = retrieveKey(time);
 
-                return interpolate(mLastLowKey->second, mLastHighKey->second, a, mKeys->mInterpolationType);
-            }
+            // now do the actual interpolation
+            const std::size_t lowKey = mLastHighKey - 1;
+            float a = (time - times[lowKey]) / (times[mLastHighKey] - times[lowKey]);
 
-            return keys.rbegin()->second.mValue;
+            return interpolate(keys[lowKey], keys[mLastHighKey], a, mKeys->mInterpolationType);
         }
 
         bool empty() const
         {
-            return !mKeys || mKeys->mKeys.empty();
+            return !mKeys || mKeys->empty();
         }
 
     private:
@@ -132,8 +124,8 @@ namespace NifOsg
             }
         }
 
-        mutable typename MapT::MapType::const_iterator mLastLowKey;
-        mutable typename MapT::MapType::const_iterator mLastHighKey;
+        // index of the key following the time of the last call, the key before it is the other interpolated key
+        mutable std::size_t mLastHighKey = 1;
 
         std::shared_ptr<const MapT> mKeys;
 
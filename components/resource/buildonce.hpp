@@ -0,0 +1,68 @@
+#ifndef OPENMW_COMPONENTS_RESOURCE_BUILDONCE_H
+#define OPENMW_COMPONENTS_RESOURCE_BUILDONCE_H
+
+#include "objectcache.hpp"
+
+#include <condition_variable>
+#include <mutex>
+#include <set>
+
+namespace Resource
+{
+
+    /// @brief Builds each object of a GenericObjectCache only once when several threads request it at the same time.
+    /// @par A thread requesting an object that another thread is building waits for that build and takes its result
+    /// from the cache instead of building the object again.
+    template <typename KeyType>
+    class BuildOnce
+    {
+    public:
+        /// @return the cached object for key, or the object returned by create after adding it to the cache
+        /// @note Thread safe. create is called without any lock held, an exception thrown by it lets a waiting thread
+        /// build the object instead.
+        template <class Create>
+        osg::ref_ptr<osg::Object> get(GenericObjectCache<KeyType>& cache, const KeyType& key, Create&& create)
+        {
+            {
+                std::unique_lock<std::mutex> lock(mMutex);
+                while (true)
+                {
+                    osg::ref_ptr<osg::Object> object = cache.getRefFromObjectCache(key);
+                    if (object)
+                        return object;
+                    if (mBuilding.insert(key).second)
+                        break;
+                    mBuilt.wait(lock);
+                }
+            }
+
+            const Finish finish {*this, key};
+            osg::ref_ptr<osg::Object> object = create();
+            cache.addEntryToObjectCache(key, object.get());
+            return object;
+        }
+
+    private:
+        struct Finish
+        {
+            BuildOnce& mBuildOnce;
+            const KeyType& mKey;
+
+            ~Finish()
+            {
+                {
+                    std::lock_guard<std::mutex> lock(mBuildOnce.mMutex);
+                    mBuildOnce.mBuilding.erase(mKey);
+                }
+                mBuildOnce.mBuilt.notify_all();
+            }
+        };
+
+        std::mutex mMutex;
+        std::condition_variable mBuilt;
+        std::set<KeyType> mBuilding;
+    };
+
+}
+
+#endif
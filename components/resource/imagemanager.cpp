@@ -94,7 +94,7 @@ namespace Resource
             Files::IStreamPtr stream;
             try
             {
-                stream = mVFS->get(normalized.c_str());
+                stream = mVFS->getNormalized(normalized);
             }
             catch (std::exception& e)
             {
@@ -150,7 +150,7 @@ namespace Resource
                 }
             }
 
-            mCache->addEntryToObjectCache(normalized, image);
+            mCache->addEntryToObjectCache(normalized, image, 0.0, image->getTotalDataSize());
             return image;
         }
     }
@@ -3,6 +3,8 @@
 // - removeExpiredObjectsInCache no longer keeps a lock while the unref happens.
 // - template allows customized KeyType.
 // - objects with uninitialized time stamp are not removed.
+// - the cache is split into shards by key hash, each with its own lock.
+// - optional size accounting with least recently used eviction against a memory budget.
 
 /* -*-c++-*- OpenSceneGraph - Copyright (C) 1998-2006 Robert Osfield
  *
@@ -23,9 +25,17 @@
 #include <osg/Referenced>
 #include <osg/ref_ptr>
 #include <osg/Node>
+#include <osg/Vec2f>
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <functional>
 #include <string>
 #include <map>
+#include <tuple>
+#include <utility>
+#include <vector>
 
 namespace osg
 {
@@ -36,13 +46,57 @@ namespace osg
 
 namespace Resource {
 
+/** Hash of a cache key, used to pick the shard of the key. Add an overload when using a new key type
+  * that has no std::hash specialization. */
+template <class T>
+std::size_t hashObjectCacheKey(const T& value)
+{
+    return std::hash<T>()(value);
+}
+
+inline std::size_t combineObjectCacheKeyHash(std::size_t seed, std::size_t value)
+{
+    return seed ^ (value + 0x9e3779b9 + (seed << 6) + (seed >> 2));
+}
+
+inline std::size_t hashObjectCacheKey(const osg::Vec2f& value)
+{
+    return combineObjectCacheKeyHash(hashObjectCacheKey(value.x()), hashObjectCacheKey(value.y()));
+}
+
+template <class ... T>
+std::size_t hashObjectCacheKey(const std::tuple<T ...>& value);
+
+template <class First, class Second>
+std::size_t hashObjectCacheKey(const std::pair<First, Second>& value)
+{
+    return combineObjectCacheKeyHash(hashObjectCacheKey(value.first), hashObjectCacheKey(value.second));
+}
+
+template <class Tuple, std::size_t ... I>
+std::size_t hashObjectCacheKeyTuple(const Tuple& value, std::index_sequence<I ...>)
+{
+    std::size_t result = 0;
+    using Expand = int[];
+    (void) Expand {0, (result = combineObjectCacheKeyHash(result, hashObjectCacheKey(std::get<I>(value))), 0) ...};
+    return result;
+}
+
+template <class ... T>
+std::size_t hashObjectCacheKey(const std::tuple<T ...>& value)
+{
+    return hashObjectCacheKeyTuple(value, std::index_sequence_for<T ...>());
+}
+
 template <typename KeyType>
 class GenericObjectCache : public osg::Referenced
 {
     public:
 
         GenericObjectCache()
-            : osg::Referenced(true) {}
+            : osg::Referenced(true)
+            , _size(0)
+            , _maxSize(0) {}
 
         /** For each object in the cache which has an reference count greater than 1
           * (and therefore referenced by elsewhere in the application) set the time stamp
@@ -52,39 +106,49 @@ class GenericObjectCache : public osg::Referenced
           * The time used should be taken from the FrameStamp::getReferenceTime().*/
         void updateTimeStampOfObjectsInCacheWithExternalReferences(double referenceTime)
         {
-            // look for objects with external references and update their time stamp.
-            OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_objectCacheMutex);
-            for(typename ObjectCacheMap::iterator itr=_objectCache.begin(); itr!=_objectCache.end(); ++itr)
+            for (Shard& shard : _shards)
             {
-                // If ref count is greater than 1, the object has an external reference.
-                // If the timestamp is yet to be initialized, it needs to be updated too.
-                if (itr->second.first->referenceCount()>1 || itr->second.second == 0.0)
-                    itr->second.second = referenceTime;
+                // look for objects with external references and update their time stamp.
+                OpenThreads::ScopedLock<OpenThreads::Mutex> lock(shard._objectCacheMutex);
+                for(typename ObjectCacheMap::iterator itr=shard._objectCache.begin(); itr!=shard._objectCache.end(); ++itr)
+                {
+                    // If ref count is greater than 1, the object has an external reference.
+                    // If the timestamp is yet to be initialized, it needs to be updated too.
+                    if (itr->second._object->referenceCount()>1 || itr->second._timeStamp == 0.0)
+                        itr->second._timeStamp = referenceTime;
+                }
             }
         }
 
         /** Removed object in the cache which have a time stamp at or before the specified expiry time.
           * This would typically be called once per frame by applications which are doing database paging,
           * and need to prune objects that are no longer required, and called after the a called
-          * after the call to updateTimeStampOfObjectsInCacheWithExternalReferences(expirtyTime).*/
+          * after the call to updateTimeStampOfObjectsInCacheWithExternalReferences(expirtyTime).
+          * When a memory budget is set, objects with a known size are not expired but kept until the budget
+          * is exceeded, then the least recently used ones without external references are removed.*/
         void removeExpiredObjectsInCache(double expiryTime)
         {
             std::vector<osg::ref_ptr<osg::Object> > objectsToRemove;
+            const std::size_t maxSize = _maxSize;
+            for (Shard& shard : _shards)
             {
-                OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_objectCacheMutex);
+                OpenThreads::ScopedLock<OpenThreads::Mutex> lock(shard._objectCacheMutex);
                 // Remove expired entries from object cache
-                typename ObjectCacheMap::iterator oitr = _objectCache.begin();
-                while(oitr != _objectCache.end())
+                typename ObjectCacheMap::iterator oitr = shard._objectCache.begin();
+                while(oitr != shard._objectCache.end())
                 {
-                    if (oitr->second.second<=expiryTime)
+                    if (oitr->second._timeStamp<=expiryTime && (maxSize == 0 || oitr->second._size == 0))
                     {
-                        objectsToRemove.push_back(oitr->second.first);
-                        _objectCache.erase(oitr++);
+                        objectsToRemove.push_back(oitr->second._object);
+                        _size -= oitr->second._size;
+                        shard._objectCache.erase(oitr++);
                     }
                     else
                         ++oitr;
                 }
             }
+            if (maxSize != 0 && _size > maxSize)
+                removeLeastRecentlyUsedObjectsInCache(maxSize, objectsToRemove);
             // note, actual unref happens outside of the lock
             objectsToRemove.clear();
         }
@@ -92,43 +156,60 @@ class GenericObjectCache : public osg::Referenced
         /** Remove all objects in the cache regardless of having external references or expiry times.*/
         void clear()
         {
-            OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_objectCacheMutex);
-            _objectCache.clear();
+            for (Shard& shard : _shards)
+            {
+                OpenThreads::ScopedLock<OpenThreads::Mutex> lock(shard._objectCacheMutex);
+                for (typename ObjectCacheMap::const_iterator itr = shard._objectCache.begin(); itr != shard._objectCache.end(); ++itr)
+                    _size -= itr->second._size;
+                shard._objectCache.clear();
+            }
         }
 
-        /** Add a key,object,timestamp triple to the Registry::ObjectCache.*/
-        void addEntryToObjectCache(const KeyType& key, osg::Object* object, double timestamp = 0.0)
+        /** Add a key,object,timestamp triple to the Registry::ObjectCache.
+          * The size is the number of bytes the object accounts for in the memory budget, 0 if unknown.*/
+        void addEntryToObjectCache(const KeyType& key, osg::Object* object, double timestamp = 0.0, std::size_t size = 0)
         {
-            OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_objectCacheMutex);
-            _objectCache[key]=ObjectTimeStampPair(object,timestamp);
+            Shard& shard = getShard(key);
+            OpenThreads::ScopedLock<OpenThreads::Mutex> lock(shard._objectCacheMutex);
+            ObjectCacheItem& item = shard._objectCache[key];
+            _size -= item._size;
+            _size += size;
+            item = ObjectCacheItem {object, timestamp, size};
         }
 
         /** Remove Object from cache.*/
         void removeFromObjectCache(const KeyType& key)
         {
-            OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_objectCacheMutex);
-            typename ObjectCacheMap::iterator itr = _objectCache.find(key);
-            if (itr!=_objectCache.end()) _objectCache.erase(itr);
+            Shard& shard = getShard(key);
+            OpenThreads::ScopedLock<OpenThreads::Mutex> lock(shard._objectCacheMutex);
+            typename ObjectCacheMap::iterator itr = shard._objectCache.find(key);
+            if (itr!=shard._objectCache.end())
+            {
+                _size -= itr->second._size;
+                shard._objectCache.erase(itr);
+            }
         }
 
         /** Get an ref_ptr<Object> from the object cache*/
         osg::ref_ptr<osg::Object> getRefFromObjectCache(const KeyType& key)
         {
-            OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_objectCacheMutex);
-            typename ObjectCacheMap::iterator itr = _objectCache.find(key);
-            if (itr!=_objectCache.end())
-                return itr->second.first;
+            Shard& shard = getShard(key);
+            OpenThreads::ScopedLock<OpenThreads::Mutex> lock(shard._objectCacheMutex);
+            typename ObjectCacheMap::iterator itr = shard._objectCache.find(key);
+            if (itr!=shard._objectCache.end())
+                return itr->second._object;
             else return 0;
         }
 
         /** Check if an object is in the cache, and if it is, update its usage time stamp. */
         bool checkInObjectCache(const KeyType& key, double timeStamp)
         {
-            OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_objectCacheMutex);
-            typename ObjectCacheMap::iterator itr = _objectCache.find(key);
-            if (itr!=_objectCache.end())
+            Shard& shard = getShard(key);
+            OpenThreads::ScopedLock<OpenThreads::Mutex> lock(shard._objectCacheMutex);
+            typename ObjectCacheMap::iterator itr = shard._objectCache.find(key);
+            if (itr!=shard._objectCache.end())
             {
-                itr->second.second = timeStamp;
+                itr->second._timeStamp = timeStamp;
                 return true;
             }
             else return false;
@@ -137,26 +218,32 @@ class GenericObjectCache : public osg::Referenced
         /** call releaseGLObjects on all objects attached to the object cache.*/
         void releaseGLObjects(osg::State* state)
         {
-            OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_objectCacheMutex);
-            for(typename ObjectCacheMap::iterator itr = _objectCache.begin(); itr != _objectCache.end(); ++itr)
+            for (Shard& shard : _shards)
             {
-                osg::Object* object = itr->second.first.get();
-                object->releaseGLObjects(state);
+                OpenThreads::ScopedLock<OpenThreads::Mutex> lock(shard._objectCacheMutex);
+                for(typename ObjectCacheMap::iterator itr = shard._objectCache.begin(); itr != shard._objectCache.end(); ++itr)
+                {
+                    osg::Object* object = itr->second._object.get();
+                    object->releaseGLObjects(state);
+                }
             }
         }
 
         /** call node->accept(nv); for all nodes in the objectCache. */
         void accept(osg::NodeVisitor& nv)
         {
-            OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_objectCacheMutex);
-            for(typename ObjectCacheMap::iterator itr = _objectCache.begin(); itr != _objectCache.end(); ++itr)
+            for (Shard& shard : _shards)
             {
-                osg::Object* object = itr->second.first.get();
-                if (object)
+                OpenThreads::ScopedLock<OpenThreads::Mutex> lock(shard._objectCacheMutex);
+                for(typename ObjectCacheMap::iterator itr = shard._objectCache.begin(); itr != shard._objectCache.end(); ++itr)
                 {
-                    osg::Node* node = dynamic_cast<osg::Node*>(object);
-                    if (node)
-                        node->accept(nv);
+                    osg::Object* object = itr->second._object.get();
+                    if (object)
+                    {
+                        osg::Node* node = dynamic_cast<osg::Node*>(object);
+                        if (node)
+                            node->accept(nv);
+                    }
                 }
             }
         }
@@ -165,27 +252,106 @@ class GenericObjectCache : public osg::Referenced
         template <class Functor>
         void call(Functor& f)
         {
-            OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_objectCacheMutex);
-            for (typename ObjectCacheMap::iterator it = _objectCache.begin(); it != _objectCache.end(); ++it)
-                f(it->second.first.get());
+            for (Shard& shard : _shards)
+            {
+                OpenThreads::ScopedLock<OpenThreads::Mutex> lock(shard._objectCacheMutex);
+                for (typename ObjectCacheMap::iterator it = shard._objectCache.begin(); it != shard._objectCache.end(); ++it)
+                    f(it->second._object.get());
+            }
         }
 
         /** Get the number of objects in the cache. */
         unsigned int getCacheSize() const
         {
-            OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_objectCacheMutex);
-            return _objectCache.size();
+            unsigned int result = 0;
+            for (const Shard& shard : _shards)
+            {
+                OpenThreads::ScopedLock<OpenThreads::Mutex> lock(shard._objectCacheMutex);
+                result += shard._objectCache.size();
+            }
+            return result;
+        }
+
+        /** Get the number of bytes accounted for by the objects in the cache. */
+        std::size_t getCacheMemorySize() const
+        {
+            return _size;
+        }
+
+        /** Set the memory budget in bytes, 0 to only use the expiry time. */
+        void setMaxCacheMemorySize(std::size_t maxSize)
+        {
+            _maxSize = maxSize;
         }
 
     protected:
 
         virtual ~GenericObjectCache() {}
 
-        typedef std::pair<osg::ref_ptr<osg::Object>, double >           ObjectTimeStampPair;
-        typedef std::map<KeyType, ObjectTimeStampPair >             ObjectCacheMap;
+        struct ObjectCacheItem
+        {
+            osg::ref_ptr<osg::Object> _object;
+            double _timeStamp;
+            std::size_t _size;
+        };
+
+        typedef std::map<KeyType, ObjectCacheItem >             ObjectCacheMap;
+
+        struct Shard
+        {
+            ObjectCacheMap                      _objectCache;
+            mutable OpenThreads::Mutex          _objectCacheMutex;
+        };
+
+        // Power of two, well above the number of threads that typically load resources concurrently
+        static const std::size_t NumShards = 16;
+
+        Shard& getShard(const KeyType& key)
+        {
+            return _shards[hashObjectCacheKey(key) % NumShards];
+        }
+
+        /** Remove objects without external references, oldest time stamp first, until the accounted size fits
+          * into the budget. Removed objects are added to objectsToRemove so they can be unreferenced outside of the lock.*/
+        void removeLeastRecentlyUsedObjectsInCache(std::size_t maxSize, std::vector<osg::ref_ptr<osg::Object> >& objectsToRemove)
+        {
+            struct Candidate
+            {
+                double _timeStamp;
+                Shard* _shard;
+                KeyType _key;
+            };
+
+            std::vector<Candidate> candidates;
+            for (Shard& shard : _shards)
+            {
+                OpenThreads::ScopedLock<OpenThreads::Mutex> lock(shard._objectCacheMutex);
+                for (typename ObjectCacheMap::const_iterator itr = shard._objectCache.begin(); itr != shard._objectCache.end(); ++itr)
+                    if (itr->second._size != 0 && itr->second._object->referenceCount() == 1)
+                        candidates.push_back(Candidate {itr->second._timeStamp, &shard, itr->first});
+            }
+
+            std::sort(candidates.begin(), candidates.end(),
+                      [] (const Candidate& lhs, const Candidate& rhs) { return lhs._timeStamp < rhs._timeStamp; });
+
+            for (const Candidate& candidate : candidates)
+            {
+                if (_size <= maxSize)
+                    break;
+                OpenThreads::ScopedLock<OpenThreads::Mutex> lock(candidate._shard->_objectCacheMutex);
+                typename ObjectCacheMap::iterator itr = candidate._shard->_objectCache.find(candidate._key);
+                // The object may have been replaced or referenced again since it was collected
+                if (itr == candidate._shard->_objectCache.end() || itr->second._object->referenceCount() != 1)
+                    continue;
+                objectsToRemove.push_back(itr->second._object);
+                _size -= itr->second._size;
+                candidate._shard->_objectCache.erase(itr);
+            }
+        }
 
-        ObjectCacheMap                          _objectCache;
-        mutable OpenThreads::Mutex              _objectCacheMutex;
+        std::array<Shard, NumShards>            _shards;
+        std::atomic<std::size_t>                _size;
+        std::atomic<std::size_t>                _maxSize;
 
 };
 
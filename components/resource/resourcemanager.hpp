@@ -26,6 +26,7 @@ namespace Resource
         virtual void updateCache(double referenceTime) {}
         virtual void clearCache() {}
         virtual void setExpiryDelay(double expiryDelay) {}
+        virtual void setMaxCacheMemorySize(std::size_t maxSize) {}
         virtual void reportStats(unsigned int frameNumber, osg::Stats* stats) const {}
         virtual void releaseGLObjects(osg::State* state) {}
     };
@@ -60,6 +61,9 @@ namespace Resource
         /// How long to keep objects in cache after no longer being referenced.
         void setExpiryDelay (double expiryDelay) { mExpiryDelay = expiryDelay; }
 
+        /// Memory budget in bytes for cached objects with a known size, 0 to only use the expiry delay.
+        void setMaxCacheMemorySize (std::size_t maxSize) { mCache->setMaxCacheMemorySize(maxSize); }
+
         const VFS::Manager* getVFS() const { return mVFS; }
 
         virtual void reportStats(unsigned int frameNumber, osg::Stats* stats) const {}
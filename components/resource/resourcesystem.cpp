@@ -62,6 +62,12 @@ namespace Resource
         mNifFileManager->setExpiryDelay(0.0);
     }
 
+    void ResourceSystem::setMaxCacheMemorySize(std::size_t maxSize)
+    {
+        for (std::vector<BaseResourceManager*>::iterator it = mResourceManagers.begin(); it != mResourceManagers.end(); ++it)
+            (*it)->setMaxCacheMemorySize(maxSize);
+    }
+
     void ResourceSystem::updateCache(double referenceTime)
     {
         for (std::vector<BaseResourceManager*>::iterator it = mResourceManagers.begin(); it != mResourceManagers.end(); ++it)
@@ -1,6 +1,7 @@
 #ifndef OPENMW_COMPONENTS_RESOURCE_RESOURCESYSTEM_H
 #define OPENMW_COMPONENTS_RESOURCE_RESOURCESYSTEM_H
 
+#include <cstddef>
 #include <memory>
 #include <vector>
 
@@ -56,6 +57,11 @@ namespace Resource
         /// How long to keep objects in cache after no longer being referenced.
         void setExpiryDelay(double expiryDelay);
 
+        /// Memory budget in bytes of each resource manager cache. Cached objects with a known size are then kept
+        /// until the budget is exceeded rather than for the expiry delay, least recently used ones are removed first.
+        /// 0 disables the budget.
+        void setMaxCacheMemorySize(std::size_t maxSize);
+
         /// @note May be called from any thread.
         const VFS::Manager* getVFS() const;
 
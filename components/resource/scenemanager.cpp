@@ -1,7 +1,9 @@
 #include "scenemanager.hpp"
 
 #include <cstdlib>
+#include <sstream>
 
+#include <osg/Geometry>
 #include <osg/Node>
 #include <osg/UserDataContainer>
 
@@ -33,6 +35,7 @@
 #include "niffilemanager.hpp"
 #include "objectcache.hpp"
 #include "multiobjectcache.hpp"
+#include "templatediskcache.hpp"
 
 namespace
 {
@@ -106,6 +109,33 @@ namespace
     private:
         unsigned int mMask;
     };
+
+    /// Estimates the memory used by the vertex and index data of a scene graph, for the object cache budget.
+    /// Images are accounted for by the ImageManager.
+    class GetDataSizeVisitor : public osg::NodeVisitor
+    {
+    public:
+        GetDataSizeVisitor()
+            : osg::NodeVisitor(TRAVERSE_ALL_CHILDREN)
+            , mSize(0)
+        {
+        }
+
+        void apply(osg::Geometry& geom)
+        {
+            osg::Geometry::ArrayList arrays;
+            geom.getArrayList(arrays);
+            for (const auto& array : arrays)
+                mSize += array->getTotalDataSize();
+
+            osg::Geometry::DrawElementsList elements;
+            geom.getDrawElementsList(elements);
+            for (const auto& element : elements)
+                mSize += element->getTotalDataSize();
+        }
+
+        std::size_t mSize;
+    };
 }
 
 namespace Resource
@@ -299,6 +329,11 @@ namespace Resource
         mShaderManager->setShaderPath(path);
     }
 
+    void SceneManager::setDiskCache(std::shared_ptr<TemplateDiskCache> diskCache)
+    {
+        mDiskCache = std::move(diskCache);
+    }
+
     bool SceneManager::checkLoaded(const std::string &name, double timeStamp)
     {
         std::string normalized = name;
@@ -477,68 +512,110 @@ namespace Resource
         else
         {
             osg::ref_ptr<osg::Node> loaded;
-            try
+            std::string diskCacheVersion;
+            if (mDiskCache && getFileExtension(normalized) == "nif")
             {
-                Files::IStreamPtr file = mVFS->get(normalized);
-
-                loaded = load(file, normalized, mImageManager, mNifFileManager);
-            }
-            catch (std::exception& e)
-            {
-                static const char * const sMeshTypes[] = { "nif", "osg", "osgt", "osgb", "osgx", "osg2" };
-
-                for (unsigned int i=0; i<sizeof(sMeshTypes)/sizeof(sMeshTypes[0]); ++i)
+                // Files without a stamp can not be told apart from an edited version of themselves
+                const std::uint64_t stamp = mVFS->getStamp(normalized);
+                if (stamp != 0)
                 {
-                    normalized = "meshes/marker_error." + std::string(sMeshTypes[i]);
-                    if (mVFS->exists(normalized))
-                    {
-                        Log(Debug::Error) << "Failed to load '" << name << "': " << e.what() << ", using marker_error." << sMeshTypes[i] << " instead";
-                        Files::IStreamPtr file = mVFS->get(normalized);
-                        loaded = load(file, normalized, mImageManager, mNifFileManager);
-                        break;
-                    }
+                    diskCacheVersion = getDiskCacheVersion(stamp);
+                    osg::ref_ptr<osgDB::Options> options (new osgDB::Options);
+                    options->setReadFileCallback(new ImageReadCallback(mImageManager));
+                    loaded = mDiskCache->get(normalized, diskCacheVersion, options);
                 }
-
-                if (!loaded)
-                    throw;
             }
 
-            // set filtering settings
-            SetFilterSettingsVisitor setFilterSettingsVisitor(mMinFilter, mMagFilter, mMaxAnisotropy);
-            loaded->accept(setFilterSettingsVisitor);
-            SetFilterSettingsControllerVisitor setFilterSettingsControllerVisitor(mMinFilter, mMagFilter, mMaxAnisotropy);
-            loaded->accept(setFilterSettingsControllerVisitor);
-
-            osg::ref_ptr<Shader::ShaderVisitor> shaderVisitor (createShaderVisitor());
-            loaded->accept(*shaderVisitor);
-
-            // share state
-            // do this before optimizing so the optimizer will be able to combine nodes more aggressively
-            // note, because StateSets will be shared at this point, StateSets can not be modified inside the optimizer
-            mSharedStateMutex.lock();
-            mSharedStateManager->share(loaded.get());
-            mSharedStateMutex.unlock();
-
-            if (canOptimize(normalized))
+            if (loaded)
             {
-                SceneUtil::Optimizer optimizer;
-                optimizer.setIsOperationPermissibleForObjectCallback(new CanOptimizeCallback);
+                // The stored template is already optimized, but its state sets still need their programs
+                osg::ref_ptr<Shader::ShaderVisitor> shaderVisitor (createShaderVisitor());
+                loaded->accept(*shaderVisitor);
 
-                static const unsigned int options = getOptimizationOptions();
-
-                optimizer.optimize(loaded, options);
+                mSharedStateMutex.lock();
+                mSharedStateManager->share(loaded.get());
+                mSharedStateMutex.unlock();
             }
+            else
+                loaded = loadTemplate(normalized, name, diskCacheVersion);
 
             if (mIncrementalCompileOperation)
                 mIncrementalCompileOperation->add(loaded);
             else
                 loaded->getBound();
 
-            mCache->addEntryToObjectCache(normalized, loaded);
+            GetDataSizeVisitor getDataSizeVisitor;
+            loaded->accept(getDataSizeVisitor);
+
+            mCache->addEntryToObjectCache(normalized, loaded, 0.0, getDataSizeVisitor.mSize);
             return loaded;
         }
     }
 
+    osg::ref_ptr<osg::Node> SceneManager::loadTemplate(std::string& normalized, const std::string& name,
+                                                       const std::string& diskCacheVersion)
+    {
+        osg::ref_ptr<osg::Node> loaded;
+        bool usedErrorMarker = false;
+        try
+        {
+            Files::IStreamPtr file = mVFS->getNormalized(normalized);
+
+            loaded = load(file, normalized, mImageManager, mNifFileManager);
+        }
+        catch (std::exception& e)
+        {
+            usedErrorMarker = true;
+            static const char * const sMeshTypes[] = { "nif", "osg", "osgt", "osgb", "osgx", "osg2" };
+
+            for (unsigned int i=0; i<sizeof(sMeshTypes)/sizeof(sMeshTypes[0]); ++i)
+            {
+                normalized = "meshes/marker_error." + std::string(sMeshTypes[i]);
+                if (mVFS->existsNormalized(normalized))
+                {
+                    Log(Debug::Error) << "Failed to load '" << name << "': " << e.what() << ", using marker_error." << sMeshTypes[i] << " instead";
+                    Files::IStreamPtr file = mVFS->getNormalized(normalized);
+                    loaded = load(file, normalized, mImageManager, mNifFileManager);
+                    break;
+                }
+            }
+
+            if (!loaded)
+                throw;
+        }
+
+        // set filtering settings
+        SetFilterSettingsVisitor setFilterSettingsVisitor(mMinFilter, mMagFilter, mMaxAnisotropy);
+        loaded->accept(setFilterSettingsVisitor);
+        SetFilterSettingsControllerVisitor setFilterSettingsControllerVisitor(mMinFilter, mMagFilter, mMaxAnisotropy);
+        loaded->accept(setFilterSettingsControllerVisitor);
+
+        osg::ref_ptr<Shader::ShaderVisitor> shaderVisitor (createShaderVisitor());
+        loaded->accept(*shaderVisitor);
+
+        // share state
+        // do this before optimizing so the optimizer will be able to combine nodes more aggressively
+        // note, because StateSets will be shared at this point, StateSets can not be modified inside the optimizer
+        mSharedStateMutex.lock();
+        mSharedStateManager->share(loaded.get());
+        mSharedStateMutex.unlock();
+
+        if (canOptimize(normalized))
+        {
+            SceneUtil::Optimizer optimizer;
+            optimizer.setIsOperationPermissibleForObjectCallback(new CanOptimizeCallback);
+
+            static const unsigned int options = getOptimizationOptions();
+
+            optimizer.optimize(loaded, options);
+        }
+
+        if (!diskCacheVersion.empty() && !usedErrorMarker)
+            mDiskCache->set(normalized, diskCacheVersion, *loaded);
+
+        return loaded;
+    }
+
     osg::ref_ptr<osg::Node> SceneManager::cacheInstance(const std::string &name)
     {
         std::string normalized = name;
@@ -740,6 +817,20 @@ namespace Resource
 
         stats->setAttribute(frameNumber, "Node", mCache->getCacheSize());
         stats->setAttribute(frameNumber, "Node Instance", mInstanceCache->getCacheSize());
+
+        if (mDiskCache)
+            mDiskCache->reportStats(frameNumber, stats);
+    }
+
+    std::string SceneManager::getDiskCacheVersion(std::uint64_t stamp) const
+    {
+        // Texture paths are resolved against the VFS index when the template is built and stored with it
+        std::ostringstream stream;
+        stream << stamp << ' ' << mVFS->getIndexStamp() << ' ' << mForceShaders << ' ' << mAutoUseNormalMaps
+               << ' ' << mNormalMapPattern << ' ' << mNormalHeightMapPattern << ' ' << mAutoUseSpecularMaps << ' ' << mSpecularMapPattern
+               << ' ' << mMinFilter << ' ' << mMagFilter << ' ' << mMaxAnisotropy << ' ' << mUnRefImageDataAfterApply
+               << ' ' << getOptimizationOptions();
+        return stream.str();
     }
 
     Shader::ShaderVisitor *SceneManager::createShaderVisitor()
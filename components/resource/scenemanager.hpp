@@ -1,6 +1,7 @@
 #ifndef OPENMW_COMPONENTS_RESOURCE_SCENEMANAGER_H
 #define OPENMW_COMPONENTS_RESOURCE_SCENEMANAGER_H
 
+#include <cstdint>
 #include <string>
 #include <map>
 #include <memory>
@@ -16,6 +17,7 @@ namespace Resource
     class ImageManager;
     class NifFileManager;
     class SharedStateManager;
+    class TemplateDiskCache;
 }
 
 namespace osgUtil
@@ -74,6 +76,11 @@ namespace Resource
 
         void setShaderPath(const std::string& path);
 
+        /// Read the templates of NIF files from the disk cache when their file and the settings above are unchanged,
+        /// and store newly loaded ones there.
+        /// @note Not thread safe, set before loading models.
+        void setDiskCache(std::shared_ptr<TemplateDiskCache> diskCache);
+
         /// Check if a given scene is loaded and if so, update its usage timestamp to prevent it from being unloaded
         bool checkLoaded(const std::string& name, double referenceTime);
 
@@ -147,6 +154,15 @@ namespace Resource
 
         Shader::ShaderVisitor* createShaderVisitor();
 
+        /// Load, optimize and store a template in the disk cache, if a disk cache version is given.
+        /// @param normalized the name of the error marker on return, if it is used instead
+        osg::ref_ptr<osg::Node> loadTemplate(std::string& normalized, const std::string& name,
+                                             const std::string& diskCacheVersion);
+
+        /// @return description of the settings and data files a template is built with from a source file of the given
+        /// stamp
+        std::string getDiskCacheVersion(std::uint64_t stamp) const;
+
         std::unique_ptr<Shader::ShaderManager> mShaderManager;
         bool mForceShaders;
         bool mClampLighting;
@@ -173,6 +189,8 @@ namespace Resource
 
         unsigned int mParticleSystemMask;
 
+        std::shared_ptr<TemplateDiskCache> mDiskCache;
+
         SceneManager(const SceneManager&);
         void operator = (const SceneManager&);
     };
@@ -274,11 +274,20 @@ void StatsHandler::setUpScene(osgViewer::ViewerBase *viewer)
             "Compiling",
             "WorkQueue",
             "WorkThread",
+            "Work Immediate",
+            "Work Predicted",
+            "Work Background",
+            "Wait Immediate",
+            "Wait Predicted",
+            "Wait Background",
             "",
             "Texture",
             "StateSet",
             "Node",
             "Node Instance",
+            "Node DiskCacheSize",
+            "Node DiskCacheHits",
+            "Node DiskCacheMisses",
             "Shape",
             "Shape Instance",
             "Image",
@@ -287,15 +296,29 @@ void StatsHandler::setUpScene(osgViewer::ViewerBase *viewer)
             "",
             "Terrain Chunk",
             "Terrain Texture",
+            "Terrain DiskCacheSize",
+            "Terrain DiskCacheHits",
+            "Terrain DiskCacheMisses",
             "Land",
             "Composite",
+            "Object Chunk",
             "",
             "UnrefQueue",
             "",
             "NavMesh UpdateJobs",
+            "NavMesh CoalescedJobs",
+            "NavMesh EvictedJobs",
+            "NavMesh JobLatency<10ms",
+            "NavMesh JobLatency<100ms",
+            "NavMesh JobLatency<1s",
+            "NavMesh JobLatency<10s",
+            "NavMesh JobLatency>=10s",
             "NavMesh CacheSize",
             "NavMesh UsedTiles",
             "NavMesh CachedTiles",
+            "NavMesh DiskCacheSize",
+            "NavMesh DiskCacheHits",
+            "NavMesh DiskCacheMisses",
         });
 
         static const auto longest = std::max_element(statNames.begin(), statNames.end(),
@@ -0,0 +1,260 @@
+#include "templatediskcache.hpp"
+
+#include <components/debug/debuglog.hpp>
+#include <components/misc/stablehash.hpp>
+#include <components/nifosg/userdata.hpp>
+#include <components/sceneutil/serialize.hpp>
+
+#include <osg/Drawable>
+#include <osg/Texture>
+#include <osg/UserDataContainer>
+#include <osg/Version>
+
+#include <osgDB/Registry>
+
+#include <cstring>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+
+namespace
+{
+    const char sMagic[] = {'O', 'M', 'W', 'M', 'O', 'D', 'E', 'L'};
+
+    // Increment when the file layout or the way templates are built changes
+    const std::uint32_t sFormatVersion = 1;
+
+    const char sExtension[] = ".template";
+
+    std::uint64_t makeNameHash(const std::string& normalizedName)
+    {
+        Misc::StableHash hash;
+        hash.add(normalizedName);
+        return hash.getValue();
+    }
+
+    /// Entries are overwritten when the name hashes collide, so the name is checked along with the version
+    std::uint64_t makeCheckHash(const std::string& normalizedName, const std::string& version)
+    {
+        Misc::StableHash hash(Misc::StableHash::sAlternativeOffsetBasis);
+        hash.add(version);
+        hash.add(normalizedName);
+        hash.add(std::string(osgGetVersion()));
+        return hash.getValue();
+    }
+
+    bool isStorableObject(const osg::Object& object)
+    {
+        if (std::strcmp(object.libraryName(), "osg") != 0)
+            return false;
+
+        const osg::UserDataContainer* container = object.getUserDataContainer();
+        if (!container)
+            return true;
+        if (std::strcmp(container->libraryName(), "osg") != 0 || container->getUserData())
+            return false;
+        for (unsigned int i = 0; i < container->getNumUserObjects(); ++i)
+        {
+            const osg::Object* userObject = container->getUserObject(i);
+            if (userObject && std::strcmp(userObject->libraryName(), "osg") != 0
+                    && !dynamic_cast<const NifOsg::NodeUserData*>(userObject))
+                return false;
+        }
+        return true;
+    }
+
+    bool isStorable(const osg::StateAttribute& attribute)
+    {
+        if (!isStorableObject(attribute) || attribute.getUpdateCallback() || attribute.getEventCallback())
+            return false;
+
+        // Images are written as references to their files, only those read by the ImageManager have a name
+        if (const osg::Texture* texture = attribute.asTexture())
+        {
+            for (unsigned int i = 0; i < texture->getNumImages(); ++i)
+            {
+                const osg::Image* image = texture->getImage(i);
+                if (image && image->getFileName().empty())
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    bool isStorable(const osg::StateSet* stateSet)
+    {
+        if (!stateSet)
+            return true;
+        if (!isStorableObject(*stateSet) || stateSet->getUpdateCallback() || stateSet->getEventCallback())
+            return false;
+
+        for (const auto& attribute : stateSet->getAttributeList())
+            if (!isStorable(*attribute.second.first))
+                return false;
+        for (const auto& unit : stateSet->getTextureAttributeList())
+            for (const auto& attribute : unit)
+                if (!isStorable(*attribute.second.first))
+                    return false;
+        for (const auto& uniform : stateSet->getUniformList())
+        {
+            const osg::Uniform& value = *uniform.second.first;
+            if (!isStorableObject(value) || value.getUpdateCallback() || value.getEventCallback())
+                return false;
+        }
+        return true;
+    }
+
+    class StorableVisitor : public osg::NodeVisitor
+    {
+    public:
+        bool mStorable;
+
+        StorableVisitor()
+            : osg::NodeVisitor(TRAVERSE_ALL_CHILDREN)
+            , mStorable(true)
+        {
+        }
+
+        void apply(osg::Node& node) override
+        {
+            if (!isStorableNode(node))
+            {
+                mStorable = false;
+                return;
+            }
+            traverse(node);
+        }
+
+        void apply(osg::Drawable& drawable) override
+        {
+            if (!isStorableNode(drawable) || drawable.getDrawCallback() || drawable.getComputeBoundingBoxCallback())
+                mStorable = false;
+        }
+
+    private:
+        static bool isStorableNode(const osg::Node& node)
+        {
+            return isStorableObject(node) && !node.getUpdateCallback() && !node.getEventCallback()
+                && !node.getCullCallback() && !node.getComputeBoundingSphereCallback()
+                && isStorable(node.getStateSet());
+        }
+    };
+
+    /// Copies the nodes and state sets of a template, leaving out the programs the shader visitor will create again.
+    /// State sets shared in the template stay shared in the copy.
+    class WithoutProgramsCopyOp : public osg::CopyOp
+    {
+    public:
+        WithoutProgramsCopyOp()
+            : osg::CopyOp(DEEP_COPY_NODES | DEEP_COPY_DRAWABLES | DEEP_COPY_STATESETS)
+        {
+        }
+
+        osg::StateSet* operator()(const osg::StateSet* stateSet) const override
+        {
+            if (!stateSet)
+                return nullptr;
+
+            auto copy = mCopies.find(stateSet);
+            if (copy == mCopies.end())
+            {
+                osg::ref_ptr<osg::StateSet> newStateSet (new osg::StateSet(*stateSet, osg::CopyOp::SHALLOW_COPY));
+                newStateSet->removeAttribute(osg::StateAttribute::PROGRAM);
+                copy = mCopies.emplace(stateSet, newStateSet).first;
+            }
+            return copy->second.get();
+        }
+
+    private:
+        mutable std::map<const osg::StateSet*, osg::ref_ptr<osg::StateSet>> mCopies;
+    };
+
+    osgDB::ReaderWriter* getReaderWriter()
+    {
+        osgDB::ReaderWriter* rw = osgDB::Registry::instance()->getReaderWriterForExtension("osgb");
+        if (!rw)
+            throw std::runtime_error("no readerwriter for 'osgb' found");
+        return rw;
+    }
+}
+
+namespace Resource
+{
+
+// There is one entry per model, so the cache doesn't grow beyond the size of the models in the data files
+TemplateDiskCache::TemplateDiskCache(const boost::filesystem::path& path)
+    : mCache(path, std::numeric_limits<std::size_t>::max(), sMagic, sFormatVersion, sExtension, "model template")
+{
+    // Templates keep the NIF transforms as user data, which needs a serializer of its own
+    SceneUtil::registerSerializers();
+}
+
+bool TemplateDiskCache::isStorable(const osg::Node& node)
+{
+    StorableVisitor visitor;
+    const_cast<osg::Node&>(node).accept(visitor);
+    return visitor.mStorable;
+}
+
+osg::ref_ptr<osg::Node> TemplateDiskCache::get(const std::string& normalizedName, const std::string& version,
+                                               const osgDB::Options* options)
+{
+    const std::string fileName = mCache.makeName(makeNameHash(normalizedName));
+    const std::vector<char> payload = mCache.read(fileName, makeCheckHash(normalizedName, version));
+    if (payload.empty())
+        return nullptr;
+
+    try
+    {
+        std::istringstream stream(std::string(payload.data(), payload.size()));
+        const std::shared_lock<std::shared_timed_mutex> lock(SceneUtil::getSerializersMutex());
+        const osgDB::ReaderWriter::ReadResult result = getReaderWriter()->readNode(stream, options);
+        if (!result.success() || !result.getNode())
+            throw std::runtime_error(result.message());
+        return result.getNode();
+    }
+    catch (const std::exception& e)
+    {
+        Log(Debug::Warning) << "Warning: failed to read model template " << (mCache.getPath() / fileName) << ": "
+            << e.what();
+        mCache.discard(fileName);
+        return nullptr;
+    }
+}
+
+void TemplateDiskCache::set(const std::string& normalizedName, const std::string& version, const osg::Node& node)
+{
+    if (!isStorable(node))
+        return;
+
+    const std::string fileName = mCache.makeName(makeNameHash(normalizedName));
+
+    try
+    {
+        const osg::ref_ptr<osg::Node> copy = static_cast<osg::Node*>(node.clone(WithoutProgramsCopyOp()));
+        const osg::ref_ptr<osgDB::Options> options (new osgDB::Options("WriteImageHint=UseExternal"));
+        std::ostringstream payload;
+        {
+            const std::shared_lock<std::shared_timed_mutex> lock(SceneUtil::getSerializersMutex());
+            const osgDB::ReaderWriter::WriteResult result = getReaderWriter()->writeNode(*copy, payload, options);
+            if (!result.success())
+                throw std::runtime_error(result.message());
+        }
+
+        const std::string data = payload.str();
+        mCache.write(fileName, makeCheckHash(normalizedName, version), data.data(), data.size());
+    }
+    catch (const std::exception& e)
+    {
+        Log(Debug::Warning) << "Warning: failed to write model template " << (mCache.getPath() / fileName) << ": "
+            << e.what();
+    }
+}
+
+void TemplateDiskCache::reportStats(unsigned int frameNumber, osg::Stats* stats) const
+{
+    mCache.reportStats(frameNumber, *stats, "Node");
+}
+
+}
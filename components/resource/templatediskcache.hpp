@@ -0,0 +1,59 @@
+#ifndef OPENMW_COMPONENTS_RESOURCE_TEMPLATEDISKCACHE_H
+#define OPENMW_COMPONENTS_RESOURCE_TEMPLATEDISKCACHE_H
+
+#include <components/misc/diskcache.hpp>
+
+#include <osg/Node>
+#include <osg/ref_ptr>
+
+#include <boost/filesystem/path.hpp>
+
+#include <string>
+
+namespace osg
+{
+    class Stats;
+}
+
+namespace osgDB
+{
+    class Options;
+}
+
+namespace Resource
+{
+
+    /// @brief Optimized scene templates persisted between sessions, so that loading a model again skips parsing and
+    /// optimizing it.
+    /// @par Entries are osgb files named by a hash of the normalized model name, so there is at most one entry per
+    /// model. The header stores a hash of a version given by the caller, describing the source file and the settings the
+    /// template was built with; a template built from another source or with other settings overwrites the entry.
+    /// @par Only templates made of standard OSG classes without callbacks are stored, which covers most static models.
+    /// Animated models and particle systems are always loaded from their source. Shader programs are left out of the
+    /// files, the templates need to be visited by a Shader::ShaderVisitor again after reading them.
+    /// @note Thread safe.
+    class TemplateDiskCache
+    {
+    public:
+        explicit TemplateDiskCache(const boost::filesystem::path& path);
+
+        /// @return true if all objects of the template can be written and read back without losing anything
+        static bool isStorable(const osg::Node& node);
+
+        /// @param options used to read the template, e.g. with a read file callback providing the images
+        /// @return nullptr when the template is not cached or was cached with another version
+        osg::ref_ptr<osg::Node> get(const std::string& normalizedName, const std::string& version,
+                                    const osgDB::Options* options);
+
+        /// Does nothing if the template is not storable.
+        void set(const std::string& normalizedName, const std::string& version, const osg::Node& node);
+
+        void reportStats(unsigned int frameNumber, osg::Stats* stats) const;
+
+    private:
+        Misc::DiskCache mCache;
+    };
+
+}
+
+#endif
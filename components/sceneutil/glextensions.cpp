@@ -0,0 +1,28 @@
+#include "glextensions.hpp"
+
+#include <osg/GraphicsContext>
+
+namespace SceneUtil
+{
+
+    namespace
+    {
+        osg::ref_ptr<const osg::GLExtensions> sGLExtensions;
+    }
+
+    const osg::GLExtensions* getGLExtensions()
+    {
+        return sGLExtensions.get();
+    }
+
+    GetGLExtensionsOperation::GetGLExtensionsOperation()
+        : osg::GraphicsOperation("GetGLExtensionsOperation", false)
+    {
+    }
+
+    void GetGLExtensionsOperation::operator()(osg::GraphicsContext* graphicsContext)
+    {
+        sGLExtensions = osg::GLExtensions::Get(graphicsContext->getState()->getContextID(), true);
+    }
+
+}
@@ -0,0 +1,26 @@
+#ifndef OPENMW_COMPONENTS_SCENEUTIL_GLEXTENSIONS_H
+#define OPENMW_COMPONENTS_SCENEUTIL_GLEXTENSIONS_H
+
+#include <osg/GLExtensions>
+#include <osg/GraphicsThread>
+
+namespace SceneUtil
+{
+
+    /// @return the extensions of the graphics context the GetGLExtensionsOperation ran for, nullptr before that.
+    const osg::GLExtensions* getGLExtensions();
+
+    /// @brief Realize operation of the viewer storing the extensions of its graphics context.
+    /// @par osg::GLExtensions::Get can only set up the extensions with the context current, so code outside of the
+    /// draw thread gets them from here instead of querying a context that may not be current on its thread.
+    class GetGLExtensionsOperation : public osg::GraphicsOperation
+    {
+    public:
+        GetGLExtensionsOperation();
+
+        void operator()(osg::GraphicsContext* graphicsContext) override;
+    };
+
+}
+
+#endif
@@ -0,0 +1,194 @@
+#include "instancing.hpp"
+
+#include <osg/Geometry>
+#include <osg/GLExtensions>
+#include <osg/NodeVisitor>
+#include <osg/Transform>
+#include <osg/VertexAttribDivisor>
+
+namespace SceneUtil
+{
+
+namespace
+{
+    /// The bounding box of a geometry is computed from its vertices, which are only those of the first instance
+    class InstancesBoundingBox : public osg::Drawable::ComputeBoundingBoxCallback
+    {
+    public:
+        InstancesBoundingBox() = default;
+
+        InstancesBoundingBox(const osg::BoundingBox& box)
+            : mBox(box)
+        {
+        }
+
+        InstancesBoundingBox(const InstancesBoundingBox& copy, const osg::CopyOp& copyop)
+            : osg::Drawable::ComputeBoundingBoxCallback(copy, copyop)
+            , mBox(copy.mBox)
+        {
+        }
+
+        META_Object(SceneUtil, InstancesBoundingBox)
+
+        osg::BoundingBox computeBound(const osg::Drawable&) const override
+        {
+            return mBox;
+        }
+
+    private:
+        osg::BoundingBox mBox;
+    };
+
+    /// Collects copies of the geometries of a model, with the transforms and state sets above them applied
+    class BakeVisitor : public osg::NodeVisitor
+    {
+    public:
+        std::vector<osg::ref_ptr<osg::Geometry>> mGeometries;
+
+        BakeVisitor()
+            : osg::NodeVisitor(TRAVERSE_ALL_CHILDREN)
+        {
+            mMatrices.push_back(osg::Matrix::identity());
+        }
+
+        void apply(osg::Node& node) override
+        {
+            pushStateSet(node);
+            traverse(node);
+            popStateSet(node);
+        }
+
+        void apply(osg::Transform& transform) override
+        {
+            osg::Matrix matrix = mMatrices.back();
+            transform.computeLocalToWorldMatrix(matrix, this);
+            mMatrices.push_back(matrix);
+            pushStateSet(transform);
+            traverse(transform);
+            popStateSet(transform);
+            mMatrices.pop_back();
+        }
+
+        void apply(osg::Drawable& drawable) override
+        {
+            const osg::Geometry* geometry = drawable.asGeometry();
+            if (!geometry)
+                return;
+
+            // The arrays of the model may be drawn with display lists, the instanced copy needs its own buffer objects
+            osg::ref_ptr<osg::Geometry> copy (new osg::Geometry(*geometry,
+                osg::CopyOp::DEEP_COPY_ARRAYS | osg::CopyOp::DEEP_COPY_PRIMITIVES));
+
+            const osg::Matrix& matrix = mMatrices.back();
+            if (!matrix.isIdentity())
+                bake(matrix, *copy);
+
+            osg::ref_ptr<osg::StateSet> stateSet (new osg::StateSet);
+            for (const osg::StateSet* parentStateSet : mStateSets)
+                stateSet->merge(*parentStateSet);
+            if (geometry->getStateSet())
+                stateSet->merge(*geometry->getStateSet());
+            copy->setStateSet(stateSet);
+
+            mGeometries.push_back(copy);
+        }
+
+    private:
+        std::vector<osg::Matrix> mMatrices;
+        std::vector<const osg::StateSet*> mStateSets;
+
+        void pushStateSet(const osg::Node& node)
+        {
+            if (node.getStateSet())
+                mStateSets.push_back(node.getStateSet());
+        }
+
+        void popStateSet(const osg::Node& node)
+        {
+            if (node.getStateSet())
+                mStateSets.pop_back();
+        }
+
+        static void bake(const osg::Matrix& matrix, osg::Geometry& geometry)
+        {
+            if (osg::Vec3Array* positions = dynamic_cast<osg::Vec3Array*>(geometry.getVertexArray()))
+            {
+                for (osg::Vec3f& position : *positions)
+                    position = position * matrix;
+                positions->dirty();
+            }
+
+            // Models are only scaled uniformly, the normals can be rotated as the positions are
+            if (osg::Vec3Array* normals = dynamic_cast<osg::Vec3Array*>(geometry.getNormalArray()))
+            {
+                for (osg::Vec3f& normal : *normals)
+                {
+                    normal = osg::Matrix::transform3x3(normal, matrix);
+                    normal.normalize();
+                }
+                normals->dirty();
+            }
+
+            if (osg::Vec4Array* tangents = dynamic_cast<osg::Vec4Array*>(geometry.getTexCoordArray(7)))
+            {
+                for (osg::Vec4f& tangent : *tangents)
+                {
+                    osg::Vec3f direction = osg::Matrix::transform3x3(osg::Vec3f(tangent.x(), tangent.y(), tangent.z()), matrix);
+                    direction.normalize();
+                    tangent = osg::Vec4f(direction, tangent.w());
+                }
+                tangents->dirty();
+            }
+        }
+    };
+}
+
+bool isInstancingSupported(const osg::GLExtensions& extensions)
+{
+    return extensions.isGlslSupported && extensions.glVertexAttribDivisor
+        && extensions.glDrawArraysInstanced && extensions.glDrawElementsInstanced;
+}
+
+osg::ref_ptr<osg::Group> createInstances(const osg::Node& model, const std::vector<Instance>& instances)
+{
+    osg::ref_ptr<osg::Vec4Array> offsets (new osg::Vec4Array);
+    osg::ref_ptr<osg::Vec4Array> rotations (new osg::Vec4Array);
+    offsets->reserve(instances.size());
+    rotations->reserve(instances.size());
+    for (const Instance& instance : instances)
+    {
+        offsets->push_back(osg::Vec4f(instance.mPosition, instance.mScale));
+        rotations->push_back(instance.mRotation.asVec4());
+    }
+
+    // The visitor only reads the model
+    BakeVisitor visitor;
+    const_cast<osg::Node&>(model).accept(visitor);
+
+    osg::ref_ptr<osg::Group> group (new osg::Group);
+    for (const osg::ref_ptr<osg::Geometry>& geometry : visitor.mGeometries)
+    {
+        geometry->setUseDisplayList(false);
+        geometry->setUseVertexBufferObjects(true);
+        geometry->setVertexAttribArray(InstanceAttribute_Offset, offsets, osg::Array::BIND_PER_VERTEX);
+        geometry->setVertexAttribArray(InstanceAttribute_Rotation, rotations, osg::Array::BIND_PER_VERTEX);
+        for (unsigned int i = 0; i < geometry->getNumPrimitiveSets(); ++i)
+            geometry->getPrimitiveSet(i)->setNumInstances(static_cast<int>(instances.size()));
+
+        osg::StateSet* stateSet = geometry->getStateSet();
+        stateSet->setAttribute(new osg::VertexAttribDivisor(InstanceAttribute_Offset, 1));
+        stateSet->setAttribute(new osg::VertexAttribDivisor(InstanceAttribute_Rotation, 1));
+
+        const osg::BoundingSphere bound (geometry->computeBoundingBox());
+        osg::BoundingBox box;
+        for (const Instance& instance : instances)
+            box.expandBy(osg::BoundingSphere(instance.mRotation * (bound.center() * instance.mScale) + instance.mPosition,
+                                             bound.radius() * instance.mScale));
+        geometry->setComputeBoundingBoxCallback(new InstancesBoundingBox(box));
+
+        group->addChild(geometry);
+    }
+    return group;
+}
+
+}
@@ -0,0 +1,48 @@
+#ifndef OPENMW_COMPONENTS_SCENEUTIL_INSTANCING_H
+#define OPENMW_COMPONENTS_SCENEUTIL_INSTANCING_H
+
+#include <osg/Group>
+#include <osg/Quat>
+#include <osg/ref_ptr>
+#include <osg/Vec3f>
+
+#include <vector>
+
+namespace osg
+{
+    class GLExtensions;
+}
+
+namespace SceneUtil
+{
+
+    /// Generic vertex attribute locations of the instance transforms. Locations 1, 6 and 7 are the only ones not
+    /// aliased by a conventional vertex attribute on any driver.
+    enum InstanceAttribute
+    {
+        /// xyz: position, w: uniform scale
+        InstanceAttribute_Offset = 6,
+        /// Rotation quaternion
+        InstanceAttribute_Rotation = 7
+    };
+
+    struct Instance
+    {
+        osg::Vec3f mPosition;
+        osg::Quat mRotation;
+        float mScale;
+    };
+
+    /// @return true if the context renders with shaders able to read per instance vertex attributes.
+    /// @see getGLExtensions
+    bool isInstancingSupported(const osg::GLExtensions& extensions);
+
+    /// Create a node drawing the model once per instance, with a single instanced draw per geometry of the model.
+    /// @par The transforms and state sets above each geometry are baked into a copy of it, so the model may only
+    /// consist of groups, matrix transforms and geometries. The instance transforms are passed as vertex attributes
+    /// with a divisor of 1, and geometries having them get an instancing shader from Shader::ShaderVisitor.
+    osg::ref_ptr<osg::Group> createInstances(const osg::Node& model, const std::vector<Instance>& instances);
+
+}
+
+#endif
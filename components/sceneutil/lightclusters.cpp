@@ -0,0 +1,154 @@
+#include "lightclusters.hpp"
+
+#include <osg/Vec4d>
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+
+namespace SceneUtil
+{
+
+    namespace
+    {
+        int getTile(float ndc, int tiles)
+        {
+            const float tile = std::floor((ndc * 0.5f + 0.5f) * tiles);
+            return static_cast<int>(std::min(std::max(tile, 0.f), static_cast<float>(tiles - 1)));
+        }
+    }
+
+    LightClusterGrid::LightClusterGrid(int tilesX, int tilesY, int slices, unsigned int maxLightsPerCluster,
+                                       std::size_t maxIndices)
+        : mTilesX(tilesX)
+        , mTilesY(tilesY)
+        , mSlices(slices)
+        , mMaxLightsPerCluster(maxLightsPerCluster)
+        , mMaxIndices(maxIndices)
+        , mPerspective(true)
+        , mNear(1.f)
+        , mSliceScale(1.f)
+        , mClusters(static_cast<std::size_t>(tilesX) * tilesY * slices, Cluster {0, 0})
+        , mFilled(mClusters.size(), 0)
+    {
+    }
+
+    void LightClusterGrid::assign(const osg::Matrixd& projection, float near, float far,
+                                  const std::vector<osg::BoundingSphere>& lights)
+    {
+        mProjection = projection;
+        mPerspective = projection(2, 3) != 0;
+        mNear = near;
+        mSliceScale = mSlices / std::log(far / near);
+
+        for (Cluster& cluster : mClusters)
+            cluster = Cluster {0, 0};
+        mAssignments.clear();
+
+        for (unsigned int light = 0; light < lights.size(); ++light)
+        {
+            const osg::Vec3f& center = lights[light].center();
+            const float radius = lights[light].radius();
+            const float minDepth = -center.z() - radius;
+            const float maxDepth = -center.z() + radius;
+            const int lastSlice = getSlice(maxDepth);
+            for (int slice = getSlice(minDepth); slice <= lastSlice; ++slice)
+            {
+                // The first slice reaches back to the eye and the last one out to infinity
+                const float sliceMinDepth = slice == 0 ? minDepth : std::max(minDepth, getSliceDepth(slice));
+                const float sliceMaxDepth = slice == mSlices - 1 ? maxDepth : std::min(maxDepth, getSliceDepth(slice + 1));
+                int firstX, lastX, firstY, lastY;
+                getTileRange(center.x(), radius, sliceMinDepth, sliceMaxDepth, 0, mTilesX, firstX, lastX);
+                getTileRange(center.y(), radius, sliceMinDepth, sliceMaxDepth, 1, mTilesY, firstY, lastY);
+                for (int y = firstY; y <= lastY; ++y)
+                {
+                    for (int x = firstX; x <= lastX; ++x)
+                    {
+                        const std::size_t index = getClusterIndex(x, y, slice);
+                        if (mClusters[index].mCount >= mMaxLightsPerCluster)
+                            continue;
+                        ++mClusters[index].mCount;
+                        mAssignments.emplace_back(index, light);
+                    }
+                }
+            }
+        }
+
+        std::size_t offset = 0;
+        for (Cluster& cluster : mClusters)
+        {
+            cluster.mOffset = static_cast<unsigned int>(offset);
+            cluster.mCount = static_cast<unsigned int>(std::min<std::size_t>(cluster.mCount, mMaxIndices - offset));
+            offset += cluster.mCount;
+        }
+
+        mIndices.resize(offset);
+        std::fill(mFilled.begin(), mFilled.end(), 0);
+        for (const auto& assignment : mAssignments)
+        {
+            const Cluster& cluster = mClusters[assignment.first];
+            unsigned int& filled = mFilled[assignment.first];
+            if (filled < cluster.mCount)
+                mIndices[cluster.mOffset + filled++] = assignment.second;
+        }
+    }
+
+    int LightClusterGrid::getSlice(float depth) const
+    {
+        if (!(depth > mNear))
+            return 0;
+        const float slice = std::floor(std::log(depth / mNear) * mSliceScale);
+        return static_cast<int>(std::min(slice, static_cast<float>(mSlices - 1)));
+    }
+
+    const LightClusterGrid::Cluster& LightClusterGrid::getCluster(const osg::Vec3f& viewPos) const
+    {
+        const osg::Vec4d clip = osg::Vec4d(viewPos, 1.0) * mProjection;
+        // Positions behind the eye belong to the first slice, which covers the whole screen for lights reaching them
+        const double w = mPerspective ? std::max(clip.w(), 1e-4) : clip.w();
+        const int x = getTile(static_cast<float>(clip.x() / w), mTilesX);
+        const int y = getTile(static_cast<float>(clip.y() / w), mTilesY);
+        return mClusters[getClusterIndex(x, y, getSlice(-viewPos.z()))];
+    }
+
+    float LightClusterGrid::getSliceDepth(int slice) const
+    {
+        return mNear * std::exp(slice / mSliceScale);
+    }
+
+    void LightClusterGrid::getTileRange(float center, float radius, float minDepth, float maxDepth, int axis,
+                                        int tiles, int& first, int& last) const
+    {
+        const float scale = static_cast<float>(mProjection(axis, axis));
+        float min = center - radius;
+        float max = center + radius;
+        if (mPerspective)
+        {
+            // The light reaches the plane of the eye, where its projection is unbounded
+            if (minDepth <= 0)
+            {
+                first = 0;
+                last = tiles - 1;
+                return;
+            }
+            // Each end of the light moves towards the center of the screen with the depth
+            const float corners[] = {min / minDepth, min / maxDepth, max / minDepth, max / maxDepth};
+            min = *std::min_element(std::begin(corners), std::end(corners));
+            max = *std::max_element(std::begin(corners), std::end(corners));
+            const float offset = -static_cast<float>(mProjection(2, axis));
+            min = min * scale + offset;
+            max = max * scale + offset;
+        }
+        else
+        {
+            const float offset = static_cast<float>(mProjection(3, axis));
+            min = min * scale + offset;
+            max = max * scale + offset;
+        }
+        if (scale < 0)
+            std::swap(min, max);
+        first = getTile(min, tiles);
+        last = getTile(max, tiles);
+    }
+
+}
@@ -0,0 +1,95 @@
+#ifndef OPENMW_COMPONENTS_SCENEUTIL_LIGHTCLUSTERS_H
+#define OPENMW_COMPONENTS_SCENEUTIL_LIGHTCLUSTERS_H
+
+#include <osg/BoundingSphere>
+#include <osg/Matrixd>
+#include <osg/Vec3f>
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace SceneUtil
+{
+
+    /// @brief Assigns lights to the clusters of a view space grid, so that forward shading only evaluates the lights
+    /// reaching the cluster of each vertex or fragment.
+    /// @par The grid divides the screen into tiles, and the depth range between near and far into slices growing
+    /// exponentially with the distance. Depths before the range belong to the first slice, depths after it to the last
+    /// one, and positions off the screen to the closest tile, so that every view space position has a cluster listing
+    /// all lights reaching it.
+    /// @par Clusters are ordered by slice, then by tile row, then by tile column.
+    class LightClusterGrid
+    {
+    public:
+        struct Cluster
+        {
+            /// Position of the first light of the cluster in getIndices()
+            unsigned int mOffset;
+            unsigned int mCount;
+        };
+
+        /// @param maxLightsPerCluster further lights reaching a cluster are left out, in the order given to assign()
+        /// @param maxIndices limit of the light indices of all clusters together, the last clusters are left with
+        /// fewer lights once it is reached
+        LightClusterGrid(int tilesX, int tilesY, int slices, unsigned int maxLightsPerCluster, std::size_t maxIndices);
+
+        /// Assign lights to the clusters of a view, replacing the previous assignment.
+        /// @param projection perspective or orthographic projection of the view
+        /// @param near the depth where the second slice starts, must be positive
+        /// @param far the depth where the last slice starts, must be greater than near
+        /// @param lights view space bounds of the lights, ideally ordered by importance
+        void assign(const osg::Matrixd& projection, float near, float far, const std::vector<osg::BoundingSphere>& lights);
+
+        int getTilesX() const { return mTilesX; }
+
+        int getTilesY() const { return mTilesY; }
+
+        int getSlices() const { return mSlices; }
+
+        float getNear() const { return mNear; }
+
+        /// @return the number of slices per unit of log(depth / near)
+        float getSliceScale() const { return mSliceScale; }
+
+        /// @param depth distance of a view space position in front of the eye, i.e. -z
+        int getSlice(float depth) const;
+
+        std::size_t getClusterIndex(int x, int y, int slice) const
+        {
+            return (static_cast<std::size_t>(slice) * mTilesY + y) * mTilesX + x;
+        }
+
+        /// @return the cluster of a view space position, the same way the shaders find it
+        const Cluster& getCluster(const osg::Vec3f& viewPos) const;
+
+        const std::vector<Cluster>& getClusters() const { return mClusters; }
+
+        /// @return the indices of the lights given to assign(), grouped by cluster
+        const std::vector<unsigned int>& getIndices() const { return mIndices; }
+
+    private:
+        int mTilesX;
+        int mTilesY;
+        int mSlices;
+        unsigned int mMaxLightsPerCluster;
+        std::size_t mMaxIndices;
+        osg::Matrixd mProjection;
+        bool mPerspective;
+        float mNear;
+        float mSliceScale;
+        std::vector<Cluster> mClusters;
+        std::vector<unsigned int> mIndices;
+        std::vector<unsigned int> mFilled;
+        std::vector<std::pair<std::size_t, unsigned int>> mAssignments;
+
+        float getSliceDepth(int slice) const;
+
+        /// Get the range of tiles along one axis covered by the part of a light between two depths
+        void getTileRange(float center, float radius, float minDepth, float maxDepth, int axis, int tiles,
+                          int& first, int& last) const;
+    };
+
+}
+
+#endif
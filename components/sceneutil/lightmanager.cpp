@@ -1,12 +1,36 @@
 #include "lightmanager.hpp"
 
+#include <osg/GLExtensions>
+#include <osg/Texture2D>
+
 #include <osgUtil/CullVisitor>
 
+#include <components/sceneutil/lightclusters.hpp>
 #include <components/sceneutil/util.hpp>
 
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+
 namespace SceneUtil
 {
 
+    // Grid of the clustered lighting, the tiles stay close to square on common aspect ratios
+    const int sClusterTilesX = 16;
+    const int sClusterTilesY = 9;
+    const int sClusterSlices = 24;
+    // Must match MAX_CLUSTER_LIGHTS in lighting.glsl
+    const unsigned int sMaxLightsPerCluster = 64;
+    const unsigned int sMaxClusterLights = 1024;
+    const int sClusterIndexTextureWidth = 1024;
+    const int sClusterIndexTextureHeight = 64;
+    // Texels per light: view position and range, diffuse, ambient, attenuation
+    const int sClusterLightTexels = 4;
+    // Lights fade out between their radius and this multiple of it, so that the cluster bounds don't show
+    const float sClusterRadiusScale = 2.f;
+    const float sMinClusterNear = 1.f;
+    const float sDefaultClusterFar = 8192.f;
+
     class LightStateCache
     {
     public:
@@ -154,7 +178,7 @@ namespace SceneUtil
         virtual void operator()(osg::Node* node, osg::NodeVisitor* nv)
         {
             LightManager* lightManager = static_cast<LightManager*>(node);
-            lightManager->update();
+            lightManager->update(nv->getTraversalNumber());
 
             traverse(node, nv);
         }
@@ -163,6 +187,7 @@ namespace SceneUtil
     LightManager::LightManager()
         : mStartLight(0)
         , mLightingMask(~0u)
+        , mClusterTextureUnit(-1)
     {
         setUpdateCallback(new LightManagerUpdateCallback);
         for (unsigned int i=0; i<8; ++i)
@@ -173,8 +198,16 @@ namespace SceneUtil
         : osg::Group(copy, copyop)
         , mStartLight(copy.mStartLight)
         , mLightingMask(copy.mLightingMask)
+        , mClusterTextureUnit(copy.mClusterTextureUnit)
     {
+        // The uniforms of the clustered lighting come with the copied StateSet
+        if (mClusterTextureUnit >= 0)
+            mClusterGrid.reset(new LightClusterGrid(sClusterTilesX, sClusterTilesY, sClusterSlices,
+                                                    sMaxLightsPerCluster, sClusterIndexTextureWidth * sClusterIndexTextureHeight));
+    }
 
+    LightManager::~LightManager()
+    {
     }
 
     void LightManager::setLightingMask(unsigned int mask)
@@ -187,11 +220,20 @@ namespace SceneUtil
         return mLightingMask;
     }
 
-    void LightManager::update()
+    void LightManager::update(unsigned int frameNum)
     {
         mLights.clear();
         mLightsInViewSpace.clear();
 
+        // forget the clusters of cameras that stopped rendering, once the draw thread is done with them
+        for (auto it = mCameraClusters.begin(); it != mCameraClusters.end(); )
+        {
+            if (frameNum - it->second.mLastFrameNumber > 2)
+                it = mCameraClusters.erase(it);
+            else
+                ++it;
+        }
+
         // do an occasional cleanup for orphaned lights
         for (int i=0; i<2; ++i)
         {
@@ -353,6 +395,42 @@ namespace SceneUtil
         return mStartLight;
     }
 
+    void LightManager::setClusteredLighting(int textureUnit)
+    {
+        mClusterTextureUnit = textureUnit;
+        mClusterGrid.reset(new LightClusterGrid(sClusterTilesX, sClusterTilesY, sClusterSlices,
+                                                sMaxLightsPerCluster, sClusterIndexTextureWidth * sClusterIndexTextureHeight));
+
+        osg::StateSet* stateset = getOrCreateStateSet();
+        stateset->addUniform(new osg::Uniform("lightClusterLights", textureUnit));
+        stateset->addUniform(new osg::Uniform("lightClusters", textureUnit + 1));
+        stateset->addUniform(new osg::Uniform("lightClusterIndices", textureUnit + 2));
+        stateset->addUniform(new osg::Uniform("lightClusterGrid", osg::Vec4f(sClusterTilesX, sClusterTilesY,
+                                                                              sClusterSlices, sMaxClusterLights)));
+        stateset->addUniform(new osg::Uniform("lightClusterIndexSize", osg::Vec2f(sClusterIndexTextureWidth,
+                                                                                   sClusterIndexTextureHeight)));
+    }
+
+    bool LightManager::isClusteredLighting() const
+    {
+        return mClusterGrid != nullptr;
+    }
+
+    void LightManager::traverse(osg::NodeVisitor& nv)
+    {
+        if (!mClusterGrid || nv.getVisitorType() != osg::NodeVisitor::CULL_VISITOR
+                || !(nv.getTraversalMask() & mLightingMask))
+        {
+            osg::Group::traverse(nv);
+            return;
+        }
+
+        osgUtil::CullVisitor* cv = static_cast<osgUtil::CullVisitor*>(&nv);
+        cv->pushStateSet(getClusterStateSet(cv));
+        osg::Group::traverse(nv);
+        cv->popStateSet();
+    }
+
     static int sLightId = 0;
 
     LightSource::LightSource()
@@ -378,6 +456,130 @@ namespace SceneUtil
         return left->mViewBound.center().length2() - left->mViewBound.radius2()*81 < right->mViewBound.center().length2() - right->mViewBound.radius2()*81;
     }
 
+    bool isClusteredLightingSupported(const osg::GLExtensions& extensions)
+    {
+        // Float textures and texture reads in vertex shaders are only guaranteed from OpenGL 3.0 on
+        return extensions.isGlslSupported && extensions.glVersion >= 3.f;
+    }
+
+    osg::ref_ptr<osg::Texture2D> createClusterTexture(osg::Image* image, GLint internalFormat)
+    {
+        osg::ref_ptr<osg::Texture2D> texture (new osg::Texture2D(image));
+        texture->setInternalFormat(internalFormat);
+        texture->setFilter(osg::Texture::MIN_FILTER, osg::Texture::NEAREST);
+        texture->setFilter(osg::Texture::MAG_FILTER, osg::Texture::NEAREST);
+        texture->setWrap(osg::Texture::WRAP_S, osg::Texture::CLAMP_TO_EDGE);
+        texture->setWrap(osg::Texture::WRAP_T, osg::Texture::CLAMP_TO_EDGE);
+        texture->setResizeNonPowerOfTwoHint(false);
+        return texture;
+    }
+
+    // Depth range of the cluster slices, the near and far planes of the projection within sane limits
+    void getClusterDepthRange(const osg::Matrix& projection, float& near, float& far)
+    {
+        double left, right, bottom, top, zNear, zFar;
+        const bool valid = projection(2, 3) != 0
+            ? projection.getFrustum(left, right, bottom, top, zNear, zFar)
+            : projection.getOrtho(left, right, bottom, top, zNear, zFar);
+        if (!valid || !std::isfinite(zNear) || !std::isfinite(zFar))
+        {
+            zNear = sMinClusterNear;
+            zFar = sDefaultClusterFar;
+        }
+        near = std::max(static_cast<float>(zNear), sMinClusterNear);
+        far = std::max(static_cast<float>(zFar), near * 2);
+    }
+
+    void LightManager::createClusterData(ClusterData& data) const
+    {
+        data.mLights = new osg::Image;
+        data.mLights->allocateImage(sClusterLightTexels, sMaxClusterLights, 1, GL_RGBA, GL_FLOAT);
+        data.mClusters = new osg::Image;
+        data.mClusters->allocateImage(sClusterTilesX * sClusterTilesY, sClusterSlices, 1, GL_LUMINANCE_ALPHA, GL_FLOAT);
+        data.mIndices = new osg::Image;
+        data.mIndices->allocateImage(sClusterIndexTextureWidth, sClusterIndexTextureHeight, 1, GL_LUMINANCE, GL_FLOAT);
+        data.mDepth = new osg::Uniform("lightClusterDepth", osg::Vec2f());
+
+        // shaders only, don't use setTextureAttributeAndModes
+        data.mStateSet = new osg::StateSet;
+        data.mStateSet->setTextureAttribute(mClusterTextureUnit, createClusterTexture(data.mLights, GL_RGBA32F_ARB));
+        data.mStateSet->setTextureAttribute(mClusterTextureUnit + 1,
+                                            createClusterTexture(data.mClusters, GL_LUMINANCE_ALPHA32F_ARB));
+        data.mStateSet->setTextureAttribute(mClusterTextureUnit + 2,
+                                            createClusterTexture(data.mIndices, GL_LUMINANCE32F_ARB));
+        data.mStateSet->addUniform(data.mDepth);
+    }
+
+    osg::StateSet* LightManager::getClusterStateSet(osgUtil::CullVisitor* cv)
+    {
+        const unsigned int frameNum = cv->getTraversalNumber();
+        CameraClusters& cameraClusters = mCameraClusters[cv->getCurrentCamera()];
+        cameraClusters.mLastFrameNumber = frameNum;
+        ClusterData& data = cameraClusters.mData[frameNum % 2];
+        if (!data.mStateSet)
+            createClusterData(data);
+
+        // Don't use Camera::getViewMatrix, that one might be relative to another camera!
+        const osg::RefMatrix* viewMatrix = cv->getCurrentRenderStage()->getInitialViewMatrix();
+        const std::vector<LightSourceViewBound>& lights = getLightsInViewSpace(cv->getCurrentCamera(), viewMatrix);
+
+        // lights outside of the view frustum can't reach anything on the screen
+        osg::CullingSet& cullingSet = cv->getModelViewCullingStack().front();
+        mClusterLights.clear();
+        for (const LightSourceViewBound& light : lights)
+        {
+            const osg::BoundingSphere bound (light.mViewBound.center(), light.mViewBound.radius() * sClusterRadiusScale);
+            if (!cullingSet.isCulled(bound))
+                mClusterLights.push_back(&light);
+        }
+
+        // keep the closest lights when there are too many of them for a cluster or for the textures
+        std::sort(mClusterLights.begin(), mClusterLights.end(), sortLights);
+        if (mClusterLights.size() > sMaxClusterLights)
+            mClusterLights.resize(sMaxClusterLights);
+
+        mClusterLightBounds.clear();
+        float* lightData = reinterpret_cast<float*>(data.mLights->data());
+        for (const LightSourceViewBound* light : mClusterLights)
+        {
+            const osg::Vec3f& position = light->mViewBound.center();
+            const float range = light->mViewBound.radius() * sClusterRadiusScale;
+            mClusterLightBounds.emplace_back(position, range);
+
+            const osg::Light* source = light->mLightSource->getLight(frameNum);
+            const osg::Vec4f& diffuse = source->getDiffuse();
+            const osg::Vec4f& ambient = source->getAmbient();
+            const float texels[sClusterLightTexels * 4] = {
+                position.x(), position.y(), position.z(), range,
+                diffuse.r(), diffuse.g(), diffuse.b(), source->getConstantAttenuation(),
+                ambient.r(), ambient.g(), ambient.b(), source->getLinearAttenuation(),
+                source->getQuadraticAttenuation(), 0.f, 0.f, 0.f
+            };
+            lightData = std::copy(std::begin(texels), std::end(texels), lightData);
+        }
+
+        const osg::Matrix& projection = *cv->getProjectionMatrix();
+        float near, far;
+        getClusterDepthRange(projection, near, far);
+        mClusterGrid->assign(projection, near, far, mClusterLightBounds);
+
+        float* clusterData = reinterpret_cast<float*>(data.mClusters->data());
+        for (const LightClusterGrid::Cluster& cluster : mClusterGrid->getClusters())
+        {
+            *clusterData++ = static_cast<float>(cluster.mOffset);
+            *clusterData++ = static_cast<float>(cluster.mCount);
+        }
+        float* indexData = reinterpret_cast<float*>(data.mIndices->data());
+        for (unsigned int index : mClusterGrid->getIndices())
+            *indexData++ = static_cast<float>(index);
+
+        data.mLights->dirty();
+        data.mClusters->dirty();
+        data.mIndices->dirty();
+        data.mDepth->set(osg::Vec2f(near, mClusterGrid->getSliceScale()));
+        return data.mStateSet;
+    }
+
     void LightListCallback::operator()(osg::Node *node, osg::NodeVisitor *nv)
     {
         osgUtil::CullVisitor* cv = static_cast<osgUtil::CullVisitor*>(nv);
@@ -400,6 +602,10 @@ namespace SceneUtil
         if (!(cv->getTraversalMask() & mLightManager->getLightingMask()))
             return false;
 
+        // the shaders find the lights on their own
+        if (mLightManager->isClusteredLighting())
+            return false;
+
         // Possible optimizations:
         // - cull list of lights by the camera frustum
         // - organize lights in a quad tree
@@ -1,14 +1,22 @@
 #ifndef OPENMW_COMPONENTS_SCENEUTIL_LIGHTMANAGER_H
 #define OPENMW_COMPONENTS_SCENEUTIL_LIGHTMANAGER_H
 
+#include <map>
+#include <memory>
 #include <set>
 
 #include <osg/Light>
 
 #include <osg/Group>
+#include <osg/Image>
 #include <osg/NodeVisitor>
 #include <osg/observer_ptr>
 
+namespace osg
+{
+    class GLExtensions;
+}
+
 namespace osgUtil
 {
     class CullVisitor;
@@ -16,6 +24,11 @@ namespace osgUtil
 
 namespace SceneUtil
 {
+    class LightClusterGrid;
+
+    /// @return true if the context can render with clustered lighting, see LightManager::setClusteredLighting.
+    /// @see getGLExtensions
+    bool isClusteredLightingSupported(const osg::GLExtensions& extensions);
 
     /// LightSource managed by a LightManager.
     /// @par Typically used for point lights. Spot lights are not supported yet. Directional lights affect the whole scene
@@ -90,6 +103,8 @@ namespace SceneUtil
 
         LightManager(const LightManager& copy, const osg::CopyOp& copyop);
 
+        ~LightManager();
+
         /// @param mask This mask is compared with the current Camera's cull mask to determine if lighting is desired.
         /// By default, it's ~0u i.e. always on.
         /// If you have some views that do not require lighting, then set the Camera's cull mask to not include
@@ -103,8 +118,22 @@ namespace SceneUtil
 
         int getStartLight() const;
 
+        /// Enable clustered forward lighting. Once per frame and camera, the lights in view are assigned to the clusters
+        /// of a view space grid, and shaders built with the clusteredLighting define read the lights of each vertex or
+        /// fragment from float textures. LightListCallbacks then do nothing, so there is no limit on the number of
+        /// lights per object, and no intersection test per object during the cull traversal.
+        /// @par Lights fade out between their radius and twice their radius. Objects not rendered by such shaders only
+        /// receive the lights below the start light.
+        /// @param textureUnit the first of three consecutive texture units holding the lights, the clusters and the
+        /// light indices of the clusters
+        void setClusteredLighting(int textureUnit);
+
+        bool isClusteredLighting() const;
+
+        void traverse(osg::NodeVisitor& nv) override;
+
         /// Internal use only, called automatically by the LightManager's UpdateCallback
-        void update();
+        void update(unsigned int frameNum);
 
         /// Internal use only, called automatically by the LightSource's UpdateCallback
         void addLight(LightSource* lightSource, const osg::Matrixf& worldMat, unsigned int frameNum);
@@ -145,6 +174,33 @@ namespace SceneUtil
         int mStartLight;
 
         unsigned int mLightingMask;
+
+        struct ClusterData
+        {
+            osg::ref_ptr<osg::StateSet> mStateSet;
+            osg::ref_ptr<osg::Image> mLights;
+            osg::ref_ptr<osg::Image> mClusters;
+            osg::ref_ptr<osg::Image> mIndices;
+            osg::ref_ptr<osg::Uniform> mDepth;
+        };
+
+        struct CameraClusters
+        {
+            // double buffered, since one of them may be in use by the draw thread at any given time
+            ClusterData mData[2];
+            unsigned int mLastFrameNumber;
+        };
+
+        int mClusterTextureUnit;
+        std::unique_ptr<LightClusterGrid> mClusterGrid;
+        // Cameras are only compared, never dereferenced, since they may be gone already
+        std::map<const osg::Camera*, CameraClusters> mCameraClusters;
+        LightList mClusterLights;
+        std::vector<osg::BoundingSphere> mClusterLightBounds;
+
+        osg::StateSet* getClusterStateSet(osgUtil::CullVisitor* cv);
+
+        void createClusterData(ClusterData& data) const;
     };
 
     /// To receive lighting, objects must be decorated by a LightListCallback. Light list callbacks must be added via
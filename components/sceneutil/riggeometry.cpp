@@ -6,30 +6,62 @@
 
 #include "skeleton.hpp"
 #include "util.hpp"
+#include "workqueue.hpp"
 
 namespace
 {
-    inline void accumulateMatrix(const osg::Matrixf& invBindMatrix, const osg::Matrixf& matrix, const float weight, osg::Matrixf& result)
+    osg::ref_ptr<SceneUtil::WorkQueue> sWorkQueue;
+
+    class SkinningWorkItem : public SceneUtil::WorkItem
     {
-        osg::Matrixf m = invBindMatrix * matrix;
-        float* ptr = m.ptr();
-        float* ptrresult = result.ptr();
-        ptrresult[0] += ptr[0] * weight;
-        ptrresult[1] += ptr[1] * weight;
-        ptrresult[2] += ptr[2] * weight;
-
-        ptrresult[4] += ptr[4] * weight;
-        ptrresult[5] += ptr[5] * weight;
-        ptrresult[6] += ptr[6] * weight;
-
-        ptrresult[8] += ptr[8] * weight;
-        ptrresult[9] += ptr[9] * weight;
-        ptrresult[10] += ptr[10] * weight;
-
-        ptrresult[12] += ptr[12] * weight;
-        ptrresult[13] += ptr[13] * weight;
-        ptrresult[14] += ptr[14] * weight;
-    }
+    public:
+        SkinningWorkItem(const SceneUtil::SkinningData* data, std::vector<osg::Matrixf>& groupMatrices,
+                         osg::Vec3Array* positions, osg::Vec3Array* normals, osg::Vec4Array* tangents)
+            : mData(data)
+            , mPositions(positions)
+            , mNormals(normals)
+            , mTangents(tangents)
+        {
+            mGroupMatrices.swap(groupMatrices);
+        }
+
+        virtual void doWork()
+        {
+            mData->skin(mGroupMatrices, *mPositions, mNormals, mTangents);
+        }
+
+    private:
+        osg::ref_ptr<const SceneUtil::SkinningData> mData;
+        std::vector<osg::Matrixf> mGroupMatrices;
+        osg::ref_ptr<osg::Vec3Array> mPositions;
+        osg::ref_ptr<osg::Vec3Array> mNormals;
+        osg::ref_ptr<osg::Vec4Array> mTangents;
+    };
+
+    /// Holds the skinning job of the internal Geometry it is attached to, and makes drawing wait for it.
+    class SkinningDrawCallback : public osg::Drawable::DrawCallback
+    {
+    public:
+        void setJob(osg::ref_ptr<SkinningWorkItem> job)
+        {
+            mJob = job;
+        }
+
+        void waitTillDone() const
+        {
+            if (mJob)
+                mJob->waitTillDone();
+        }
+
+        virtual void drawImplementation(osg::RenderInfo& renderInfo, const osg::Drawable* drawable) const
+        {
+            waitTillDone();
+            drawable->drawImplementation(renderInfo);
+        }
+
+    private:
+        osg::ref_ptr<SkinningWorkItem> mJob;
+    };
 }
 
 namespace SceneUtil
@@ -47,13 +79,14 @@ RigGeometry::RigGeometry()
 RigGeometry::RigGeometry(const RigGeometry &copy, const osg::CopyOp &copyop)
     : Drawable(copy, copyop)
     , mSkeleton(nullptr)
-    , mInfluenceMap(copy.mInfluenceMap)
-    , mBone2VertexVector(copy.mBone2VertexVector)
     , mBoneSphereVector(copy.mBoneSphereVector)
     , mLastFrameNumber(0)
     , mBoundsFirstFrame(true)
 {
     setSourceGeometry(copy.mSourceGeometry);
+    // share the skinning data instead of building it again
+    mInfluenceMap = copy.mInfluenceMap;
+    mSkinningData = copy.mSkinningData;
     setNumChildrenRequiringUpdateTraversal(1);
 }
 
@@ -71,6 +104,7 @@ void RigGeometry::setSourceGeometry(osg::ref_ptr<osg::Geometry> sourceGeometry)
         to.setCullingActive(false); // make sure to disable culling since that's handled by this class
         to.setComputeBoundingBoxCallback(new CopyBoundingBoxCallback());
         to.setComputeBoundingSphereCallback(new CopyBoundingSphereCallback());
+        to.setDrawCallback(new SkinningDrawCallback);
 
         // vertices and normals are modified every frame, so we need to deep copy them.
         // assign a dedicated VBO to make sure that modifications don't interfere with source geometry's VBO.
@@ -96,14 +130,14 @@ void RigGeometry::setSourceGeometry(osg::ref_ptr<osg::Geometry> sourceGeometry)
 
         if (const osg::Vec4Array* tangents = dynamic_cast<const osg::Vec4Array*>(from.getTexCoordArray(7)))
         {
-            mSourceTangents = tangents;
             osg::ref_ptr<osg::Array> tangentArray = osg::clone(tangents, osg::CopyOp::DEEP_COPY_ALL);
             tangentArray->setVertexBufferObject(vbo);
             to.setTexCoordArray(7, tangentArray, osg::Array::BIND_PER_VERTEX);
         }
-        else
-            mSourceTangents = nullptr;
     }
+
+    if (mInfluenceMap)
+        initSkinningData();
 }
 
 osg::ref_ptr<osg::Geometry> RigGeometry::getSourceGeometry()
@@ -111,6 +145,11 @@ osg::ref_ptr<osg::Geometry> RigGeometry::getSourceGeometry()
     return mSourceGeometry;
 }
 
+void RigGeometry::setWorkQueue(osg::ref_ptr<WorkQueue> workQueue)
+{
+    sWorkQueue = workQueue;
+}
+
 bool RigGeometry::initFromParentSkeleton(osg::NodeVisitor* nv)
 {
     const osg::NodePath& path = nv->getNodePath();
@@ -137,35 +176,16 @@ bool RigGeometry::initFromParentSkeleton(osg::NodeVisitor* nv)
     }
 
     mBoneNodesVector.clear();
+    mBoneMatrices.clear();
     for (auto& bonePair : mBoneSphereVector->mData)
     {
         const std::string& boneName = bonePair.first;
         Bone* bone = mSkeleton->getBone(boneName);
         if (!bone)
-        {
-            mBoneNodesVector.push_back(nullptr);
             Log(Debug::Error) << "Error: RigGeometry did not find bone " << boneName;
-            continue;
-        }
 
         mBoneNodesVector.push_back(bone);
-    }
-
-    for (auto& pair : mBone2VertexVector->mData)
-    {
-        for (auto &weight : pair.first)
-        {
-            const std::string& boneName = weight.first.first;
-            Bone* bone = mSkeleton->getBone(boneName);
-            if (!bone)
-            {
-                mBoneNodesVector.push_back(nullptr);
-                Log(Debug::Error) << "Error: RigGeometry did not find bone " << boneName;
-                continue;
-            }
-
-            mBoneNodesVector.push_back(bone);
-        }
+        mBoneMatrices.push_back(bone ? &bone->mMatrixInSkeletonSpace : nullptr);
     }
 
     return true;
@@ -195,50 +215,24 @@ void RigGeometry::cull(osg::NodeVisitor* nv)
 
     mSkeleton->updateBoneMatrices(traversalNumber);
 
-    // skinning
-    const osg::Vec3Array* positionSrc = static_cast<osg::Vec3Array*>(mSourceGeometry->getVertexArray());
-    const osg::Vec3Array* normalSrc = static_cast<osg::Vec3Array*>(mSourceGeometry->getNormalArray());
-    const osg::Vec4Array* tangentSrc = mSourceTangents;
+    // the buffer may still be skinned for a frame that was culled but not drawn
+    waitForSkinning(mLastFrameNumber);
 
+    // skinning
     osg::Vec3Array* positionDst = static_cast<osg::Vec3Array*>(geom.getVertexArray());
     osg::Vec3Array* normalDst = static_cast<osg::Vec3Array*>(geom.getNormalArray());
     osg::Vec4Array* tangentDst = static_cast<osg::Vec4Array*>(geom.getTexCoordArray(7));
 
-    int index = mBoneSphereVector->mData.size();
-    for (auto &pair : mBone2VertexVector->mData)
-    {
-        osg::Matrixf resultMat (0, 0, 0, 0,
-                                0, 0, 0, 0,
-                                0, 0, 0, 0,
-                                0, 0, 0, 1);
-
-        for (auto &weight : pair.first)
-        {
-            Bone* bone = mBoneNodesVector[index];
-            if (bone == nullptr)
-                continue;
-
-            accumulateMatrix(weight.first.second, bone->mMatrixInSkeletonSpace, weight.second, resultMat);
-            index++;
-        }
-
-        if (mGeomToSkelMatrix)
-            resultMat *= (*mGeomToSkelMatrix);
-
-        for (auto &vertex : pair.second)
-        {
-            (*positionDst)[vertex] = resultMat.preMult((*positionSrc)[vertex]);
-            if (normalDst)
-                (*normalDst)[vertex] = osg::Matrixf::transform3x3((*normalSrc)[vertex], resultMat);
+    mSkinningData->computeGroupMatrices(mBoneMatrices, mGeomToSkelMatrix.get(), mGroupMatrices);
 
-            if (tangentDst)
-            {
-                const osg::Vec4f& srcTangent = (*tangentSrc)[vertex];
-                osg::Vec3f transformedTangent = osg::Matrixf::transform3x3(osg::Vec3f(srcTangent.x(), srcTangent.y(), srcTangent.z()), resultMat);
-                (*tangentDst)[vertex] = osg::Vec4f(transformedTangent, srcTangent.w());
-            }
-        }
+    if (sWorkQueue)
+    {
+        osg::ref_ptr<SkinningWorkItem> job (new SkinningWorkItem(mSkinningData, mGroupMatrices, positionDst, normalDst, tangentDst));
+        static_cast<SkinningDrawCallback*>(geom.getDrawCallback())->setJob(job);
+        sWorkQueue->addWorkItem(job, WorkPriority_Immediate);
     }
+    else
+        mSkinningData->skin(mGroupMatrices, *positionDst, normalDst, tangentDst);
 
     positionDst->dirty();
     if (normalDst)
@@ -273,15 +267,13 @@ void RigGeometry::updateBounds(osg::NodeVisitor *nv)
 
     osg::BoundingBox box;
 
-    int index = 0;
-    for (auto& boundPair : mBoneSphereVector->mData)
+    for (std::size_t i = 0; i < mBoneSphereVector->mData.size(); ++i)
     {
-        Bone* bone = mBoneNodesVector[index];
+        Bone* bone = mBoneNodesVector[i];
         if (bone == nullptr)
             continue;
 
-        index++;
-        osg::BoundingSpheref bs = boundPair.second;
+        osg::BoundingSpheref bs = mBoneSphereVector->mData[i].second;
         if (mGeomToSkelMatrix)
             transformBoundingSphere(bone->mMatrixInSkeletonSpace * (*mGeomToSkelMatrix), bs);
         else
@@ -337,33 +329,33 @@ void RigGeometry::setInfluenceMap(osg::ref_ptr<InfluenceMap> influenceMap)
 {
     mInfluenceMap = influenceMap;
 
-    typedef std::map<unsigned short, std::vector<BoneWeight> > Vertex2BoneMap;
-    Vertex2BoneMap vertex2BoneMap;
     mBoneSphereVector = new BoneSphereVector;
     mBoneSphereVector->mData.reserve(mInfluenceMap->mData.size());
-    mBone2VertexVector = new Bone2VertexVector;
     for (auto& influencePair : mInfluenceMap->mData)
-    {
-        const std::string& boneName = influencePair.first;
-        const BoneInfluence& bi = influencePair.second;
-        mBoneSphereVector->mData.emplace_back(boneName, bi.mBoundSphere);
-
-        for (auto& weightPair: bi.mWeights)
-        {
-            std::vector<BoneWeight>& vec = vertex2BoneMap[weightPair.first];
+        mBoneSphereVector->mData.emplace_back(influencePair.first, influencePair.second.mBoundSphere);
 
-            vec.emplace_back(std::make_pair(boneName, bi.mInvBindMatrix), weightPair.second);
-        }
-    }
+    if (mSourceGeometry)
+        initSkinningData();
+}
 
-    Bone2VertexMap bone2VertexMap;
-    for (auto& vertexPair : vertex2BoneMap)
+void RigGeometry::initSkinningData()
+{
+    std::vector<osg::Matrixf> invBindMatrices;
+    std::vector<const SkinningData::VertexWeights*> boneWeights;
+    invBindMatrices.reserve(mInfluenceMap->mData.size());
+    boneWeights.reserve(mInfluenceMap->mData.size());
+    for (auto& influencePair : mInfluenceMap->mData)
     {
-        bone2VertexMap[vertexPair.second].emplace_back(vertexPair.first);
+        invBindMatrices.push_back(influencePair.second.mInvBindMatrix);
+        boneWeights.push_back(&influencePair.second.mWeights);
     }
 
-    mBone2VertexVector->mData.reserve(bone2VertexMap.size());
-    mBone2VertexVector->mData.assign(bone2VertexMap.begin(), bone2VertexMap.end());
+    mSkinningData = new SkinningData(invBindMatrices, boneWeights, *mSourceGeometry);
+}
+
+void RigGeometry::waitForSkinning(unsigned int frame) const
+{
+    static_cast<const SkinningDrawCallback*>(getGeometry(frame)->getDrawCallback())->waitTillDone();
 }
 
 void RigGeometry::accept(osg::NodeVisitor &nv)
@@ -385,6 +377,7 @@ void RigGeometry::accept(osg::NodeVisitor &nv)
 
 void RigGeometry::accept(osg::PrimitiveFunctor& func) const
 {
+    waitForSkinning(mLastFrameNumber);
     getGeometry(mLastFrameNumber)->accept(func);
 }
 
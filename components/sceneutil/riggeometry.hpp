@@ -4,16 +4,21 @@
 #include <osg/Geometry>
 #include <osg/Matrixf>
 
+#include "skinning.hpp"
+
 namespace SceneUtil
 {
     class Skeleton;
     class Bone;
+    class WorkQueue;
 
     /// @brief Mesh skinning implementation.
     /// @note A RigGeometry may be attached directly to a Skeleton, or somewhere below a Skeleton.
     /// Note though that the RigGeometry ignores any transforms below the Skeleton, so the attachment point is not that important.
     /// @note The internal Geometry used for rendering is double buffered, this allows updates to be done in a thread safe way while
     /// not compromising rendering performance. This is crucial when using osg's default threading model of DrawThreadPerContext.
+    /// @note If a skinning WorkQueue is set, the cull traversal only blends the bone matrices and leaves the vertices to the queue,
+    /// so that independent RigGeometries are skinned in parallel. Drawing the internal Geometry waits for its skinning to finish.
     class RigGeometry : public osg::Drawable
     {
     public:
@@ -46,6 +51,9 @@ namespace SceneUtil
 
         osg::ref_ptr<osg::Geometry> getSourceGeometry();
 
+        /// Skin vertices on the threads of \a workQueue instead of the cull thread. Pass nullptr to skin on the cull thread again.
+        static void setWorkQueue(osg::ref_ptr<WorkQueue> workQueue);
+
         virtual void accept(osg::NodeVisitor &nv);
         virtual bool supports(const osg::PrimitiveFunctor&) const { return true; }
         virtual void accept(osg::PrimitiveFunctor&) const;
@@ -72,26 +80,14 @@ namespace SceneUtil
         osg::Geometry* getGeometry(unsigned int frame) const;
 
         osg::ref_ptr<osg::Geometry> mSourceGeometry;
-        osg::ref_ptr<const osg::Vec4Array> mSourceTangents;
         Skeleton* mSkeleton;
 
         osg::ref_ptr<osg::RefMatrix> mGeomToSkelMatrix;
 
         osg::ref_ptr<InfluenceMap> mInfluenceMap;
 
-        typedef std::pair<std::string, osg::Matrixf> BoneBindMatrixPair;
-
-        typedef std::pair<BoneBindMatrixPair, float> BoneWeight;
-
-        typedef std::vector<unsigned short> VertexList;
-
-        typedef std::map<std::vector<BoneWeight>, VertexList> Bone2VertexMap;
-
-        struct Bone2VertexVector : public osg::Referenced
-        {
-            std::vector<std::pair<std::vector<BoneWeight>, VertexList>> mData;
-        };
-        osg::ref_ptr<Bone2VertexVector> mBone2VertexVector;
+        osg::ref_ptr<const SkinningData> mSkinningData;
+        std::vector<osg::Matrixf> mGroupMatrices;
 
         struct BoneSphereVector : public osg::Referenced
         {
@@ -99,12 +95,17 @@ namespace SceneUtil
         };
         osg::ref_ptr<BoneSphereVector> mBoneSphereVector;
         std::vector<Bone*> mBoneNodesVector;
+        std::vector<const osg::Matrixf*> mBoneMatrices;
 
         unsigned int mLastFrameNumber;
         bool mBoundsFirstFrame;
 
         bool initFromParentSkeleton(osg::NodeVisitor* nv);
 
+        void initSkinningData();
+
+        void waitForSkinning(unsigned int frame) const;
+
         void updateGeomToSkelMatrix(const osg::NodePath& nodePath);
     };
 
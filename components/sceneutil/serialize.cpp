@@ -8,6 +8,8 @@
 #include <components/sceneutil/riggeometry.hpp>
 #include <components/sceneutil/morphgeometry.hpp>
 
+#include <components/nifosg/userdata.hpp>
+
 namespace SceneUtil
 {
 
@@ -74,6 +76,42 @@ public:
     }
 };
 
+class NodeUserDataSerializer : public osgDB::ObjectWrapper
+{
+public:
+    NodeUserDataSerializer()
+        : osgDB::ObjectWrapper(createInstanceFunc<NifOsg::NodeUserData>, "NifOsg::NodeUserData", "osg::Object NifOsg::NodeUserData")
+    {
+        addSerializer( new osgDB::UserSerializer<NifOsg::NodeUserData>(
+            "transform", &hasTransform, &readTransform, &writeTransform), osgDB::BaseSerializer::RW_USER );
+    }
+
+private:
+    static bool hasTransform(const NifOsg::NodeUserData&)
+    {
+        return true;
+    }
+
+    static bool readTransform(osgDB::InputStream& is, NifOsg::NodeUserData& data)
+    {
+        is >> data.mIndex >> data.mScale;
+        for (auto& row : data.mRotationScale.mValues)
+            for (float& value : row)
+                is >> value;
+        return true;
+    }
+
+    static bool writeTransform(osgDB::OutputStream& os, const NifOsg::NodeUserData& data)
+    {
+        os << data.mIndex << data.mScale;
+        for (const auto& row : data.mRotationScale.mValues)
+            for (float value : row)
+                os << value;
+        os << std::endl;
+        return true;
+    }
+};
+
 osgDB::ObjectWrapper* makeDummySerializer(const std::string& classname)
 {
     return new osgDB::ObjectWrapper(createInstanceFunc<osg::DummyObject>, classname, "osg::Object");
@@ -100,10 +138,7 @@ void registerSerializers()
         mgr->addWrapper(new MorphGeometrySerializer);
         mgr->addWrapper(new LightManagerSerializer);
         mgr->addWrapper(new CameraRelativeTransformSerializer);
-
-        // Don't serialize Geometry data as we are more interested in the overall structure rather than tons of vertex data that would make the file large and hard to read.
-        mgr->removeWrapper(mgr->findWrapper("osg::Geometry"));
-        mgr->addWrapper(new GeometrySerializer);
+        mgr->addWrapper(new NodeUserDataSerializer);
 
         // ignore the below for now to avoid warning spam
         const char* ignore[] = {
@@ -115,7 +150,6 @@ void registerSerializers()
             "SceneUtil::UpdateRigGeometry",
             "SceneUtil::LightSource",
             "SceneUtil::StateSetUpdater",
-            "NifOsg::NodeUserData",
             "NifOsg::FlipController",
             "NifOsg::KeyframeController",
             "NifOsg::TextKeyMapHolder",
@@ -142,4 +176,28 @@ void registerSerializers()
     }
 }
 
+std::shared_timed_mutex& getSerializersMutex()
+{
+    static std::shared_timed_mutex mutex;
+    return mutex;
+}
+
+GeometryDataSkipper::GeometryDataSkipper()
+    : mLock(getSerializersMutex())
+{
+    osgDB::ObjectWrapperManager* mgr = osgDB::Registry::instance()->getObjectWrapperManager();
+    mGeometryWrapper = mgr->findWrapper("osg::Geometry");
+    if (mGeometryWrapper)
+        mgr->removeWrapper(mGeometryWrapper);
+    mgr->addWrapper(new GeometrySerializer);
+}
+
+GeometryDataSkipper::~GeometryDataSkipper()
+{
+    osgDB::ObjectWrapperManager* mgr = osgDB::Registry::instance()->getObjectWrapperManager();
+    mgr->removeWrapper(mgr->findWrapper("osg::Geometry"));
+    if (mGeometryWrapper)
+        mgr->addWrapper(mGeometryWrapper);
+}
+
 }
@@ -1,12 +1,44 @@
 #ifndef OPENMW_COMPONENTS_SCENEUTIL_SERIALIZE_H
 #define OPENMW_COMPONENTS_SCENEUTIL_SERIALIZE_H
 
+#include <osg/ref_ptr>
+
+#include <mutex>
+#include <shared_mutex>
+
+namespace osgDB
+{
+    class ObjectWrapper;
+}
+
 namespace SceneUtil
 {
 
-    /// Register osg node serializers for certain SceneUtil classes if not already done so
+    /// Register osg node serializers for certain SceneUtil and NifOsg classes if not already done so
     void registerSerializers();
 
+    /// Reading or writing a scene with the registered serializers, e.g. in the TemplateDiskCache, needs a shared lock
+    /// on this mutex, so that a GeometryDataSkipper doesn't swap the osg::Geometry serializer in the middle of it.
+    std::shared_timed_mutex& getSerializersMutex();
+
+    /// Don't serialize Geometry data while in scope, for scene dumps where we are more interested in the overall
+    /// structure rather than tons of vertex data that would make the file large and hard to read. The regular
+    /// serializer is restored afterwards, so that scenes written later on keep their vertex data. The serializers
+    /// mutex is held exclusively meanwhile.
+    class GeometryDataSkipper
+    {
+    public:
+        GeometryDataSkipper();
+        ~GeometryDataSkipper();
+
+        GeometryDataSkipper(const GeometryDataSkipper&) = delete;
+        GeometryDataSkipper& operator=(const GeometryDataSkipper&) = delete;
+
+    private:
+        std::unique_lock<std::shared_timed_mutex> mLock;
+        osg::ref_ptr<osgDB::ObjectWrapper> mGeometryWrapper;
+    };
+
 }
 
 #endif
@@ -0,0 +1,283 @@
+#include "skinning.hpp"
+
+#include <map>
+
+#include <osg/Geometry>
+
+#include <components/debug/debuglog.hpp>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define OPENMW_SKINNING_SSE2
+#include <emmintrin.h>
+#if defined(__FMA__) || defined(__AVX2__)
+#define OPENMW_SKINNING_FMA
+#include <immintrin.h>
+#endif
+#endif
+
+namespace
+{
+    struct SkinningStreams
+    {
+        const unsigned short* mVertices;
+        const osg::Vec3f* mSourcePositions;
+        const osg::Vec3f* mSourceNormals;
+        const osg::Vec4f* mSourceTangents;
+        osg::Vec3f* mPositions;
+        osg::Vec3f* mNormals;
+        osg::Vec4f* mTangents;
+    };
+
+    // The blended matrices are affine, so the vertices can be transformed without the perspective divide of preMult.
+    inline osg::Vec3f transformPoint(const float* m, float x, float y, float z)
+    {
+        return osg::Vec3f(x * m[0] + y * m[4] + z * m[8] + m[12],
+                          x * m[1] + y * m[5] + z * m[9] + m[13],
+                          x * m[2] + y * m[6] + z * m[10] + m[14]);
+    }
+
+    inline osg::Vec3f transformVector(const float* m, float x, float y, float z)
+    {
+        return osg::Vec3f(x * m[0] + y * m[4] + z * m[8],
+                          x * m[1] + y * m[5] + z * m[9],
+                          x * m[2] + y * m[6] + z * m[10]);
+    }
+
+    void skinScalar(const osg::Matrixf& matrix, std::size_t begin, std::size_t end, const SkinningStreams& streams)
+    {
+        const float* m = matrix.ptr();
+        for (std::size_t i = begin; i < end; ++i)
+        {
+            const unsigned short vertex = streams.mVertices[i];
+
+            const osg::Vec3f& position = streams.mSourcePositions[i];
+            streams.mPositions[vertex] = transformPoint(m, position.x(), position.y(), position.z());
+
+            if (streams.mNormals)
+            {
+                const osg::Vec3f& normal = streams.mSourceNormals[i];
+                streams.mNormals[vertex] = transformVector(m, normal.x(), normal.y(), normal.z());
+            }
+
+            if (streams.mTangents)
+            {
+                const osg::Vec4f& tangent = streams.mSourceTangents[i];
+                streams.mTangents[vertex] = osg::Vec4f(transformVector(m, tangent.x(), tangent.y(), tangent.z()), tangent.w());
+            }
+        }
+    }
+
+#ifdef OPENMW_SKINNING_SSE2
+    inline __m128 multiplyAdd(__m128 a, __m128 b, __m128 c)
+    {
+#ifdef OPENMW_SKINNING_FMA
+        return _mm_fmadd_ps(a, b, c);
+#else
+        return _mm_add_ps(_mm_mul_ps(a, b), c);
+#endif
+    }
+
+    // x * row0 + y * row1 + z * row2 + translation, one matrix row per register
+    inline __m128 transform(const float* v, __m128 row0, __m128 row1, __m128 row2, __m128 translation)
+    {
+        __m128 result = multiplyAdd(_mm_set1_ps(v[0]), row0, translation);
+        result = multiplyAdd(_mm_set1_ps(v[1]), row1, result);
+        return multiplyAdd(_mm_set1_ps(v[2]), row2, result);
+    }
+
+    // Write only three floats, the destination arrays are tightly packed
+    inline void store3(float* dst, __m128 value)
+    {
+        _mm_storel_pi(reinterpret_cast<__m64*>(dst), value);
+        _mm_store_ss(dst + 2, _mm_movehl_ps(value, value));
+    }
+
+    void skinSse2(const osg::Matrixf& matrix, std::size_t begin, std::size_t end, const SkinningStreams& streams)
+    {
+        const float* m = matrix.ptr();
+        const __m128 row0 = _mm_loadu_ps(m);
+        const __m128 row1 = _mm_loadu_ps(m + 4);
+        const __m128 row2 = _mm_loadu_ps(m + 8);
+        const __m128 translation = _mm_loadu_ps(m + 12);
+        const __m128 zero = _mm_setzero_ps();
+
+        for (std::size_t i = begin; i < end; ++i)
+        {
+            const unsigned short vertex = streams.mVertices[i];
+
+            store3(streams.mPositions[vertex].ptr(),
+                   transform(streams.mSourcePositions[i].ptr(), row0, row1, row2, translation));
+
+            if (streams.mNormals)
+                store3(streams.mNormals[vertex].ptr(), transform(streams.mSourceNormals[i].ptr(), row0, row1, row2, zero));
+
+            if (streams.mTangents)
+            {
+                const float* tangent = streams.mSourceTangents[i].ptr();
+                float* dst = streams.mTangents[vertex].ptr();
+                store3(dst, transform(tangent, row0, row1, row2, zero));
+                dst[3] = tangent[3];
+            }
+        }
+    }
+#endif
+
+    inline void accumulateMatrix(const osg::Matrixf& invBindMatrix, const osg::Matrixf& matrix, const float weight, osg::Matrixf& result)
+    {
+        osg::Matrixf m = invBindMatrix * matrix;
+        float* ptr = m.ptr();
+        float* ptrresult = result.ptr();
+        ptrresult[0] += ptr[0] * weight;
+        ptrresult[1] += ptr[1] * weight;
+        ptrresult[2] += ptr[2] * weight;
+
+        ptrresult[4] += ptr[4] * weight;
+        ptrresult[5] += ptr[5] * weight;
+        ptrresult[6] += ptr[6] * weight;
+
+        ptrresult[8] += ptr[8] * weight;
+        ptrresult[9] += ptr[9] * weight;
+        ptrresult[10] += ptr[10] * weight;
+
+        ptrresult[12] += ptr[12] * weight;
+        ptrresult[13] += ptr[13] * weight;
+        ptrresult[14] += ptr[14] * weight;
+    }
+}
+
+namespace SceneUtil
+{
+
+SkinningData::SkinningData(const std::vector<osg::Matrixf>& invBindMatrices, const std::vector<const VertexWeights*>& boneWeights,
+                           const osg::Geometry& source)
+    : mNumBones(static_cast<unsigned int>(boneWeights.size()))
+{
+    const osg::Vec3Array* positions = static_cast<const osg::Vec3Array*>(source.getVertexArray());
+    const osg::Vec3Array* normals = static_cast<const osg::Vec3Array*>(source.getNormalArray());
+    const osg::Vec4Array* tangents = dynamic_cast<const osg::Vec4Array*>(source.getTexCoordArray(7));
+    const std::size_t numVertices = positions ? positions->size() : 0;
+
+    // <bone, weight>, sorted by bone since bones are visited in order
+    typedef std::vector<std::pair<unsigned int, float>> BoneWeights;
+    std::map<unsigned short, BoneWeights> vertex2BoneMap;
+    for (unsigned int bone = 0; bone < mNumBones; ++bone)
+    {
+        for (const auto& weight : *boneWeights[bone])
+        {
+            if (weight.first >= numVertices)
+            {
+                Log(Debug::Error) << "Error: skinned vertex " << weight.first << " is out of range";
+                continue;
+            }
+            vertex2BoneMap[weight.first].emplace_back(bone, weight.second);
+        }
+    }
+
+    std::map<BoneWeights, std::vector<unsigned short>> bone2VertexMap;
+    for (const auto& vertexPair : vertex2BoneMap)
+        bone2VertexMap[vertexPair.second].push_back(vertexPair.first);
+
+    mGroups.reserve(bone2VertexMap.size());
+    mVertices.reserve(vertex2BoneMap.size());
+    for (const auto& groupPair : bone2VertexMap)
+    {
+        Group group;
+        group.mFirstInfluence = static_cast<unsigned int>(mInfluences.size());
+        group.mNumInfluences = static_cast<unsigned int>(groupPair.first.size());
+        group.mFirstVertex = static_cast<unsigned int>(mVertices.size());
+        group.mNumVertices = static_cast<unsigned int>(groupPair.second.size());
+        mGroups.push_back(group);
+
+        for (const auto& weight : groupPair.first)
+            mInfluences.push_back(Influence {weight.first, weight.second, invBindMatrices[weight.first]});
+
+        mVertices.insert(mVertices.end(), groupPair.second.begin(), groupPair.second.end());
+    }
+
+    mPositions.reserve(mVertices.size());
+    for (unsigned short vertex : mVertices)
+        mPositions.push_back((*positions)[vertex]);
+
+    if (normals && normals->size() >= numVertices)
+    {
+        mNormals.reserve(mVertices.size());
+        for (unsigned short vertex : mVertices)
+            mNormals.push_back((*normals)[vertex]);
+    }
+
+    if (tangents && tangents->size() >= numVertices)
+    {
+        mTangents.reserve(mVertices.size());
+        for (unsigned short vertex : mVertices)
+            mTangents.push_back((*tangents)[vertex]);
+    }
+}
+
+void SkinningData::computeGroupMatrices(const std::vector<const osg::Matrixf*>& boneMatrices, const osg::Matrix* geomToSkelMatrix,
+                                        std::vector<osg::Matrixf>& groupMatrices) const
+{
+    groupMatrices.resize(mGroups.size());
+    for (std::size_t i = 0; i < mGroups.size(); ++i)
+    {
+        const Group& group = mGroups[i];
+        osg::Matrixf& resultMat = groupMatrices[i];
+        resultMat.set(0, 0, 0, 0,
+                      0, 0, 0, 0,
+                      0, 0, 0, 0,
+                      0, 0, 0, 1);
+
+        for (unsigned int j = group.mFirstInfluence; j < group.mFirstInfluence + group.mNumInfluences; ++j)
+        {
+            const Influence& influence = mInfluences[j];
+            const osg::Matrixf* boneMatrix = boneMatrices[influence.mBone];
+            if (boneMatrix == nullptr)
+                continue;
+
+            accumulateMatrix(influence.mInvBindMatrix, *boneMatrix, influence.mWeight, resultMat);
+        }
+
+        if (geomToSkelMatrix)
+            resultMat *= *geomToSkelMatrix;
+    }
+}
+
+void SkinningData::skin(const std::vector<osg::Matrixf>& groupMatrices, osg::Vec3Array& positions, osg::Vec3Array* normals,
+                        osg::Vec4Array* tangents, bool vectorized) const
+{
+    if (mVertices.empty())
+        return;
+
+    SkinningStreams streams;
+    streams.mVertices = mVertices.data();
+    streams.mSourcePositions = mPositions.data();
+    streams.mSourceNormals = mNormals.data();
+    streams.mSourceTangents = mTangents.data();
+    streams.mPositions = &positions.front();
+    streams.mNormals = normals && hasNormals() && !normals->empty() ? &normals->front() : nullptr;
+    streams.mTangents = tangents && hasTangents() && !tangents->empty() ? &tangents->front() : nullptr;
+
+    void (*kernel)(const osg::Matrixf&, std::size_t, std::size_t, const SkinningStreams&) = skinScalar;
+#ifdef OPENMW_SKINNING_SSE2
+    if (vectorized)
+        kernel = skinSse2;
+#endif
+
+    for (std::size_t i = 0; i < mGroups.size(); ++i)
+    {
+        const Group& group = mGroups[i];
+        kernel(groupMatrices[i], group.mFirstVertex, group.mFirstVertex + group.mNumVertices, streams);
+    }
+}
+
+const char* SkinningData::getInstructionSet()
+{
+#if defined(OPENMW_SKINNING_FMA)
+    return "SSE2+FMA";
+#elif defined(OPENMW_SKINNING_SSE2)
+    return "SSE2";
+#else
+    return "scalar";
+#endif
+}
+
+}
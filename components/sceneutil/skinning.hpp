@@ -0,0 +1,89 @@
+#ifndef OPENMW_COMPONENTS_SCENEUTIL_SKINNING_H
+#define OPENMW_COMPONENTS_SCENEUTIL_SKINNING_H
+
+#include <osg/Array>
+#include <osg/Matrix>
+#include <osg/Matrixf>
+#include <osg/Referenced>
+
+#include <utility>
+#include <vector>
+
+namespace osg
+{
+    class Geometry;
+}
+
+namespace SceneUtil
+{
+
+    /// @brief Skinning data of a mesh, laid out for fast per-frame skinning.
+    /// @par Vertices influenced by the same bones with the same weights form a group, which is transformed by a single
+    /// blended matrix. Groups are stored in flat arrays, and the source vertex attributes are copied in group order,
+    /// so that skinning streams through memory and only the results are scattered to the vertex indices of the mesh.
+    /// @note Immutable once created, so it can be shared by all copies of a mesh and used from several threads.
+    class SkinningData : public osg::Referenced
+    {
+    public:
+        /// <vertex index, weight>
+        typedef std::vector<std::pair<unsigned short, float>> VertexWeights;
+
+        /// @param invBindMatrices The inverse bind matrix of each bone.
+        /// @param boneWeights The vertices influenced by each bone, in the same order as invBindMatrices.
+        /// @param source Geometry to take the source positions, normals and tangents (texture unit 7) from.
+        SkinningData(const std::vector<osg::Matrixf>& invBindMatrices, const std::vector<const VertexWeights*>& boneWeights,
+                     const osg::Geometry& source);
+
+        unsigned int getNumBones() const { return mNumBones; }
+        std::size_t getNumGroups() const { return mGroups.size(); }
+        std::size_t getNumVertices() const { return mVertices.size(); }
+
+        bool hasNormals() const { return !mNormals.empty(); }
+        bool hasTangents() const { return !mTangents.empty(); }
+
+        /// Blend the bone matrices of each group.
+        /// @param boneMatrices Skeleton space matrix of each bone, or nullptr for bones missing from the skeleton.
+        /// @param geomToSkelMatrix Optional transform from skeleton space to the space of the mesh.
+        /// @param groupMatrices Receives one matrix per group.
+        void computeGroupMatrices(const std::vector<const osg::Matrixf*>& boneMatrices, const osg::Matrix* geomToSkelMatrix,
+                                  std::vector<osg::Matrixf>& groupMatrices) const;
+
+        /// Transform the source vertices of each group by its matrix, and write them to the destination arrays.
+        /// @param normals May be nullptr, as may be tangents.
+        /// @param vectorized Use the SSE2 kernel, if it was compiled in. Only useful to disable for testing.
+        void skin(const std::vector<osg::Matrixf>& groupMatrices, osg::Vec3Array& positions, osg::Vec3Array* normals,
+                  osg::Vec4Array* tangents, bool vectorized = true) const;
+
+        /// Name of the instruction set used by the vectorized kernel, "scalar" if none is available.
+        static const char* getInstructionSet();
+
+    private:
+        struct Influence
+        {
+            unsigned int mBone;
+            float mWeight;
+            osg::Matrixf mInvBindMatrix;
+        };
+
+        struct Group
+        {
+            unsigned int mFirstInfluence;
+            unsigned int mNumInfluences;
+            unsigned int mFirstVertex;
+            unsigned int mNumVertices;
+        };
+
+        unsigned int mNumBones;
+        std::vector<Influence> mInfluences;
+        std::vector<Group> mGroups;
+
+        // Vertex index in the mesh and source attributes, all in group order
+        std::vector<unsigned short> mVertices;
+        std::vector<osg::Vec3f> mPositions;
+        std::vector<osg::Vec3f> mNormals;
+        std::vector<osg::Vec4f> mTangents;
+    };
+
+}
+
+#endif
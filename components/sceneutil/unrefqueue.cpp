@@ -26,7 +26,7 @@ namespace SceneUtil
         if (mWorkItem->mObjects.empty())
             return;
 
-        workQueue->addWorkItem(mWorkItem, true);
+        workQueue->addWorkItem(mWorkItem, SceneUtil::WorkPriority_Immediate);
 
         mWorkItem = new UnrefWorkItem;
     }
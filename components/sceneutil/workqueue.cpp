@@ -1,7 +1,16 @@
 #include "workqueue.hpp"
 
+#include <algorithm>
+
+#include <osg/Stats>
+
 #include <components/debug/debuglog.hpp>
 
+namespace
+{
+    const char* const sPriorityNames[SceneUtil::WorkPriority_Count] = {"Immediate", "Predicted", "Background"};
+}
+
 namespace SceneUtil
 {
 
@@ -27,6 +36,8 @@ void WorkItem::signalDone()
 }
 
 WorkItem::WorkItem()
+    : mCancelled(false)
+    , mPriority(WorkPriority_Predicted)
 {
 }
 
@@ -39,12 +50,37 @@ bool WorkItem::isDone() const
     return (mDone > 0);
 }
 
+void WorkItem::cancel()
+{
+    mCancelled = true;
+    abort();
+}
+
+bool WorkItem::isCancelled() const
+{
+    return mCancelled;
+}
+
+void WorkItem::setQueued(WorkPriority priority)
+{
+    mPriority = priority;
+    mQueuedTime = std::chrono::steady_clock::now();
+}
+
 WorkQueue::WorkQueue(int workerThreads)
     : mIsReleased(false)
+    , mNextQueue(0)
 {
+    for (auto& numItems : mNumItems)
+        numItems = 0;
+    mWaitTime.fill(0.0);
+
+    for (int i=0; i<std::max(workerThreads, 1); ++i)
+        mQueues.emplace_back(new ThreadQueue);
+
     for (int i=0; i<workerThreads; ++i)
     {
-        WorkThread* thread = new WorkThread(this);
+        WorkThread* thread = new WorkThread(this, i);
         mThreads.push_back(thread);
         thread->startThread();
     }
@@ -52,10 +88,18 @@ WorkQueue::WorkQueue(int workerThreads)
 
 WorkQueue::~WorkQueue()
 {
+    for (auto& queue : mQueues)
+    {
+        OpenThreads::ScopedLock<OpenThreads::Mutex> lock(queue->mMutex);
+        for (int priority = 0; priority < WorkPriority_Count; ++priority)
+        {
+            mNumItems[priority] -= queue->mItems[priority].size();
+            queue->mItems[priority].clear();
+        }
+    }
+
     {
         OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
-        while (!mQueue.empty())
-            mQueue.pop_back();
         mIsReleased = true;
         mCondition.broadcast();
     }
@@ -67,7 +111,7 @@ WorkQueue::~WorkQueue()
     }
 }
 
-void WorkQueue::addWorkItem(osg::ref_ptr<WorkItem> item, bool front)
+void WorkQueue::addWorkItem(osg::ref_ptr<WorkItem> item, WorkPriority priority)
 {
     if (item->isDone())
     {
@@ -75,35 +119,87 @@ void WorkQueue::addWorkItem(osg::ref_ptr<WorkItem> item, bool front)
         return;
     }
 
+    item->setQueued(priority);
+
+    ThreadQueue& queue = *mQueues[mNextQueue++ % mQueues.size()];
+    {
+        OpenThreads::ScopedLock<OpenThreads::Mutex> lock(queue.mMutex);
+        queue.mItems[priority].push_back(item);
+        ++mNumItems[priority];
+    }
+
+    // Notify while holding the lock, so a thread can't miss the item between checking the count and going to sleep
     OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
-    if (front)
-        mQueue.push_front(item);
-    else
-        mQueue.push_back(item);
     mCondition.signal();
 }
 
-osg::ref_ptr<WorkItem> WorkQueue::removeWorkItem()
+osg::ref_ptr<WorkItem> WorkQueue::takeWorkItem(ThreadQueue& queue, WorkPriority priority)
 {
-    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
-    while (mQueue.empty() && !mIsReleased)
-    {
-        mCondition.wait(&mMutex);
-    }
-    if (!mQueue.empty())
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(queue.mMutex);
+    std::deque<osg::ref_ptr<WorkItem> >& items = queue.mItems[priority];
+    if (items.empty())
+        return nullptr;
+    osg::ref_ptr<WorkItem> item = items.front();
+    items.pop_front();
+    --mNumItems[priority];
+    return item;
+}
+
+osg::ref_ptr<WorkItem> WorkQueue::removeWorkItem(std::size_t thread)
+{
+    while (true)
     {
-        osg::ref_ptr<WorkItem> item = mQueue.front();
-        mQueue.pop_front();
-        return item;
+        osg::ref_ptr<WorkItem> item;
+        for (int priority = 0; priority < WorkPriority_Count && !item; ++priority)
+        {
+            if (mNumItems[priority] == 0)
+                continue;
+            // Own queue first, then steal from the other threads
+            for (std::size_t i = 0; i < mQueues.size() && !item; ++i)
+                item = takeWorkItem(*mQueues[(thread + i) % mQueues.size()], static_cast<WorkPriority>(priority));
+        }
+
+        if (item)
+        {
+            if (item->isCancelled())
+            {
+                item->signalDone();
+                continue;
+            }
+            updateWaitTime(*item);
+            return item;
+        }
+
+        OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
+        while (getNumItems() == 0 && !mIsReleased)
+        {
+            mCondition.wait(&mMutex);
+        }
+        if (mIsReleased)
+            return nullptr;
     }
-    else
-        return nullptr;
+}
+
+void WorkQueue::updateWaitTime(const WorkItem& item)
+{
+    const double waitTime = std::chrono::duration<double, std::milli>(item.getWaitTime(std::chrono::steady_clock::now())).count();
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mWaitTimeMutex);
+    // Exponential moving average, so the stats follow recent changes in load without flickering
+    double& average = mWaitTime[item.getPriority()];
+    average += (waitTime - average) * 0.1;
 }
 
 unsigned int WorkQueue::getNumItems() const
 {
-    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
-    return mQueue.size();
+    unsigned int count = 0;
+    for (const auto& numItems : mNumItems)
+        count += numItems;
+    return count;
+}
+
+unsigned int WorkQueue::getNumItems(WorkPriority priority) const
+{
+    return mNumItems[priority];
 }
 
 unsigned int WorkQueue::getNumActiveThreads() const
@@ -117,8 +213,22 @@ unsigned int WorkQueue::getNumActiveThreads() const
     return count;
 }
 
-WorkThread::WorkThread(WorkQueue *workQueue)
+void WorkQueue::reportStats(unsigned int frameNumber, osg::Stats& stats) const
+{
+    stats.setAttribute(frameNumber, "WorkQueue", getNumItems());
+    stats.setAttribute(frameNumber, "WorkThread", getNumActiveThreads());
+
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mWaitTimeMutex);
+    for (int priority = 0; priority < WorkPriority_Count; ++priority)
+    {
+        stats.setAttribute(frameNumber, std::string("Work ") + sPriorityNames[priority], mNumItems[priority]);
+        stats.setAttribute(frameNumber, std::string("Wait ") + sPriorityNames[priority], mWaitTime[priority]);
+    }
+}
+
+WorkThread::WorkThread(WorkQueue *workQueue, std::size_t index)
     : mWorkQueue(workQueue)
+    , mIndex(index)
     , mActive(false)
 {
 }
@@ -127,7 +237,7 @@ void WorkThread::run()
 {
     while (true)
     {
-        osg::ref_ptr<WorkItem> item = mWorkQueue->removeWorkItem();
+        osg::ref_ptr<WorkItem> item = mWorkQueue->removeWorkItem(mIndex);
         if (!item)
             return;
         mActive = true;
@@ -9,12 +9,31 @@
 #include <osg/Referenced>
 #include <osg/ref_ptr>
 
+#include <array>
 #include <atomic>
-#include <queue>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <vector>
+
+namespace osg
+{
+    class Stats;
+}
 
 namespace SceneUtil
 {
 
+    /// Priority of a work item. Items with a lower value are always started first.
+    enum WorkPriority
+    {
+        WorkPriority_Immediate = 0, ///< Needed right now, e.g. the cell the player is in when loading a game, or freeing memory
+        WorkPriority_Predicted = 1, ///< Likely to be needed soon, e.g. cells the player is walking towards
+        WorkPriority_Background = 2, ///< Speculative or not time critical, e.g. destinations of nearby doors, the global map
+
+        WorkPriority_Count
+    };
+
     class WorkItem : public osg::Referenced
     {
     public:
@@ -35,16 +54,36 @@ namespace SceneUtil
         /// Set abort flag in order to return from doWork() as soon as possible. May not be respected by all WorkItems.
         virtual void abort() {}
 
+        /// Drop the item if it has not been started yet, or abort() it otherwise. Dropped items are still signalled done.
+        void cancel();
+
+        bool isCancelled() const;
+
+        /// Internal use by the WorkQueue.
+        void setQueued(WorkPriority priority);
+
+        WorkPriority getPriority() const { return mPriority; }
+
+        /// Time spent in the queue, valid once the item has been started.
+        std::chrono::steady_clock::duration getWaitTime(std::chrono::steady_clock::time_point now) const { return now - mQueuedTime; }
+
     protected:
         OpenThreads::Atomic mDone;
         OpenThreads::Mutex mMutex;
         OpenThreads::Condition mCondition;
+
+    private:
+        std::atomic<bool> mCancelled;
+        WorkPriority mPriority;
+        std::chrono::steady_clock::time_point mQueuedTime;
     };
 
     class WorkThread;
 
     /// @brief A work queue that users can push work items onto, to be completed by one or more background threads.
-    /// @note Work items will be processed in the order that they were given in, however
+    /// @par Each work thread has its own queue per priority. New items are spread over the threads, and a thread that
+    /// runs out of work steals from the others, so items of a higher priority are always started before lower ones.
+    /// @note Work items of the same priority will be processed in the order that they were given in, however
     /// if multiple work threads are involved then it is possible for a later item to complete before earlier items.
     class WorkQueue : public osg::Referenced
     {
@@ -52,27 +91,51 @@ namespace SceneUtil
         WorkQueue(int numWorkerThreads=1);
         ~WorkQueue();
 
-        /// Add a new work item to the back of the queue.
+        /// Add a new work item to the back of the queue of its priority.
         /// @par The work item's waitTillDone() method may be used by the caller to wait until the work is complete.
-        /// @param front If true, add item to the front of the queue. If false (default), add to the back.
-        void addWorkItem(osg::ref_ptr<WorkItem> item, bool front=false);
+        /// Use WorkItem::cancel() to drop the item if it is no longer needed.
+        void addWorkItem(osg::ref_ptr<WorkItem> item, WorkPriority priority=WorkPriority_Predicted);
 
-        /// Get the next work item from the front of the queue. If the queue is empty, waits until a new item is added.
+        /// Get the next work item with the highest priority, from the queue of the given thread if possible, or else
+        /// from the queue of another thread. If there is no item, waits until a new item is added.
+        /// Cancelled items are signalled done and skipped.
         /// If the workqueue is in the process of being destroyed, may return nullptr.
         /// @par Used internally by the WorkThread.
-        osg::ref_ptr<WorkItem> removeWorkItem();
+        osg::ref_ptr<WorkItem> removeWorkItem(std::size_t thread);
 
         unsigned int getNumItems() const;
 
+        unsigned int getNumItems(WorkPriority priority) const;
+
         unsigned int getNumActiveThreads() const;
 
+        /// Report the number of queued items and the average time items spent in the queue (in milliseconds) per priority.
+        void reportStats(unsigned int frameNumber, osg::Stats& stats) const;
+
     private:
+        struct ThreadQueue
+        {
+            OpenThreads::Mutex mMutex;
+            std::array<std::deque<osg::ref_ptr<WorkItem> >, WorkPriority_Count> mItems;
+        };
+
+        osg::ref_ptr<WorkItem> takeWorkItem(ThreadQueue& queue, WorkPriority priority);
+
+        void updateWaitTime(const WorkItem& item);
+
         bool mIsReleased;
-        std::deque<osg::ref_ptr<WorkItem> > mQueue;
 
+        std::vector<std::unique_ptr<ThreadQueue> > mQueues;
+        std::array<std::atomic<unsigned int>, WorkPriority_Count> mNumItems;
+        std::atomic<std::size_t> mNextQueue;
+
+        // Only used to let idle threads sleep until new items are added
         mutable OpenThreads::Mutex mMutex;
         OpenThreads::Condition mCondition;
 
+        mutable OpenThreads::Mutex mWaitTimeMutex;
+        std::array<double, WorkPriority_Count> mWaitTime;
+
         std::vector<WorkThread*> mThreads;
     };
 
@@ -80,7 +143,7 @@ namespace SceneUtil
     class WorkThread : public OpenThreads::Thread
     {
     public:
-        WorkThread(WorkQueue* workQueue);
+        WorkThread(WorkQueue* workQueue, std::size_t index);
 
         virtual void run();
 
@@ -88,6 +151,7 @@ namespace SceneUtil
 
     private:
         WorkQueue* mWorkQueue;
+        std::size_t mIndex;
         std::atomic<bool> mActive;
     };
 
@@ -22,5 +22,6 @@ void SceneUtil::writeScene(osg::Node *node, const std::string& filename, const s
     osg::ref_ptr<osgDB::Options> options = new osgDB::Options;
     options->setPluginStringData("fileType", format);
 
+    const GeometryDataSkipper skipGeometryData;
     rw->writeNode(*node, stream, options);
 }
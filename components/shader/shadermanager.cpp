@@ -11,6 +11,7 @@
 
 #include <components/debug/debuglog.hpp>
 #include <components/misc/stringops.hpp>
+#include <components/sceneutil/instancing.hpp>
 
 namespace Shader
 {
@@ -330,6 +331,9 @@ namespace Shader
             osg::ref_ptr<osg::Program> program (new osg::Program);
             program->addShader(vertexShader);
             program->addShader(fragmentShader);
+            // Instanced geometry passes the instance transforms as generic attributes, other shaders do not declare them
+            program->addBindAttribLocation("instanceOffset", SceneUtil::InstanceAttribute_Offset);
+            program->addBindAttribLocation("instanceRotation", SceneUtil::InstanceAttribute_Rotation);
             found = mPrograms.insert(std::make_pair(std::make_pair(vertexShader, fragmentShader), program)).first;
         }
         return found->second;
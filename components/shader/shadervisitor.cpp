@@ -10,6 +10,7 @@
 #include <components/misc/stringops.hpp>
 #include <components/resource/imagemanager.hpp>
 #include <components/vfs/manager.hpp>
+#include <components/sceneutil/instancing.hpp>
 #include <components/sceneutil/riggeometry.hpp>
 #include <components/sceneutil/morphgeometry.hpp>
 #include <components/settings/settings.hpp>
@@ -25,6 +26,7 @@ namespace Shader
         , mMaterialOverridden(false)
         , mNormalHeight(false)
         , mTexStageRequiringTangents(-1)
+        , mInstanced(false)
         , mNode(nullptr)
     {
     }
@@ -308,6 +310,7 @@ namespace Shader
         }
 
         defineMap["parallax"] = reqs.mNormalHeight ? "1" : "0";
+        defineMap["instancing"] = reqs.mInstanced ? "1" : "0";
 
         writableStateSet->addUniform(new osg::Uniform("colorMode", reqs.mColorMode));
 
@@ -316,7 +319,10 @@ namespace Shader
 
         if (vertexShader && fragmentShader)
         {
-            writableStateSet->setAttributeAndModes(mShaderManager.getProgram(vertexShader, fragmentShader), osg::StateAttribute::ON);
+            // The shadow casting program overrides the scene's, which would draw all instances at the first one
+            const unsigned int programValue = reqs.mInstanced ? osg::StateAttribute::ON | osg::StateAttribute::PROTECTED
+                                                              : osg::StateAttribute::ON;
+            writableStateSet->setAttributeAndModes(mShaderManager.getProgram(vertexShader, fragmentShader), programValue);
 
             for (std::map<int, std::string>::const_iterator texIt = reqs.mTextures.begin(); texIt != reqs.mTextures.end(); ++texIt)
             {
@@ -357,11 +363,19 @@ namespace Shader
 
     void ShaderVisitor::apply(osg::Geometry& geometry)
     {
-        bool needPop = (geometry.getStateSet() != nullptr);
-        if (geometry.getStateSet()) // TODO: check if stateset affects shader permutation before pushing it
+        const bool instanced = geometry.getVertexAttribArray(SceneUtil::InstanceAttribute_Offset) != nullptr;
+        bool needPop = (geometry.getStateSet() != nullptr || instanced);
+        if (needPop) // TODO: check if stateset affects shader permutation before pushing it
         {
             pushRequirements(geometry);
-            applyStateSet(geometry.getStateSet(), geometry);
+            if (geometry.getStateSet())
+                applyStateSet(geometry.getStateSet(), geometry);
+            if (instanced)
+            {
+                // Only shaders can read the instance transforms
+                mRequirements.back().mInstanced = true;
+                mRequirements.back().mShaderRequired = true;
+            }
         }
 
         if (!mRequirements.empty())
@@ -80,6 +80,9 @@ namespace Shader
             // -1 == no tangents required
             int mTexStageRequiringTangents;
 
+            // the geometry is drawn once per instance, see SceneUtil::createInstances
+            bool mInstanced;
+
             // the Node that requested these requirements
             osg::Node* mNode;
         };
@@ -0,0 +1,239 @@
+#include "chunkdiskcache.hpp"
+
+#include <components/debug/debuglog.hpp>
+#include <components/misc/stablehash.hpp>
+#include <components/vfs/archive.hpp>
+#include <components/vfs/manager.hpp>
+
+#include <boost/filesystem/operations.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace
+{
+    const char sMagic[] = {'O', 'M', 'W', 'T', 'E', 'R', 'R', 'N'};
+
+    // Increment when the file layout or the way chunks and composite maps are built changes
+    const std::uint32_t sFormatVersion = 1;
+
+    const char sExtension[] = ".chunk";
+
+    template <class T>
+    void append(std::vector<char>& buffer, const T* data, std::size_t count)
+    {
+        const auto bytes = reinterpret_cast<const char*>(data);
+        buffer.insert(buffer.end(), bytes, bytes + count * sizeof(T));
+    }
+
+    template <class T>
+    void append(std::vector<char>& buffer, const T& value)
+    {
+        append(buffer, &value, 1);
+    }
+
+    /// Reads the payload of an entry, throws when it is shorter than it claims to be
+    class PayloadReader
+    {
+    public:
+        explicit PayloadReader(const std::vector<char>& buffer) : mBuffer(buffer), mOffset(0) {}
+
+        template <class T>
+        void read(T* data, std::size_t count)
+        {
+            const std::size_t size = count * sizeof(T);
+            if (mBuffer.size() - mOffset < size)
+                throw std::runtime_error("unexpected end of file");
+            std::memcpy(data, mBuffer.data() + mOffset, size);
+            mOffset += size;
+        }
+
+        template <class T>
+        T read()
+        {
+            T value;
+            read(&value, 1);
+            return value;
+        }
+
+    private:
+        const std::vector<char>& mBuffer;
+        std::size_t mOffset;
+    };
+}
+
+namespace Terrain
+{
+
+ChunkDiskCache::ChunkDiskCache(const boost::filesystem::path& path, std::size_t maxSize, std::uint64_t contentHash,
+                               std::uint64_t texturesHash)
+    : mCache(path, maxSize, sMagic, sFormatVersion, sExtension, "terrain chunk")
+    , mContentHash(contentHash)
+{
+    Misc::StableHash compositeMapHash;
+    compositeMapHash.add(contentHash);
+    compositeMapHash.add(texturesHash);
+    mCompositeMapHash = compositeMapHash.getValue();
+}
+
+std::uint64_t ChunkDiskCache::makeContentHash(const std::vector<boost::filesystem::path>& contentFiles)
+{
+    Misc::StableHash hash;
+    for (const boost::filesystem::path& file : contentFiles)
+    {
+        hash.add(file.filename().string());
+        boost::system::error_code error;
+        const std::uint64_t size = boost::filesystem::file_size(file, error);
+        hash.add(error ? std::uint64_t(0) : size);
+        const std::int64_t time = static_cast<std::int64_t>(boost::filesystem::last_write_time(file, error));
+        hash.add(error ? std::int64_t(0) : time);
+    }
+    return hash.getValue();
+}
+
+std::uint64_t ChunkDiskCache::makeTexturesHash(const VFS::Manager& vfs, std::vector<std::string> textures)
+{
+    for (std::string& texture : textures)
+        vfs.normalizeFilename(texture);
+    std::sort(textures.begin(), textures.end());
+    textures.erase(std::unique(textures.begin(), textures.end()), textures.end());
+
+    Misc::StableHash hash;
+    const std::map<std::string, VFS::File*>& index = vfs.getIndex();
+    for (const std::string& texture : textures)
+    {
+        const std::string stem = texture.substr(0, texture.rfind('.'));
+        for (auto it = index.lower_bound(stem); it != index.end() && it->first.compare(0, stem.size(), stem) == 0; ++it)
+        {
+            hash.add(it->first);
+            hash.add(it->second->getStamp());
+        }
+    }
+    return hash.getValue();
+}
+
+bool ChunkDiskCache::getVertexBuffers(int lodLevel, float size, const osg::Vec2f& center, osg::Vec3Array& positions,
+                                      osg::Vec3Array& normals, osg::Vec4ubArray& colours)
+{
+    const Key key = makeKey('v', mContentHash, size, center, static_cast<std::uint32_t>(lodLevel));
+    const std::vector<char> payload = mCache.read(key.mName, key.mCheckHash);
+    if (payload.empty())
+        return false;
+
+    try
+    {
+        PayloadReader reader(payload);
+        const std::uint32_t count = reader.read<std::uint32_t>();
+        if (count == 0)
+            throw std::runtime_error("empty chunk");
+        std::vector<osg::Vec3f> newPositions(count);
+        std::vector<osg::Vec3f> newNormals(count);
+        std::vector<osg::Vec4ub> newColours(count);
+        reader.read(newPositions.data(), count);
+        reader.read(newNormals.data(), count);
+        reader.read(newColours.data(), count);
+        positions.asVector().swap(newPositions);
+        normals.asVector().swap(newNormals);
+        colours.asVector().swap(newColours);
+        return true;
+    }
+    catch (const std::exception& e)
+    {
+        Log(Debug::Warning) << "Warning: failed to read terrain chunk " << (mCache.getPath() / key.mName) << ": "
+            << e.what();
+        mCache.discard(key.mName);
+        return false;
+    }
+}
+
+void ChunkDiskCache::setVertexBuffers(int lodLevel, float size, const osg::Vec2f& center, const osg::Vec3Array& positions,
+                                      const osg::Vec3Array& normals, const osg::Vec4ubArray& colours)
+{
+    const std::uint32_t count = positions.size();
+    if (count == 0 || normals.size() != count || colours.size() != count)
+        return;
+
+    std::vector<char> payload;
+    payload.reserve(sizeof(count) + count * (2 * sizeof(osg::Vec3f) + sizeof(osg::Vec4ub)));
+    append(payload, count);
+    append(payload, static_cast<const osg::Vec3f*>(positions.getDataPointer()), count);
+    append(payload, static_cast<const osg::Vec3f*>(normals.getDataPointer()), count);
+    append(payload, static_cast<const osg::Vec4ub*>(colours.getDataPointer()), count);
+
+    const Key key = makeKey('v', mContentHash, size, center, static_cast<std::uint32_t>(lodLevel));
+    mCache.write(key.mName, key.mCheckHash, payload.data(), payload.size());
+}
+
+osg::ref_ptr<osg::Image> ChunkDiskCache::getCompositeMap(float size, const osg::Vec2f& center, unsigned int resolution)
+{
+    const Key key = makeKey('c', mCompositeMapHash, size, center, resolution);
+    const std::vector<char> payload = mCache.read(key.mName, key.mCheckHash);
+    if (payload.empty())
+        return nullptr;
+
+    try
+    {
+        PayloadReader reader(payload);
+        const std::uint32_t width = reader.read<std::uint32_t>();
+        const std::uint32_t height = reader.read<std::uint32_t>();
+        if (width != resolution || height != resolution)
+            throw std::runtime_error("invalid composite map size");
+        osg::ref_ptr<osg::Image> image (new osg::Image);
+        image->allocateImage(width, height, 1, GL_RGB, GL_UNSIGNED_BYTE);
+        reader.read(image->data(), image->getTotalSizeInBytes());
+        return image;
+    }
+    catch (const std::exception& e)
+    {
+        Log(Debug::Warning) << "Warning: failed to read terrain composite map " << (mCache.getPath() / key.mName) << ": "
+            << e.what();
+        mCache.discard(key.mName);
+        return nullptr;
+    }
+}
+
+void ChunkDiskCache::setCompositeMap(float size, const osg::Vec2f& center, const osg::Image& image)
+{
+    if (image.getPixelFormat() != GL_RGB || image.getDataType() != GL_UNSIGNED_BYTE || image.s() != image.t()
+            || image.r() != 1 || image.getPacking() != 1)
+        return;
+
+    const std::uint32_t width = image.s();
+    const std::uint32_t height = image.t();
+
+    std::vector<char> payload;
+    payload.reserve(sizeof(width) + sizeof(height) + image.getTotalSizeInBytes());
+    append(payload, width);
+    append(payload, height);
+    append(payload, image.data(), image.getTotalSizeInBytes());
+
+    const Key key = makeKey('c', mCompositeMapHash, size, center, width);
+    mCache.write(key.mName, key.mCheckHash, payload.data(), payload.size());
+}
+
+void ChunkDiskCache::reportStats(unsigned int frameNumber, osg::Stats* stats) const
+{
+    mCache.reportStats(frameNumber, *stats, "Terrain");
+}
+
+ChunkDiskCache::Key ChunkDiskCache::makeKey(char kind, std::uint64_t sourceHash, float size, const osg::Vec2f& center,
+                                            std::uint32_t detail) const
+{
+    const auto makeHash = [&] (std::uint64_t offsetBasis)
+    {
+        Misc::StableHash hash(offsetBasis);
+        hash.add(sourceHash);
+        hash.add(kind);
+        hash.add(size);
+        hash.add(center.x());
+        hash.add(center.y());
+        hash.add(detail);
+        return hash.getValue();
+    };
+
+    return Key {mCache.makeName(makeHash(Misc::StableHash::sOffsetBasis)),
+                makeHash(Misc::StableHash::sAlternativeOffsetBasis)};
+}
+
+}
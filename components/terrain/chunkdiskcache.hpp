@@ -0,0 +1,83 @@
+#ifndef OPENMW_COMPONENTS_TERRAIN_CHUNKDISKCACHE_H
+#define OPENMW_COMPONENTS_TERRAIN_CHUNKDISKCACHE_H
+
+#include <components/misc/diskcache.hpp>
+
+#include <osg/Array>
+#include <osg/Image>
+#include <osg/ref_ptr>
+#include <osg/Vec2f>
+
+#include <boost/filesystem/path.hpp>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace osg
+{
+    class Stats;
+}
+
+namespace VFS
+{
+    class Manager;
+}
+
+namespace Terrain
+{
+
+    /// @brief Terrain LOD vertex buffers and rendered composite maps persisted between sessions
+    /// @par Entries are files named by a hash of the content fingerprint, the chunk size and center, and the lod or
+    /// the composite map resolution. Composite maps also depend on the fingerprint of the layer textures. Starting a
+    /// game with other content files or changed ones gives other names, the old entries are then only removed as least
+    /// recently used when the total size exceeds the limit.
+    /// @note Thread safe.
+    class ChunkDiskCache
+    {
+    public:
+        ChunkDiskCache(const boost::filesystem::path& path, std::size_t maxSize, std::uint64_t contentHash,
+                       std::uint64_t texturesHash);
+
+        /// Fingerprint of the content files from their names, sizes and modification times, which is enough to notice
+        /// an edited or replaced file without reading hundreds of megabytes on every startup.
+        static std::uint64_t makeContentHash(const std::vector<boost::filesystem::path>& contentFiles);
+
+        /// Fingerprint of the files the layer textures are read from. The names and stamps of the files sharing the
+        /// stem of a texture name notice an added replacer or an edited texture or specular map variant whatever the
+        /// pattern of the variant is, files unrelated to the textures don't change it.
+        /// @param textures names of the land textures as found in the VFS, they don't need to be normalized
+        static std::uint64_t makeTexturesHash(const VFS::Manager& vfs, std::vector<std::string> textures);
+
+        /// @return false when the chunk is not cached, the arrays are left unchanged then
+        bool getVertexBuffers(int lodLevel, float size, const osg::Vec2f& center, osg::Vec3Array& positions,
+                              osg::Vec3Array& normals, osg::Vec4ubArray& colours);
+
+        void setVertexBuffers(int lodLevel, float size, const osg::Vec2f& center, const osg::Vec3Array& positions,
+                              const osg::Vec3Array& normals, const osg::Vec4ubArray& colours);
+
+        /// @return RGB image of the composite map, nullptr when it is not cached
+        osg::ref_ptr<osg::Image> getCompositeMap(float size, const osg::Vec2f& center, unsigned int resolution);
+
+        void setCompositeMap(float size, const osg::Vec2f& center, const osg::Image& image);
+
+        void reportStats(unsigned int frameNumber, osg::Stats* stats) const;
+
+    private:
+        struct Key
+        {
+            std::string mName;
+            std::uint64_t mCheckHash;
+        };
+
+        Misc::DiskCache mCache;
+        std::uint64_t mContentHash;
+        std::uint64_t mCompositeMapHash;
+
+        Key makeKey(char kind, std::uint64_t sourceHash, float size, const osg::Vec2f& center,
+                    std::uint32_t detail) const;
+    };
+
+}
+
+#endif
@@ -18,6 +18,7 @@
 #include "storage.hpp"
 #include "texturemanager.hpp"
 #include "compositemaprenderer.hpp"
+#include "chunkdiskcache.hpp"
 
 namespace Terrain
 {
@@ -31,27 +32,24 @@ ChunkManager::ChunkManager(Storage *storage, Resource::SceneManager *sceneMgr, T
     , mCompositeMapSize(512)
     , mCompositeMapLevel(1.f)
     , mMaxCompGeometrySize(1.f)
+    , mNodeMask(~0u)
 {
 
 }
 
 osg::ref_ptr<osg::Node> ChunkManager::getChunk(float size, const osg::Vec2f &center, unsigned char lod, unsigned int lodFlags)
 {
-    ChunkId id = std::make_tuple(center, lod, lodFlags);
-    osg::ref_ptr<osg::Object> obj = mCache->getRefFromObjectCache(id);
-    if (obj)
-        return obj->asNode();
-    else
-    {
-        osg::ref_ptr<osg::Node> node = createChunk(size, center, lod, lodFlags);
-        mCache->addEntryToObjectCache(id, node.get());
-        return node;
-    }
+    const ChunkId id = std::make_tuple(center, lod, lodFlags);
+    const osg::ref_ptr<osg::Object> obj = mBuildOnce.get(*mCache, id,
+        [&] { return osg::ref_ptr<osg::Object>(createChunk(size, center, lod, lodFlags)); });
+    return obj->asNode();
 }
 
 void ChunkManager::reportStats(unsigned int frameNumber, osg::Stats *stats) const
 {
     stats->setAttribute(frameNumber, "Terrain Chunk", mCache->getCacheSize());
+    if (mDiskCache)
+        mDiskCache->reportStats(frameNumber, stats);
 }
 
 void ChunkManager::clearCache()
@@ -166,6 +164,7 @@ osg::ref_ptr<osg::Node> ChunkManager::createChunk(float chunkSize, const osg::Ve
     osg::Vec2f worldCenter = chunkCenter*mStorage->getCellWorldSize();
     osg::ref_ptr<SceneUtil::PositionAttitudeTransform> transform (new SceneUtil::PositionAttitudeTransform);
     transform->setPosition(osg::Vec3f(worldCenter.x(), worldCenter.y(), 0.f));
+    transform->setNodeMask(mNodeMask);
 
     osg::ref_ptr<osg::Vec3Array> positions (new osg::Vec3Array);
     osg::ref_ptr<osg::Vec3Array> normals (new osg::Vec3Array);
@@ -177,7 +176,12 @@ osg::ref_ptr<osg::Node> ChunkManager::createChunk(float chunkSize, const osg::Ve
     normals->setVertexBufferObject(vbo);
     colors->setVertexBufferObject(vbo);
 
-    mStorage->fillVertexBuffers(lod, chunkSize, chunkCenter, positions, normals, colors);
+    if (!mDiskCache || !mDiskCache->getVertexBuffers(lod, chunkSize, chunkCenter, *positions, *normals, *colors))
+    {
+        mStorage->fillVertexBuffers(lod, chunkSize, chunkCenter, positions, normals, colors);
+        if (mDiskCache)
+            mDiskCache->setVertexBuffers(lod, chunkSize, chunkCenter, *positions, *normals, *colors);
+    }
 
     osg::ref_ptr<TerrainDrawable> geometry (new TerrainDrawable);
     geometry->setVertexArray(positions);
@@ -205,13 +209,28 @@ osg::ref_ptr<osg::Node> ChunkManager::createChunk(float chunkSize, const osg::Ve
     {
         osg::ref_ptr<CompositeMap> compositeMap = new CompositeMap;
         compositeMap->mTexture = createCompositeMapRTT();
+        compositeMap->mChunkSize = chunkSize;
+        compositeMap->mChunkCenter = chunkCenter;
 
-        createCompositeMapGeometry(chunkSize, chunkCenter, osg::Vec4f(0,0,1,1), *compositeMap);
+        osg::ref_ptr<osg::Image> cachedImage;
+        if (mDiskCache)
+            cachedImage = mDiskCache->getCompositeMap(chunkSize, chunkCenter, mCompositeMapSize);
 
-        mCompositeMapRenderer->addCompositeMap(compositeMap.get(), false);
+        if (cachedImage)
+        {
+            // nothing left to render, the image is dropped once it is uploaded
+            compositeMap->mTexture->setImage(cachedImage);
+            compositeMap->mTexture->setUnRefImageDataAfterApply(true);
+        }
+        else
+        {
+            createCompositeMapGeometry(chunkSize, chunkCenter, osg::Vec4f(0,0,1,1), *compositeMap);
 
-        geometry->setCompositeMap(compositeMap);
-        geometry->setCompositeMapRenderer(mCompositeMapRenderer);
+            mCompositeMapRenderer->addCompositeMap(compositeMap.get(), false);
+
+            geometry->setCompositeMap(compositeMap);
+            geometry->setCompositeMapRenderer(mCompositeMapRenderer);
+        }
 
         TextureLayer layer;
         layer.mDiffuseMap = compositeMap->mTexture;
@@ -1,8 +1,10 @@
 #ifndef OPENMW_COMPONENTS_TERRAIN_CHUNKMANAGER_H
 #define OPENMW_COMPONENTS_TERRAIN_CHUNKMANAGER_H
 
+#include <memory>
 #include <tuple>
 
+#include <components/resource/buildonce.hpp>
 #include <components/resource/resourcemanager.hpp>
 
 #include "buffercache.hpp"
@@ -25,6 +27,7 @@ namespace Terrain
     class CompositeMapRenderer;
     class Storage;
     class CompositeMap;
+    class ChunkDiskCache;
 
     typedef std::tuple<osg::Vec2f, unsigned char, unsigned int> ChunkId; // Center, Lod, Lod Flags
 
@@ -35,10 +38,15 @@ namespace Terrain
         ChunkManager(Storage* storage, Resource::SceneManager* sceneMgr, TextureManager* textureManager, CompositeMapRenderer* renderer);
 
         osg::ref_ptr<osg::Node> getChunk(float size, const osg::Vec2f& center, unsigned char lod, unsigned int lodFlags);
+        ///< @note Thread safe. A chunk requested while another thread is building it waits for that build instead of building it again.
 
         void setCompositeMapSize(unsigned int size) { mCompositeMapSize = size; }
         void setCompositeMapLevel(float level) { mCompositeMapLevel = level; }
         void setMaxCompositeGeometrySize(float maxCompGeometrySize) { mMaxCompGeometrySize = maxCompGeometrySize; }
+        /// Node mask of new chunks, so that they stay hidden from traversals that only enter the terrain root for other nodes
+        void setNodeMask(unsigned int nodeMask) { mNodeMask = nodeMask; }
+        /// Take vertex buffers and composite maps of new chunks from this cache when possible, and store the built vertex buffers in it
+        void setDiskCache(std::shared_ptr<ChunkDiskCache> diskCache) { mDiskCache = diskCache; }
 
         void reportStats(unsigned int frameNumber, osg::Stats* stats) const override;
 
@@ -64,6 +72,11 @@ namespace Terrain
         unsigned int mCompositeMapSize;
         float mCompositeMapLevel;
         float mMaxCompGeometrySize;
+        unsigned int mNodeMask;
+
+        std::shared_ptr<ChunkDiskCache> mDiskCache;
+
+        Resource::BuildOnce<ChunkId> mBuildOnce;
     };
 
 }
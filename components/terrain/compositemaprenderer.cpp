@@ -2,7 +2,9 @@
 
 #include <OpenThreads/ScopedLock>
 
+#include <osg/BufferObject>
 #include <osg/FrameBufferObject>
+#include <osg/Image>
 #include <osg/Texture2D>
 #include <osg/RenderInfo>
 
@@ -10,6 +12,37 @@
 #include <components/sceneutil/workqueue.hpp>
 
 #include <algorithm>
+#include <cstring>
+
+#include "chunkdiskcache.hpp"
+
+namespace
+{
+
+    /// Frames to wait before mapping a pixel buffer object, by then the GPU has finished the copy
+    const unsigned int sReadbackLatency = 2;
+
+    class StoreCompositeMapWorkItem : public SceneUtil::WorkItem
+    {
+    public:
+        StoreCompositeMapWorkItem(std::shared_ptr<Terrain::ChunkDiskCache> diskCache, float chunkSize, const osg::Vec2f& chunkCenter, osg::Image* image)
+            : mDiskCache(diskCache), mChunkSize(chunkSize), mChunkCenter(chunkCenter), mImage(image)
+        {
+        }
+
+        virtual void doWork()
+        {
+            mDiskCache->setCompositeMap(mChunkSize, mChunkCenter, *mImage);
+        }
+
+    private:
+        std::shared_ptr<Terrain::ChunkDiskCache> mDiskCache;
+        float mChunkSize;
+        osg::Vec2f mChunkCenter;
+        osg::ref_ptr<osg::Image> mImage;
+    };
+
+}
 
 namespace Terrain
 {
@@ -37,6 +70,11 @@ void CompositeMapRenderer::setWorkQueue(SceneUtil::WorkQueue* workQueue)
     mWorkQueue = workQueue;
 }
 
+void CompositeMapRenderer::setDiskCache(std::shared_ptr<ChunkDiskCache> diskCache)
+{
+    mDiskCache = diskCache;
+}
+
 void CompositeMapRenderer::drawImplementation(osg::RenderInfo &renderInfo) const
 {
     double dt = mTimer.time_s();
@@ -50,6 +88,8 @@ void CompositeMapRenderer::drawImplementation(osg::RenderInfo &renderInfo) const
     if (mWorkQueue)
         mUnrefQueue->flush(mWorkQueue.get());
 
+    finishReadbacks(*renderInfo.getState());
+
     OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
 
     if (mImmediateCompileSet.empty() && mCompileSet.empty())
@@ -157,14 +197,79 @@ void CompositeMapRenderer::compile(CompositeMap &compositeMap, osg::RenderInfo &
         }
     }
     if (compositeMap.mCompiled == compositeMap.mDrawables.size())
+    {
         compositeMap.mDrawables = std::vector<osg::ref_ptr<osg::Drawable>>();
 
+        if (mDiskCache)
+            startReadback(compositeMap, state);
+    }
+
     state.haveAppliedAttribute(osg::StateAttribute::VIEWPORT);
 
     GLuint fboId = state.getGraphicsContext() ? state.getGraphicsContext()->getDefaultFboId() : 0;
     ext->glBindFramebuffer(GL_FRAMEBUFFER_EXT, fboId);
 }
 
+void CompositeMapRenderer::startReadback(const CompositeMap& compositeMap, osg::State& state) const
+{
+    osg::GLExtensions* ext = state.get<osg::GLExtensions>();
+    if (!ext->isPBOSupported || !state.getFrameStamp())
+        return;
+
+    PendingReadback readback;
+    readback.mWidth = compositeMap.mTexture->getTextureWidth();
+    readback.mHeight = compositeMap.mTexture->getTextureHeight();
+    readback.mChunkSize = compositeMap.mChunkSize;
+    readback.mChunkCenter = compositeMap.mChunkCenter;
+    readback.mFrameNumber = state.getFrameStamp()->getFrameNumber();
+
+    // the map is still attached to our FBO, bind it for reading too
+    mFBO->apply(state, osg::FrameBufferObject::READ_FRAMEBUFFER);
+
+    ext->glGenBuffers(1, &readback.mBuffer);
+    ext->glBindBuffer(GL_PIXEL_PACK_BUFFER_ARB, readback.mBuffer);
+    ext->glBufferData(GL_PIXEL_PACK_BUFFER_ARB, readback.mWidth * readback.mHeight * 3, nullptr, GL_STREAM_READ_ARB);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    // with a pack buffer bound the copy is queued and the last argument is an offset into the buffer
+    glReadPixels(0, 0, readback.mWidth, readback.mHeight, GL_RGB, GL_UNSIGNED_BYTE, nullptr);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    ext->glBindBuffer(GL_PIXEL_PACK_BUFFER_ARB, 0);
+
+    mPendingReadbacks.push_back(readback);
+}
+
+void CompositeMapRenderer::finishReadbacks(osg::State& state) const
+{
+    if (mPendingReadbacks.empty() || !state.getFrameStamp())
+        return;
+
+    osg::GLExtensions* ext = state.get<osg::GLExtensions>();
+    const unsigned int frameNumber = state.getFrameStamp()->getFrameNumber();
+
+    while (!mPendingReadbacks.empty() && mPendingReadbacks.front().mFrameNumber + sReadbackLatency <= frameNumber)
+    {
+        const PendingReadback readback = mPendingReadbacks.front();
+        mPendingReadbacks.pop_front();
+
+        ext->glBindBuffer(GL_PIXEL_PACK_BUFFER_ARB, readback.mBuffer);
+        if (const void* data = ext->glMapBuffer(GL_PIXEL_PACK_BUFFER_ARB, GL_READ_ONLY_ARB))
+        {
+            osg::ref_ptr<osg::Image> image (new osg::Image);
+            image->allocateImage(readback.mWidth, readback.mHeight, 1, GL_RGB, GL_UNSIGNED_BYTE, 1);
+            std::memcpy(image->data(), data, image->getTotalSizeInBytes());
+            ext->glUnmapBuffer(GL_PIXEL_PACK_BUFFER_ARB);
+
+            osg::ref_ptr<StoreCompositeMapWorkItem> item (new StoreCompositeMapWorkItem(mDiskCache, readback.mChunkSize, readback.mChunkCenter, image));
+            if (mWorkQueue)
+                mWorkQueue->addWorkItem(item, SceneUtil::WorkPriority_Background);
+            else
+                item->doWork();
+        }
+        ext->glBindBuffer(GL_PIXEL_PACK_BUFFER_ARB, 0);
+        ext->glDeleteBuffers(1, &readback.mBuffer);
+    }
+}
+
 void CompositeMapRenderer::setMinimumTimeAvailableForCompile(double time)
 {
     mMinimumTimeAvailable = time;
@@ -205,6 +310,7 @@ unsigned int CompositeMapRenderer::getCompileSetSize() const
 
 CompositeMap::CompositeMap()
     : mCompiled(0)
+    , mChunkSize(0.f)
 {
 }
 
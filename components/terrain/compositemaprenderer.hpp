@@ -2,9 +2,12 @@
 #define OPENMW_COMPONENTS_TERRAIN_COMPOSITEMAPRENDERER_H
 
 #include <osg/Drawable>
+#include <osg/Vec2f>
 
 #include <OpenThreads/Mutex>
 
+#include <deque>
+#include <memory>
 #include <set>
 
 namespace osg
@@ -23,6 +26,8 @@ namespace SceneUtil
 namespace Terrain
 {
 
+    class ChunkDiskCache;
+
     class CompositeMap : public osg::Referenced
     {
     public:
@@ -31,6 +36,10 @@ namespace Terrain
         std::vector<osg::ref_ptr<osg::Drawable> > mDrawables;
         osg::ref_ptr<osg::Texture2D> mTexture;
         unsigned int mCompiled;
+
+        /// The chunk using this map, to store it in the disk cache once it is fully rendered
+        float mChunkSize;
+        osg::Vec2f mChunkCenter;
     };
 
     /**
@@ -49,6 +58,9 @@ namespace Terrain
         /// Set a WorkQueue to delete compiled composite map layers in the background thread
         void setWorkQueue(SceneUtil::WorkQueue* workQueue);
 
+        /// Read back fully rendered composite maps and store them in this cache, in the WorkQueue thread if there is one
+        void setDiskCache(std::shared_ptr<ChunkDiskCache> diskCache);
+
         /// Set the available time in seconds for compiling (non-immediate) composite maps each frame
         void setMinimumTimeAvailableForCompile(double time);
 
@@ -64,6 +76,22 @@ namespace Terrain
         unsigned int getCompileSetSize() const;
 
     private:
+        /// Composite map copied into a pixel buffer object, mapped some frames later so the draw thread doesn't wait
+        /// for the GPU to finish rendering it
+        struct PendingReadback
+        {
+            GLuint mBuffer;
+            int mWidth;
+            int mHeight;
+            float mChunkSize;
+            osg::Vec2f mChunkCenter;
+            unsigned int mFrameNumber;
+        };
+
+        void startReadback(const CompositeMap& compositeMap, osg::State& state) const;
+
+        void finishReadbacks(osg::State& state) const;
+
         float mTargetFrameRate;
         double mMinimumTimeAvailable;
         mutable osg::Timer mTimer;
@@ -79,6 +107,11 @@ namespace Terrain
         mutable OpenThreads::Mutex mMutex;
 
         osg::ref_ptr<osg::FrameBufferObject> mFBO;
+
+        std::shared_ptr<ChunkDiskCache> mDiskCache;
+
+        /// Only used in the draw thread
+        mutable std::deque<PendingReadback> mPendingReadbacks;
     };
 
 }
@@ -3,12 +3,21 @@
 #include <osgUtil/CullVisitor>
 #include <osg/ShapeDrawable>
 #include <osg/PolygonMode>
+#include <osg/Group>
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
 #include <limits>
+#include <mutex>
 #include <sstream>
+#include <vector>
 
 #include <components/misc/constants.hpp>
 #include <components/sceneutil/mwshadowtechnique.hpp>
+#include <components/sceneutil/workqueue.hpp>
 
 #include "quadtreenode.hpp"
 #include "storage.hpp"
@@ -44,6 +53,74 @@ namespace
         return targetlevel;
     }
 
+    /// The chunks of a view being built by the preloading thread with the help of the chunk build queue
+    struct ChunkBuild : public osg::Referenced
+    {
+        /// Builds chunks until there are none left, only called while the build is open
+        std::function<void()> mBuildChunks;
+        std::atomic<unsigned int> mNextEntry {0};
+        std::atomic<bool> mFailed {false};
+
+        std::mutex mMutex;
+        std::condition_variable mCondition;
+        unsigned int mRunning = 0;
+        bool mClosed = false;
+        std::exception_ptr mError;
+
+        void help()
+        {
+            {
+                const std::lock_guard<std::mutex> lock(mMutex);
+                if (mClosed)
+                    return;
+                ++mRunning;
+            }
+
+            std::exception_ptr error;
+            try
+            {
+                mBuildChunks();
+            }
+            catch (...)
+            {
+                error = std::current_exception();
+                mFailed = true;
+            }
+
+            const std::lock_guard<std::mutex> lock(mMutex);
+            if (error && !mError)
+                mError = error;
+            --mRunning;
+            mCondition.notify_all();
+        }
+
+        /// Waits for the helpers already building chunks, the ones starting later return right away. The preloading
+        /// thread may be a worker of a queue the helpers wait in, so it never waits for a helper to start.
+        void close()
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mClosed = true;
+            mCondition.wait(lock, [&] { return mRunning == 0; });
+        }
+    };
+
+    class ChunkBuildWorkItem : public SceneUtil::WorkItem
+    {
+    public:
+        ChunkBuildWorkItem(ChunkBuild* build)
+            : mBuild(build)
+        {
+        }
+
+        virtual void doWork()
+        {
+            mBuild->help();
+        }
+
+    private:
+        osg::ref_ptr<ChunkBuild> mBuild;
+    };
+
 }
 
 namespace Terrain
@@ -71,6 +148,47 @@ private:
     float mMinSize;
 };
 
+bool isEmptyGrid(const osg::Vec4i& grid)
+{
+    return grid.x() >= grid.z() || grid.y() >= grid.w();
+}
+
+bool overlapsGrid(QuadTreeNode* node, const osg::Vec4i& grid)
+{
+    const float halfSize = node->getSize() / 2.f;
+    const osg::Vec2f& center = node->getCenter();
+    return center.x() + halfSize > grid.x() && center.x() - halfSize < grid.z()
+        && center.y() + halfSize > grid.y() && center.y() - halfSize < grid.w();
+}
+
+bool isInActiveGrid(QuadTreeNode* node, const osg::Vec4i& grid)
+{
+    const osg::Vec2f& center = node->getCenter();
+    return center.x() > grid.x() && center.x() < grid.z() && center.y() > grid.y() && center.y() < grid.w();
+}
+
+/// Splits nodes overlapping the active grid down to cell size, chunk providers render the active cells in full detail.
+class ActiveGridLodCallback : public LodCallback
+{
+public:
+    ActiveGridLodCallback(LodCallback* lodCallback, const osg::Vec4i& activeGrid)
+        : mLodCallback(lodCallback)
+        , mActiveGrid(activeGrid)
+    {
+    }
+
+    virtual bool isSufficientDetail(QuadTreeNode* node, float dist)
+    {
+        if (node->getSize() > 1 && overlapsGrid(node, mActiveGrid))
+            return false;
+        return mLodCallback->isSufficientDetail(node, dist);
+    }
+
+private:
+    osg::ref_ptr<LodCallback> mLodCallback;
+    osg::Vec4i mActiveGrid;
+};
+
 class RootNode : public QuadTreeNode
 {
 public:
@@ -220,14 +338,19 @@ private:
     osg::ref_ptr<RootNode> mRootNode;
 };
 
-QuadTreeWorld::QuadTreeWorld(osg::Group *parent, osg::Group *compileRoot, Resource::ResourceSystem *resourceSystem, Storage *storage, int nodeMask, int preCompileMask, int borderMask, int compMapResolution, float compMapLevel, float lodFactor, int vertexLodMod, float maxCompGeometrySize)
+QuadTreeWorld::QuadTreeWorld(osg::Group *parent, osg::Group *compileRoot, Resource::ResourceSystem *resourceSystem, Storage *storage, int nodeMask, int preCompileMask, int borderMask, int compMapResolution, float compMapLevel, float lodFactor, int vertexLodMod, float maxCompGeometrySize, unsigned int chunkBuildThreads)
     : TerrainGrid(parent, compileRoot, resourceSystem, storage, nodeMask, preCompileMask, borderMask)
     , mViewDataMap(new ViewDataMap)
     , mQuadTreeBuilt(false)
     , mLodFactor(lodFactor)
     , mVertexLodMod(vertexLodMod)
     , mViewDistance(std::numeric_limits<float>::max())
+    , mChunkBuildThreads(std::max(1u, chunkBuildThreads))
+    , mActiveGrid(0, 0, 0, 0)
 {
+    if (mChunkBuildThreads > 1)
+        mChunkBuildQueue = new SceneUtil::WorkQueue(static_cast<int>(mChunkBuildThreads - 1));
+
     mChunkManager->setCompositeMapSize(compMapResolution);
     mChunkManager->setCompositeMapLevel(compMapLevel);
     mChunkManager->setMaxCompositeGeometrySize(maxCompGeometrySize);
@@ -289,7 +412,8 @@ unsigned int getLodFlags(QuadTreeNode* node, int ourLod, int vertexLodMod, ViewD
     return lodFlags;
 }
 
-void loadRenderingNode(ViewData::Entry& entry, ViewData* vd, int vertexLodMod, ChunkManager* chunkManager)
+void loadRenderingNode(ViewData::Entry& entry, ViewData* vd, int vertexLodMod, ChunkManager* chunkManager,
+                       const std::vector<QuadTreeWorld::ChunkProvider*>& chunkProviders)
 {
     if (!vd->hasChanged() && entry.mRenderingNode)
         return;
@@ -307,11 +431,31 @@ void loadRenderingNode(ViewData::Entry& entry, ViewData* vd, int vertexLodMod, C
         }
     }
 
-    if (!entry.mRenderingNode)
-        entry.mRenderingNode = chunkManager->getChunk(entry.mNode->getSize(), entry.mNode->getCenter(), ourLod, entry.mLodFlags);
+    if (entry.mRenderingNode)
+        return;
+
+    const float size = entry.mNode->getSize();
+    const osg::Vec2f& center = entry.mNode->getCenter();
+    osg::ref_ptr<osg::Node> terrain = chunkManager->getChunk(size, center, ourLod, entry.mLodFlags);
+    if (chunkProviders.empty())
+    {
+        entry.mRenderingNode = terrain;
+        return;
+    }
+
+    const bool activeGrid = isInActiveGrid(entry.mNode, vd->getActiveGrid());
+    osg::ref_ptr<osg::Group> group (new osg::Group);
+    group->addChild(terrain);
+    for (QuadTreeWorld::ChunkProvider* chunkProvider : chunkProviders)
+    {
+        osg::ref_ptr<osg::Node> node = chunkProvider->getChunk(size, center, activeGrid);
+        if (node)
+            group->addChild(node);
+    }
+    entry.mRenderingNode = group;
 }
 
-void updateWaterCullingView(HeightCullCallback* callback, ViewData* vd, osgUtil::CullVisitor* cv, float cellworldsize, bool outofworld)
+void updateWaterCullingView(HeightCullCallback* callback, ViewData* vd, osgUtil::CullVisitor* cv, float cellworldsize, bool outofworld, bool hasChunkProviders)
 {
     if (!(cv->getTraversalMask() & callback->getCullMask()))
         return;
@@ -326,7 +470,10 @@ void updateWaterCullingView(HeightCullCallback* callback, ViewData* vd, osgUtil:
     for (unsigned int i=0; i<vd->getNumEntries(); ++i)
     {
         ViewData::Entry& entry = vd->getEntry(i);
-        osg::BoundingBox bb = static_cast<TerrainDrawable*>(entry.mRenderingNode->asGroup()->getChild(0))->getWaterBoundingBox();
+        osg::Node* terrain = entry.mRenderingNode;
+        if (hasChunkProviders)
+            terrain = terrain->asGroup()->getChild(0);
+        osg::BoundingBox bb = static_cast<TerrainDrawable*>(terrain->asGroup()->getChild(0))->getWaterBoundingBox();
         if (!bb.valid())
             continue;
         osg::Vec3f ofs (entry.mNode->getCenter().x()*cellworldsize, entry.mNode->getCenter().y()*cellworldsize, 0.f);
@@ -385,11 +532,12 @@ void QuadTreeWorld::accept(osg::NodeVisitor &nv)
     bool needsUpdate = true;
     ViewData* vd = nullptr;
     if (isCullVisitor)
-        vd = mViewDataMap->getViewData(static_cast<osgUtil::CullVisitor*>(&nv)->getCurrentCamera(), nv.getViewPoint(), needsUpdate);
+        vd = mViewDataMap->getViewData(static_cast<osgUtil::CullVisitor*>(&nv)->getCurrentCamera(), nv.getViewPoint(), mActiveGrid, needsUpdate);
     else
     {
         static ViewData sIntersectionViewData;
         vd = &sIntersectionViewData;
+        vd->setActiveGrid(mActiveGrid);
     }
 
     if (needsUpdate)
@@ -409,7 +557,7 @@ void QuadTreeWorld::accept(osg::NodeVisitor &nv)
                 mRootNode->traverseTo(vd, 1, osg::Vec2f(x+0.5,y+0.5));
             }
             else
-                mRootNode->traverseNodes(vd, cv->getViewPoint(), mLodCallback, mViewDistance);
+                mRootNode->traverseNodes(vd, cv->getViewPoint(), makeLodCallback(mActiveGrid), mViewDistance);
         }
         else
         {
@@ -432,17 +580,21 @@ void QuadTreeWorld::accept(osg::NodeVisitor &nv)
         }
     }
 
+    // Intersections only need the terrain, their view is discarded anyway and would build the provided chunks in vain
+    static const std::vector<ChunkProvider*> sNoChunkProviders;
+    const std::vector<ChunkProvider*>& chunkProviders = isCullVisitor ? mChunkProviders : sNoChunkProviders;
+
     for (unsigned int i=0; i<vd->getNumEntries(); ++i)
     {
         ViewData::Entry& entry = vd->getEntry(i);
 
-        loadRenderingNode(entry, vd, mVertexLodMod, mChunkManager.get());
+        loadRenderingNode(entry, vd, mVertexLodMod, mChunkManager.get(), chunkProviders);
 
         entry.mRenderingNode->accept(nv);
     }
 
     if (isCullVisitor)
-        updateWaterCullingView(mHeightCullCallback, vd, static_cast<osgUtil::CullVisitor*>(&nv), mStorage->getCellWorldSize(), !isGridEmpty());
+        updateWaterCullingView(mHeightCullCallback, vd, static_cast<osgUtil::CullVisitor*>(&nv), mStorage->getCellWorldSize(), !isGridEmpty(), !mChunkProviders.empty());
 
     if (!isCullVisitor)
         vd->clear(); // we can't reuse intersection views in the next frame because they only contain what is touched by the intersection ray.
@@ -473,6 +625,13 @@ void QuadTreeWorld::ensureQuadTreeBuilt()
     mQuadTreeBuilt = true;
 }
 
+osg::ref_ptr<LodCallback> QuadTreeWorld::makeLodCallback(const osg::Vec4i& activeGrid) const
+{
+    if (mChunkProviders.empty() || isEmptyGrid(activeGrid))
+        return mLodCallback;
+    return new ActiveGridLodCallback(mLodCallback, activeGrid);
+}
+
 void QuadTreeWorld::enable(bool enabled)
 {
     if (enabled)
@@ -491,12 +650,15 @@ void QuadTreeWorld::cacheCell(View *view, int x, int y)
 {
     ensureQuadTreeBuilt();
     ViewData* vd = static_cast<ViewData*>(view);
+    // The cell is cached to be loaded by the scene
+    if (!mChunkProviders.empty())
+        vd->setActiveGrid(osg::Vec4i(x, y, x+1, y+1));
     mRootNode->traverseTo(vd, 1, osg::Vec2f(x+0.5f,y+0.5f));
 
     for (unsigned int i=0; i<vd->getNumEntries(); ++i)
     {
         ViewData::Entry& entry = vd->getEntry(i);
-        loadRenderingNode(entry, vd, mVertexLodMod, mChunkManager.get());
+        loadRenderingNode(entry, vd, mVertexLodMod, mChunkManager.get(), mChunkProviders);
     }
 }
 
@@ -505,19 +667,56 @@ View* QuadTreeWorld::createView()
     return new ViewData;
 }
 
-void QuadTreeWorld::preload(View *view, const osg::Vec3f &viewPoint, std::atomic<bool> &abort)
+void QuadTreeWorld::preload(View *view, const osg::Vec3f &viewPoint, const osg::Vec4i &activeGrid, std::atomic<bool> &abort)
 {
     ensureQuadTreeBuilt();
 
     ViewData* vd = static_cast<ViewData*>(view);
     vd->setViewPoint(viewPoint);
-    mRootNode->traverseNodes(vd, viewPoint, mLodCallback, mViewDistance);
+    vd->setActiveGrid(mChunkProviders.empty() ? osg::Vec4i(0, 0, 0, 0) : activeGrid);
+    mRootNode->traverseNodes(vd, viewPoint, makeLodCallback(vd->getActiveGrid()), mViewDistance);
 
-    for (unsigned int i=0; i<vd->getNumEntries() && !abort; ++i)
+    // Each entry is only written by the thread that picked it, the view data is only read, so the chunks are built
+    // as independent tasks. The chunk manager makes threads wait for a chunk already in flight instead of rebuilding it.
+    osg::ref_ptr<ChunkBuild> build (new ChunkBuild);
+    build->mBuildChunks = [&]
     {
-        ViewData::Entry& entry = vd->getEntry(i);
-        loadRenderingNode(entry, vd, mVertexLodMod, mChunkManager.get());
+        for (unsigned int i = build->mNextEntry++; i < vd->getNumEntries() && !abort && !build->mFailed; i = build->mNextEntry++)
+        {
+            ViewData::Entry& entry = vd->getEntry(i);
+            loadRenderingNode(entry, vd, mVertexLodMod, mChunkManager.get(), mChunkProviders);
+        }
+    };
+
+    std::vector<osg::ref_ptr<ChunkBuildWorkItem>> helpers;
+    if (mChunkBuildQueue)
+    {
+        for (unsigned int i = 1; i < std::min(mChunkBuildThreads, vd->getNumEntries()); ++i)
+        {
+            helpers.emplace_back(new ChunkBuildWorkItem(build.get()));
+            mChunkBuildQueue->addWorkItem(helpers.back(), SceneUtil::WorkPriority_Immediate);
+        }
+    }
+
+    try
+    {
+        build->mBuildChunks();
     }
+    catch (...)
+    {
+        build->mFailed = true;
+        build->close();
+        for (const auto& helper : helpers)
+            helper->cancel();
+        throw;
+    }
+
+    build->close();
+    for (const auto& helper : helpers)
+        helper->cancel();
+    if (build->mError)
+        std::rethrow_exception(build->mError);
+
     vd->markUnchanged();
 }
 
@@ -536,6 +735,24 @@ void QuadTreeWorld::reportStats(unsigned int frameNumber, osg::Stats *stats)
     stats->setAttribute(frameNumber, "Composite", mCompositeMapRenderer->getCompileSetSize());
 }
 
+void QuadTreeWorld::addChunkProvider(ChunkProvider* provider)
+{
+    mChunkProviders.push_back(provider);
+    mTerrainRoot->setNodeMask(mTerrainRoot->getNodeMask() | provider->getNodeMask());
+}
+
+void QuadTreeWorld::setActiveGrid(const osg::Vec4i& grid)
+{
+    // Without chunk providers the grid does not change any chunk, views keep their entries then
+    if (!mChunkProviders.empty())
+        mActiveGrid = grid;
+}
+
+void QuadTreeWorld::rebuildViews()
+{
+    mViewDataMap->rebuildViews();
+}
+
 void QuadTreeWorld::loadCell(int x, int y)
 {
     // fallback behavior only for undefined cells (every other is already handled in quadtree)
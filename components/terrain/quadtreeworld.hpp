@@ -6,11 +6,20 @@
 
 #include <OpenThreads/Mutex>
 
+#include <osg/Vec4i>
+
+#include <vector>
+
 namespace osg
 {
     class NodeVisitor;
 }
 
+namespace SceneUtil
+{
+    class WorkQueue;
+}
+
 namespace Terrain
 {
     class RootNode;
@@ -21,7 +30,7 @@ namespace Terrain
     class QuadTreeWorld : public TerrainGrid // note: derived from TerrainGrid is only to render default cells (see loadCell)
     {
     public:
-        QuadTreeWorld(osg::Group* parent, osg::Group* compileRoot, Resource::ResourceSystem* resourceSystem, Storage* storage, int nodeMask, int preCompileMask, int borderMask, int compMapResolution, float comMapLevel, float lodFactor, int vertexLodMod, float maxCompGeometrySize);
+        QuadTreeWorld(osg::Group* parent, osg::Group* compileRoot, Resource::ResourceSystem* resourceSystem, Storage* storage, int nodeMask, int preCompileMask, int borderMask, int compMapResolution, float comMapLevel, float lodFactor, int vertexLodMod, float maxCompGeometrySize, unsigned int chunkBuildThreads = 1);
 
         ~QuadTreeWorld();
 
@@ -38,14 +47,43 @@ namespace Terrain
         virtual void unloadCell(int x, int y);
 
         View* createView();
-        void preload(View* view, const osg::Vec3f& eyePoint, std::atomic<bool>& abort);
+        void preload(View* view, const osg::Vec3f& eyePoint, const osg::Vec4i& activeGrid, std::atomic<bool>& abort);
+        ///< Builds the missing chunks of the view with up to chunkBuildThreads threads, the calling one and the workers
+        /// of a chunk build queue of the remaining threads.
         void storeView(const View* view, double referenceTime);
 
         void reportStats(unsigned int frameNumber, osg::Stats* stats);
 
+        /// @brief Source of nodes rendered along with the terrain chunks, e.g. the batched objects of the chunk area.
+        class ChunkProvider
+        {
+        public:
+            virtual ~ChunkProvider() {}
+
+            /// @param activeGrid the chunk is in the active grid, it covers at most one cell then
+            /// @return nullptr when there is nothing to render in the chunk area
+            /// @note Thread safe.
+            virtual osg::ref_ptr<osg::Node> getChunk(float size, const osg::Vec2f& center, bool activeGrid) = 0;
+
+            /// Node mask of the returned nodes, the terrain root is entered by traversals with any of these bits.
+            virtual unsigned int getNodeMask() = 0;
+        };
+
+        /// Add the nodes of \a provider to the rendering node of each chunk, the terrain chunk remains the first child.
+        /// Chunks overlapping the active grid are then split down to cell size, so that each chunk is either entirely
+        /// in the active grid or entirely out of it.
+        /// @note Call before rendering.
+        void addChunkProvider(ChunkProvider* provider);
+
+        virtual void setActiveGrid(const osg::Vec4i& grid);
+
+        virtual void rebuildViews();
+
     private:
         void ensureQuadTreeBuilt();
 
+        osg::ref_ptr<LodCallback> makeLodCallback(const osg::Vec4i& activeGrid) const;
+
         osg::ref_ptr<RootNode> mRootNode;
 
         osg::ref_ptr<ViewDataMap> mViewDataMap;
@@ -56,6 +94,10 @@ namespace Terrain
         float mLodFactor;
         int mVertexLodMod;
         float mViewDistance;
+        unsigned int mChunkBuildThreads;
+        osg::ref_ptr<SceneUtil::WorkQueue> mChunkBuildQueue;
+        std::vector<ChunkProvider*> mChunkProviders;
+        osg::Vec4i mActiveGrid;
     };
 
 }
@@ -8,6 +8,7 @@ ViewData::ViewData()
     , mLastUsageTimeStamp(0.0)
     , mChanged(false)
     , mHasViewPoint(false)
+    , mActiveGrid(0, 0, 0, 0)
 {
 
 }
@@ -24,6 +25,7 @@ void ViewData::copyFrom(const ViewData& other)
     mChanged = other.mChanged;
     mHasViewPoint = other.mHasViewPoint;
     mViewPoint = other.mViewPoint;
+    mActiveGrid = other.mActiveGrid;
 }
 
 void ViewData::add(QuadTreeNode *node)
@@ -118,12 +120,12 @@ bool ViewData::Entry::set(QuadTreeNode *node)
     }
 }
 
-bool suitable(ViewData* vd, const osg::Vec3f& viewPoint, float& maxDist)
+bool suitable(ViewData* vd, const osg::Vec3f& viewPoint, const osg::Vec4i& activeGrid, float& maxDist)
 {
-    return vd->hasViewPoint() && (vd->getViewPoint() - viewPoint).length2() < maxDist*maxDist;
+    return vd->hasViewPoint() && (vd->getViewPoint() - viewPoint).length2() < maxDist*maxDist && vd->getActiveGrid() == activeGrid;
 }
 
-ViewData *ViewDataMap::getViewData(osg::Object *viewer, const osg::Vec3f& viewPoint, bool& needsUpdate)
+ViewData *ViewDataMap::getViewData(osg::Object *viewer, const osg::Vec3f& viewPoint, const osg::Vec4i& activeGrid, bool& needsUpdate)
 {
     Map::const_iterator found = mViews.find(viewer);
     ViewData* vd = nullptr;
@@ -135,18 +137,22 @@ ViewData *ViewDataMap::getViewData(osg::Object *viewer, const osg::Vec3f& viewPo
     else
         vd = found->second;
 
-    if (!suitable(vd, viewPoint, mReuseDistance))
+    if (!suitable(vd, viewPoint, activeGrid, mReuseDistance))
     {
         for (Map::const_iterator other = mViews.begin(); other != mViews.end(); ++other)
         {
-            if (suitable(other->second, viewPoint, mReuseDistance) && other->second->getNumEntries())
+            if (suitable(other->second, viewPoint, activeGrid, mReuseDistance) && other->second->getNumEntries())
             {
                 vd->copyFrom(*other->second);
                 needsUpdate = false;
                 return vd;
             }
         }
+        // The entries of another grid hold rendering nodes built for the cells that were active then.
+        if (vd->getActiveGrid() != activeGrid)
+            vd->clear();
         vd->setViewPoint(viewPoint);
+        vd->setActiveGrid(activeGrid);
         needsUpdate = true;
     }
     else
@@ -186,6 +192,17 @@ void ViewDataMap::clearUnusedViews(double referenceTime)
     }
 }
 
+void ViewDataMap::rebuildViews()
+{
+    for (Map::iterator it = mViews.begin(); it != mViews.end(); ++it)
+    {
+        ViewData* vd = it->second;
+        const double lastUsage = vd->getLastUsageTimeStamp();
+        vd->clear();
+        vd->setLastUsageTimeStamp(lastUsage);
+    }
+}
+
 void ViewDataMap::clear()
 {
     mViews.clear();
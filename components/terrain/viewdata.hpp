@@ -5,6 +5,7 @@
 #include <deque>
 
 #include <osg/Node>
+#include <osg/Vec4i>
 
 #include "world.hpp"
 
@@ -57,6 +58,9 @@ namespace Terrain
         void setViewPoint(const osg::Vec3f& viewPoint);
         const osg::Vec3f& getViewPoint() const;
 
+        void setActiveGrid(const osg::Vec4i& grid) { mActiveGrid = grid; }
+        const osg::Vec4i& getActiveGrid() const { return mActiveGrid; }
+
     private:
         std::vector<Entry> mEntries;
         unsigned int mNumEntries;
@@ -64,6 +68,7 @@ namespace Terrain
         bool mChanged;
         osg::Vec3f mViewPoint;
         bool mHasViewPoint;
+        osg::Vec4i mActiveGrid;
     };
 
     class ViewDataMap : public osg::Referenced
@@ -75,12 +80,15 @@ namespace Terrain
             , mExpiryDelay(1.f)
         {}
 
-        ViewData* getViewData(osg::Object* viewer, const osg::Vec3f& viewPoint, bool& needsUpdate);
+        ViewData* getViewData(osg::Object* viewer, const osg::Vec3f& viewPoint, const osg::Vec4i& activeGrid, bool& needsUpdate);
 
         ViewData* createOrReuseView();
 
         void clearUnusedViews(double referenceTime);
 
+        /// Drop the entries of all views, so that their rendering nodes are loaded again on the next use.
+        void rebuildViews();
+
         void clear();
 
     private:
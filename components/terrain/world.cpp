@@ -48,6 +48,7 @@ World::World(osg::Group* parent, osg::Group* compileRoot, Resource::ResourceSyst
 
     mTextureManager.reset(new TextureManager(mResourceSystem->getSceneManager()));
     mChunkManager.reset(new ChunkManager(mStorage, mResourceSystem->getSceneManager(), mTextureManager.get(), mCompositeMapRenderer));
+    mChunkManager->setNodeMask(nodeMask);
     mCellBorder.reset(new CellBorder(this,mTerrainRoot.get(),borderMask));
 
     mResourceSystem->addResourceManager(mChunkManager.get());
@@ -72,6 +73,12 @@ void World::setWorkQueue(SceneUtil::WorkQueue* workQueue)
     mCompositeMapRenderer->setWorkQueue(workQueue);
 }
 
+void World::setDiskCache(std::shared_ptr<ChunkDiskCache> diskCache)
+{
+    mChunkManager->setDiskCache(diskCache);
+    mCompositeMapRenderer->setDiskCache(diskCache);
+}
+
 void World::setBordersVisible(bool visible)
 {
     mBorderVisible = visible;
@@ -4,6 +4,7 @@
 #include <osg/ref_ptr>
 #include <osg/Referenced>
 #include <osg/Vec3f>
+#include <osg/Vec4i>
 #include <osg/NodeCallback>
 
 #include <atomic>
@@ -38,6 +39,7 @@ namespace Terrain
 
     class TextureManager;
     class ChunkManager;
+    class ChunkDiskCache;
     class CompositeMapRenderer;
 
 class HeightCullCallback : public osg::NodeCallback
@@ -101,6 +103,9 @@ private:
         /// Set a WorkQueue to delete objects in the background thread.
         void setWorkQueue(SceneUtil::WorkQueue* workQueue);
 
+        /// Reuse vertex buffers and composite maps of chunks built in previous sessions. Call before loading any chunk.
+        void setDiskCache(std::shared_ptr<ChunkDiskCache> diskCache);
+
         /// See CompositeMapRenderer::setTargetFrameRate
         void setTargetFrameRate(float rate);
 
@@ -135,8 +140,9 @@ private:
         virtual View* createView() { return nullptr; }
 
         /// @note Thread safe, as long as you do not attempt to load into the same view from multiple threads.
+        /// @param activeGrid cells the scene will have loaded once the view is used, see setActiveGrid
 
-        virtual void preload(View* view, const osg::Vec3f& viewPoint, std::atomic<bool>& abort) {}
+        virtual void preload(View* view, const osg::Vec3f& viewPoint, const osg::Vec4i& activeGrid, std::atomic<bool>& abort) {}
 
         /// Store a preloaded view into the cache with the intent that the next rendering traversal can use it.
         /// @note Not thread safe.
@@ -146,6 +152,14 @@ private:
 
         virtual void setViewDistance(float distance) {}
 
+        /// Set the cells loaded by the scene as (minX, minY, maxX, maxY) with exclusive maximums.
+        /// @note Not thread safe.
+        virtual void setActiveGrid(const osg::Vec4i& grid) {}
+
+        /// Reload the rendering nodes of all views on their next use, e.g. after the content of cached chunks changed.
+        /// @note Not thread safe.
+        virtual void rebuildViews() {}
+
         Storage* getStorage() { return mStorage; }
 
         osg::Callback* getHeightCullCallback(float highz, unsigned int mask);
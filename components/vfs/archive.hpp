@@ -1,6 +1,7 @@
 #ifndef OPENMW_COMPONENTS_RESOURCE_ARCHIVE_H
 #define OPENMW_COMPONENTS_RESOURCE_ARCHIVE_H
 
+#include <cstdint>
 #include <map>
 
 #include <components/files/constrainedfilestream.hpp>
@@ -14,6 +15,11 @@ namespace VFS
         virtual ~File() {}
 
         virtual Files::IStreamPtr open() = 0;
+
+        /// Identify the contents of the file without reading it, from the size and modification time of the file
+        /// or of the archive containing it.
+        /// @return 0 when unknown, anything derived from the contents should not be cached then.
+        virtual std::uint64_t getStamp() { return 0; }
     };
 
     class Archive
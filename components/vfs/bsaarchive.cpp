@@ -1,5 +1,9 @@
 #include "bsaarchive.hpp"
+#include "filesystemarchive.hpp"
+
 #include <components/bsa/compressedbsafile.hpp>
+#include <components/misc/stablehash.hpp>
+
 #include <memory>
 
 namespace VFS
@@ -18,10 +22,12 @@ BsaArchive::BsaArchive(const std::string &filename)
 
     mFile->open(filename);
 
+    const std::uint64_t archiveStamp = getFileStamp(filename);
+
     const Bsa::BSAFile::FileList &filelist = mFile->getList();
     for(Bsa::BSAFile::FileList::const_iterator it = filelist.begin();it != filelist.end();++it)
     {
-        mResources.push_back(BsaArchiveFile(&*it, mFile.get()));
+        mResources.push_back(BsaArchiveFile(&*it, mFile.get(), archiveStamp));
     }
 }
 
@@ -41,9 +47,10 @@ void BsaArchive::listResources(std::map<std::string, File *> &out, char (*normal
 
 // ------------------------------------------------------------------------------
 
-BsaArchiveFile::BsaArchiveFile(const Bsa::BSAFile::FileStruct *info, Bsa::BSAFile* bsa)
+BsaArchiveFile::BsaArchiveFile(const Bsa::BSAFile::FileStruct *info, Bsa::BSAFile* bsa, std::uint64_t archiveStamp)
     : mInfo(info)
     , mFile(bsa)
+    , mArchiveStamp(archiveStamp)
 {
 
 }
@@ -53,4 +60,14 @@ Files::IStreamPtr BsaArchiveFile::open()
     return mFile->getFile(mInfo);
 }
 
+std::uint64_t BsaArchiveFile::getStamp()
+{
+    if (mArchiveStamp == 0)
+        return 0;
+    Misc::StableHash stamp(mArchiveStamp);
+    stamp.add(static_cast<std::uint64_t>(mInfo->offset));
+    stamp.add(static_cast<std::uint64_t>(mInfo->fileSize));
+    return stamp.getValue();
+}
+
 }
@@ -10,12 +10,15 @@ namespace VFS
     class BsaArchiveFile : public File
     {
     public:
-        BsaArchiveFile(const Bsa::BSAFile::FileStruct* info, Bsa::BSAFile* bsa);
+        BsaArchiveFile(const Bsa::BSAFile::FileStruct* info, Bsa::BSAFile* bsa, std::uint64_t archiveStamp);
 
         virtual Files::IStreamPtr open();
 
+        virtual std::uint64_t getStamp();
+
         const Bsa::BSAFile::FileStruct* mInfo;
         Bsa::BSAFile* mFile;
+        std::uint64_t mArchiveStamp;
     };
 
     class BsaArchive : public Archive
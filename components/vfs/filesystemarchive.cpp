@@ -3,6 +3,7 @@
 #include <boost/filesystem.hpp>
 
 #include <components/debug/debuglog.hpp>
+#include <components/misc/stablehash.hpp>
 
 namespace VFS
 {
@@ -65,4 +66,25 @@ namespace VFS
         return Files::openConstrainedFileStream(mPath.c_str());
     }
 
+    std::uint64_t FileSystemArchiveFile::getStamp()
+    {
+        return getFileStamp(mPath);
+    }
+
+    std::uint64_t getFileStamp(const std::string& path)
+    {
+        boost::system::error_code error;
+        const std::uint64_t size = boost::filesystem::file_size(path, error);
+        if (error)
+            return 0;
+        const std::uint64_t time = static_cast<std::uint64_t>(boost::filesystem::last_write_time(path, error));
+        if (error)
+            return 0;
+
+        Misc::StableHash stamp;
+        stamp.add(size);
+        stamp.add(time);
+        return stamp.getValue();
+    }
+
 }
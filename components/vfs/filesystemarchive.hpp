@@ -13,6 +13,8 @@ namespace VFS
 
         virtual Files::IStreamPtr open();
 
+        virtual std::uint64_t getStamp();
+
     private:
         std::string mPath;
 
@@ -35,6 +37,10 @@ namespace VFS
 
     };
 
+    /// Stamp of a file on the disk from its size and modification time, 0 if they can not be read.
+    /// @see File::getStamp
+    std::uint64_t getFileStamp(const std::string& path);
+
 }
 
 #endif
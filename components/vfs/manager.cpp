@@ -1,7 +1,9 @@
 #include "manager.hpp"
 
+#include <algorithm>
 #include <stdexcept>
 
+#include <components/misc/stablehash.hpp>
 #include <components/misc/stringops.hpp>
 
 #include "archive.hpp"
@@ -25,6 +27,22 @@ namespace
         std::transform(path.begin(), path.end(), path.begin(), normalize_char);
     }
 
+    // Function objects rather than function pointers, so that lookups get the normalization inlined
+    struct KeepChar
+    {
+        char operator()(char ch) const { return ch; }
+    };
+
+    struct StrictNormalizeChar
+    {
+        char operator()(char ch) const { return strict_normalize_char(ch); }
+    };
+
+    struct NonStrictNormalizeChar
+    {
+        char operator()(char ch) const { return nonstrict_normalize_char(ch); }
+    };
+
 }
 
 namespace VFS
@@ -32,6 +50,7 @@ namespace VFS
 
     Manager::Manager(bool strict)
         : mStrict(strict)
+        , mIndexStamp(0)
     {
 
     }
@@ -43,7 +62,9 @@ namespace VFS
 
     void Manager::reset()
     {
+        mLookup.clear();
         mIndex.clear();
+        mIndexStamp = 0;
         for (std::vector<Archive*>::iterator it = mArchives.begin(); it != mArchives.end(); ++it)
             delete *it;
         mArchives.clear();
@@ -56,34 +77,103 @@ namespace VFS
 
     void Manager::buildIndex()
     {
+        mLookup.clear();
         mIndex.clear();
 
         for (std::vector<Archive*>::const_iterator it = mArchives.begin(); it != mArchives.end(); ++it)
             (*it)->listResources(mIndex, mStrict ? &strict_normalize_char : &nonstrict_normalize_char);
+
+        std::size_t size = 16;
+        while (size < mIndex.size() * 2)
+            size *= 2;
+        mLookup.assign(size, Entry {0, nullptr, nullptr});
+
+        const std::size_t mask = size - 1;
+        Misc::StableHash indexStamp;
+        for (std::map<std::string, File*>::const_iterator it = mIndex.begin(); it != mIndex.end(); ++it)
+        {
+            indexStamp.add(it->first);
+
+            Misc::StableHash stableHash;
+            stableHash.add(it->first.data(), it->first.size());
+            const std::uint64_t hash = stableHash.getValue();
+
+            std::size_t slot = static_cast<std::size_t>(hash) & mask;
+            while (mLookup[slot].mName != nullptr)
+                slot = (slot + 1) & mask;
+            mLookup[slot] = Entry {hash, &it->first, it->second};
+        }
+        mIndexStamp = indexStamp.getValue();
+    }
+
+    template <class Normalize>
+    File* Manager::lookup(boost::string_view name, Normalize normalize) const
+    {
+        if (mLookup.empty())
+            return nullptr;
+
+        Misc::StableHash stableHash;
+        for (char ch : name)
+            stableHash.add(normalize(ch));
+        const std::uint64_t hash = stableHash.getValue();
+
+        const std::size_t mask = mLookup.size() - 1;
+        for (std::size_t slot = static_cast<std::size_t>(hash) & mask; ; slot = (slot + 1) & mask)
+        {
+            const Entry& entry = mLookup[slot];
+            if (entry.mName == nullptr)
+                return nullptr;
+            if (entry.mHash == hash && entry.mName->size() == name.size()
+                && std::equal(name.begin(), name.end(), entry.mName->begin(),
+                              [&] (char ch, char normalized) { return normalize(ch) == normalized; }))
+                return entry.mFile;
+        }
+    }
+
+    File* Manager::lookup(boost::string_view name) const
+    {
+        if (mStrict)
+            return lookup(name, StrictNormalizeChar());
+        return lookup(name, NonStrictNormalizeChar());
     }
 
-    Files::IStreamPtr Manager::get(const std::string &name) const
+    Files::IStreamPtr Manager::get(boost::string_view name) const
     {
-        std::string normalized = name;
+        if (File* file = lookup(name))
+            return file->open();
+
+        std::string normalized = name.to_string();
         normalize_path(normalized, mStrict);
+        throw std::runtime_error("Resource '" + normalized + "' not found");
+    }
 
-        return getNormalized(normalized);
+    Files::IStreamPtr Manager::getNormalized(boost::string_view normalizedName) const
+    {
+        if (File* file = lookup(normalizedName, KeepChar()))
+            return file->open();
+        throw std::runtime_error("Resource '" + normalizedName.to_string() + "' not found");
     }
 
-    Files::IStreamPtr Manager::getNormalized(const std::string &normalizedName) const
+    std::uint64_t Manager::getStamp(boost::string_view name) const
     {
-        std::map<std::string, File*>::const_iterator found = mIndex.find(normalizedName);
-        if (found == mIndex.end())
-            throw std::runtime_error("Resource '" + normalizedName + "' not found");
-        return found->second->open();
+        if (File* file = lookup(name))
+            return file->getStamp();
+        return 0;
     }
 
-    bool Manager::exists(const std::string &name) const
+    std::uint64_t Manager::getIndexStamp() const
     {
-        std::string normalized = name;
-        normalize_path(normalized, mStrict);
+        return mIndexStamp;
+    }
 
-        return mIndex.find(normalized) != mIndex.end();
+    bool Manager::exists(boost::string_view name) const
+    {
+        return lookup(name) != nullptr;
+    }
+
+    bool Manager::existsNormalized(boost::string_view normalizedName) const
+    {
+        return lookup(normalizedName, KeepChar()) != nullptr;
     }
 
     const std::map<std::string, File*>& Manager::getIndex() const
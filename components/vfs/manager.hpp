@@ -3,9 +3,12 @@
 
 #include <components/files/constrainedfilestream.hpp>
 
+#include <cstdint>
 #include <vector>
 #include <map>
 
+#include <boost/utility/string_view.hpp>
+
 namespace VFS
 {
 
@@ -37,8 +40,13 @@ namespace VFS
         void buildIndex();
 
         /// Does a file with this name exist?
+        /// @note The name is normalized on the fly while hashing, without making a copy.
+        /// @note May be called from any thread once the index has been built.
+        bool exists(boost::string_view name) const;
+
+        /// Does a file with this name exist? (name is already normalized)
         /// @note May be called from any thread once the index has been built.
-        bool exists(const std::string& name) const;
+        bool existsNormalized(boost::string_view normalizedName) const;
 
         /// Get a complete list of files from all archives
         /// @note May be called from any thread once the index has been built.
@@ -51,19 +59,49 @@ namespace VFS
         /// Retrieve a file by name.
         /// @note Throws an exception if the file can not be found.
         /// @note May be called from any thread once the index has been built.
-        Files::IStreamPtr get(const std::string& name) const;
+        Files::IStreamPtr get(boost::string_view name) const;
 
         /// Retrieve a file by name (name is already normalized).
         /// @note Throws an exception if the file can not be found.
         /// @note May be called from any thread once the index has been built.
-        Files::IStreamPtr getNormalized(const std::string& normalizedName) const;
+        Files::IStreamPtr getNormalized(boost::string_view normalizedName) const;
+
+        /// Identify the contents of a file without reading it, see File::getStamp.
+        /// @return 0 if the file can not be found or its stamp is unknown.
+        /// @note May be called from any thread once the index has been built.
+        std::uint64_t getStamp(boost::string_view name) const;
+
+        /// Identify the set of file names in the index, which changes when a file is added to or removed from a data
+        /// directory or when an archive is added, unlike the stamps of the files already in the index.
+        /// @note May be called from any thread once the index has been built.
+        std::uint64_t getIndexStamp() const;
 
     private:
+        /// Slot of the lookup table. The name is interned in mIndex, an empty slot has no name.
+        struct Entry
+        {
+            std::uint64_t mHash;
+            const std::string* mName;
+            File* mFile;
+        };
+
+        template <class Normalize>
+        File* lookup(boost::string_view name, Normalize normalize) const;
+
+        File* lookup(boost::string_view name) const;
+
         bool mStrict;
 
         std::vector<Archive*> mArchives;
 
         std::map<std::string, File*> mIndex;
+
+        std::uint64_t mIndexStamp;
+
+        /// Open addressing hash table over mIndex with linear probing, used for lookups.
+        /// Its size is a power of two and it is at most half full, so probing always ends on an empty slot.
+        /// It is not modified after buildIndex(), so concurrent lookups need no locking.
+        std::vector<Entry> mLookup;
     };
 
 }
@@ -2,6 +2,61 @@
 
 uniform int colorMode;
 
+#if @clusteredLighting
+// Must match sMaxLightsPerCluster in lightmanager.cpp
+#define MAX_CLUSTER_LIGHTS 64
+
+// 4 texels per light: view position and range, diffuse and constant attenuation, ambient and linear attenuation,
+// quadratic attenuation
+uniform sampler2D lightClusterLights;
+// Offset and count of the light indices of each cluster, a row of tiles per depth slice
+uniform sampler2D lightClusters;
+uniform sampler2D lightClusterIndices;
+// Tiles along x and y, depth slices, rows of the light texture
+uniform vec4 lightClusterGrid;
+uniform vec2 lightClusterIndexSize;
+// Depth where the second slice starts, slices per unit of log(depth / near)
+uniform vec2 lightClusterDepth;
+
+vec4 fetchClusterTexel(sampler2D data, float x, float y, vec2 size)
+{
+    return texture2D(data, (vec2(x, y) + 0.5) / size);
+}
+
+// Offset and count of the light indices of the cluster containing a view space position
+vec2 getLightCluster(vec3 viewPos)
+{
+    vec4 clip = gl_ProjectionMatrix * vec4(viewPos, 1.0);
+    // Positions behind the eye are in the first slice, which covers the whole screen for lights reaching them
+    float w = gl_ProjectionMatrix[2][3] != 0.0 ? max(clip.w, 1e-4) : clip.w;
+    vec2 tile = clamp(floor((clip.xy / w * 0.5 + 0.5) * lightClusterGrid.xy), vec2(0.0), lightClusterGrid.xy - 1.0);
+    float depth = -viewPos.z;
+    float slice = depth > lightClusterDepth.x ? min(floor(log(depth / lightClusterDepth.x) * lightClusterDepth.y), lightClusterGrid.z - 1.0) : 0.0;
+    return fetchClusterTexel(lightClusters, tile.y * lightClusterGrid.x + tile.x, slice, vec2(lightClusterGrid.x * lightClusterGrid.y, lightClusterGrid.z)).ra;
+}
+
+void perClusterLight(out vec3 ambientOut, out vec3 diffuseOut, float index, vec3 viewPos, vec3 viewNormal, vec4 diffuse, vec3 ambient)
+{
+    float indexRow = floor(index / lightClusterIndexSize.x);
+    float light = fetchClusterTexel(lightClusterIndices, index - indexRow * lightClusterIndexSize.x, indexRow, lightClusterIndexSize).r;
+    vec2 lightsSize = vec2(4.0, lightClusterGrid.w);
+    vec4 position = fetchClusterTexel(lightClusterLights, 0.0, light, lightsSize);
+    vec4 lightDiffuse = fetchClusterTexel(lightClusterLights, 1.0, light, lightsSize);
+    vec4 lightAmbient = fetchClusterTexel(lightClusterLights, 2.0, light, lightsSize);
+    float quadraticAttenuation = fetchClusterTexel(lightClusterLights, 3.0, light, lightsSize).r;
+
+    vec3 lightDir = position.xyz - viewPos;
+    float lightDistance = length(lightDir);
+    lightDir = normalize(lightDir);
+    float illumination = clamp(1.0 / (lightDiffuse.w + lightAmbient.w * lightDistance + quadraticAttenuation * lightDistance * lightDistance), 0.0, 1.0);
+    // The light ends where its range ends, fade it out instead of showing the bounds of the clusters
+    illumination *= 1.0 - smoothstep(0.5 * position.w, position.w, lightDistance);
+
+    ambientOut = ambient * lightAmbient.xyz * illumination;
+    diffuseOut = diffuse.xyz * lightDiffuse.xyz * max(dot(viewNormal.xyz, lightDir), 0.0) * illumination;
+}
+#endif
+
 void perLight(out vec3 ambientOut, out vec3 diffuseOut, int lightIndex, vec3 viewPos, vec3 viewNormal, vec4 diffuse, vec3 ambient)
 {
     vec3 lightDir;
@@ -49,11 +104,24 @@ vec4 doLighting(vec3 viewPos, vec3 viewNormal, vec4 vertexColor, out vec3 shadow
     shadowDiffuse = diffuseLight;
     lightResult.xyz -= shadowDiffuse; // This light gets added a second time in the loop to fix Mesa users' slowdown, so we need to negate its contribution here.
 #endif
+#if @clusteredLighting
+    // The lights after the first one are found through the clusters
+    lightResult.xyz += ambientLight + diffuseLight;
+    vec2 cluster = getLightCluster(viewPos);
+    for (int i=0; i<MAX_CLUSTER_LIGHTS; ++i)
+    {
+        if (float(i) >= cluster.y)
+            break;
+        perClusterLight(ambientLight, diffuseLight, cluster.x + float(i), viewPos, viewNormal, diffuse, ambient);
+        lightResult.xyz += ambientLight + diffuseLight;
+    }
+#else
     for (int i=0; i<MAX_LIGHTS; ++i)
     {
         perLight(ambientLight, diffuseLight, i, viewPos, viewNormal, diffuse, ambient);
         lightResult.xyz += ambientLight + diffuseLight;
     }
+#endif
 
     lightResult.xyz += gl_LightModel.ambient.xyz * ambient;
 
@@ -51,20 +51,41 @@ centroid varying vec4 passColor;
 varying vec3 passViewPos;
 varying vec3 passNormal;
 
+#if @instancing
+// xyz: position, w: scale
+attribute vec4 instanceOffset;
+attribute vec4 instanceRotation;
+
+vec3 rotateByInstance(vec3 v)
+{
+    vec3 uv = cross(instanceRotation.xyz, v);
+    vec3 uuv = cross(instanceRotation.xyz, uv);
+    return v + 2.0 * (instanceRotation.w * uv + uuv);
+}
+#endif
+
 #include "shadows_vertex.glsl"
 
 #include "lighting.glsl"
 
 void main(void)
 {
-    gl_Position = gl_ModelViewProjectionMatrix * gl_Vertex;
+#if @instancing
+    vec4 vertex = vec4(rotateByInstance(gl_Vertex.xyz * instanceOffset.w) + instanceOffset.xyz * gl_Vertex.w, gl_Vertex.w);
+    vec3 normal = rotateByInstance(gl_Normal);
+#else
+    vec4 vertex = gl_Vertex;
+    vec3 normal = gl_Normal;
+#endif
+
+    gl_Position = gl_ModelViewProjectionMatrix * vertex;
 
-    vec4 viewPos = (gl_ModelViewMatrix * gl_Vertex);
+    vec4 viewPos = (gl_ModelViewMatrix * vertex);
     gl_ClipVertex = viewPos;
     euclideanDepth = length(viewPos.xyz);
     linearDepth = gl_Position.z;
 
-    vec3 viewNormal = normalize((gl_NormalMatrix * gl_Normal).xyz);
+    vec3 viewNormal = normalize((gl_NormalMatrix * normal).xyz);
 
 #if @envMap
     vec3 viewVec = normalize(viewPos.xyz);
@@ -95,8 +116,12 @@ void main(void)
 
 #if @normalMap
     normalMapUV = (gl_TextureMatrix[@normalMapUV] * gl_MultiTexCoord@normalMapUV).xy;
+#if @instancing
+    passTangent = vec4(rotateByInstance(gl_MultiTexCoord7.xyz), gl_MultiTexCoord7.w);
+#else
     passTangent = gl_MultiTexCoord7.xyzw;
 #endif
+#endif
 
 #if @bumpMap
     bumpMapUV = (gl_TextureMatrix[@bumpMapUV] * gl_MultiTexCoord@bumpMapUV).xy;
@@ -112,7 +137,7 @@ void main(void)
     passColor = gl_Color;
 #endif
     passViewPos = viewPos.xyz;
-    passNormal = gl_Normal.xyz;
+    passNormal = normal;
 
     setupShadowCoords(viewPos, viewNormal);
 }